@@ -0,0 +1,87 @@
+#include <neogfx/neogfx.hpp>
+#include <iostream>
+#include <neogfx/app/app.hpp>
+#include <neogfx/core/timer.hpp>
+#include <neogfx/gfx/image.hpp>
+#include <neogfx/gui/window/window.hpp>
+#include "../../../src/gui/window/native/software_window.hpp"
+
+namespace ng = neogfx;
+
+// Renders a window with the software renderer (no display or GPU needed) and checks the resulting pixels;
+// exits with EXIT_FAILURE if any pixel is wrong so it can be run as part of a CI build.
+int main(int, char* argv[])
+{
+	char software[] = "--software";
+	char* arguments[] = { argv[0], software };
+	ng::app app(2, arguments, "neoGFX Headless Rendering Check");
+
+	ng::window window(ng::size{ 64.0, 64.0 }, "Headless", ng::window_style::None);
+	window.set_background_colour(ng::colour::Red);
+	window.paint_overlay([](ng::graphics_context& aGraphicsContext)
+	{
+		aGraphicsContext.fill_rect(ng::rect{ ng::point{ 16.0, 16.0 }, ng::size{ 16.0, 16.0 } }, ng::colour::Blue);
+	});
+	window.native_surface().invalidate(ng::rect{ ng::point{}, window.surface_size() });
+	window.native_surface().render(true);
+
+	struct expected_pixel
+	{
+		int32_t x;
+		int32_t y;
+		ng::colour colour;
+	};
+	const expected_pixel expectedPixels[] =
+	{
+		{ 0, 0, ng::colour::Red },
+		{ 15, 15, ng::colour::Red },
+		{ 16, 16, ng::colour::Blue },
+		{ 31, 31, ng::colour::Blue },
+		{ 32, 32, ng::colour::Red },
+		{ 63, 63, ng::colour::Red }
+	};
+	const ng::software_frame_buffer& frameBuffer = static_cast<const ng::software_window&>(window.native_surface()).frame_buffer();
+	int failures = 0;
+	for (const auto& expected : expectedPixels)
+	{
+		ng::colour actual = frameBuffer.get_pixel(expected.x, expected.y);
+		if (!(actual == expected.colour))
+		{
+			std::cerr << "pixel (" << expected.x << ", " << expected.y << "): expected " << expected.colour.to_hex_string() << ", got " << actual.to_hex_string() << std::endl;
+			++failures;
+		}
+	}
+
+	// A staged image larger than one frame's upload budget has to finish uploading, and be repainted, without any input
+	// waking a blocking event loop; the watchdog fails the check if it is still pending after ten seconds.
+	auto& textureManager = app.rendering_engine().texture_manager();
+	textureManager.set_upload_budget(1024u);
+	ng::image stagedImage{ ng::size{ 16.0, 16.0 }, ng::colour::Green };
+	auto atlas = textureManager.create_texture_atlas(ng::size{ 64.0, 64.0 });
+	auto& stagedTexture = atlas->create_sub_texture(stagedImage, ng::texture_upload::Staged);
+	window.paint_overlay([&](ng::graphics_context& aGraphicsContext)
+	{
+		aGraphicsContext.draw_texture(ng::point{ 40.0, 40.0 }, stagedTexture);
+		if (!textureManager.uploads_pending())
+			app.quit(EXIT_SUCCESS);
+	});
+	ng::callback_timer watchdog{ app, [&app](ng::callback_timer&) { app.quit(EXIT_FAILURE); }, 10000 };
+	app.set_event_loop_mode(ng::event_loop_mode::Blocking);
+	window.native_surface().invalidate(ng::rect{ ng::point{}, window.surface_size() });
+	if (app.exec() != EXIT_SUCCESS)
+	{
+		std::cerr << "staged upload did not complete without input" << std::endl;
+		++failures;
+	}
+	else
+	{
+		ng::colour actual = frameBuffer.get_pixel(47, 47);
+		if (!(actual == ng::colour::Green))
+		{
+			std::cerr << "staged texture pixel (47, 47): expected " << ng::colour(ng::colour::Green).to_hex_string() << ", got " << actual.to_hex_string() << std::endl;
+			++failures;
+		}
+	}
+	std::cout << (failures == 0 ? "passed" : "FAILED") << std::endl;
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
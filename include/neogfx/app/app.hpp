@@ -21,11 +21,15 @@
 
 #include <neogfx/neogfx.hpp>
 #include <map>
+#include <vector>
+#include <mutex>
+#include <functional>
 #include <boost/optional.hpp>
 #include <boost/pool/pool_alloc.hpp>
 #include <boost/program_options.hpp>
 #include <neolib/thread.hpp>
 #include <neolib/io_task.hpp>
+#include <neogfx/core/timer.hpp>
 #include <neogfx/app/i_app.hpp>
 #include <neogfx/app/i_service_factory.hpp>
 #include <neogfx/app/i_basic_services.hpp>
@@ -40,6 +44,12 @@
 
 namespace neogfx
 {
+	enum class event_loop_mode
+	{
+		Polling,
+		Blocking	// Sleep on the native event queue until input, a posted callback or the next frame or callback_timer deadline.
+	};
+
 	class app : public neolib::thread, public neolib::io_task, private async_event_queue, public i_app, private i_keyboard_handler
 	{
 	public:
@@ -116,6 +126,8 @@ namespace neogfx
 		struct action_not_found : std::runtime_error { action_not_found() : std::runtime_error("neogfx::app::action_not_found") {} };
 		struct style_not_found : std::runtime_error { style_not_found() : std::runtime_error("neogfx::app::style_not_found") {} };
 		struct style_exists : std::runtime_error { style_exists() : std::runtime_error("neogfx::app::style_exists") {} };
+	public:
+		static const uint32_t kStagedUploadInterval_ms = 16;
 	public:
 		app(const std::string& aName = std::string(), i_service_factory& aServiceFactory = default_service_factory());
 		app(int argc, char* argv[], const std::string& aName = std::string(), i_service_factory& aServiceFactory = default_service_factory());
@@ -161,9 +173,16 @@ namespace neogfx
 		virtual void remove_mnemonic(i_mnemonic& aMnemonic);
 	public:
 		virtual bool process_events(i_event_processing_context& aContext);
+		bool process_events_or_wait(i_event_processing_context& aContext);
+		neogfx::event_loop_mode event_loop_mode() const;
+		void set_event_loop_mode(neogfx::event_loop_mode aMode);
+		void post(const std::function<void()>& aCallback);
+		void wake();
 	private:
 		virtual void task() {}
 		bool do_process_events();
+		bool process_posted();
+		void wait_for_events();
 	private:
 		virtual bool key_pressed(scan_code_e aScanCode, key_code_e aKeyCode, key_modifiers_e aKeyModifiers);
 		virtual bool key_released(scan_code_e aScanCode, key_code_e aKeyCode, key_modifiers_e aKeyModifiers);
@@ -175,6 +194,7 @@ namespace neogfx
 		std::string iName;
 		bool iQuitWhenLastWindowClosed;
 		bool iInExec;
+		neogfx::event_loop_mode iEventLoopMode;
 		std::unique_ptr<i_basic_services> iBasicServices;
 		std::unique_ptr<i_keyboard> iKeyboard;
 		std::unique_ptr<i_clipboard> iClipboard;
@@ -198,8 +218,10 @@ namespace neogfx
 		i_action& iActionPaste;
 		i_action& iActionDelete;
 		i_action& iActionSelectAll;
-		neolib::callback_timer iStandardActionManager;
+		callback_timer iStandardActionManager;
 		mnemonic_list iMnemonics;
 		std::unique_ptr<event_processing_context> iContext;
+		std::mutex iPostedMutex;
+		std::vector<std::function<void()>> iPosted;
 	};
 }
\ No newline at end of file
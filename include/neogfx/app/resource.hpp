@@ -32,6 +32,7 @@ namespace neogfx
 		resource() = delete;
 		resource(i_resource_manager& aManager, const std::string& aUri);
 		resource(i_resource_manager& aManager, const std::string& aUri, const void* aData, std::size_t aSize);
+		resource(i_resource_manager& aManager, const std::string& aUri, data_type&& aData);
 		~resource();
 	public:
 		virtual bool available() const;
@@ -50,6 +51,6 @@ namespace neogfx
 		std::string iUri;
 		boost::optional<std::string> iError;
 		std::size_t iSize;
-		std::vector<uint8_t> iData;
+		data_type iData;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,77 @@
+// resource_archive.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <unordered_map>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include "i_resource.hpp"
+
+namespace neogfx
+{
+	// Read-only view of a zip archive; the central directory is indexed once on construction and entries are 
+	// extracted individually on demand. Entries that are stored uncompressed can be accessed in place.
+	class resource_archive
+	{
+	public:
+		struct failed_to_open_archive : std::runtime_error { failed_to_open_archive() : std::runtime_error("neogfx::resource_archive::failed_to_open_archive") {} };
+		struct bad_archive : std::runtime_error { bad_archive() : std::runtime_error("neogfx::resource_archive::bad_archive") {} };
+		struct entry_not_found : std::logic_error { entry_not_found() : std::logic_error("neogfx::resource_archive::entry_not_found") {} };
+		struct unsupported_entry : std::runtime_error { unsupported_entry() : std::runtime_error("neogfx::resource_archive::unsupported_entry") {} };
+		struct decompression_failure : std::runtime_error { decompression_failure() : std::runtime_error("neogfx::resource_archive::decompression_failure") {} };
+	public:
+		typedef std::shared_ptr<resource_archive> pointer;
+	private:
+		struct entry
+		{
+			std::string path;
+			uint16_t method;
+			uint32_t compressedSize;
+			uint32_t uncompressedSize;
+			uint32_t localHeaderOffset;
+		};
+		static const uint16_t kMethodStored = 0u;
+		static const uint16_t kMethodDeflated = 8u;
+	public:
+		resource_archive(const std::string& aFilePath);
+		resource_archive(i_resource::pointer aArchiveResource);
+	public:
+		std::size_t file_count() const;
+		const std::string& file_path(std::size_t aIndex) const;
+		bool contains(const std::string& aFilePath) const;
+		std::size_t index_of(const std::string& aFilePath) const;
+		std::size_t file_size(std::size_t aIndex) const;
+		bool is_stored(std::size_t aIndex) const;
+		const void* stored_data(std::size_t aIndex) const;
+		void extract_to(std::size_t aIndex, i_resource::data_type& aBuffer) const;
+		std::string extract_to_string(std::size_t aIndex) const;
+	private:
+		void index();
+		const uint8_t* entry_data(const entry& aEntry) const;
+		void extract_to(const entry& aEntry, uint8_t* aDestination) const;
+	private:
+		boost::iostreams::mapped_file_source iFile;
+		i_resource::pointer iResource;
+		const uint8_t* iData;
+		std::size_t iSize;
+		std::vector<entry> iEntries;
+		std::unordered_map<std::string, std::size_t> iIndex;
+	};
+}
\ No newline at end of file
@@ -22,6 +22,7 @@
 #include <neogfx/neogfx.hpp>
 #include <neolib/variant.hpp>
 #include "i_resource_manager.hpp"
+#include "resource_archive.hpp"
 
 namespace neogfx
 {
@@ -34,11 +35,12 @@ namespace neogfx
 		virtual void add_resource(const std::string& aUri, const void* aResourceData, std::size_t aResourceSize);
 		virtual void add_module_resource(const std::string& aUri, const void* aResourceData, std::size_t aResourceSize);
 		virtual i_resource::pointer load_resource(const std::string& aUri);
+		resource_archive::pointer load_archive(const std::string& aUri);
 	public:
 		virtual void cleanup();
 		virtual void clean();
 	private:
 		std::map<std::string, neolib::variant<i_resource::pointer, i_resource::weak_pointer>> iResources;
-		std::map<std::string, neolib::variant<i_resource::pointer, i_resource::weak_pointer>> iResourceArchives;
+		std::map<std::string, resource_archive::pointer> iResourceArchives;
 	};
 }
\ No newline at end of file
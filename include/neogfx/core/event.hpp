@@ -22,6 +22,9 @@
 #include <neogfx/neogfx.hpp>
 #include <list>
 #include <deque>
+#include <vector>
+#include <tuple>
+#include <utility>
 #include <boost/optional.hpp>
 #include <boost/pool/pool_alloc.hpp>
 #include <neolib/destroyable.hpp>
@@ -61,11 +64,20 @@ namespace neogfx
 		struct instance_exists : std::logic_error { instance_exists() : std::logic_error("neogfx::async_event_queue::instance_exists") {} };
 		struct event_not_found : std::logic_error { event_not_found() : std::logic_error("neogfx::async_event_queue::event_not_found") {} };
 	private:
-		typedef std::multimap<const void*, std::pair<callback, neolib::destroyable::destroyed_flag>> event_list;
+		struct queued_event
+		{
+			const void* source;
+			callback handler;
+			neolib::destroyable::destroyed_flag destroyed;
+		};
+		typedef std::vector<queued_event> event_list;
 	public:
-		async_event_queue(neolib::io_task& aIoTask);
+		async_event_queue();
 		~async_event_queue();
 		static async_event_queue& instance();
+	public:
+		bool pending() const;
+		bool exec();
 	public:
 		template<typename... Arguments>
 		void add(const event<Arguments...>& aEvent, callback aCallback)
@@ -88,8 +100,9 @@ namespace neogfx
 		bool has(const void* aEvent) const;
 	private:
 		static async_event_queue* sInstance;
-		neolib::callback_timer iTimer;
 		event_list iEvents;
+		event_list iProcessing;
+		bool iExecuting;
 	};
 
 	enum class event_trigger_type
@@ -115,7 +128,15 @@ namespace neogfx
 		typedef typename handle::handler_list_item handler_list_item;
 		typedef typename handle::handler_list handler_list;
 		typedef std::map<unique_id_type, typename handler_list::iterator> unique_id_map;
-		typedef std::deque<typename handler_list::const_iterator> notification_list;
+		// Position of an in-progress sync_trigger() (lives on its stack); unsubscribe() adjusts every active cursor so
+		// handlers can be added and removed during dispatch without the handler list having to be copied.
+		struct dispatch_cursor
+		{
+			typename handler_list::const_iterator next;
+			typename handler_list::const_iterator last;
+			bool done;
+			dispatch_cursor* previous;
+		};
 		struct instance_data
 		{
 			instance_ptr instancePtr;
@@ -123,9 +144,34 @@ namespace neogfx
 			unique_id_map uniqueIdMap;
 			event_trigger_type triggerType;
 			bool accepted;
-			notification_list notifications;
+			dispatch_cursor* cursors;
 		};
 		typedef std::list<instance_data, boost::fast_pool_allocator<instance_data>> instance_data_list;
+		// Arguments of an asynchronous trigger: const references are copied as the referenced value may not outlive the
+		// trigger call; non-const references refer to objects owned by the caller and are kept as references.
+		template <typename T>
+		struct queued_argument { typedef T type; };
+		template <typename T>
+		struct queued_argument<const T&> { typedef T type; };
+		typedef std::tuple<typename queued_argument<Arguments>::type...> queued_arguments;
+		// Unlinks a dispatch_cursor however dispatch ends (including a handler throwing) unless the event was
+		// destroyed by a handler in which case its instance data is already gone.
+		struct dispatch_cursor_link
+		{
+			instance_data& instance;
+			dispatch_cursor& cursor;
+			const destroyed_flag& destroyed;
+			dispatch_cursor_link(instance_data& aInstance, dispatch_cursor& aCursor, const destroyed_flag& aDestroyed) :
+				instance(aInstance), cursor(aCursor), destroyed(aDestroyed)
+			{
+				instance.cursors = &cursor;
+			}
+			~dispatch_cursor_link()
+			{
+				if (!destroyed)
+					instance.cursors = cursor.previous;
+			}
+		};
 	public:
 		event()
 		{
@@ -168,18 +214,23 @@ namespace neogfx
 			if (!has_instance()) // no instance means no subscribers so no point triggering.
 				return true;
 			destroyed_flag destroyed(*this);
-			for (auto i = instance().handlers.begin(); i != instance().handlers.end(); ++i)
-				instance().notifications.push_back(i);
-			while (!instance().notifications.empty())
+			auto& handlers = instance().handlers;
+			dispatch_cursor cursor{ handlers.begin(), handlers.end(), handlers.empty(), instance().cursors };
+			if (!cursor.done)
+				cursor.last = std::prev(handlers.end()); // handlers subscribed during dispatch are not notified until the next trigger
+			dispatch_cursor_link link{ instance(), cursor, destroyed };
+			while (!cursor.done)
 			{
-				auto i = instance().notifications.front();
-				instance().notifications.pop_front();
+				auto i = cursor.next;
+				if (i == cursor.last)
+					cursor.done = true;
+				else
+					++cursor.next;
 				i->iHandlerCallback(aArguments...);
 				if (destroyed)
 					return false;
 				if (instance().accepted)
 				{
-					instance().notifications.clear();
 					instance().accepted = false;
 					return false;
 				}
@@ -190,7 +241,9 @@ namespace neogfx
 		{
 			if (!has_instance()) // no instance means no subscribers so no point triggering.
 				return;
-			async_event_queue::instance().add(*this, [&]() { sync_trigger(aArguments...); });
+			// the queued trigger outlives this call so it holds its own copy of the arguments
+			queued_arguments arguments{ aArguments... };
+			async_event_queue::instance().add(*this, [this, arguments]() { queued_trigger(arguments, std::index_sequence_for<Arguments...>{}); });
 		}
 		void accept() const
 		{
@@ -200,6 +253,10 @@ namespace neogfx
 		{
 			instance().accepted = false;
 		}
+		bool has_subscribers() const
+		{
+			return has_instance() && !instance().handlers.empty();
+		}
 	public:
 		handle subscribe(const handler_callback& aHandlerCallback, const void* aUniqueId = 0) const
 		{
@@ -255,7 +312,20 @@ namespace neogfx
 	private:
 		void unsubscribe(handle aHandle) const
 		{
-			instance().notifications.erase(std::remove(instance().notifications.begin(), instance().notifications.end(), aHandle.iHandler), instance().notifications.end());
+			for (auto cursor = instance().cursors; cursor != nullptr; cursor = cursor->previous)
+			{
+				if (cursor->done)
+					continue;
+				if (cursor->last == aHandle.iHandler)
+				{
+					if (cursor->next == aHandle.iHandler)
+						cursor->done = true;
+					else
+						cursor->last = std::prev(cursor->last);
+				}
+				else if (cursor->next == aHandle.iHandler)
+					++cursor->next;
+			}
 			if (aHandle.iHandler->iUniqueId != 0)
 			{
 				auto existing = instance().uniqueIdMap.find(aHandle.iHandler->iUniqueId);
@@ -264,6 +334,11 @@ namespace neogfx
 			}
 			instance().handlers.erase(aHandle.iHandler);
 		}
+		template <std::size_t... Indexes>
+		void queued_trigger(const queued_arguments& aArguments, std::index_sequence<Indexes...>) const
+		{
+			sync_trigger(std::get<Indexes>(aArguments)...);
+		}
 		bool has_instance() const
 		{
 			return iInstanceData != boost::none;
@@ -123,15 +123,18 @@ namespace neogfx
 		{ 
 			return iPaths; 
 		}
-		std::vector<xyz> to_vertices(const typename paths_type::value_type& aPath, coordinate_type aPixelAdjust = 0.0) const
+		template <typename Vertex = xyz>
+		std::vector<Vertex> to_vertices(const typename paths_type::value_type& aPath, coordinate_type aPixelAdjust = 0.0) const
 		{
-			std::vector<xyz> result;
+			typedef typename Vertex::value_type vertex_coordinate;
+			auto vertex = [](coordinate_type aX, coordinate_type aY) { return Vertex{ { static_cast<vertex_coordinate>(aX), static_cast<vertex_coordinate>(aY) } }; };
+			std::vector<Vertex> result;
 			result.reserve((aPath.size() + 1) * (iShape == Quads ? 6 : 1));
 			if (aPath.size() > 2)
 			{
 				if (iShape == ConvexPolygon)
 				{
-					result.push_back(xyz{ bounding_rect(false).centre().x + position().x + aPixelAdjust, bounding_rect(false).centre().y + position().y + aPixelAdjust });
+					result.push_back(vertex(bounding_rect(false).centre().x + position().x + aPixelAdjust, bounding_rect(false).centre().y + position().y + aPixelAdjust));
 				}
 				for (auto vi = aPath.begin(); vi != aPath.end(); ++vi)
 				{
@@ -140,15 +143,15 @@ namespace neogfx
 					case Quads:
 						if (vi + 1 != aPath.end())
 						{
-							result.push_back(xyz{ vi->x + position().x + aPixelAdjust, vi->y + position().y + aPixelAdjust });
-							result.push_back(xyz{ (vi + 1)->x + position().x + aPixelAdjust, (vi + 1)->y + position().y + aPixelAdjust });
-							result.push_back(xyz{ vi->x + position().x + aPixelAdjust, vi->y + position().y + aPixelAdjust });
-							result.push_back(xyz{ (vi + 1)->x + position().x + aPixelAdjust, (vi + 1)->y + position().y + aPixelAdjust });
+							result.push_back(vertex(vi->x + position().x + aPixelAdjust, vi->y + position().y + aPixelAdjust));
+							result.push_back(vertex((vi + 1)->x + position().x + aPixelAdjust, (vi + 1)->y + position().y + aPixelAdjust));
+							result.push_back(vertex(vi->x + position().x + aPixelAdjust, vi->y + position().y + aPixelAdjust));
+							result.push_back(vertex((vi + 1)->x + position().x + aPixelAdjust, (vi + 1)->y + position().y + aPixelAdjust));
 						}
 						break;
 					case ConvexPolygon:
 					default:
-						result.push_back(xyz{ vi->x + position().x + aPixelAdjust, vi->y + position().y + aPixelAdjust });
+						result.push_back(vertex(vi->x + position().x + aPixelAdjust, vi->y + position().y + aPixelAdjust));
 						break;
 					}
 				}
@@ -158,7 +161,7 @@ namespace neogfx
 				}
 				else if (iShape == ConvexPolygon && aPath[0] != aPath[aPath.size() - 1])
 				{
-					result.push_back(xyz{ aPath[0].x + aPixelAdjust, aPath[0].y + aPixelAdjust });
+					result.push_back(vertex(aPath[0].x + aPixelAdjust, aPath[0].y + aPixelAdjust));
 				}
 			}
 			return result;
@@ -0,0 +1,60 @@
+// timer.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <chrono>
+#include <functional>
+#include <boost/optional.hpp>
+#include <neolib/destroyable.hpp>
+#include <neolib/io_task.hpp>
+#include <neolib/timer.hpp>
+
+namespace neogfx
+{
+	// A neolib::callback_timer whose deadline is known so that a blocking event loop (event_loop_mode::Blocking) can
+	// sleep until the earliest timer of its io_task is due; neolib does not expose the expiry of its own timers.
+	class callback_timer : public neolib::destroyable
+	{
+	public:
+		typedef std::function<void(callback_timer&)> callback;
+		typedef std::chrono::steady_clock::time_point time_point;
+	public:
+		callback_timer(neolib::io_task& aIoTask, callback aCallback, uint32_t aDuration_ms, bool aInitialWait = true);
+		~callback_timer();
+	public:
+		static boost::optional<time_point> next_deadline(const neolib::io_task& aIoTask);
+	public:
+		bool waiting() const;
+		uint32_t duration() const;
+		void set_duration(uint32_t aDuration_ms, bool aEffectiveImmediately = false);
+		void again();
+		void again_if();
+		void cancel();
+	private:
+		void expired();
+	private:
+		neolib::io_task& iIoTask;
+		callback iCallback;
+		uint32_t iDuration_ms;
+		boost::optional<time_point> iDeadline;
+		neolib::callback_timer iTimer;
+	};
+}
\ No newline at end of file
@@ -28,7 +28,11 @@ namespace neogfx
 	class i_physical_object
 	{
 	public:
-		typedef std::array<vec3, 6> aabb_type;
+		struct aabb_type
+		{
+			vec3 min;
+			vec3 max;
+		};
 		typedef std::chrono::time_point<std::chrono::steady_clock> time_point;
 		typedef boost::optional<time_point> optional_time_point;
 	public:
@@ -70,6 +74,8 @@ namespace neogfx
 			set_spin_degrees(vec3{ 0.0, 0.0, aSpin });
 		}
 	public:
+		virtual const aabb_type& bounds() const = 0; ///< relative to position
+		virtual void set_bounds(const aabb_type& aBounds) = 0;
 		virtual const aabb_type& aabb() const = 0;
 		virtual bool collided(const i_physical_object& aOther) const = 0;
 		virtual bool update(const optional_time_point& aNow, const vec3& aForce) = 0;
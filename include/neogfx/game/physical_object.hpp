@@ -59,6 +59,8 @@ namespace neogfx
 		virtual void set_spin_degrees(const vec3& aSpin);
 		virtual void set_mass(scalar aMass);
 	public:
+		virtual const aabb_type& bounds() const;
+		virtual void set_bounds(const aabb_type& aBounds);
 		virtual const aabb_type& aabb() const;
 		virtual bool collided(const i_physical_object& aOther) const;
 		virtual bool update(const optional_time_point& aNow, const vec3& aForce);
@@ -70,6 +72,7 @@ namespace neogfx
 		bool apply_physics(double aElapsedTime, const vec3& aForce);
 	private:
 		vec3 iOrigin;
+		aabb_type iBounds;
 		mutable aabb_type iAxisAlignedBoundingBox;
 		optional_time_point iTimeOfLastUpdate;
 		mutable optional_physics iCurrentPhysics;
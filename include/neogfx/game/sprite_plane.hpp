@@ -31,6 +31,7 @@ namespace neogfx
 	public:
 		event<> applying_physics;
 		event<> physics_applied;
+		event<i_physical_object&, i_physical_object&> objects_collided;
 		event<graphics_context&> painting_sprites;
 		event<graphics_context&> sprites_painted;
 	public:
@@ -38,9 +39,34 @@ namespace neogfx
 		typedef std::vector<std::shared_ptr<i_sprite>> sprite_list;
 		typedef std::vector<std::shared_ptr<i_physical_object>> object_list;
 		typedef std::map<const i_shape*, std::pair<i_shape*, vec3>> buddy_list;
+		typedef std::vector<std::pair<i_physical_object*, i_physical_object*>> collision_list;
 	private:
 		typedef std::list<sprite, boost::fast_pool_allocator<sprite>> simple_sprite_list;
 		typedef std::list<physical_object, boost::fast_pool_allocator<physical_object>> simple_object_list;
+		struct broad_phase_entry
+		{
+			i_physical_object* object;
+			vec3 min;
+			vec3 max;
+		};
+		struct mass_body
+		{
+			i_physical_object* object;
+			vec3 position;
+			scalar mass;
+			uint32_t next;
+		};
+		struct mass_node
+		{
+			vec3 centre;
+			scalar halfSize;
+			vec3 centreOfMass;
+			scalar mass;
+			uint32_t firstChild;
+			uint32_t firstBody;
+		};
+		static const uint32_t kNoMassTreeIndex = 0xFFFFFFFF;
+		static const uint32_t kMaxMassTreeDepth = 24;
 	public:
 		struct no_buddy : std::logic_error { no_buddy() : std::logic_error("neogfx::sprite_plane::no_buddy") {} };
 		struct buddy_exists : std::logic_error { buddy_exists() : std::logic_error("neogfx::sprite_plane::buddy_exists") {} };
@@ -65,6 +91,8 @@ namespace neogfx
 		virtual void unset_buddy(const i_shape& aShape);
 	public:
 		void enable_z_sorting(bool aEnableZSorting);
+		void enable_collision_detection(bool aEnableCollisionDetection);
+		const collision_list& collisions() const;
 	public:
 		void add_shape(i_shape& aShape);
 		void add_shape(std::shared_ptr<i_shape> aShape);
@@ -79,6 +107,9 @@ namespace neogfx
 		void set_gravitational_constant(scalar aG);
 		const optional_vec3& uniform_gravity() const;
 		void set_uniform_gravity(const optional_vec3& aUniformGravity = vec3{ 0.0, -9.80665, 0.0});
+		void enable_barnes_hut(bool aEnableBarnesHut);
+		scalar barnes_hut_theta() const;
+		void set_barnes_hut_theta(scalar aTheta);
 		void add_object(i_physical_object& aObject);
 		void add_object(std::shared_ptr<i_physical_object> aObject);
 		i_physical_object& create_earth(); ///< adds gravity by simulating the earth, groundlevel at y = 0;
@@ -94,11 +125,17 @@ namespace neogfx
 		buddy_list& buddies();
 	private:
 		bool update_objects();
+		void detect_collisions();
+		void build_mass_tree();
+		vec3 mass_tree_force(const i_physical_object& aObject) const;
 	private:
 		sink iSink;
 		bool iEnableZSorting;
+		bool iEnableCollisionDetection;
 		scalar iG;
 		optional_vec3 iUniformGravity;
+		bool iEnableBarnesHut;
+		scalar iBarnesHutTheta;
 		shape_list iShapes;
 		sprite_list iSprites;
 		object_list iObjects;
@@ -107,5 +144,11 @@ namespace neogfx
 		simple_object_list iSimpleObjects;
 		mutable std::vector<i_shape*> iRenderBuffer;
 		mutable std::vector<i_physical_object*> iUpdateBuffer;
+		collision_list iCollisions;
+		std::vector<broad_phase_entry> iBroadPhaseBuffer;
+		std::vector<std::size_t> iBroadPhaseActive;
+		std::vector<mass_body> iMassBodies;
+		std::vector<mass_node> iMassTree;
+		mutable std::vector<uint32_t> iMassTreeStack;
 	};
 }
\ No newline at end of file
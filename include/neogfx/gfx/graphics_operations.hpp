@@ -350,5 +350,10 @@ namespace neogfx
 		typedef neolib::vecarray<operation, 1, -1> batch;
 
 		typedef std::deque<batch> queue;
+
+		optional_rect bounding_rect(const operation& aOperation);
+		// Moves operations into earlier compatible batches where doing so cannot change the result (i.e. they do
+		// not overlap anything they are moved past); operations are never moved across state changes.
+		void reorder(queue& aQueue);
 	}
 }
\ No newline at end of file
@@ -126,9 +126,14 @@ namespace neogfx
 		virtual bool is_subpixel_rendering_on() const = 0;
 		virtual void subpixel_rendering_on() = 0;
 		virtual void subpixel_rendering_off() = 0;
+		virtual bool is_operation_reordering_on() const = 0;
+		virtual void operation_reordering_on() = 0;
+		virtual void operation_reordering_off() = 0;
 	public:
 		virtual void render_now() = 0;
 	public:
 		virtual bool process_events() = 0;
+		virtual bool wait_for_events(const boost::optional<uint32_t>& aTimeout_ms) = 0; // no timeout: wait until woken
+		virtual void wake() = 0;
 	};
 }
\ No newline at end of file
@@ -33,6 +33,12 @@ namespace neogfx
 		Multisample
 	};
 
+	enum class texture_upload
+	{
+		Immediate,
+		Staged		// Pixel data is uploaded in budgeted chunks per frame (see i_texture_manager::process_uploads).
+	};
+
 	class i_texture
 	{
 	public:
@@ -27,6 +27,14 @@ namespace neogfx
 {
 	class i_texture_atlas
 	{
+	public:
+		struct page_statistics
+		{
+			size extents;
+			dimension usedArea;
+			dimension freedArea;
+			uint32_t subTextureCount;
+		};
 	public:
 		struct sub_texture_not_found : std::logic_error { sub_texture_not_found() : std::logic_error("neogfx::i_texture_atlas::sub_texture_not_found") {} };
 		struct texture_too_big_for_atlas : std::logic_error { texture_too_big_for_atlas() : std::logic_error("neogfx::i_texture_atlas::texture_too_big_for_atlas") {} };
@@ -34,7 +42,10 @@ namespace neogfx
 		virtual const i_sub_texture& sub_texture(i_sub_texture::id aSubTextureId) const = 0;
 		virtual i_sub_texture& sub_texture(i_sub_texture::id aSubTextureId) = 0;
 		virtual i_sub_texture& create_sub_texture(const size& aSize, texture_sampling aSampling) = 0;
-		virtual i_sub_texture& create_sub_texture(const i_image& aImage) = 0;
+		virtual i_sub_texture& create_sub_texture(const i_image& aImage, texture_upload aUpload = texture_upload::Immediate) = 0;
 		virtual void destroy_sub_texture(i_sub_texture& aSubTexture) = 0;
+	public:
+		virtual std::vector<page_statistics> statistics() const = 0;
+		virtual uint64_t memory_usage() const = 0;
 	};
 }
\ No newline at end of file
@@ -27,17 +27,28 @@
 namespace neogfx
 {
 	class i_native_texture;
+	class i_native_surface;
 
 	class i_texture_manager
 	{
 	public:
 		struct texture_not_found : std::logic_error { texture_not_found() : std::logic_error("neogfx::i_texture_manager::texture_not_found") {} };
+	public:
+		typedef std::vector<std::pair<const i_native_surface*, rect>> upload_damage;
 	public:
 		virtual std::unique_ptr<i_native_texture> create_texture(const neogfx::size& aExtents, texture_sampling aSampling = texture_sampling::NormalMipmap, const optional_colour& aColour = optional_colour()) = 0;
-		virtual std::unique_ptr<i_native_texture> create_texture(const i_image& aImage) = 0;
+		virtual std::unique_ptr<i_native_texture> create_texture(const i_image& aImage, texture_upload aUpload = texture_upload::Immediate) = 0;
 		virtual std::unique_ptr<i_native_texture> join_texture(const i_native_texture& aTexture) = 0;
 		virtual std::unique_ptr<i_native_texture> join_texture(const i_texture& aTexture) = 0;
 		virtual void clear_textures() = 0;
 		virtual std::unique_ptr<i_texture_atlas> create_texture_atlas(const size& aSize = size{ 1024.0, 1024.0 }) = 0;
+	public:
+		virtual std::size_t upload_budget() const = 0;
+		virtual void set_upload_budget(std::size_t aBytesPerFrame) = 0;
+		virtual void queue_upload(std::shared_ptr<i_native_texture> aTexture, const rect& aRect, i_resource::data_type aPixels) = 0;
+		virtual void cancel_uploads(const i_native_texture& aTexture, const rect& aRect) = 0;
+		virtual bool uploads_pending() const = 0;
+		virtual void texture_drawn(const i_native_texture& aTexture, const rect& aTextureRect, const i_native_surface& aSurface, const rect& aSurfaceRect) = 0;
+		virtual upload_damage process_uploads() = 0;
 	};
 }
\ No newline at end of file
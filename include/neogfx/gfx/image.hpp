@@ -27,6 +27,12 @@
 
 namespace neogfx
 {
+	enum class image_loading
+	{
+		Synchronous,
+		Asynchronous	// Decoded on a worker thread; available() is false until done, then downloaded (or failed_to_download) is triggered.
+	};
+
 	class image : public i_image
 	{
 	public:
@@ -37,12 +43,13 @@ namespace neogfx
 		};
 	private:
 		struct no_resource : std::logic_error { no_resource() : std::logic_error("neogfx::image::no_resource") {} };
+		struct decode_state;
 	public:
 		image(texture_sampling aSampling = texture_sampling::NormalMipmap);
 		image(const neogfx::size& aSize, const colour& aColour = colour::Black, texture_sampling aSampling = texture_sampling::NormalMipmap);
-		image(const std::string& aUri, texture_sampling aSampling = texture_sampling::NormalMipmap);
+		image(const std::string& aUri, texture_sampling aSampling = texture_sampling::NormalMipmap, image_loading aLoading = image_loading::Synchronous);
 		template <typename T, std::size_t Width, std::size_t Height>
-		image(const std::string& aUri, const T(&aImagePattern)[Height][Width], const std::unordered_map<T, colour>& aColourMap, texture_sampling aSampling = texture_sampling::NormalMipmap) : iUri(aUri), iColourFormat(neogfx::colour_format::RGBA8), iSampling(aSampling)
+		image(const std::string& aUri, const T(&aImagePattern)[Height][Width], const std::unordered_map<T, colour>& aColourMap, texture_sampling aSampling = texture_sampling::NormalMipmap) : iUri(aUri), iColourFormat(neogfx::colour_format::RGBA8), iSampling(aSampling), iDecodePending(false)
 		{
 			resize(neogfx::size{ Width, Height });
 			for (std::size_t y = 0; y < Height; ++y)
@@ -50,7 +57,7 @@ namespace neogfx
 					set_pixel(point(x, y), aColourMap.find(aImagePattern[y][x])->second);
 		}
 		template <typename T, std::size_t Width, std::size_t Height>
-		image(const T(&aImagePattern)[Height][Width], const std::unordered_map<T, colour>& aColourMap, texture_sampling aSampling = texture_sampling::NormalMipmap) : iColourFormat(neogfx::colour_format::RGBA8), iSampling(aSampling)
+		image(const T(&aImagePattern)[Height][Width], const std::unordered_map<T, colour>& aColourMap, texture_sampling aSampling = texture_sampling::NormalMipmap) : iColourFormat(neogfx::colour_format::RGBA8), iSampling(aSampling), iDecodePending(false)
 		{
 			resize(neogfx::size{ Width, Height });
 			for (std::size_t y = 0; y < Height; ++y)
@@ -83,13 +90,18 @@ namespace neogfx
 		image_type_e recognize() const;
 		bool load();
 		bool load_png();
+		void load_async();
+		void sync() const;
+		void decode_finished();
 	private:
 		i_resource::pointer iResource;
 		std::string iUri;
-		boost::optional<std::string> iError;
+		mutable boost::optional<std::string> iError;
 		neogfx::colour_format iColourFormat;
-		data_type iData;
+		mutable data_type iData;
 		texture_sampling iSampling;
-		neogfx::size iSize;
+		mutable neogfx::size iSize;
+		mutable bool iDecodePending;
+		std::shared_ptr<decode_state> iDecodeState;
 	};
 }
\ No newline at end of file
@@ -21,6 +21,7 @@
 
 #include <neogfx/neogfx.hpp>
 #include <unordered_map>
+#include <bitset>
 #include <neogfx/gfx/i_texture_manager.hpp>
 #include <neogfx/gfx/i_texture_atlas.hpp>
 #include "i_emoji_atlas.hpp"
@@ -32,6 +33,7 @@ namespace neogfx
 	private:
 		typedef std::map<dimension, std::string> sets;
 		typedef std::map<std::u32string, sets> emojis;
+		typedef std::bitset<256> emoji_block;
 	public:
 		emoji_atlas(i_texture_manager& aTextureManager);
 	public:
@@ -45,5 +47,7 @@ namespace neogfx
 		std::unique_ptr<i_texture_atlas> iTextureAtlas;
 		emojis iEmojis;
 		mutable std::unordered_map<std::u32string, boost::optional<emoji_id>> iEmojiMap;
+		std::vector<uint16_t> iSingleEmojiBlockIndex;
+		std::vector<emoji_block> iSingleEmojiBlocks;
 	};
 }
\ No newline at end of file
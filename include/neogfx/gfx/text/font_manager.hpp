@@ -21,6 +21,8 @@
 
 #include <neogfx/neogfx.hpp>
 #include <set>
+#include <array>
+#include <memory>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include <neolib/string_utils.hpp>
@@ -31,7 +33,11 @@
 namespace neogfx
 {
 	class native_font;
+	class native_font_face;
 	class i_rendering_engine;
+	class i_native_texture;
+	class glyph_rasterizer;
+	struct rasterized_glyph;
 
 	class fallback_font_info : public i_fallback_font_info
 	{
@@ -49,6 +55,16 @@ namespace neogfx
 	private:
 		typedef std::list<native_font> native_font_list;
 		typedef std::map<neolib::ci_string, std::vector<native_font_list::iterator>> font_family_list;
+		struct glyph_page
+		{
+			std::weak_ptr<i_native_texture> texture;
+			uint32_t width;
+			uint32_t height;
+			std::vector<std::array<uint8_t, 4>> pixels;
+			uint32_t dirtyTop;
+			uint32_t dirtyBottom;
+		};
+		typedef std::map<const i_native_texture*, glyph_page> glyph_page_map;
 	public:
 		struct error_initializing_font_library : std::runtime_error { error_initializing_font_library() : std::runtime_error("neogfx::font_manager::error_initializing_font_library") {} };
 		struct no_matching_font_found : std::runtime_error { no_matching_font_found() : std::runtime_error("neogfx::font_manager::no_matching_font_found") {} };
@@ -80,6 +96,21 @@ namespace neogfx
 		virtual i_texture_atlas& glyph_atlas();
 		virtual const i_emoji_atlas& emoji_atlas() const;
 		virtual i_emoji_atlas& emoji_atlas();
+		virtual const neogfx::shaped_text_cache& shaped_text_cache() const;
+		virtual neogfx::shaped_text_cache& shaped_text_cache();
+	public:
+		virtual uint64_t glyph_atlas_budget() const;
+		virtual void set_glyph_atlas_budget(uint64_t aBudgetInBytes);
+		virtual void trim_glyph_atlas();
+		virtual void update_glyph_atlas();
+	private:
+		void add_face(native_font_face& aFace);
+		void remove_face(native_font_face& aFace);
+		uint64_t next_glyph_use();
+		neogfx::glyph_rasterizer& glyph_rasterizer();
+		uint64_t glyph_staging_usage() const;
+		void stage_glyph(const i_sub_texture& aGlyphTexture, const rasterized_glyph& aGlyph);
+		void upload_glyphs();
 	private:
 		i_native_font& find_font(const std::string& aFamilyName, const std::string& aStyleName, font::point_size aSize);
 		i_native_font& find_best_font(const std::string& aFamilyName, font::style_e aStyle, font::point_size aSize);
@@ -92,5 +123,12 @@ namespace neogfx
 		font_family_list iFontFamilies;
 		texture_atlas iGlyphAtlas;
 		neogfx::emoji_atlas iEmojiAtlas;
+		neogfx::shaped_text_cache iShapedTextCache;
+		uint64_t iGlyphAtlasBudget;
+		uint64_t iGlyphUse;
+		uint64_t iGlyphUseAtLastTrim;
+		std::set<native_font_face*> iFaces;
+		glyph_page_map iGlyphPages;
+		std::unique_ptr<neogfx::glyph_rasterizer> iGlyphRasterizer;
 	};
 }
\ No newline at end of file
@@ -31,6 +31,7 @@ namespace neogfx
 	public:
 		struct emoji_not_found : std::logic_error { emoji_not_found() : std::logic_error("neogfx::i_emoji_atlas::emoji_not_found") {} };
 	public:
+		// Latin-1 code points are never emoji; single code point queries must not allocate as they are made for every character shaped.
 		virtual bool is_emoji(char32_t aCodePoint) const = 0;
 		virtual bool is_emoji(const std::u32string& aCodePoints) const = 0;
 		virtual emoji_id emoji(char32_t aCodePoint, dimension aDesiredSize) const = 0;
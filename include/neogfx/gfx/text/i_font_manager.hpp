@@ -23,6 +23,7 @@
 #include <neogfx/core/geometry.hpp>
 #include <neogfx/gfx/i_texture_atlas.hpp>
 #include <neogfx/gfx/text/i_emoji_atlas.hpp>
+#include <neogfx/gfx/text/shaped_text_cache.hpp>
 #include "font.hpp"
 
 namespace neogfx
@@ -62,5 +63,12 @@ namespace neogfx
 		virtual i_texture_atlas& glyph_atlas() = 0;
 		virtual const i_emoji_atlas& emoji_atlas() const = 0;
 		virtual i_emoji_atlas& emoji_atlas() = 0;
+		virtual const neogfx::shaped_text_cache& shaped_text_cache() const = 0;
+		virtual neogfx::shaped_text_cache& shaped_text_cache() = 0;
+	public:
+		virtual uint64_t glyph_atlas_budget() const = 0;
+		virtual void set_glyph_atlas_budget(uint64_t aBudgetInBytes) = 0;
+		virtual void trim_glyph_atlas() = 0;
+		virtual void update_glyph_atlas() = 0;
 	};
 }
\ No newline at end of file
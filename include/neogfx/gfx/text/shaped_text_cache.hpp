@@ -0,0 +1,83 @@
+// shaped_text_cache.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <list>
+#include <unordered_map>
+#include <boost/optional.hpp>
+#include "font.hpp"
+#include "glyph.hpp"
+
+namespace neogfx
+{
+	class i_native_font_face;
+
+	// Process-wide cache of shaped text keyed on the text and everything that influences how it is shaped.
+	// Entries hold a copy of the font so a cached face cannot be destroyed (and its address reused) while cached.
+	class shaped_text_cache
+	{
+	public:
+		struct key
+		{
+			std::string text;
+			bool utf32;
+			const i_native_font_face* face;
+			font::style_e style;
+			bool subpixel;
+			char mnemonicPrefix;
+			bool operator==(const key& aOther) const;
+		};
+		struct key_hash
+		{
+			std::size_t operator()(const key& aKey) const;
+		};
+	private:
+		typedef std::list<std::pair<key, glyph_text>> entry_list;
+		typedef std::unordered_map<key, entry_list::iterator, key_hash> entry_map;
+	public:
+		shaped_text_cache(std::size_t aCapacityInBytes = 4u * 1024u * 1024u);
+	public:
+		const glyph_text* find(const key& aKey);
+		const glyph_text& insert(const key& aKey, const glyph_text& aGlyphText);
+		void clear();
+	public:
+		std::size_t capacity() const;
+		void set_capacity(std::size_t aCapacityInBytes);
+		std::size_t memory_usage() const;
+		uint64_t hits() const;
+		uint64_t misses() const;
+		void reset_counters();
+	public:
+		static key make_key(const std::string& aText, const font& aFont, bool aSubpixel, const boost::optional<std::pair<bool, char>>& aMnemonic);
+		static key make_key(const std::u32string& aText, const font& aFont, bool aSubpixel, const boost::optional<std::pair<bool, char>>& aMnemonic);
+	private:
+		static std::size_t cost(const key& aKey, const glyph_text& aGlyphText);
+		void trim();
+	private:
+		std::size_t iCapacity;
+		std::size_t iMemoryUsage;
+		entry_list iEntries;
+		entry_map iIndex;
+		uint64_t iHits;
+		uint64_t iMisses;
+	};
+}
\ No newline at end of file
@@ -20,6 +20,8 @@
 #pragma once
 
 #include <neogfx/neogfx.hpp>
+#include <array>
+#include <vector>
 #include "glyph.hpp"
 #include "i_emoji_atlas.hpp"
 
@@ -1824,28 +1826,47 @@ namespace neogfx
 			{ 0x100000, text_category::LTR },
 			{ 0x10FFFE, text_category::Unknown }
 		};
+
+		// Two-stage lookup table (block index -> deduplicated block of categories) generated once from TEXT_CATEGORY_MAP.
+		class text_category_table
+		{
+		public:
+			static const uint32_t BlockShift = 8;
+			static const uint32_t BlockSize = 1u << BlockShift;
+			static const uint32_t CodePointCount = 0x110000;
+		private:
+			typedef std::array<text_category, BlockSize> block;
+		private:
+			text_category_table();
+		public:
+			static const text_category_table& instance();
+		public:
+			text_category category(uint32_t aCodePoint) const
+			{
+				if (aCodePoint >= CodePointCount)
+					return text_category::Unknown;
+				return iBlocks[iBlockIndex[aCodePoint >> BlockShift]][aCodePoint & (BlockSize - 1)];
+			}
+		private:
+			std::vector<uint16_t> iBlockIndex;
+			std::vector<block> iBlocks;
+		};
 	}
 
 	inline text_category get_text_category(const i_emoji_atlas& aEmojiAtlas, uint32_t aCodePoint)
 	{
-		if (aEmojiAtlas.is_emoji(aCodePoint))
+		if (aCodePoint >= 0x100 && aEmojiAtlas.is_emoji(aCodePoint))
 			return text_category::Emoji;
-		const detail::TEXT_CATEGORY_MAP_VALUE_TYPE* rangeStart = std::lower_bound(
-			&detail::TEXT_CATEGORY_MAP[0], 
-			&detail::TEXT_CATEGORY_MAP[0] + sizeof(detail::TEXT_CATEGORY_MAP) / sizeof(detail::TEXT_CATEGORY_MAP[0]),
-			detail::TEXT_CATEGORY_MAP_VALUE_TYPE(aCodePoint, text_category::Unknown),
-			[](const detail::TEXT_CATEGORY_MAP_VALUE_TYPE& lhs, const detail::TEXT_CATEGORY_MAP_VALUE_TYPE& rhs) -> bool
-		{
-			return lhs.first < rhs.first;
-		});
-		if (rangeStart != &detail::TEXT_CATEGORY_MAP[0] && aCodePoint < rangeStart->first)
-			--rangeStart;
-		return rangeStart->second;
+		return detail::text_category_table::instance().category(aCodePoint);
 	}
 
-	inline text_direction get_text_direction(const i_emoji_atlas& aEmojiAtlas, uint32_t aCodePoint, text_direction aExistingDirection)
+	// Classifies [aBegin, aEnd) into aResult, which must have room for aEnd - aBegin categories; the table is fetched
+	// once for the whole run and Latin-1 code points never reach the emoji atlas.
+	void get_text_categories(const i_emoji_atlas& aEmojiAtlas, const char32_t* aBegin, const char32_t* aEnd, text_category* aResult);
+
+	inline text_direction get_text_direction(text_category aCategory, text_direction aExistingDirection)
 	{
-		switch (get_text_category(aEmojiAtlas, aCodePoint))
+		switch (aCategory)
 		{
 		case text_category::LTR:
 			return text_direction::LTR;
@@ -1865,4 +1886,9 @@ namespace neogfx
 			return aExistingDirection;
 		}
 	}
+
+	inline text_direction get_text_direction(const i_emoji_atlas& aEmojiAtlas, uint32_t aCodePoint, text_direction aExistingDirection)
+	{
+		return get_text_direction(get_text_category(aEmojiAtlas, aCodePoint), aExistingDirection);
+	}
 }
\ No newline at end of file
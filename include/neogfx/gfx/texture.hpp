@@ -36,7 +36,7 @@ namespace neogfx
 		texture();
 		texture(const neogfx::size& aExtents, texture_sampling aSampling = texture_sampling::NormalMipmap, const optional_colour& aColour = optional_colour());
 		texture(const i_texture& aTexture);
-		texture(const i_image& aImage);
+		texture(const i_image& aImage, texture_upload aUpload = texture_upload::Immediate);
 		~texture();
 		// operations
 	public:
@@ -22,6 +22,7 @@
 #include <neogfx/neogfx.hpp>
 #include <unordered_map>
 #include <tuple>
+#include <limits>
 #include "i_texture_atlas.hpp"
 #include "i_texture_manager.hpp"
 #include "texture.hpp"
@@ -47,16 +48,62 @@ namespace neogfx
 			};
 			skyline_bin_pack pack;
 			std::set<rect, fragment_less_than> used;
-			std::set<rect, fragment_less_than> freed; // todo: use this when bin pack is full
+			std::set<rect, fragment_less_than> freed;
+			dimension usedArea;
+			dimension freedArea;
+			fragments(const size& aPageSize) :
+				pack{ aPageSize }, usedArea{ 0.0 }, freedArea{ 0.0 }
+			{
+			}
 			bool insert(const size& aSize, rect& aResult)
 			{
-				if (pack.insert(aSize, aResult))
+				if (!reuse(aSize, aResult) && !pack.insert(aSize, aResult))
+					return false;
+				used.insert(aResult);
+				usedArea += aResult.width() * aResult.height();
+				return true;
+			}
+			void remove(const rect& aRect)
+			{
+				auto existing = used.find(aRect);
+				if (existing == used.end())
+					return;
+				used.erase(existing);
+				usedArea -= aRect.width() * aRect.height();
+				if (used.empty())
 				{
-					used.insert(aResult);
-					return true;
+					// nothing left on the page so start again with a clean skyline
+					pack.init();
+					freed.clear();
+					freedArea = 0.0;
 				}
 				else
-					return false;
+					add_freed(aRect);
+			}
+		private:
+			bool reuse(const size& aSize, rect& aResult)
+			{
+				// smallest freed space that fits; what is left over is split (guillotine) and kept for reuse
+				for (auto candidate = freed.lower_bound(rect{ point{ std::numeric_limits<coordinate>::lowest(), std::numeric_limits<coordinate>::lowest() }, aSize }); candidate != freed.end(); ++candidate)
+				{
+					if (candidate->cx < aSize.cx || candidate->cy < aSize.cy)
+						continue;
+					rect space = *candidate;
+					freed.erase(candidate);
+					freedArea -= space.width() * space.height();
+					aResult = rect{ space.top_left(), aSize };
+					add_freed(rect{ point{ space.x + aSize.cx, space.y }, size{ space.cx - aSize.cx, aSize.cy } });
+					add_freed(rect{ point{ space.x, space.y + aSize.cy }, size{ space.cx, space.cy - aSize.cy } });
+					return true;
+				}
+				return false;
+			}
+			void add_freed(const rect& aRect)
+			{
+				if (aRect.cx < 1.0 || aRect.cy < 1.0)
+					return;
+				freed.insert(aRect);
+				freedArea += aRect.width() * aRect.height();
 			}
 		};
 		typedef std::pair<texture, fragments> page;
@@ -69,8 +116,11 @@ namespace neogfx
 		virtual const i_sub_texture& sub_texture(i_sub_texture::id aSubTextureId) const;
 		virtual i_sub_texture& sub_texture(i_sub_texture::id aSubTextureId);
 		virtual i_sub_texture& create_sub_texture(const size& aSize, texture_sampling aSampling);
-		virtual i_sub_texture& create_sub_texture(const i_image& aImage);
+		virtual i_sub_texture& create_sub_texture(const i_image& aImage, texture_upload aUpload = texture_upload::Immediate);
 		virtual void destroy_sub_texture(i_sub_texture& aSubTexture);
+	public:
+		virtual std::vector<page_statistics> statistics() const;
+		virtual uint64_t memory_usage() const;
 	private:
 		const size& page_size() const;
 		pages::iterator create_page(texture_sampling aSampling);
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <neogfx/neogfx.hpp>
+#include <deque>
 #include <neogfx/gfx/i_image.hpp>
 #include "i_texture_manager.hpp"
 
@@ -30,11 +31,33 @@ namespace neogfx
 		friend class texture_wrapper;
 	protected:
 		typedef std::list<std::weak_ptr<i_native_texture>> texture_list;
+	private:
+		struct pending_upload
+		{
+			std::weak_ptr<i_native_texture> texture;
+			rect area;
+			i_resource::data_type pixels;
+			uint32_t rowsUploaded;
+			upload_damage damage;
+		};
+		typedef std::deque<pending_upload> pending_upload_list;
+	public:
+		static const std::size_t kDefaultUploadBudget = 4u * 1024u * 1024u;
+	public:
+		texture_manager();
 	public:
 		virtual std::unique_ptr<i_native_texture> join_texture(const i_native_texture& aTexture);
 		virtual std::unique_ptr<i_native_texture> join_texture(const i_texture& aTexture);
 		virtual void clear_textures();
 		virtual std::unique_ptr<i_texture_atlas> create_texture_atlas(const size& aSize = size{ 1024.0, 1024.0 });
+	public:
+		virtual std::size_t upload_budget() const;
+		virtual void set_upload_budget(std::size_t aBytesPerFrame);
+		virtual void queue_upload(std::shared_ptr<i_native_texture> aTexture, const rect& aRect, i_resource::data_type aPixels);
+		virtual void cancel_uploads(const i_native_texture& aTexture, const rect& aRect);
+		virtual bool uploads_pending() const;
+		virtual void texture_drawn(const i_native_texture& aTexture, const rect& aTextureRect, const i_native_surface& aSurface, const rect& aSurfaceRect);
+		virtual upload_damage process_uploads();
 	protected:
 		const texture_list& textures() const;
 		texture_list& textures();
@@ -44,5 +67,7 @@ namespace neogfx
 	private:
 		texture_list iTextures;
 		std::vector<std::unique_ptr<i_texture_atlas>> iTextureAtlases;
+		std::size_t iUploadBudget;
+		pending_upload_list iPendingUploads;
 	};
 }
\ No newline at end of file
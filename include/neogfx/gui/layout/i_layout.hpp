@@ -93,8 +93,9 @@ namespace neogfx
 		virtual void disable() = 0;
 		virtual bool enabled() const = 0;
 		virtual void layout_items(const point& aPosition, const size& aSize) = 0;
-		virtual uint32_t layout_id() const = 0;
-		virtual void next_layout_id() = 0;
+		virtual uint32_t size_hints_id() const = 0;
+		virtual void invalidate_size_hints() = 0;
+		virtual bool invalidate_size_hints(i_widget& aWidget) = 0;
 		virtual bool invalidated() const = 0;
 		virtual void invalidate() = 0;
 		virtual void validate() = 0;
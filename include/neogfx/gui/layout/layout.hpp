@@ -120,8 +120,9 @@ namespace neogfx
 		virtual void enable();
 		virtual void disable();
 		virtual bool enabled() const;
-		virtual uint32_t layout_id() const;
-		virtual void next_layout_id();
+		virtual uint32_t size_hints_id() const;
+		virtual void invalidate_size_hints();
+		virtual bool invalidate_size_hints(i_widget& aWidget);
 		virtual bool invalidated() const;
 		virtual void invalidate();
 		virtual void validate();
@@ -177,7 +178,7 @@ namespace neogfx
 		optional_size iMaximumSize;
 		item_list iItems;
 		bool iLayoutStarted;
-		uint32_t iLayoutId;
+		uint32_t iSizeHintsId;
 		bool iInvalidated;
 	};
 }
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <neogfx/neogfx.hpp>
+#include <array>
 #include <neolib/variant.hpp>
 #include <neogfx/gui/widget/i_widget.hpp>
 #include <neogfx/gui/layout/i_layout.hpp>
@@ -28,6 +29,21 @@ namespace neogfx
 {
 	class layout_item : public i_widget_geometry
 	{
+	private:
+		struct size_hint
+		{
+			bool valid;
+			std::pair<uint32_t, uint32_t> id;
+			optional_size availableSpace;
+			size value;
+		};
+		struct size_hints
+		{
+			// the hint without an available space does not depend on it so it survives resizes
+			size_hint unconstrained;
+			// constrained hints are requested with and without margins deducted so remember both
+			std::array<size_hint, 2> constrained;
+		};
 	public:
 		typedef std::shared_ptr<i_widget> widget_pointer;
 		typedef std::shared_ptr<i_layout> layout_pointer;
@@ -72,12 +88,17 @@ namespace neogfx
 		bool visible() const;
 	public:
 		bool operator==(const layout_item& aOther) const;
+	public:
+		static void invalidate_all_size_hints();
+	private:
+		std::pair<uint32_t, uint32_t> size_hints_id() const;
+		const size_hint* find_size_hint(const size_hints& aHints, const optional_size& aAvailableSpace) const;
+		void cache_size_hint(size_hints& aHints, const std::pair<uint32_t, uint32_t>& aId, const optional_size& aAvailableSpace, const size& aValue) const;
 	private:
 		i_layout& iParent;
 		pointer_wrapper iPointerWrapper;
 		i_widget* iOwner;
-		mutable std::pair<uint32_t, uint32_t> iLayoutId;
-		mutable size iMinimumSize;
-		mutable size iMaximumSize;
+		mutable size_hints iMinimumSizeHints;
+		mutable size_hints iMaximumSizeHints;
 	};
 }
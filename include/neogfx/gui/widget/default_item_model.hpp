@@ -276,6 +276,16 @@ namespace neogfx
 		{
 			return iItems[aIndex.row()].second[aIndex.column()].second;
 		}
+		virtual bool row_cached(item_model_index::value_type) const
+		{
+			return true;
+		}
+		virtual void rows_in_view(item_model_index::value_type, item_model_index::value_type) const
+		{
+		}
+		virtual void rows_in_view(const row_range_list&) const
+		{
+		}
 	public:
 		virtual void reserve(uint32_t aItemCount)
 		{
@@ -417,7 +427,7 @@ namespace neogfx
 			notify_observers(i_item_model_subscriber::NotifyItemsSorted);
 		}
 	private:
-		virtual void notify_observer(i_item_model_subscriber& aObserver, i_item_model_subscriber::notify_type aType, const void* aParameter, const void*)
+		virtual void notify_observer(i_item_model_subscriber& aObserver, i_item_model_subscriber::notify_type aType, const void* aParameter, const void* aParameter2)
 		{
 			switch (aType)
 			{
@@ -433,6 +443,15 @@ namespace neogfx
 			case i_item_model_subscriber::NotifyItemRemoved:
 				aObserver.item_removed(*this, *static_cast<const item_model_index*>(aParameter));
 				break;
+			case i_item_model_subscriber::NotifyItemsAdded:
+				aObserver.items_added(*this, *static_cast<const item_model_index::value_type*>(aParameter), *static_cast<const uint32_t*>(aParameter2));
+				break;
+			case i_item_model_subscriber::NotifyItemsChanged:
+				aObserver.items_changed(*this, *static_cast<const item_model_index::value_type*>(aParameter), *static_cast<const uint32_t*>(aParameter2));
+				break;
+			case i_item_model_subscriber::NotifyItemsRemoved:
+				aObserver.items_removed(*this, *static_cast<const item_model_index::value_type*>(aParameter), *static_cast<const uint32_t*>(aParameter2));
+				break;
 			case i_item_model_subscriber::NotifyItemsSorted:
 				aObserver.items_sorted(*this);
 				break;
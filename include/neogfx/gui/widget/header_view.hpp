@@ -77,6 +77,9 @@ namespace neogfx
 		virtual void item_added(const i_item_model& aModel, const item_model_index& aItemIndex);
 		virtual void item_changed(const i_item_model& aModel, const item_model_index& aItemIndex);
 		virtual void item_removed(const i_item_model& aModel, const item_model_index& aItemIndex);
+		virtual void items_added(const i_item_model& aModel, item_model_index::value_type aFirstRow, uint32_t aRowCount);
+		virtual void items_changed(const i_item_model& aModel, item_model_index::value_type aFirstRow, uint32_t aRowCount);
+		virtual void items_removed(const i_item_model& aModel, item_model_index::value_type aFirstRow, uint32_t aRowCount);
 		virtual void items_sorted(const i_item_model& aModel);
 		virtual void model_destroyed(const i_item_model& aModel);
 	private:
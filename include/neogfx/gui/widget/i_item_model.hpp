@@ -37,10 +37,13 @@ namespace neogfx
 		virtual void item_added(const i_item_model& aModel, const item_model_index& aItemIndex) = 0;
 		virtual void item_changed(const i_item_model& aModel, const item_model_index& aItemIndex) = 0;
 		virtual void item_removed(const i_item_model& aModel, const item_model_index& aItemIndex) = 0;
+		virtual void items_added(const i_item_model& aModel, item_model_index::value_type aFirstRow, uint32_t aRowCount) = 0;
+		virtual void items_changed(const i_item_model& aModel, item_model_index::value_type aFirstRow, uint32_t aRowCount) = 0;
+		virtual void items_removed(const i_item_model& aModel, item_model_index::value_type aFirstRow, uint32_t aRowCount) = 0;
 		virtual void items_sorted(const i_item_model& aModel) = 0;
 		virtual void model_destroyed(const i_item_model& aModel) = 0;
 	public:
-		enum notify_type { NotifyColumnInfoChanged, NotifyItemAdded, NotifyItemChanged, NotifyItemRemoved, NotifyItemsSorted, NotifyModelDestroyed };
+		enum notify_type { NotifyColumnInfoChanged, NotifyItemAdded, NotifyItemChanged, NotifyItemRemoved, NotifyItemsAdded, NotifyItemsChanged, NotifyItemsRemoved, NotifyItemsSorted, NotifyModelDestroyed };
 	};
 
 	class i_item_model
@@ -82,6 +85,7 @@ namespace neogfx
 		typedef boost::optional<sort_direction_e> optional_sort_direction;
 		typedef std::pair<item_model_index::value_type, sort_direction_e> sort_order;
 		typedef boost::optional<sort_order> optional_sort_order;
+		typedef std::vector<std::pair<item_model_index::value_type, item_model_index::value_type>> row_range_list;
 	public:
 		struct bad_column_index : std::logic_error { bad_column_index() : std::logic_error("neogfx::i_item_model::bad_column_index") {} };
 	public:
@@ -126,6 +130,9 @@ namespace neogfx
 	public:
 		virtual const cell_data_type& cell_data(const item_model_index& aIndex) const = 0;
 		virtual const i_item_presentation_model::cell_meta_type& cell_meta(const item_model_index& aIndex) const = 0;
+		virtual bool row_cached(item_model_index::value_type aRow) const = 0;
+		virtual void rows_in_view(item_model_index::value_type aFirstRow, item_model_index::value_type aLastRow) const = 0;
+		virtual void rows_in_view(const row_range_list& aRowRanges) const = 0; // ascending, non-overlapping (first, last) ranges
 	public:
 		virtual void subscribe(i_item_model_subscriber& aSubscriber) = 0;
 		virtual void unsubscribe(i_item_model_subscriber& aSubscriber) = 0;
@@ -119,10 +119,12 @@ namespace neogfx
 		virtual bool has_parent_layout() const = 0;
 		virtual const i_layout& parent_layout() const = 0;
 		virtual i_layout& parent_layout() = 0;
+		virtual void set_parent_layout(i_layout* aParentLayout) = 0;
 		virtual void layout_items(bool aDefer = false) = 0;
 		virtual void layout_items_started() = 0;
 		virtual bool layout_items_in_progress() const = 0;
 		virtual void layout_items_completed() = 0;
+		virtual void invalidate_size_hints() = 0;
 	public:
 		virtual neogfx::logical_coordinate_system logical_coordinate_system() const = 0;
 		virtual point position() const = 0;
@@ -132,6 +134,7 @@ namespace neogfx
 		virtual size extents() const = 0;
 		virtual void resize(const size& aSize) = 0;
 		virtual void resized() = 0;
+		virtual void child_geometry_changed(i_widget& aChild) = 0;
 		virtual rect window_rect() const = 0;
 		virtual rect client_rect(bool aIncludeMargins = true) const = 0;
 		virtual const i_widget& widget_at(const point& aPosition) const = 0;
@@ -24,7 +24,6 @@
 #include <deque>
 #include <boost/algorithm/string.hpp>
 #include <neolib/vecarray.hpp>
-#include <neolib/segmented_array.hpp>
 #include <neolib/observable.hpp>
 #include <neogfx/gfx/graphics_context.hpp>
 #include <neogfx/app/app.hpp>
@@ -36,7 +35,157 @@ namespace neogfx
 	class item_presentation_model : public i_item_presentation_model, private i_item_model_subscriber
 	{
 	private:
-		typedef boost::optional<i_scrollbar::value_type> optional_position;
+		// Row positions as a Fenwick tree of each row's height delta from the default (single line) row height; rows
+		// are measured lazily (when their height is asked for) and unmeasured rows are assumed to be default height.
+		// While every measured row is default height the tree is not consulted at all.
+		class row_height_index
+		{
+		public:
+			row_height_index() : iDefaultHeight(0.0), iIrregularRows(0), iTreeValid(false)
+			{
+			}
+		public:
+			std::size_t rows() const
+			{
+				return iDeltas.size();
+			}
+			dimension default_height() const
+			{
+				return iDefaultHeight;
+			}
+			void reset(std::size_t aRows, dimension aDefaultHeight)
+			{
+				iDefaultHeight = aDefaultHeight;
+				iDeltas.assign(aRows, 0.0);
+				iMeasured.assign(aRows, false);
+				iIrregularRows = 0;
+				iTree.clear();
+				iTreeValid = false;
+			}
+			bool measured(std::size_t aRow) const
+			{
+				return iMeasured[aRow];
+			}
+			void set_height(std::size_t aRow, dimension aHeight)
+			{
+				iMeasured[aRow] = true;
+				set_delta(aRow, aHeight - iDefaultHeight);
+			}
+			void invalidate(std::size_t aRow)
+			{
+				iMeasured[aRow] = false;
+				set_delta(aRow, 0.0);
+			}
+			void insert(std::size_t aRow, std::size_t aCount = 1)
+			{
+				iDeltas.insert(iDeltas.begin() + aRow, aCount, 0.0);
+				iMeasured.insert(iMeasured.begin() + aRow, aCount, false);
+				if (iTreeValid && aRow + aCount == rows())
+				{
+					for (std::size_t node = aRow + 1; node <= rows(); ++node)
+						iTree.push_back(prefix(node - 1) - prefix(node - (node & (~node + 1))));
+				}
+				else
+					iTreeValid = false;
+			}
+			void erase(std::size_t aRow, std::size_t aCount = 1)
+			{
+				for (std::size_t row = aRow; row < aRow + aCount; ++row)
+					if (iDeltas[row] != 0.0)
+						--iIrregularRows;
+				iDeltas.erase(iDeltas.begin() + aRow, iDeltas.begin() + aRow + aCount);
+				iMeasured.erase(iMeasured.begin() + aRow, iMeasured.begin() + aRow + aCount);
+				if (iTreeValid && aRow == rows())
+					iTree.resize(rows());
+				else
+					iTreeValid = false;
+			}
+			double position(std::size_t aRow) const
+			{
+				double result = aRow * iDefaultHeight;
+				if (iIrregularRows != 0)
+					result += prefix(aRow);
+				return result;
+			}
+			double total() const
+			{
+				return position(rows());
+			}
+			std::size_t row_at(double aPosition) const
+			{
+				if (rows() == 0 || aPosition <= 0.0)
+					return 0;
+				std::size_t row = 0;
+				if (iIrregularRows == 0)
+				{
+					if (iDefaultHeight > 0.0)
+						row = static_cast<std::size_t>(std::min(std::floor(aPosition / iDefaultHeight), static_cast<double>(rows())));
+				}
+				else
+				{
+					build();
+					std::size_t step = 1;
+					while (step * 2 <= rows())
+						step *= 2;
+					double remaining = aPosition;
+					for (; step != 0; step /= 2)
+					{
+						if (row + step > rows())
+							continue;
+						double span = step * iDefaultHeight + iTree[row + step - 1];
+						if (span <= remaining)
+						{
+							row += step;
+							remaining -= span;
+						}
+					}
+				}
+				return std::min(row, rows() - 1);
+			}
+		private:
+			void set_delta(std::size_t aRow, dimension aDelta)
+			{
+				dimension oldDelta = iDeltas[aRow];
+				if (aDelta == oldDelta)
+					return;
+				if (oldDelta == 0.0)
+					++iIrregularRows;
+				else if (aDelta == 0.0)
+					--iIrregularRows;
+				iDeltas[aRow] = aDelta;
+				if (iTreeValid)
+					for (std::size_t node = aRow + 1; node <= rows(); node += (node & (~node + 1)))
+						iTree[node - 1] += (aDelta - oldDelta);
+			}
+			double prefix(std::size_t aRows) const
+			{
+				build();
+				double result = 0.0;
+				for (std::size_t node = aRows; node != 0; node -= (node & (~node + 1)))
+					result += iTree[node - 1];
+				return result;
+			}
+			void build() const
+			{
+				if (iTreeValid)
+					return;
+				iTree.assign(iDeltas.begin(), iDeltas.end());
+				for (std::size_t node = 1; node <= iTree.size(); ++node)
+				{
+					std::size_t parent = node + (node & (~node + 1));
+					if (parent <= iTree.size())
+						iTree[parent - 1] += iTree[node - 1];
+				}
+				iTreeValid = true;
+			}
+		private:
+			dimension iDefaultHeight;
+			std::vector<dimension> iDeltas;
+			std::vector<bool> iMeasured;
+			std::size_t iIrregularRows;
+			mutable std::vector<double> iTree;
+			mutable bool iTreeValid;
+		};
 	public:
 		item_presentation_model() : iItemModel(0)
 		{
@@ -67,7 +216,7 @@ namespace neogfx
 				return;
 			iItemModel = &aItemModel;
 			item_model().subscribe(*this);
-			reset_position_meta(0);
+			reset_position_meta();
 		}
 	public:
 		virtual dimension item_height(const item_model_index& aIndex, const graphics_context& aGraphicsContext) const
@@ -75,93 +224,46 @@ namespace neogfx
 			dimension height = 0.0;
 			for (uint32_t col = 0; col < item_model().columns(aIndex.row()); ++col)
 			{
-				optional_font cellFont = cell_font(aIndex);
+				item_model_index cellIndex(aIndex.row(), col);
+				optional_font cellFont = cell_font(cellIndex);
 				if (cellFont == boost::none && iFont != font())
 				{
 					reset_meta();
 					iFont = font();
 				}
-				if (item_model().cell_meta(aIndex).extents != boost::none)
-					height = std::max(height, units_converter(aGraphicsContext).from_device_units(*item_model().cell_meta(aIndex).extents).cy);
+				if (item_model().cell_meta(cellIndex).extents != boost::none)
+					height = std::max(height, units_converter(aGraphicsContext).from_device_units(*item_model().cell_meta(cellIndex).extents).cy);
 				else
 				{
-					std::string cellString = cell_to_string(item_model_index(aIndex.row(), col));
+					std::string cellString = cell_to_string(cellIndex);
 					const font& effectiveFont = (cellFont == boost::none ? iFont : *cellFont);
 					height = std::max(height, units_converter(aGraphicsContext).from_device_units(size(0.0, std::ceil(effectiveFont.height()))).cy *
 						(1 + std::count(cellString.begin(), cellString.end(), '\n')));
 				}
 			}
+			row_heights(aGraphicsContext).set_height(aIndex.row(), height);
 			return height;
 		}
 		virtual double total_height(const graphics_context& aGraphicsContext) const
 		{
-			if (iTotalHeight != boost::none)
-				return *iTotalHeight;
-			i_scrollbar::value_type height = 0.0;
-			for (item_model_index::value_type row = 0; row < item_model().rows(); ++row)
-				height += item_height(item_model_index(row, 0), aGraphicsContext);
-			iTotalHeight = height;
-			return *iTotalHeight;
+			return row_heights(aGraphicsContext).total();
 		}
 		virtual double item_position(const item_model_index& aIndex, const graphics_context& aGraphicsContext) const
 		{
-			if (iPositions[aIndex.row()] == boost::none)
-			{
-				auto pred = [](const optional_position& lhs, const optional_position& rhs) -> bool
-				{
-					if (lhs == boost::none && rhs == boost::none)
-						return false;
-					else if (lhs != boost::none && rhs == boost::none)
-						return true;
-					else if (lhs == boost::none && rhs != boost::none)
-						return false;
-					else
-						return *lhs < *rhs;
-				};
-				auto i = std::lower_bound(iPositions.begin(), iPositions.end(), optional_position(), pred);
-				uint32_t row = std::distance(iPositions.begin(), i);
-				double position = (row == 0 ? 0.0 : **(std::prev(i)) + item_height(item_model_index(row - 1), aGraphicsContext));
-				while (row <= aIndex.row())
-				{
-					iPositions[row] = position;
-					position += item_height(item_model_index(row), aGraphicsContext);
-					++row;
-				}
-			}
-			return *iPositions[aIndex.row()];
+			return row_heights(aGraphicsContext).position(aIndex.row());
 		}
 		virtual std::pair<item_model_index::value_type, coordinate> item_at(double aPosition, const graphics_context& aGraphicsContext) const
 		{
 			if (item_model().rows() == 0)
 				return std::pair<item_model_index::value_type, coordinate>(0, 0.0);
-			auto pred = [](const optional_position& lhs, const optional_position& rhs) -> bool
+			const row_height_index& rowHeights = row_heights(aGraphicsContext);
+			auto row = rowHeights.row_at(aPosition);
+			if (!rowHeights.measured(row))
 			{
-				if (lhs == boost::none && rhs == boost::none)
-					return false;
-				else if (lhs != boost::none && rhs == boost::none)
-					return true;
-				else if (lhs == boost::none && rhs != boost::none)
-					return false;
-				else
-					return *lhs < *rhs;
-			};
-			auto i = std::lower_bound(iPositions.begin(), iPositions.end(), aPosition, pred);
-			if (*i == boost::none)
-			{
-				auto j = std::lower_bound(iPositions.begin(), iPositions.end(), optional_position(), pred);
-				uint32_t row = std::distance(iPositions.begin(), j);
-				double position = (row == 0 ? 0.0 : **(std::prev(j)) + item_height(item_model_index(row - 1), aGraphicsContext));
-				while (row < iPositions.size())
-				{
-					iPositions[row] = position;
-					position += item_height(item_model_index(row), aGraphicsContext);
-					++row;
-				}
-				i = std::lower_bound(iPositions.begin(), iPositions.end(), aPosition, pred);
+				item_height(item_model_index(row), aGraphicsContext);
+				row = rowHeights.row_at(aPosition);
 			}
-			if (i == iPositions.end() || *i > aPosition && i != iPositions.begin())
-				--i;
-			return std::pair<item_model_index::value_type, coordinate>(std::distance(iPositions.begin(), i), static_cast<coordinate>(**i - aPosition));
+			return std::pair<item_model_index::value_type, coordinate>(static_cast<item_model_index::value_type>(row), static_cast<coordinate>(rowHeights.position(row) - aPosition));
 		}
 		virtual std::string cell_to_string(const item_model_index& aIndex) const
 		{
@@ -217,7 +319,6 @@ namespace neogfx
 		}
 		virtual size cell_extents(const item_model_index& aIndex, const graphics_context& aGraphicsContext) const
 		{
-			auto oldItemHeight = item_height(aIndex, aGraphicsContext);
 			optional_font cellFont = cell_font(aIndex);
 			if (cellFont == boost::none && iFont != font())
 			{
@@ -230,8 +331,7 @@ namespace neogfx
 			item_model().cell_meta(aIndex).extents = units_converter(aGraphicsContext).to_device_units(cellExtents);
 			item_model().cell_meta(aIndex).extents->cx = std::ceil(item_model().cell_meta(aIndex).extents->cx);
 			item_model().cell_meta(aIndex).extents->cy = std::ceil(item_model().cell_meta(aIndex).extents->cy);
-			if (iTotalHeight != boost::none)
-				*iTotalHeight += (item_height(aIndex, aGraphicsContext) - oldItemHeight);
+			item_height(aIndex, aGraphicsContext);
 			return units_converter(aGraphicsContext).from_device_units(*item_model().cell_meta(aIndex).extents);
 		}
 	private:
@@ -240,18 +340,37 @@ namespace neogfx
 		}
 		virtual void item_added(const i_item_model&, const item_model_index& aItemIndex)
 		{
-			reset_position_meta(aItemIndex.row());
+			if (aItemIndex.row() <= iRowHeights.rows())
+				iRowHeights.insert(aItemIndex.row());
 		}
 		virtual void item_changed(const i_item_model&, const item_model_index& aItemIndex)
 		{
-			reset_position_meta(aItemIndex.row());
+			if (aItemIndex.row() < iRowHeights.rows())
+				iRowHeights.invalidate(aItemIndex.row());
+		}
+		virtual void item_removed(const i_item_model&, const item_model_index& aItemIndex)
+		{
+			if (aItemIndex.row() < iRowHeights.rows())
+				iRowHeights.erase(aItemIndex.row());
+		}
+		virtual void items_added(const i_item_model&, item_model_index::value_type aFirstRow, uint32_t aRowCount)
+		{
+			if (aFirstRow <= iRowHeights.rows())
+				iRowHeights.insert(aFirstRow, aRowCount);
 		}
-		virtual void item_removed(const i_item_model&, const item_model_index&)
+		virtual void items_changed(const i_item_model&, item_model_index::value_type aFirstRow, uint32_t aRowCount)
 		{
+			for (std::size_t row = aFirstRow; row < aFirstRow + aRowCount && row < iRowHeights.rows(); ++row)
+				iRowHeights.invalidate(row);
+		}
+		virtual void items_removed(const i_item_model&, item_model_index::value_type aFirstRow, uint32_t aRowCount)
+		{
+			if (aFirstRow + aRowCount <= iRowHeights.rows())
+				iRowHeights.erase(aFirstRow, aRowCount);
 		}
 		virtual void items_sorted(const i_item_model&)
 		{
-			reset_position_meta(0);
+			reset_position_meta();
 		}
 		virtual void model_destroyed(const i_item_model&)
 		{
@@ -262,25 +381,36 @@ namespace neogfx
 		{
 			for (uint32_t row = 0; row < item_model().rows(); ++row)
 			{
+				if (!item_model().row_cached(row))
+					continue;
 				for (uint32_t col = 0; col < item_model().columns(item_model_index(row)); ++col)
 				{
 					item_model().cell_meta(item_model_index(row, col)).text = boost::none;
 					item_model().cell_meta(item_model_index(row, col)).extents = boost::none;
 				}
 			}
+			reset_position_meta();
+		}
+		void reset_position_meta() const
+		{
+			iRowHeights.reset(has_item_model() ? item_model().rows() : 0, iRowHeights.default_height());
 		}
-		void reset_position_meta(item_model_index::value_type aFromRow) const
+		row_height_index& row_heights(const graphics_context& aGraphicsContext) const
 		{
-			iTotalHeight = boost::none;
-			iPositions.resize(item_model().rows());
-			for (std::size_t i = aFromRow; i < iPositions.size() && iPositions[i] != boost::none; ++i)
-				iPositions[i] = boost::none;
+			if (iFont != font())
+			{
+				reset_meta();
+				iFont = font();
+			}
+			dimension defaultHeight = units_converter(aGraphicsContext).from_device_units(size(0.0, std::ceil(iFont.height()))).cy;
+			if (iRowHeights.rows() != item_model().rows() || iRowHeights.default_height() != defaultHeight)
+				iRowHeights.reset(item_model().rows(), defaultHeight);
+			return iRowHeights;
 		}
 	private:
 		i_item_model* iItemModel;
 		mutable font iFont;
-		mutable boost::optional<i_scrollbar::value_type> iTotalHeight;
-		mutable neolib::segmented_array<optional_position, 256> iPositions;
+		mutable row_height_index iRowHeights;
 		sink iSink;
 	};
 }
\ No newline at end of file
@@ -187,6 +187,15 @@ namespace neogfx
 		virtual void item_removed(const i_item_model&, const item_model_index&)
 		{
 		}
+		virtual void items_added(const i_item_model&, item_model_index::value_type, uint32_t)
+		{
+		}
+		virtual void items_changed(const i_item_model&, item_model_index::value_type, uint32_t)
+		{
+		}
+		virtual void items_removed(const i_item_model&, item_model_index::value_type, uint32_t)
+		{
+		}
 		virtual void items_sorted(const i_item_model&)
 		{
 		}
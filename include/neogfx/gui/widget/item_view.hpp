@@ -87,11 +87,15 @@ namespace neogfx
 		virtual child_widget_scrolling_disposition_e scrolling_disposition() const;
 		using scrollable_widget::update_scrollbar_visibility;
 		virtual void update_scrollbar_visibility(usv_stage_e aStage);
+		virtual optional_rect scrolled_area() const;
 	protected:
 		virtual void column_info_changed(const i_item_model& aModel, item_model_index::value_type aColumnIndex);
 		virtual void item_added(const i_item_model& aModel, const item_model_index& aItemIndex);
 		virtual void item_changed(const i_item_model& aModel, const item_model_index& aItemIndex);
 		virtual void item_removed(const i_item_model& aModel, const item_model_index& aItemIndex);
+		virtual void items_added(const i_item_model& aModel, item_model_index::value_type aFirstRow, uint32_t aRowCount);
+		virtual void items_changed(const i_item_model& aModel, item_model_index::value_type aFirstRow, uint32_t aRowCount);
+		virtual void items_removed(const i_item_model& aModel, item_model_index::value_type aFirstRow, uint32_t aRowCount);
 		virtual void items_sorted(const i_item_model& aModel);
 		virtual void model_destroyed(const i_item_model& aModel);
 	protected:
@@ -110,6 +114,6 @@ namespace neogfx
 		std::shared_ptr<i_item_presentation_model> iPresentationModel;
 		std::shared_ptr<i_item_selection_model> iSelectionModel;
 		uint32_t iBatchUpdatesInProgress;
-		boost::optional<std::shared_ptr<neolib::callback_timer>> iMouseTracker;
+		boost::optional<std::shared_ptr<callback_timer>> iMouseTracker;
 	};
 }
\ No newline at end of file
@@ -74,7 +74,7 @@ namespace neogfx
 		text_widget iText;
 		horizontal_spacer iSpacer;
 		text_widget iShortcutText;
-		boost::optional<std::unique_ptr<neolib::callback_timer>> iSubMenuOpener;
+		boost::optional<std::unique_ptr<callback_timer>> iSubMenuOpener;
 		mutable boost::optional<std::pair<colour, texture>> iSubMenuArrow;
 	};
 }
\ No newline at end of file
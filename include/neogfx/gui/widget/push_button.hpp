@@ -20,7 +20,7 @@
 #pragma once
 
 #include <neogfx/neogfx.hpp>
-#include <neolib/timer.hpp>
+#include <neogfx/core/timer.hpp>
 #include "button.hpp"
 
 namespace neogfx
@@ -65,7 +65,7 @@ namespace neogfx
 		colour animation_colour() const;
 		colour animation_colour(uint32_t aAnimationFrame) const;
 	private:
-		neolib::callback_timer iAnimator;
+		callback_timer iAnimator;
 		uint32_t iAnimationFrame;
 		push_button_style iStyle;
 		optional_colour iHoverColour;
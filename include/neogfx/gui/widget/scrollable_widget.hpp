@@ -80,6 +80,10 @@ namespace neogfx
 		void scrollbar_updated(const i_scrollbar& aScrollbar, i_scrollbar::update_reason_e aReason) override;
 		colour scrollbar_colour(const i_scrollbar& aScrollbar) const override;
 		const i_widget& as_widget() const override;
+	protected:
+		virtual optional_rect scrolled_area() const;
+	private:
+		bool scroll_blit(const i_scrollbar& aScrollbar, const point& aDelta);
 	protected:
 		virtual void update_scrollbar_visibility();
 		virtual void update_scrollbar_visibility(usv_stage_e aStage);
@@ -0,0 +1,972 @@
+// sort_filter_proxy_model.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <thread>
+#include <random>
+#include <functional>
+#include <boost/algorithm/string.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+#include <neolib/observable.hpp>
+#include "i_item_model.hpp"
+
+namespace neogfx
+{
+	// Presents a source item model sorted and filtered through a row mapping, leaving the source (and the cell metadata
+	// it holds) untouched. Sorting extracts each visible row's key once and stable sorts the keys, in parallel for large
+	// models; row and row range inserts, changes and removals in the source are applied incrementally, each row in
+	// O(log n). Sorting and filtering read every source row so a source that fetches rows on demand (virtual_item_model)
+	// is fully fetched; such models should be sorted with their own sort_by(), which passes the order to the fetch.
+	class sort_filter_proxy_model : public i_item_model, private neolib::observable<i_item_model_subscriber>, private i_item_model_subscriber
+	{
+	public:
+		typedef std::function<bool(const i_item_model& aSourceModel, item_model_index::value_type aSourceRow)> filter_function;
+	public:
+		struct no_source_model : std::logic_error { no_source_model() : std::logic_error("neogfx::sort_filter_proxy_model::no_source_model") {} };
+		struct operation_not_supported : std::logic_error { operation_not_supported() : std::logic_error("neogfx::sort_filter_proxy_model::operation_not_supported") {} };
+	private:
+		typedef boost::counting_iterator<item_model_index::value_type> row_iterator;
+		typedef neolib::specialized_generic_iterator<row_iterator> base_iterator;
+		typedef std::vector<item_model_index::value_type> row_list;
+		typedef std::pair<cell_data_type, item_model_index::value_type> sort_key;
+		static const item_model_index::value_type kNoRow = 0xFFFFFFFFu;
+		static const std::size_t kParallelSortMinimumRowsPerThread = 16384;
+		// Source and proxy row orders are both kept as treaps (randomised balanced binary trees) whose nodes are the source
+		// rows and which are sized for rank lookups: mapping a row either way and inserting or removing a row in either order
+		// are O(log n) rather than shifting every mapping after the row.
+		class row_mapping
+		{
+		public:
+			typedef uint32_t node_index;
+			static const node_index kNil = 0xFFFFFFFFu;
+		private:
+			enum order_e
+			{
+				SourceOrder = 0,
+				ProxyOrder = 1
+			};
+			struct link
+			{
+				node_index parent;
+				node_index left;
+				node_index right;
+				uint32_t size;
+			};
+			struct node
+			{
+				link links[2];
+				uint32_t priority;
+				bool proxied;
+			};
+		public:
+			row_mapping()
+			{
+				iRoots[SourceOrder] = iRoots[ProxyOrder] = kNil;
+			}
+		public:
+			uint32_t source_rows() const
+			{
+				return size(SourceOrder, iRoots[SourceOrder]);
+			}
+			uint32_t proxy_rows() const
+			{
+				return size(ProxyOrder, iRoots[ProxyOrder]);
+			}
+			item_model_index::value_type source_row(item_model_index::value_type aProxyRow) const
+			{
+				return rank(SourceOrder, select(ProxyOrder, aProxyRow));
+			}
+			item_model_index::value_type proxy_row(item_model_index::value_type aSourceRow) const
+			{
+				auto n = select(SourceOrder, aSourceRow);
+				return iNodes[n].proxied ? rank(ProxyOrder, n) : kNoRow;
+			}
+			void clear()
+			{
+				iNodes.clear();
+				iFreeNodes.clear();
+				iRoots[SourceOrder] = iRoots[ProxyOrder] = kNil;
+			}
+			void insert_source_rows(item_model_index::value_type aSourceRow, uint32_t aCount)
+			{
+				std::vector<node_index> newNodes;
+				newNodes.reserve(aCount);
+				for (uint32_t i = 0; i < aCount; ++i)
+					newNodes.push_back(allocate());
+				auto parts = split(SourceOrder, iRoots[SourceOrder], aSourceRow);
+				iRoots[SourceOrder] = merge(SourceOrder, merge(SourceOrder, parts.first, build(SourceOrder, newNodes)), parts.second);
+			}
+			void erase_source_rows(item_model_index::value_type aSourceRow, uint32_t aCount)
+			{
+				auto before = split(SourceOrder, iRoots[SourceOrder], aSourceRow);
+				auto erased = split(SourceOrder, before.second, aCount);
+				iRoots[SourceOrder] = merge(SourceOrder, before.first, erased.second);
+				std::vector<node_index> erasedNodes;
+				in_order(SourceOrder, erased.first, erasedNodes);
+				for (auto n : erasedNodes)
+				{
+					if (iNodes[n].proxied)
+						unlink_proxy(n);
+					iFreeNodes.push_back(n);
+				}
+			}
+			void insert_proxy_row(item_model_index::value_type aProxyRow, item_model_index::value_type aSourceRow)
+			{
+				auto n = select(SourceOrder, aSourceRow);
+				iNodes[n].links[ProxyOrder] = link{ kNil, kNil, kNil, 1u };
+				iNodes[n].proxied = true;
+				auto parts = split(ProxyOrder, iRoots[ProxyOrder], aProxyRow);
+				iRoots[ProxyOrder] = merge(ProxyOrder, merge(ProxyOrder, parts.first, n), parts.second);
+			}
+			void erase_proxy_row(item_model_index::value_type aProxyRow)
+			{
+				unlink_proxy(select(ProxyOrder, aProxyRow));
+			}
+			void erase_proxy_rows(item_model_index::value_type aFirstSourceRow, uint32_t aSourceRowCount)
+			{
+				for (auto sourceRow = aFirstSourceRow; sourceRow < aFirstSourceRow + aSourceRowCount; ++sourceRow)
+				{
+					auto n = select(SourceOrder, sourceRow);
+					if (iNodes[n].proxied)
+						unlink_proxy(n);
+				}
+			}
+			// replaces the proxy order with the given source rows
+			void assign_proxy_rows(const row_list& aSourceRows)
+			{
+				std::vector<node_index> sourceNodes;
+				in_order(SourceOrder, iRoots[SourceOrder], sourceNodes);
+				for (auto n : sourceNodes)
+					iNodes[n].proxied = false;
+				std::vector<node_index> proxyNodes;
+				proxyNodes.reserve(aSourceRows.size());
+				for (auto sourceRow : aSourceRows)
+				{
+					proxyNodes.push_back(sourceNodes[sourceRow]);
+					iNodes[sourceNodes[sourceRow]].proxied = true;
+				}
+				iRoots[ProxyOrder] = build(ProxyOrder, proxyNodes);
+			}
+			// the source rows in proxy order
+			row_list proxy_order() const
+			{
+				std::vector<node_index> sourceNodes;
+				in_order(SourceOrder, iRoots[SourceOrder], sourceNodes);
+				row_list sourceRowOfNode(iNodes.size(), static_cast<item_model_index::value_type>(kNoRow));
+				for (std::size_t i = 0; i < sourceNodes.size(); ++i)
+					sourceRowOfNode[sourceNodes[i]] = static_cast<item_model_index::value_type>(i);
+				std::vector<node_index> proxyNodes;
+				in_order(ProxyOrder, iRoots[ProxyOrder], proxyNodes);
+				row_list result;
+				result.reserve(proxyNodes.size());
+				for (auto n : proxyNodes)
+					result.push_back(sourceRowOfNode[n]);
+				return result;
+			}
+			// the number of leading proxy rows whose source rows satisfy aBefore (which must partition the proxy order)
+			template <typename Predicate>
+			item_model_index::value_type partition_point(Predicate aBefore) const
+			{
+				item_model_index::value_type result = 0;
+				for (auto n = iRoots[ProxyOrder]; n != kNil;)
+				{
+					const auto& l = iNodes[n].links[ProxyOrder];
+					if (aBefore(rank(SourceOrder, n)))
+					{
+						result += size(ProxyOrder, l.left) + 1;
+						n = l.right;
+					}
+					else
+						n = l.left;
+				}
+				return result;
+			}
+		private:
+			node_index allocate()
+			{
+				node_index n;
+				if (!iFreeNodes.empty())
+				{
+					n = iFreeNodes.back();
+					iFreeNodes.pop_back();
+				}
+				else
+				{
+					n = static_cast<node_index>(iNodes.size());
+					iNodes.emplace_back();
+				}
+				iNodes[n].links[SourceOrder] = iNodes[n].links[ProxyOrder] = link{ kNil, kNil, kNil, 1u };
+				iNodes[n].priority = static_cast<uint32_t>(iRandom());
+				iNodes[n].proxied = false;
+				return n;
+			}
+			uint32_t size(order_e aOrder, node_index aNode) const
+			{
+				return aNode != kNil ? iNodes[aNode].links[aOrder].size : 0u;
+			}
+			void update(order_e aOrder, node_index aNode)
+			{
+				auto& l = iNodes[aNode].links[aOrder];
+				l.size = 1u + size(aOrder, l.left) + size(aOrder, l.right);
+				if (l.left != kNil)
+					iNodes[l.left].links[aOrder].parent = aNode;
+				if (l.right != kNil)
+					iNodes[l.right].links[aOrder].parent = aNode;
+			}
+			node_index merge(order_e aOrder, node_index aLeft, node_index aRight)
+			{
+				if (aLeft == kNil || aRight == kNil)
+				{
+					auto root = (aLeft != kNil ? aLeft : aRight);
+					if (root != kNil)
+						iNodes[root].links[aOrder].parent = kNil;
+					return root;
+				}
+				if (iNodes[aLeft].priority > iNodes[aRight].priority)
+				{
+					iNodes[aLeft].links[aOrder].right = merge(aOrder, iNodes[aLeft].links[aOrder].right, aRight);
+					update(aOrder, aLeft);
+					iNodes[aLeft].links[aOrder].parent = kNil;
+					return aLeft;
+				}
+				iNodes[aRight].links[aOrder].left = merge(aOrder, aLeft, iNodes[aRight].links[aOrder].left);
+				update(aOrder, aRight);
+				iNodes[aRight].links[aOrder].parent = kNil;
+				return aRight;
+			}
+			// splits off the first aCount nodes
+			std::pair<node_index, node_index> split(order_e aOrder, node_index aRoot, uint32_t aCount)
+			{
+				if (aRoot == kNil)
+					return std::make_pair(aRoot, aRoot);
+				auto& l = iNodes[aRoot].links[aOrder];
+				std::pair<node_index, node_index> result;
+				if (size(aOrder, l.left) >= aCount)
+				{
+					auto parts = split(aOrder, l.left, aCount);
+					iNodes[aRoot].links[aOrder].left = parts.second;
+					result = std::make_pair(parts.first, aRoot);
+				}
+				else
+				{
+					auto parts = split(aOrder, l.right, aCount - size(aOrder, l.left) - 1u);
+					iNodes[aRoot].links[aOrder].right = parts.first;
+					result = std::make_pair(aRoot, parts.second);
+				}
+				update(aOrder, aRoot);
+				if (result.first != kNil)
+					iNodes[result.first].links[aOrder].parent = kNil;
+				if (result.second != kNil)
+					iNodes[result.second].links[aOrder].parent = kNil;
+				return result;
+			}
+			// builds a treap holding aNodes in order in linear time (a Cartesian tree over their priorities)
+			node_index build(order_e aOrder, const std::vector<node_index>& aNodes)
+			{
+				std::vector<node_index> spine;
+				for (auto n : aNodes)
+				{
+					iNodes[n].links[aOrder] = link{ kNil, kNil, kNil, 1u };
+					node_index last = kNil;
+					while (!spine.empty() && iNodes[spine.back()].priority < iNodes[n].priority)
+					{
+						last = spine.back();
+						spine.pop_back();
+					}
+					iNodes[n].links[aOrder].left = last;
+					if (last != kNil)
+						iNodes[last].links[aOrder].parent = n;
+					if (!spine.empty())
+					{
+						iNodes[spine.back()].links[aOrder].right = n;
+						iNodes[n].links[aOrder].parent = spine.back();
+					}
+					spine.push_back(n);
+				}
+				if (spine.empty())
+					return kNil;
+				post_order_sizes(aOrder, spine.front());
+				return spine.front();
+			}
+			void post_order_sizes(order_e aOrder, node_index aNode)
+			{
+				if (aNode == kNil)
+					return;
+				post_order_sizes(aOrder, iNodes[aNode].links[aOrder].left);
+				post_order_sizes(aOrder, iNodes[aNode].links[aOrder].right);
+				update(aOrder, aNode);
+			}
+			void in_order(order_e aOrder, node_index aNode, std::vector<node_index>& aResult) const
+			{
+				std::vector<node_index> stack;
+				while (aNode != kNil || !stack.empty())
+				{
+					while (aNode != kNil)
+					{
+						stack.push_back(aNode);
+						aNode = iNodes[aNode].links[aOrder].left;
+					}
+					aNode = stack.back();
+					stack.pop_back();
+					aResult.push_back(aNode);
+					aNode = iNodes[aNode].links[aOrder].right;
+				}
+			}
+			node_index select(order_e aOrder, uint32_t aRank) const
+			{
+				auto n = iRoots[aOrder];
+				for (;;)
+				{
+					const auto& l = iNodes[n].links[aOrder];
+					auto leftSize = size(aOrder, l.left);
+					if (aRank < leftSize)
+						n = l.left;
+					else if (aRank == leftSize)
+						return n;
+					else
+					{
+						aRank -= leftSize + 1u;
+						n = l.right;
+					}
+				}
+			}
+			uint32_t rank(order_e aOrder, node_index aNode) const
+			{
+				uint32_t result = size(aOrder, iNodes[aNode].links[aOrder].left);
+				for (auto parent = iNodes[aNode].links[aOrder].parent; parent != kNil; aNode = parent, parent = iNodes[aNode].links[aOrder].parent)
+					if (iNodes[parent].links[aOrder].right == aNode)
+						result += size(aOrder, iNodes[parent].links[aOrder].left) + 1u;
+				return result;
+			}
+			void unlink_proxy(node_index aNode)
+			{
+				auto proxyRow = rank(ProxyOrder, aNode);
+				auto before = split(ProxyOrder, iRoots[ProxyOrder], proxyRow);
+				auto after = split(ProxyOrder, before.second, 1u);
+				iRoots[ProxyOrder] = merge(ProxyOrder, before.first, after.second);
+				iNodes[aNode].proxied = false;
+			}
+		private:
+			std::vector<node> iNodes;
+			std::vector<node_index> iFreeNodes;
+			node_index iRoots[2];
+			std::minstd_rand iRandom;
+		};
+	public:
+		sort_filter_proxy_model() : iSourceModel(0)
+		{
+		}
+		sort_filter_proxy_model(i_item_model& aSourceModel) : iSourceModel(0)
+		{
+			set_source_model(aSourceModel);
+		}
+		~sort_filter_proxy_model()
+		{
+			if (has_source_model())
+				source_model().unsubscribe(*this);
+			notify_observers(i_item_model_subscriber::NotifyModelDestroyed);
+		}
+	public:
+		bool has_source_model() const
+		{
+			return iSourceModel != 0;
+		}
+		i_item_model& source_model() const
+		{
+			if (iSourceModel == 0)
+				throw no_source_model();
+			return *iSourceModel;
+		}
+		void set_source_model(i_item_model& aSourceModel)
+		{
+			if (iSourceModel == &aSourceModel)
+				return;
+			if (has_source_model())
+				source_model().unsubscribe(*this);
+			iSourceModel = &aSourceModel;
+			source_model().subscribe(*this);
+			rebuild();
+			notify_observers(i_item_model_subscriber::NotifyItemsSorted);
+		}
+		void set_filter(filter_function aFilter)
+		{
+			iFilter = aFilter;
+			invalidate_filter();
+		}
+		void invalidate_filter()
+		{
+			rebuild();
+			notify_observers(i_item_model_subscriber::NotifyItemsSorted);
+		}
+		item_model_index map_to_source(const item_model_index& aIndex) const
+		{
+			return item_model_index(iMapping.source_row(aIndex.row()), aIndex.column());
+		}
+		optional_item_model_index map_from_source(const item_model_index& aSourceIndex) const
+		{
+			if (aSourceIndex.row() >= iMapping.source_rows())
+				return optional_item_model_index();
+			auto proxyRow = iMapping.proxy_row(aSourceIndex.row());
+			if (proxyRow == kNoRow)
+				return optional_item_model_index();
+			return item_model_index(proxyRow, aSourceIndex.column());
+		}
+	public:
+		virtual uint32_t rows() const
+		{
+			return iMapping.proxy_rows();
+		}
+		virtual uint32_t columns() const
+		{
+			return has_source_model() ? source_model().columns() : 0;
+		}
+		virtual uint32_t columns(const item_model_index& aIndex) const
+		{
+			return source_model().columns(map_to_source(aIndex));
+		}
+		virtual const std::string& column_heading_text(item_model_index::value_type aColumnIndex) const
+		{
+			return source_model().column_heading_text(aColumnIndex);
+		}
+		virtual size column_heading_extents(item_model_index::value_type aColumnIndex, const graphics_context& aGraphicsContext) const
+		{
+			return source_model().column_heading_extents(aColumnIndex, aGraphicsContext);
+		}
+		virtual void set_column_heading_text(item_model_index::value_type aColumnIndex, const std::string& aHeadingText)
+		{
+			source_model().set_column_heading_text(aColumnIndex, aHeadingText);
+		}
+		virtual i_item_model::iterator index_to_iterator(const item_model_index& aIndex)
+		{
+			return base_iterator(row_iterator(aIndex.row()));
+		}
+		virtual i_item_model::const_iterator index_to_iterator(const item_model_index& aIndex) const
+		{
+			return base_iterator(row_iterator(aIndex.row()));
+		}
+		virtual item_model_index iterator_to_index(i_item_model::const_iterator aPosition) const
+		{
+			return item_model_index(*base_iterator(aPosition).get<row_iterator, row_iterator, row_iterator, row_iterator, row_iterator>(), 0);
+		}
+		virtual i_item_model::iterator begin()
+		{
+			return base_iterator(row_iterator(0));
+		}
+		virtual i_item_model::const_iterator begin() const
+		{
+			return base_iterator(row_iterator(0));
+		}
+		virtual i_item_model::iterator end()
+		{
+			return base_iterator(row_iterator(rows()));
+		}
+		virtual i_item_model::const_iterator end() const
+		{
+			return base_iterator(row_iterator(rows()));
+		}
+		virtual i_item_model::iterator sibling_begin()
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::const_iterator sibling_begin() const
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::iterator sibling_end()
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::const_iterator sibling_end() const
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::iterator parent(i_item_model::const_iterator)
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::const_iterator parent(i_item_model::const_iterator) const
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::iterator sibling_begin(i_item_model::const_iterator)
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::const_iterator sibling_begin(i_item_model::const_iterator) const
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::iterator sibling_end(i_item_model::const_iterator)
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::const_iterator sibling_end(i_item_model::const_iterator) const
+		{
+			throw operation_not_supported();
+		}
+	public:
+		virtual void subscribe(i_item_model_subscriber& aSubscriber)
+		{
+			add_observer(aSubscriber);
+		}
+		virtual void unsubscribe(i_item_model_subscriber& aSubscriber)
+		{
+			remove_observer(aSubscriber);
+		}
+	public:
+		virtual void reserve(uint32_t aItemCount)
+		{
+			source_model().reserve(aItemCount);
+		}
+		virtual uint32_t capacity() const
+		{
+			return source_model().capacity();
+		}
+		virtual i_item_model::iterator insert_item(i_item_model::const_iterator aPosition, const cell_data_type& aCellData)
+		{
+			return from_source(source_model().insert_item(to_source(aPosition), aCellData));
+		}
+		virtual i_item_model::iterator insert_item(const item_model_index& aIndex, const cell_data_type& aCellData)
+		{
+			return insert_item(index_to_iterator(aIndex), aCellData);
+		}
+		virtual i_item_model::iterator append_item(i_item_model::const_iterator aParent, const cell_data_type& aCellData)
+		{
+			return from_source(source_model().append_item(to_source(aParent), aCellData));
+		}
+		virtual void insert_cell_data(i_item_model::const_iterator aItem, item_model_index::value_type aColumnIndex, const cell_data_type& aCellData)
+		{
+			source_model().insert_cell_data(to_source(aItem), aColumnIndex, aCellData);
+		}
+		virtual void insert_cell_data(const item_model_index& aIndex, const cell_data_type& aCellData)
+		{
+			source_model().insert_cell_data(map_to_source(aIndex), aCellData);
+		}
+		virtual void update_cell_data(const item_model_index& aIndex, const cell_data_type& aCellData)
+		{
+			source_model().update_cell_data(map_to_source(aIndex), aCellData);
+		}
+	public:
+		virtual optional_sort_order sorting_by() const
+		{
+			if (!iSortOrder.empty())
+				return iSortOrder.front();
+			else
+				return optional_sort_order();
+		}
+		virtual void sort_by(item_model_index::value_type aColumnIndex, const optional_sort_direction& aSortDirection = optional_sort_direction())
+		{
+			iSortOrder.push_front(sort_order(aColumnIndex, aSortDirection == boost::none ? SortAscending : *aSortDirection));
+			for (auto i = std::next(iSortOrder.begin()); i != iSortOrder.end(); ++i)
+			{
+				if (i->first == aColumnIndex)
+				{
+					if (aSortDirection == boost::none)
+					{
+						if (i == std::next(iSortOrder.begin()))
+							iSortOrder.front().second = (i->second == SortAscending ? SortDescending : SortAscending);
+						else
+							iSortOrder.front().second = i->second;
+					}
+					iSortOrder.erase(i);
+					break;
+				}
+			}
+			// the rows are already in order of the remaining sort columns so a stable sort on the new primary column suffices
+			auto proxyRows = iMapping.proxy_order();
+			sort_rows(proxyRows, iSortOrder.front());
+			iMapping.assign_proxy_rows(proxyRows);
+			notify_observers(i_item_model_subscriber::NotifyItemsSorted);
+		}
+		virtual void reset_sort()
+		{
+			iSortOrder.clear();
+			rebuild();
+			notify_observers(i_item_model_subscriber::NotifyItemsSorted);
+		}
+	public:
+		virtual const cell_data_type& cell_data(const item_model_index& aIndex) const
+		{
+			return source_model().cell_data(map_to_source(aIndex));
+		}
+		virtual const i_item_presentation_model::cell_meta_type& cell_meta(const item_model_index& aIndex) const
+		{
+			return source_model().cell_meta(map_to_source(aIndex));
+		}
+		virtual bool row_cached(item_model_index::value_type aRow) const
+		{
+			return source_model().row_cached(iMapping.source_row(aRow));
+		}
+		virtual void rows_in_view(item_model_index::value_type aFirstRow, item_model_index::value_type aLastRow) const
+		{
+			rows_in_view(row_range_list{ { aFirstRow, aLastRow } });
+		}
+		// The source rows behind the proxy rows in view are scattered when sorted or filtered so they are forwarded as
+		// runs of contiguous source rows rather than as the (possibly whole model) span between the least and greatest.
+		virtual void rows_in_view(const row_range_list& aRowRanges) const
+		{
+			if (rows() == 0)
+				return;
+			row_list sourceRows;
+			for (const auto& rowRange : aRowRanges)
+			{
+				auto lastRow = std::min<item_model_index::value_type>(rowRange.second, rows() - 1);
+				auto firstRow = std::min(rowRange.first, lastRow);
+				for (auto proxyRow = firstRow; proxyRow <= lastRow; ++proxyRow)
+					sourceRows.push_back(iMapping.source_row(proxyRow));
+			}
+			std::sort(sourceRows.begin(), sourceRows.end());
+			row_range_list sourceRowRanges;
+			for (auto sourceRow : sourceRows)
+			{
+				if (!sourceRowRanges.empty() && sourceRow <= sourceRowRanges.back().second + 1)
+					sourceRowRanges.back().second = sourceRow;
+				else
+					sourceRowRanges.emplace_back(sourceRow, sourceRow);
+			}
+			source_model().rows_in_view(sourceRowRanges);
+		}
+	private:
+		virtual void column_info_changed(const i_item_model&, item_model_index::value_type aColumnIndex)
+		{
+			notify_observers(i_item_model_subscriber::NotifyColumnInfoChanged, aColumnIndex);
+		}
+		virtual void item_added(const i_item_model&, const item_model_index& aSourceIndex)
+		{
+			auto sourceRow = aSourceIndex.row();
+			if (sourceRow > iMapping.source_rows())
+			{
+				invalidate_filter();
+				return;
+			}
+			iMapping.insert_source_rows(sourceRow, 1);
+			if (accepts(sourceRow))
+				notify_observers(i_item_model_subscriber::NotifyItemAdded, item_model_index(insert_row(sourceRow)));
+		}
+		virtual void item_changed(const i_item_model&, const item_model_index& aSourceIndex)
+		{
+			auto sourceRow = aSourceIndex.row();
+			if (sourceRow >= iMapping.source_rows())
+			{
+				invalidate_filter();
+				return;
+			}
+			auto proxyRow = iMapping.proxy_row(sourceRow);
+			bool accepted = accepts(sourceRow);
+			if (proxyRow == kNoRow)
+			{
+				if (accepted)
+					notify_observers(i_item_model_subscriber::NotifyItemAdded, item_model_index(insert_row(sourceRow)));
+				return;
+			}
+			if (!accepted)
+			{
+				erase_row(proxyRow);
+				notify_observers(i_item_model_subscriber::NotifyItemRemoved, item_model_index(proxyRow));
+				return;
+			}
+			if (sorted_by(aSourceIndex.column()) && !in_order(proxyRow))
+			{
+				erase_row(proxyRow);
+				notify_observers(i_item_model_subscriber::NotifyItemRemoved, item_model_index(proxyRow));
+				proxyRow = insert_row(sourceRow);
+				notify_observers(i_item_model_subscriber::NotifyItemAdded, item_model_index(proxyRow));
+			}
+			notify_observers(i_item_model_subscriber::NotifyItemChanged, item_model_index(proxyRow, aSourceIndex.column()));
+		}
+		virtual void item_removed(const i_item_model&, const item_model_index& aSourceIndex)
+		{
+			auto sourceRow = aSourceIndex.row();
+			if (sourceRow >= iMapping.source_rows())
+			{
+				invalidate_filter();
+				return;
+			}
+			auto proxyRow = iMapping.proxy_row(sourceRow);
+			iMapping.erase_source_rows(sourceRow, 1);
+			if (proxyRow != kNoRow)
+				notify_observers(i_item_model_subscriber::NotifyItemRemoved, item_model_index(proxyRow));
+		}
+		// Source row ranges are notified as a proxy row range when the affected proxy rows are contiguous and otherwise as a re-sort.
+		virtual void items_added(const i_item_model&, item_model_index::value_type aFirstRow, uint32_t aRowCount)
+		{
+			if (aFirstRow > iMapping.source_rows())
+			{
+				invalidate_filter();
+				return;
+			}
+			iMapping.insert_source_rows(aFirstRow, aRowCount);
+			item_model_index::value_type firstProxyRow = kNoRow;
+			uint32_t added = 0;
+			bool contiguous = true;
+			for (auto sourceRow = aFirstRow; sourceRow < aFirstRow + aRowCount; ++sourceRow)
+			{
+				if (!accepts(sourceRow))
+					continue;
+				auto proxyRow = insert_row(sourceRow);
+				if (added++ == 0)
+					firstProxyRow = proxyRow;
+				else if (proxyRow != firstProxyRow + added - 1)
+					contiguous = false;
+			}
+			if (added == 0)
+				return;
+			if (contiguous)
+				notify_observers(i_item_model_subscriber::NotifyItemsAdded, firstProxyRow, added);
+			else
+				notify_observers(i_item_model_subscriber::NotifyItemsSorted);
+		}
+		virtual void items_changed(const i_item_model&, item_model_index::value_type aFirstRow, uint32_t aRowCount)
+		{
+			if (aRowCount == 0)
+				return;
+			if (aFirstRow + aRowCount > iMapping.source_rows())
+			{
+				invalidate_filter();
+				return;
+			}
+			// All the changed rows are taken out before any is put back as the rows they are positioned against must be in order.
+			row_list previousProxyRows;
+			previousProxyRows.reserve(aRowCount);
+			for (auto sourceRow = aFirstRow; sourceRow < aFirstRow + aRowCount; ++sourceRow)
+				previousProxyRows.push_back(iMapping.proxy_row(sourceRow));
+			iMapping.erase_proxy_rows(aFirstRow, aRowCount);
+			for (auto sourceRow = aFirstRow; sourceRow < aFirstRow + aRowCount; ++sourceRow)
+				if (accepts(sourceRow))
+					insert_row(sourceRow);
+			bool reorganised = false;
+			item_model_index::value_type firstProxyRow = kNoRow;
+			item_model_index::value_type lastProxyRow = 0;
+			for (uint32_t i = 0; i < aRowCount; ++i)
+			{
+				auto proxyRow = iMapping.proxy_row(aFirstRow + i);
+				if (proxyRow != previousProxyRows[i])
+					reorganised = true;
+				else if (proxyRow != kNoRow)
+				{
+					firstProxyRow = std::min(firstProxyRow, proxyRow);
+					lastProxyRow = std::max(lastProxyRow, proxyRow);
+				}
+			}
+			if (reorganised)
+				notify_observers(i_item_model_subscriber::NotifyItemsSorted);
+			else if (firstProxyRow != kNoRow)
+				notify_observers(i_item_model_subscriber::NotifyItemsChanged, firstProxyRow, lastProxyRow - firstProxyRow + 1);
+		}
+		virtual void items_removed(const i_item_model&, item_model_index::value_type aFirstRow, uint32_t aRowCount)
+		{
+			if (aFirstRow + aRowCount > iMapping.source_rows())
+			{
+				invalidate_filter();
+				return;
+			}
+			item_model_index::value_type firstProxyRow = kNoRow;
+			item_model_index::value_type lastProxyRow = 0;
+			uint32_t removed = 0;
+			for (auto sourceRow = aFirstRow; sourceRow < aFirstRow + aRowCount; ++sourceRow)
+			{
+				auto proxyRow = iMapping.proxy_row(sourceRow);
+				if (proxyRow == kNoRow)
+					continue;
+				firstProxyRow = std::min(firstProxyRow, proxyRow);
+				lastProxyRow = std::max(lastProxyRow, proxyRow);
+				++removed;
+			}
+			iMapping.erase_source_rows(aFirstRow, aRowCount);
+			if (removed == 0)
+				return;
+			if (lastProxyRow - firstProxyRow + 1 == removed)
+				notify_observers(i_item_model_subscriber::NotifyItemsRemoved, firstProxyRow, removed);
+			else
+				notify_observers(i_item_model_subscriber::NotifyItemsSorted);
+		}
+		virtual void items_sorted(const i_item_model&)
+		{
+			invalidate_filter();
+		}
+		virtual void model_destroyed(const i_item_model&)
+		{
+			iSourceModel = 0;
+			iMapping.clear();
+			notify_observers(i_item_model_subscriber::NotifyItemsSorted);
+		}
+	private:
+		virtual void notify_observer(i_item_model_subscriber& aObserver, i_item_model_subscriber::notify_type aType, const void* aParameter, const void* aParameter2)
+		{
+			switch (aType)
+			{
+			case i_item_model_subscriber::NotifyColumnInfoChanged:
+				aObserver.column_info_changed(*this, *static_cast<const item_model_index::value_type*>(aParameter));
+				break;
+			case i_item_model_subscriber::NotifyItemAdded:
+				aObserver.item_added(*this, *static_cast<const item_model_index*>(aParameter));
+				break;
+			case i_item_model_subscriber::NotifyItemChanged:
+				aObserver.item_changed(*this, *static_cast<const item_model_index*>(aParameter));
+				break;
+			case i_item_model_subscriber::NotifyItemRemoved:
+				aObserver.item_removed(*this, *static_cast<const item_model_index*>(aParameter));
+				break;
+			case i_item_model_subscriber::NotifyItemsAdded:
+				aObserver.items_added(*this, *static_cast<const item_model_index::value_type*>(aParameter), *static_cast<const uint32_t*>(aParameter2));
+				break;
+			case i_item_model_subscriber::NotifyItemsChanged:
+				aObserver.items_changed(*this, *static_cast<const item_model_index::value_type*>(aParameter), *static_cast<const uint32_t*>(aParameter2));
+				break;
+			case i_item_model_subscriber::NotifyItemsRemoved:
+				aObserver.items_removed(*this, *static_cast<const item_model_index::value_type*>(aParameter), *static_cast<const uint32_t*>(aParameter2));
+				break;
+			case i_item_model_subscriber::NotifyItemsSorted:
+				aObserver.items_sorted(*this);
+				break;
+			case i_item_model_subscriber::NotifyModelDestroyed:
+				aObserver.model_destroyed(*this);
+				break;
+			}
+		}
+	private:
+		i_item_model::const_iterator to_source(i_item_model::const_iterator aPosition) const
+		{
+			auto proxyRow = iterator_to_index(aPosition).row();
+			return source_model().index_to_iterator(item_model_index(proxyRow < rows() ? iMapping.source_row(proxyRow) : source_model().rows()));
+		}
+		i_item_model::iterator from_source(i_item_model::const_iterator aSourcePosition)
+		{
+			auto proxyRow = map_from_source(source_model().iterator_to_index(aSourcePosition));
+			return index_to_iterator(proxyRow != boost::none ? *proxyRow : item_model_index(rows()));
+		}
+		bool accepts(item_model_index::value_type aSourceRow) const
+		{
+			return !iFilter || iFilter(source_model(), aSourceRow);
+		}
+		bool sorted_by(item_model_index::value_type aColumnIndex) const
+		{
+			for (const auto& s : iSortOrder)
+				if (s.first == aColumnIndex)
+					return true;
+			return false;
+		}
+		cell_data_type key(item_model_index::value_type aSourceRow, item_model_index::value_type aColumnIndex) const
+		{
+			if (aColumnIndex >= source_model().columns(item_model_index(aSourceRow)))
+				return cell_data_type();
+			const cell_data_type& value = source_model().cell_data(item_model_index(aSourceRow, aColumnIndex));
+			if (value.is<std::string>())
+				return boost::to_upper_copy<std::string>(value);
+			return value;
+		}
+		bool less(item_model_index::value_type aLhs, item_model_index::value_type aRhs) const
+		{
+			for (const auto& s : iSortOrder)
+			{
+				cell_data_type k1 = key(aLhs, s.first);
+				cell_data_type k2 = key(aRhs, s.first);
+				if (k1 < k2)
+					return s.second == SortAscending;
+				else if (k2 < k1)
+					return s.second == SortDescending;
+			}
+			return false;
+		}
+		bool in_order(item_model_index::value_type aProxyRow) const
+		{
+			return (aProxyRow == 0 || !less(iMapping.source_row(aProxyRow), iMapping.source_row(aProxyRow - 1))) &&
+				(aProxyRow + 1 == rows() || !less(iMapping.source_row(aProxyRow + 1), iMapping.source_row(aProxyRow)));
+		}
+		item_model_index::value_type insert_row(item_model_index::value_type aSourceRow)
+		{
+			item_model_index::value_type proxyRow;
+			if (iSortOrder.empty())
+				proxyRow = iMapping.partition_point([aSourceRow](item_model_index::value_type aRow) { return aRow < aSourceRow; });
+			else
+				proxyRow = iMapping.partition_point([this, aSourceRow](item_model_index::value_type aRow) { return !less(aSourceRow, aRow); });
+			iMapping.insert_proxy_row(proxyRow, aSourceRow);
+			return proxyRow;
+		}
+		void erase_row(item_model_index::value_type aProxyRow)
+		{
+			iMapping.erase_proxy_row(aProxyRow);
+		}
+		void rebuild()
+		{
+			iMapping.clear();
+			iMapping.insert_source_rows(0, has_source_model() ? source_model().rows() : 0);
+			row_list proxyRows;
+			for (item_model_index::value_type sourceRow = 0; sourceRow < iMapping.source_rows(); ++sourceRow)
+				if (accepts(sourceRow))
+					proxyRows.push_back(sourceRow);
+			for (auto s = iSortOrder.rbegin(); s != iSortOrder.rend(); ++s)
+				sort_rows(proxyRows, *s);
+			iMapping.assign_proxy_rows(proxyRows);
+		}
+		// Reads the key of every row through the source's cell_data() (see the class comment about virtual models).
+		void sort_rows(row_list& aRows, const sort_order& aSortOrder) const
+		{
+			std::vector<sort_key> keys;
+			keys.reserve(aRows.size());
+			for (auto sourceRow : aRows)
+				keys.emplace_back(key(sourceRow, aSortOrder.first), sourceRow);
+			if (aSortOrder.second == SortAscending)
+				parallel_stable_sort(keys.begin(), keys.end(), [](const sort_key& aLhs, const sort_key& aRhs) { return aLhs.first < aRhs.first; });
+			else
+				parallel_stable_sort(keys.begin(), keys.end(), [](const sort_key& aLhs, const sort_key& aRhs) { return aRhs.first < aLhs.first; });
+			for (std::size_t i = 0; i < keys.size(); ++i)
+				aRows[i] = keys[i].second;
+		}
+		template <typename Iterator, typename Compare>
+		static void parallel_stable_sort(Iterator aFirst, Iterator aLast, Compare aCompare)
+		{
+			std::size_t count = std::distance(aFirst, aLast);
+			std::size_t threads = std::min<std::size_t>(std::max(std::thread::hardware_concurrency(), 1u), count / kParallelSortMinimumRowsPerThread);
+			if (threads < 2)
+			{
+				std::stable_sort(aFirst, aLast, aCompare);
+				return;
+			}
+			std::vector<Iterator> bounds;
+			for (std::size_t i = 0; i <= threads; ++i)
+				bounds.push_back(std::next(aFirst, count * i / threads));
+			std::vector<std::thread> workers;
+			for (std::size_t i = 0; i < threads; ++i)
+				workers.emplace_back([&bounds, &aCompare, i]() { std::stable_sort(bounds[i], bounds[i + 1], aCompare); });
+			for (auto& w : workers)
+				w.join();
+			// merge adjacent runs pairwise; std::inplace_merge is stable so equal keys keep their prior relative order
+			for (std::size_t width = 1; width < threads; width *= 2)
+			{
+				workers.clear();
+				for (std::size_t i = 0; i + width < threads; i += width * 2)
+					workers.emplace_back([&bounds, &aCompare, i, width, threads]() { std::inplace_merge(bounds[i], bounds[i + width], bounds[std::min(i + width * 2, threads)], aCompare); });
+				for (auto& w : workers)
+					w.join();
+			}
+		}
+	private:
+		i_item_model* iSourceModel;
+		filter_function iFilter;
+		std::deque<sort_order> iSortOrder;
+		row_mapping iMapping;
+	};
+}
\ No newline at end of file
@@ -20,6 +20,8 @@
 #pragma once
 
 #include <neogfx/neogfx.hpp>
+#include <set>
+#include <chrono>
 #include <boost/pool/pool_alloc.hpp>
 #include <neolib/tag_array.hpp>
 #include <neolib/segmented_array.hpp>
@@ -314,13 +316,20 @@ namespace neogfx
 			{
 				return iParent->iGlyphs.begin() + end_index();
 			}
+			bool deferred() const
+			{
+				// lazy layout delimits paragraphs without shaping them so they have text but no glyphs
+				return iSelf->second.glyphs() == 0 && iSelf->second.characters() != 0;
+			}
 			dimension height(document_glyphs::iterator aStart, document_glyphs::iterator aEnd) const
 			{
+				// heights are keyed on glyph index relative to the start of the paragraph so they remain valid
+				// when other paragraphs are reshaped
+				auto glyphsStartIndex = start_index();
 				if (iHeights.empty())
 				{
 					dimension previousHeight = 0.0;
 					auto textStartIndex = text_start_index();
-					auto glyphsStartIndex = start_index();
 					auto glyphsEndIndex = end_index();
 					auto iterGlyph = start();
 					for (auto i = glyphsStartIndex; i != glyphsEndIndex; ++i)
@@ -334,17 +343,18 @@ namespace neogfx
 							cy += 2.0;
 						if (i == glyphsStartIndex || cy != previousHeight)
 						{
-							iHeights[i] = cy;
+							iHeights[i - glyphsStartIndex] = cy;
 							previousHeight = cy;
 						}
 					}
-					iHeights[end_index()] = 0.0;
+					iHeights[glyphsEndIndex - glyphsStartIndex] = 0.0;
 				}
 				dimension result = 0.0;
-				auto start = iHeights.lower_bound(aStart - iParent->iGlyphs.begin());
-				if (start != iHeights.begin() && aStart < iParent->iGlyphs.begin() + start->first)
+				document_glyphs::size_type startIndex = (aStart - iParent->iGlyphs.begin()) - glyphsStartIndex;
+				auto start = iHeights.lower_bound(startIndex);
+				if (start != iHeights.begin() && (start == iHeights.end() || startIndex < start->first))
 					--start;
-				auto stop = iHeights.lower_bound(aEnd - iParent->iGlyphs.begin());
+				auto stop = iHeights.lower_bound((aEnd - iParent->iGlyphs.begin()) - glyphsStartIndex);
 				for (auto i = start; i != stop; ++i)
 					result = std::max(result, (*i).second);
 				return result;
@@ -356,13 +366,52 @@ namespace neogfx
 		};
 		struct glyph_line
 		{
-			std::pair<glyph_paragraphs::size_type, glyph_paragraphs::const_iterator> paragraph;
-			std::pair<document_glyphs::size_type, document_glyphs::const_iterator> lineStart;
-			std::pair<document_glyphs::size_type, document_glyphs::const_iterator> lineEnd;
-			coordinate ypos;
+			glyph_paragraphs::iterator paragraph;
+			// glyph offsets are relative to the start of the paragraph so lines remain valid when other paragraphs are reshaped
+			document_glyphs::size_type lineStart;
+			document_glyphs::size_type lineEnd;
 			size extents;
+			bool estimated;
+			document_glyphs::size_type start_index() const { return paragraph->first.start_index() + lineStart; }
+			document_glyphs::const_iterator start() const { return paragraph->first.start() + lineStart; }
+			document_glyphs::size_type end_index() const { return paragraph->first.start_index() + lineEnd; }
+			document_glyphs::const_iterator end() const { return paragraph->first.start() + lineEnd; }
 		};
-		typedef std::vector<glyph_line> glyph_lines;
+		typedef std::vector<glyph_line> glyph_line_list;
+		// The first line of each paragraph counts as one paragraph so lines can be found by paragraph index as well as by ypos.
+		class glyph_line_index
+		{
+		public:
+			glyph_line_index() :
+				iParagraphs(0), iHeight(0.0)
+			{
+			}
+			glyph_line_index(glyph_paragraphs::size_type aParagraphs, dimension aHeight) :
+				iParagraphs(aParagraphs), iHeight(aHeight)
+			{
+			}
+		public:
+			glyph_paragraphs::size_type paragraphs() const { return iParagraphs; }
+			dimension height() const { return iHeight; }
+		public:
+			bool operator==(const glyph_line_index& aRhs) const { return iHeight == aRhs.iHeight; }
+			bool operator!=(const glyph_line_index& aRhs) const { return !(*this == aRhs); }
+			bool operator<(const glyph_line_index& aRhs) const { return iHeight < aRhs.iHeight; }
+			bool operator>(const glyph_line_index& aRhs) const { return aRhs < *this; }
+			bool operator<=(const glyph_line_index& aRhs) const { return iHeight <= aRhs.iHeight; }
+			bool operator>=(const glyph_line_index& aRhs) const { return aRhs <= *this; }
+			glyph_line_index operator+(const glyph_line_index& aRhs) const { glyph_line_index result = *this; result += aRhs; return result; }
+			glyph_line_index operator-(const glyph_line_index& aRhs) const { glyph_line_index result = *this; result -= aRhs; return result; }
+			glyph_line_index& operator+=(const glyph_line_index& aRhs) { iParagraphs += aRhs.iParagraphs; iHeight += aRhs.iHeight; return *this; };
+			glyph_line_index& operator-=(const glyph_line_index& aRhs) { iParagraphs -= aRhs.iParagraphs; iHeight -= aRhs.iHeight; return *this; };
+		private:
+			glyph_paragraphs::size_type iParagraphs;
+			dimension iHeight;
+		};
+		typedef neolib::indexitor<
+			glyph_line,
+			glyph_line_index,
+			boost::fast_pool_allocator<std::pair<glyph_line, const glyph_line_index>, boost::default_user_allocator_new_delete, boost::details::pool::null_mutex>> glyph_lines;
 		class glyph_column : public column_info
 		{
 		public:
@@ -382,6 +431,14 @@ namespace neogfx
 			dimension iWidth;
 		};
 		typedef std::vector<glyph_column> glyph_columns;
+		static const uint32_t kLazyLayoutBudget_ms = 4;
+		struct line_layout
+		{
+			dimension availableWidth;
+			dimension availableHeight;
+			bool verticalScrollbar;
+			bool horizontalScrollbar;
+		};
 	public:
 		typedef document_text::size_type position_type;
 	public:
@@ -421,6 +478,7 @@ namespace neogfx
 		virtual void update_scrollbar_visibility(usv_stage_e aStage);
 	protected:
 		virtual colour frame_colour() const;
+		virtual optional_rect scrolled_area() const;
 	public:
 		virtual bool can_undo() const;
 		virtual bool can_redo() const;
@@ -443,6 +501,8 @@ namespace neogfx
 		void set_read_only(bool aReadOnly = true);
 		bool word_wrap() const;
 		void set_word_wrap(bool aWordWrap = true);
+		bool lazy_layout() const;
+		void set_lazy_layout(bool aLazyLayout = true);
 		bool password() const;
 		void set_password(bool aPassword, const std::string& aMask = "\xE2\x97\x8F");
 		neogfx::alignment alignment() const;
@@ -496,9 +556,24 @@ namespace neogfx
 		glyph_paragraphs::const_iterator glyph_to_paragraph(position_type aGlyphPos) const;
 		document_glyphs::const_iterator to_glyph(document_text::const_iterator aWhere) const;
 		std::pair<document_text::size_type, document_text::size_type> from_glyph(document_glyphs::const_iterator aWhere) const;
+		void clear_paragraph_caches();
 		void refresh_paragraph(document_text::const_iterator aWhere, ptrdiff_t aDelta);
+		std::pair<glyph_paragraphs::iterator, glyph_paragraphs::size_type> shape_paragraphs(position_type aTextStart, position_type aTextEnd, document_glyphs::size_type aGlyphPosition, glyph_paragraphs::const_iterator aInsertBefore);
+		void defer_paragraphs(position_type aTextStart, position_type aTextEnd, glyph_paragraphs::const_iterator aInsertBefore);
+		glyph_paragraphs::iterator shape_deferred_paragraph(glyph_paragraphs::iterator aParagraph);
+		dimension estimated_character_width() const;
 		void refresh_columns();
 		void refresh_lines();
+		bool refresh_lines(glyph_paragraphs::iterator aFirstParagraph, glyph_paragraphs::size_type aFirstParagraphIndex, glyph_paragraphs::size_type aOldParagraphCount, glyph_paragraphs::size_type aNewParagraphCount);
+		void wrap_paragraph(glyph_paragraphs::iterator aParagraph, glyph_line_list& aLines, point& aPos, dimension aAvailableWidth);
+		void estimate_paragraph(glyph_paragraphs::iterator aParagraph, glyph_line_list& aLines, point& aPos, dimension aAvailableWidth);
+		void insert_lines(glyph_lines::const_iterator aPosition, const glyph_line_list& aLines);
+		void erase_lines(glyph_lines::const_iterator aFirst, glyph_lines::const_iterator aLast);
+		void clear_lines();
+		static coordinate line_ypos(const glyph_lines& aLines, glyph_lines::const_iterator aLine);
+		static glyph_lines::const_iterator ypos_to_line(const glyph_lines& aLines, coordinate aYpos);
+		void refine_lines();
+		void refine_lines(glyph_lines::const_iterator aFirstLine, glyph_lines::const_iterator aLastLine, const boost::optional<std::chrono::steady_clock::time_point>& aDeadline = boost::none);
 		void animate();
 		void update_cursor();
 		void make_cursor_visible(bool aForcePreviewScroll = false);
@@ -511,6 +586,7 @@ namespace neogfx
 		type_e iType;
 		bool iReadOnly;
 		bool iWordWrap;
+		bool iLazyLayout;
 		bool iPassword;
 		std::string iPasswordMask;
 		neogfx::alignment iAlignment;
@@ -524,6 +600,10 @@ namespace neogfx
 		document_glyphs iGlyphs;
 		glyph_paragraphs iGlyphParagraphs;
 		glyph_columns iGlyphColumns;
+		boost::optional<line_layout> iLineLayout;
+		glyph_lines::size_type iEstimatedLines;
+		glyph_lines::const_iterator iNextEstimatedLine;
+		std::multiset<dimension> iLineWidths;
 		size iTextExtents;
 		uint64_t iCursorAnimationStartTime;
 		typedef std::pair<position_type, position_type> find_span;
@@ -541,8 +621,9 @@ namespace neogfx
 		optional_dimension iTabStops;
 		std::string iTabStopHint;
 		mutable boost::optional<std::pair<neogfx::font, dimension>> iCalculatedTabStops;
-		neolib::callback_timer iAnimator;
-		boost::optional<neolib::callback_timer> iDragger;
+		mutable boost::optional<std::pair<neogfx::font, dimension>> iEstimatedCharacterWidth;
+		callback_timer iAnimator;
+		boost::optional<callback_timer> iDragger;
 		std::unique_ptr<context_menu> iMenu;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,564 @@
+// virtual_item_model.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <vector>
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <functional>
+#include <memory>
+#include <boost/iterator/counting_iterator.hpp>
+#include <neolib/observable.hpp>
+#include "i_item_model.hpp"
+#include <neogfx/gfx/graphics_context.hpp>
+#include <neogfx/app/app.hpp>
+
+namespace neogfx
+{
+	// Item model whose rows are not held in memory: cell data is requested a page of rows at a time from a user supplied
+	// fetch function when first needed and kept in a least recently used page cache. Until a requested page has been
+	// supplied (by calling fill(), from any thread, either from within the fetch function or later) its rows read as
+	// empty cells. A page filled from within the fetch function is available immediately and silently; a page filled
+	// later is posted to the event loop (waking it), never applied from within cell_data() or rows_in_view(), and notified
+	// with a single items_changed for the page. Pages holding the rows reported by rows_in_view() are not evicted; when
+	// those rows are a single run the pages around them are prefetched (and kept) too.
+	// Cells written to a page that is still being fetched keep the written data once the page is filled; writes to rows
+	// that are not cached are not kept. Cell metadata (including selection state) of evicted pages is lost.
+	class virtual_item_model : public i_item_model, private neolib::observable<i_item_model_subscriber>
+	{
+	public:
+		typedef std::vector<cell_data_type> row_data;
+		struct fetch_request
+		{
+			uint64_t id;
+			item_model_index::value_type firstRow;
+			uint32_t rowCount;
+			optional_sort_order sortOrder;
+		};
+		typedef std::function<void(const fetch_request&)> fetch_function;
+	public:
+		struct operation_not_supported : std::logic_error { operation_not_supported() : std::logic_error("neogfx::virtual_item_model::operation_not_supported") {} };
+	public:
+		static const uint32_t kDefaultPageSize = 256;
+		static const uint32_t kDefaultCachedPages = 256;
+	private:
+		typedef boost::counting_iterator<item_model_index::value_type> row_iterator;
+		typedef neolib::specialized_generic_iterator<row_iterator> base_iterator;
+		typedef std::vector<cell_type> row_type;
+		struct page
+		{
+			uint64_t request;
+			bool pending;
+			std::vector<row_type> rows;
+			std::vector<std::pair<item_model_index, cell_data_type>> writes;
+		};
+		typedef std::list<std::pair<uint32_t, page>> page_list;
+		typedef std::unordered_map<uint32_t, page_list::iterator> page_map;
+		typedef std::pair<uint32_t, uint32_t> page_range;
+		typedef std::vector<page_range> page_range_list;
+		typedef std::vector<std::pair<fetch_request, std::vector<row_data>>> fill_list;
+		// shared with callbacks posted to the event loop so that they can outlive the model
+		struct fill_queue
+		{
+			std::mutex mutex;
+			virtual_item_model* owner;
+			fill_list fills;
+			bool posted;
+			boost::optional<uint64_t> fetching;
+		};
+		struct column_info
+		{
+			std::string headingText;
+			mutable font headingFont;
+			mutable optional_size extents;
+		};
+	public:
+		virtual_item_model(uint32_t aRows, uint32_t aColumns, fetch_function aFetchFunction, uint32_t aPageSize = kDefaultPageSize, uint32_t aCachedPages = kDefaultCachedPages) :
+			iRows(aRows),
+			iColumns(aColumns),
+			iFetchFunction(aFetchFunction),
+			iPageSize(std::max<uint32_t>(aPageSize, 1)),
+			iCachedPages(std::max<uint32_t>(aCachedPages, 1)),
+			iNextRequest(0),
+			iFillQueue(std::make_shared<fill_queue>())
+		{
+			iFillQueue->owner = this;
+			iFillQueue->posted = false;
+		}
+		~virtual_item_model()
+		{
+			{
+				std::lock_guard<std::mutex> lock(iFillQueue->mutex);
+				iFillQueue->owner = nullptr;
+			}
+			notify_observers(i_item_model_subscriber::NotifyModelDestroyed);
+		}
+	public:
+		virtual uint32_t rows() const
+		{
+			return iRows;
+		}
+		virtual uint32_t columns() const
+		{
+			return iColumns.size();
+		}
+		virtual uint32_t columns(const item_model_index&) const
+		{
+			return iColumns.size();
+		}
+		virtual const std::string& column_heading_text(item_model_index::value_type aColumnIndex) const
+		{
+			if (iColumns.size() < aColumnIndex + 1)
+				throw bad_column_index();
+			return iColumns[aColumnIndex].headingText;
+		}
+		virtual size column_heading_extents(item_model_index::value_type aColumnIndex, const graphics_context& aGraphicsContext) const
+		{
+			if (iColumns.size() < aColumnIndex + 1)
+				throw bad_column_index();
+			if (iColumns[aColumnIndex].headingFont != font())
+			{
+				iColumns[aColumnIndex].headingFont = font();
+				iColumns[aColumnIndex].extents = boost::none;
+			}
+			if (iColumns[aColumnIndex].extents != boost::none)
+				return units_converter(aGraphicsContext).from_device_units(*iColumns[aColumnIndex].extents);
+			size columnHeadingExtents = aGraphicsContext.text_extent(column_heading_text(aColumnIndex), iColumns[aColumnIndex].headingFont);
+			iColumns[aColumnIndex].extents = units_converter(aGraphicsContext).to_device_units(columnHeadingExtents);
+			iColumns[aColumnIndex].extents->cx = std::ceil(iColumns[aColumnIndex].extents->cx);
+			iColumns[aColumnIndex].extents->cy = std::ceil(iColumns[aColumnIndex].extents->cy);
+			return units_converter(aGraphicsContext).from_device_units(*iColumns[aColumnIndex].extents);
+		}
+		virtual void set_column_heading_text(item_model_index::value_type aColumnIndex, const std::string& aHeadingText)
+		{
+			if (iColumns.size() < aColumnIndex + 1)
+			{
+				iColumns.resize(aColumnIndex + 1);
+				discard_pages(0);
+			}
+			iColumns[aColumnIndex].headingText = aHeadingText;
+			iColumns[aColumnIndex].extents = boost::none;
+			notify_observers(i_item_model_subscriber::NotifyColumnInfoChanged, aColumnIndex);
+		}
+		virtual i_item_model::iterator index_to_iterator(const item_model_index& aIndex)
+		{
+			return base_iterator(row_iterator(aIndex.row()));
+		}
+		virtual i_item_model::const_iterator index_to_iterator(const item_model_index& aIndex) const
+		{
+			return base_iterator(row_iterator(aIndex.row()));
+		}
+		virtual item_model_index iterator_to_index(i_item_model::const_iterator aPosition) const
+		{
+			return item_model_index(*base_iterator(aPosition).get<row_iterator, row_iterator, row_iterator, row_iterator, row_iterator>(), 0);
+		}
+		virtual i_item_model::iterator begin()
+		{
+			return base_iterator(row_iterator(0));
+		}
+		virtual i_item_model::const_iterator begin() const
+		{
+			return base_iterator(row_iterator(0));
+		}
+		virtual i_item_model::iterator end()
+		{
+			return base_iterator(row_iterator(iRows));
+		}
+		virtual i_item_model::const_iterator end() const
+		{
+			return base_iterator(row_iterator(iRows));
+		}
+		virtual i_item_model::iterator sibling_begin()
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::const_iterator sibling_begin() const
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::iterator sibling_end()
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::const_iterator sibling_end() const
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::iterator parent(i_item_model::const_iterator)
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::const_iterator parent(i_item_model::const_iterator) const
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::iterator sibling_begin(i_item_model::const_iterator)
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::const_iterator sibling_begin(i_item_model::const_iterator) const
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::iterator sibling_end(i_item_model::const_iterator)
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::const_iterator sibling_end(i_item_model::const_iterator) const
+		{
+			throw operation_not_supported();
+		}
+	public:
+		virtual void subscribe(i_item_model_subscriber& aSubscriber)
+		{
+			add_observer(aSubscriber);
+		}
+		virtual void unsubscribe(i_item_model_subscriber& aSubscriber)
+		{
+			remove_observer(aSubscriber);
+		}
+	public:
+		virtual void reserve(uint32_t)
+		{
+		}
+		virtual uint32_t capacity() const
+		{
+			return iRows;
+		}
+		virtual i_item_model::iterator insert_item(i_item_model::const_iterator, const cell_data_type&)
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::iterator insert_item(const item_model_index&, const cell_data_type&)
+		{
+			throw operation_not_supported();
+		}
+		virtual i_item_model::iterator append_item(i_item_model::const_iterator, const cell_data_type&)
+		{
+			throw operation_not_supported();
+		}
+		virtual void insert_cell_data(i_item_model::const_iterator aItem, item_model_index::value_type aColumnIndex, const cell_data_type& aCellData)
+		{
+			update_cell_data(item_model_index(iterator_to_index(aItem).row(), aColumnIndex), aCellData);
+		}
+		virtual void insert_cell_data(const item_model_index& aIndex, const cell_data_type& aCellData)
+		{
+			update_cell_data(aIndex, aCellData);
+		}
+		virtual void update_cell_data(const item_model_index& aIndex, const cell_data_type& aCellData)
+		{
+			if (aIndex.column() >= columns())
+				throw bad_column_index();
+			auto existing = iPageMap.find(aIndex.row() / iPageSize);
+			if (existing == iPageMap.end())
+				return;
+			auto& target = existing->second->second;
+			item_model_index pageIndex{ aIndex.row() % iPageSize, aIndex.column() };
+			if (target.pending)
+				target.writes.emplace_back(pageIndex, aCellData);
+			target.rows[pageIndex.row()][pageIndex.column()] = cell_type(aCellData, i_item_presentation_model::cell_meta_type());
+			notify_observers(i_item_model_subscriber::NotifyItemChanged, aIndex);
+		}
+	public:
+		virtual optional_sort_order sorting_by() const
+		{
+			return iSortOrder;
+		}
+		virtual void sort_by(item_model_index::value_type aColumnIndex, const optional_sort_direction& aSortDirection = optional_sort_direction())
+		{
+			if (aSortDirection != boost::none)
+				iSortOrder = sort_order(aColumnIndex, *aSortDirection);
+			else if (iSortOrder != boost::none && iSortOrder->first == aColumnIndex)
+				iSortOrder = sort_order(aColumnIndex, iSortOrder->second == SortAscending ? SortDescending : SortAscending);
+			else
+				iSortOrder = sort_order(aColumnIndex, SortAscending);
+			discard_pages(0);
+			notify_observers(i_item_model_subscriber::NotifyItemsSorted);
+		}
+		virtual void reset_sort()
+		{
+			iSortOrder = boost::none;
+			discard_pages(0);
+			notify_observers(i_item_model_subscriber::NotifyItemsSorted);
+		}
+	public:
+		virtual const cell_data_type& cell_data(const item_model_index& aIndex) const
+		{
+			if (aIndex.column() >= columns())
+				throw bad_column_index();
+			return fetch_page(aIndex.row() / iPageSize).rows[aIndex.row() % iPageSize][aIndex.column()].first;
+		}
+		virtual const i_item_presentation_model::cell_meta_type& cell_meta(const item_model_index& aIndex) const
+		{
+			if (aIndex.column() >= columns())
+				throw bad_column_index();
+			auto existing = iPageMap.find(aIndex.row() / iPageSize);
+			if (existing == iPageMap.end())
+			{
+				iPlaceholderMeta = i_item_presentation_model::cell_meta_type();
+				return iPlaceholderMeta;
+			}
+			return existing->second->second.rows[aIndex.row() % iPageSize][aIndex.column()].second;
+		}
+		virtual bool row_cached(item_model_index::value_type aRow) const
+		{
+			return iPageMap.find(aRow / iPageSize) != iPageMap.end();
+		}
+		virtual void rows_in_view(item_model_index::value_type aFirstRow, item_model_index::value_type aLastRow) const
+		{
+			rows_in_view(row_range_list{ { aFirstRow, aLastRow } });
+		}
+		virtual void rows_in_view(const row_range_list& aRowRanges) const
+		{
+			iViewPages.clear();
+			if (iRows == 0)
+				return;
+			for (const auto& rowRange : aRowRanges)
+			{
+				uint32_t firstPage = std::min(rowRange.first, iRows - 1) / iPageSize;
+				uint32_t lastPage = std::max(std::min(rowRange.second, iRows - 1) / iPageSize, firstPage);
+				if (!iViewPages.empty() && firstPage <= iViewPages.back().second + 1)
+					iViewPages.back().second = std::max(iViewPages.back().second, lastPage);
+				else
+					iViewPages.emplace_back(firstPage, lastPage);
+			}
+			for (const auto& pageRange : iViewPages)
+				for (uint32_t p = pageRange.first; p <= pageRange.second; ++p)
+					fetch_page(p);
+			// rows scattered over several runs (e.g. those of a sorted proxy) give no direction to prefetch in
+			if (iViewPages.size() != 1)
+				return;
+			uint32_t firstPage = iViewPages[0].first;
+			uint32_t lastPage = iViewPages[0].second;
+			uint32_t prefetch = lastPage - firstPage + 1;
+			iViewPages[0].first = firstPage - std::min(firstPage, prefetch);
+			iViewPages[0].second = std::min(lastPage + prefetch, (iRows - 1) / iPageSize);
+			for (uint32_t p = lastPage + 1; p <= iViewPages[0].second; ++p)
+				fetch_page(p);
+			for (uint32_t p = firstPage; p-- > iViewPages[0].first;)
+				fetch_page(p);
+		}
+	public:
+		void set_row_count(uint32_t aRows)
+		{
+			if (aRows == iRows)
+				return;
+			uint32_t oldRows = iRows;
+			discard_pages(std::min(aRows, oldRows) / iPageSize, false);
+			iRows = aRows;
+			if (aRows > oldRows)
+				notify_observers(i_item_model_subscriber::NotifyItemsAdded, oldRows, aRows - oldRows);
+			else
+				notify_observers(i_item_model_subscriber::NotifyItemsRemoved, aRows, oldRows - aRows);
+		}
+		void invalidate_rows(item_model_index::value_type aFirstRow, uint32_t aRowCount)
+		{
+			if (aRowCount == 0)
+				return;
+			for (uint32_t p = aFirstRow / iPageSize; p <= (aFirstRow + aRowCount - 1) / iPageSize; ++p)
+			{
+				auto existing = iPageMap.find(p);
+				if (existing == iPageMap.end())
+					continue;
+				uint32_t rowCount = existing->second->second.rows.size();
+				discard_page(existing);
+				notify_observers(i_item_model_subscriber::NotifyItemsChanged, p * iPageSize, rowCount);
+			}
+		}
+		void fill(const fetch_request& aRequest, std::vector<row_data> aRows)
+		{
+			auto queue = iFillQueue;
+			{
+				std::lock_guard<std::mutex> lock(queue->mutex);
+				queue->fills.emplace_back(aRequest, std::move(aRows));
+				// a fill from within the fetch function is picked up by fetch_page() itself
+				if (queue->posted || queue->fetching == aRequest.id)
+					return;
+				queue->posted = true;
+			}
+			app::instance().post([queue]()
+			{
+				virtual_item_model* owner;
+				{
+					std::lock_guard<std::mutex> lock(queue->mutex);
+					queue->posted = false;
+					owner = queue->owner;
+				}
+				if (owner != nullptr)
+					owner->apply_fills();
+			});
+		}
+	private:
+		uint32_t page_rows(uint32_t aPage) const
+		{
+			return std::min(iPageSize, iRows - aPage * iPageSize);
+		}
+		page& fetch_page(uint32_t aPage) const
+		{
+			auto existing = iPageMap.find(aPage);
+			if (existing != iPageMap.end())
+			{
+				iPages.splice(iPages.begin(), iPages, existing->second);
+				return existing->second->second;
+			}
+			iPages.emplace_front(aPage, page{ ++iNextRequest, true, std::vector<row_type>(page_rows(aPage), row_type(columns())), {} });
+			iPageMap[aPage] = iPages.begin();
+			evict();
+			fetch_request request{ iPages.front().second.request, aPage * iPageSize, page_rows(aPage), iSortOrder };
+			{
+				std::lock_guard<std::mutex> lock(iFillQueue->mutex);
+				iFillQueue->fetching = request.id;
+			}
+			iFetchFunction(request);
+			{
+				std::lock_guard<std::mutex> lock(iFillQueue->mutex);
+				iFillQueue->fetching = boost::none;
+				auto& fills = iFillQueue->fills;
+				auto f = std::find_if(fills.begin(), fills.end(), [&request](const fill_list::value_type& aFill) { return aFill.first.id == request.id; });
+				if (f != fills.end())
+				{
+					apply_fill(*f);
+					fills.erase(f);
+				}
+			}
+			return iPageMap.find(aPage)->second->second;
+		}
+		const page* apply_fill(const fill_list::value_type& aFill) const
+		{
+			auto existing = iPageMap.find(aFill.first.firstRow / iPageSize);
+			if (existing == iPageMap.end() || !existing->second->second.pending || existing->second->second.request != aFill.first.id)
+				return nullptr;
+			page& filled = existing->second->second;
+			for (std::size_t row = 0; row < filled.rows.size() && row < aFill.second.size(); ++row)
+				for (std::size_t col = 0; col < filled.rows[row].size() && col < aFill.second[row].size(); ++col)
+					filled.rows[row][col].first = aFill.second[row][col];
+			for (const auto& write : filled.writes)
+				filled.rows[write.first.row()][write.first.column()].first = write.second;
+			filled.writes.clear();
+			filled.pending = false;
+			return &filled;
+		}
+		void apply_fills()
+		{
+			fill_list fills;
+			{
+				std::lock_guard<std::mutex> lock(iFillQueue->mutex);
+				fills.swap(iFillQueue->fills);
+			}
+			for (const auto& f : fills)
+			{
+				auto filled = apply_fill(f);
+				if (filled != nullptr)
+					notify_observers(i_item_model_subscriber::NotifyItemsChanged, f.first.firstRow, static_cast<uint32_t>(filled->rows.size()));
+			}
+		}
+		void evict() const
+		{
+			auto candidate = iPages.end();
+			while (iPageMap.size() > iCachedPages && candidate != iPages.begin())
+			{
+				if (--candidate == iPages.begin())
+					break;
+				if (in_view(candidate->first))
+					continue;
+				auto evictee = candidate++;
+				discard_page(iPageMap.find(evictee->first));
+			}
+		}
+		bool in_view(uint32_t aPage) const
+		{
+			auto pageRange = std::upper_bound(iViewPages.begin(), iViewPages.end(), aPage, [](uint32_t aLhs, const page_range& aRhs) { return aLhs < aRhs.first; });
+			return pageRange != iViewPages.begin() && aPage <= (--pageRange)->second;
+		}
+		void discard_page(page_map::iterator aPage) const
+		{
+			iPages.erase(aPage->second);
+			iPageMap.erase(aPage);
+		}
+		void discard_pages(uint32_t aFirstPage, bool aNotify = true)
+		{
+			std::vector<std::pair<uint32_t, uint32_t>> discarded;
+			for (auto i = iPageMap.begin(); i != iPageMap.end();)
+			{
+				auto next = std::next(i);
+				if (i->first >= aFirstPage)
+				{
+					discarded.emplace_back(i->first, i->second->second.rows.size());
+					discard_page(i);
+				}
+				i = next;
+			}
+			if (aNotify)
+				for (const auto& d : discarded)
+					notify_observers(i_item_model_subscriber::NotifyItemsChanged, d.first * iPageSize, d.second);
+		}
+	private:
+		virtual void notify_observer(i_item_model_subscriber& aObserver, i_item_model_subscriber::notify_type aType, const void* aParameter, const void* aParameter2)
+		{
+			switch (aType)
+			{
+			case i_item_model_subscriber::NotifyColumnInfoChanged:
+				aObserver.column_info_changed(*this, *static_cast<const item_model_index::value_type*>(aParameter));
+				break;
+			case i_item_model_subscriber::NotifyItemAdded:
+				aObserver.item_added(*this, *static_cast<const item_model_index*>(aParameter));
+				break;
+			case i_item_model_subscriber::NotifyItemChanged:
+				aObserver.item_changed(*this, *static_cast<const item_model_index*>(aParameter));
+				break;
+			case i_item_model_subscriber::NotifyItemRemoved:
+				aObserver.item_removed(*this, *static_cast<const item_model_index*>(aParameter));
+				break;
+			case i_item_model_subscriber::NotifyItemsAdded:
+				aObserver.items_added(*this, *static_cast<const item_model_index::value_type*>(aParameter), *static_cast<const uint32_t*>(aParameter2));
+				break;
+			case i_item_model_subscriber::NotifyItemsChanged:
+				aObserver.items_changed(*this, *static_cast<const item_model_index::value_type*>(aParameter), *static_cast<const uint32_t*>(aParameter2));
+				break;
+			case i_item_model_subscriber::NotifyItemsRemoved:
+				aObserver.items_removed(*this, *static_cast<const item_model_index::value_type*>(aParameter), *static_cast<const uint32_t*>(aParameter2));
+				break;
+			case i_item_model_subscriber::NotifyItemsSorted:
+				aObserver.items_sorted(*this);
+				break;
+			case i_item_model_subscriber::NotifyModelDestroyed:
+				aObserver.model_destroyed(*this);
+				break;
+			}
+		}
+	private:
+		uint32_t iRows;
+		std::vector<column_info> iColumns;
+		fetch_function iFetchFunction;
+		uint32_t iPageSize;
+		uint32_t iCachedPages;
+		optional_sort_order iSortOrder;
+		mutable page_list iPages;
+		mutable page_map iPageMap;
+		mutable uint64_t iNextRequest;
+		mutable page_range_list iViewPages;
+		mutable i_item_presentation_model::cell_meta_type iPlaceholderMeta;
+		std::shared_ptr<fill_queue> iFillQueue;
+	};
+}
\ No newline at end of file
@@ -22,7 +22,7 @@
 #include <neogfx/neogfx.hpp>
 #include <unordered_set>
 #include <neolib/destroyable.hpp>
-#include <neolib/timer.hpp>
+#include <neogfx/core/timer.hpp>
 #include "i_widget.hpp"
 
 namespace neogfx
@@ -101,10 +101,12 @@ namespace neogfx
 		bool has_parent_layout() const override;
 		const i_layout& parent_layout() const override;
 		i_layout& parent_layout() override;
+		void set_parent_layout(i_layout* aParentLayout) override;
 		void layout_items(bool aDefer = false) override;
 		void layout_items_started() override;
 		bool layout_items_in_progress() const override;
 		void layout_items_completed() override;
+		void invalidate_size_hints() override;
 	public:
 		neogfx::logical_coordinate_system logical_coordinate_system() const override;
 		point position() const override;
@@ -116,6 +118,7 @@ namespace neogfx
 		void set_extents(const size& aSize) override;
 		void resize(const size& aSize) override;
 		void resized() override;
+		void child_geometry_changed(i_widget& aChild) override;
 		rect window_rect() const override;
 		rect client_rect(bool aIncludeMargins = true) const override;
 		const i_widget& widget_at(const point& aPosition) const override;
@@ -211,13 +214,18 @@ namespace neogfx
 		// helpers
 	public:
 		using i_widget::set_size_policy;
+	private:
+		void add_child(std::shared_ptr<i_widget> aChild);
 	private:
 		bool iSingular;
 		i_widget* iParent;
 		widget_list iChildren;
+		class child_index;
+		std::unique_ptr<child_index> iChildIndex;
 		i_widget* iLinkBefore;
 		i_widget* iLinkAfter;
 		std::shared_ptr<i_layout> iLayout;
+		i_layout* iParentLayout;
 		class layout_timer;
 		std::unique_ptr<layout_timer> iLayoutTimer;
 		device_metrics_forwarder iDeviceMetricsForwarder;
@@ -237,5 +245,6 @@ namespace neogfx
 		optional_colour iBackgroundColour;
 		optional_font iFont;
 		bool iIgnoreMouseEvents;
+		mutable boost::optional<rect> iUpdateRect;
 	};
 }
\ No newline at end of file
@@ -95,8 +95,10 @@ namespace neogfx
 		void set_logical_coordinates(const std::pair<vec2, vec2>& aCoordinates) override;
 		void layout_surface() override;
 		void invalidate_surface(const rect& aInvalidatedRect, bool aInternal = true) override;
+		void scroll_surface(const rect& aArea, const delta& aDelta) override;
 		bool has_invalidated_area() const override;
 		const rect& invalidated_area() const override;
+		const std::vector<rect>& invalidated_rects() const override;
 		bool has_rendering_priority() const override;
 		void render_surface() override;
 		void pause_rendering() override;
@@ -105,8 +105,10 @@ namespace neogfx
 		virtual void set_logical_coordinates(const std::pair<vec2, vec2>& aCoordinates) = 0;
 		virtual void layout_surface() = 0;
 		virtual void invalidate_surface(const rect& aInvalidatedRect, bool aInternal = true) = 0;
+		virtual void scroll_surface(const rect& aArea, const delta& aDelta) = 0;
 		virtual bool has_invalidated_area() const = 0;
 		virtual const rect& invalidated_area() const = 0;
+		virtual const std::vector<rect>& invalidated_rects() const = 0;
 		virtual bool has_rendering_priority() const = 0;
 		virtual void render_surface() = 0;
 		virtual void pause_rendering() = 0;
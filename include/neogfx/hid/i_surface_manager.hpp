@@ -40,6 +40,7 @@ namespace neogfx
 		virtual void layout_surfaces() = 0;
 		virtual void invalidate_surfaces() = 0;
 		virtual void render_surfaces() = 0;
+		virtual boost::optional<uint64_t> next_frame_time() const = 0;
 		virtual void display_error_message(const std::string& aTitle, const std::string& aMessage) const = 0;
 		virtual void display_error_message(const i_native_surface& aParent, const std::string& aTitle, const std::string& aMessage) const = 0;
 		virtual uint32_t display_count() const = 0;
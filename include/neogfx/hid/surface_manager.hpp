@@ -57,6 +57,7 @@ namespace neogfx
 		virtual void layout_surfaces();
 		virtual void invalidate_surfaces();
 		virtual void render_surfaces();
+		virtual boost::optional<uint64_t> next_frame_time() const;
 		virtual void display_error_message(const std::string& aTitle, const std::string& aMessage) const;
 		virtual void display_error_message(const i_native_surface& aParent, const std::string& aTitle, const std::string& aMessage) const;
 		virtual uint32_t display_count() const;
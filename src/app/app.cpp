@@ -19,6 +19,7 @@
 
 #include <neogfx/neogfx.hpp>
 #include <atomic>
+#include <chrono>
 #include <boost/locale.hpp> 
 #include <neogfx/app/app.hpp>
 #include <neogfx/hid/surface_manager.hpp>
@@ -78,12 +79,13 @@ namespace neogfx
 		try :
 		neolib::thread{ "neogfx::app", true },
 		neolib::io_task{ *this, "neogfx::app" },
-		async_event_queue{ static_cast<neolib::io_task&>(*this) },
+		async_event_queue{},
 		iProgramOptions{ argc, argv },
 		iLoader{ iProgramOptions, *this },
 		iName{ aName },
 		iQuitWhenLastWindowClosed{ true },
 		iInExec{ false },
+		iEventLoopMode{ neogfx::event_loop_mode::Polling },
 		iBasicServices{ aServiceFactory.create_basic_services(*this) },
 		iKeyboard{ aServiceFactory.create_keyboard() },
 		iClipboard{ new neogfx::clipboard(basic_services().system_clipboard()) },
@@ -104,7 +106,7 @@ namespace neogfx
 		iActionPaste{ add_action("Paste").set_shortcut("Ctrl+V") },
 		iActionDelete{ add_action("Delete").set_shortcut("Del") },
 		iActionSelectAll{ add_action("Select All").set_shortcut("Ctrl+A") },
-		iStandardActionManager{ *this, [this](neolib::callback_timer& aTimer)
+		iStandardActionManager{ *this, [this](callback_timer& aTimer)
 		{
 			aTimer.again();
 			if (clipboard().sink_active())
@@ -216,7 +218,7 @@ namespace neogfx
 			surface_manager().invalidate_surfaces();
 			iQuitWhenLastWindowClosed = aQuitWhenLastWindowClosed;
 			while (!iQuitResultCode.is_initialized())
-				process_events(*iContext);
+				process_events_or_wait(*iContext);
 			return *iQuitResultCode;
 		}
 		catch (std::exception& e)
@@ -458,7 +460,9 @@ namespace neogfx
 		{
 			bool hadStrongSurfaces = surface_manager().any_strong_surfaces();
 			didSome = pump_messages();
-			didSome = (do_io(neolib::yield_type::Sleep) || didSome);
+			didSome = (do_io(iEventLoopMode == neogfx::event_loop_mode::Blocking || async_event_queue::pending() ? neolib::yield_type::NoYield : neolib::yield_type::Sleep) || didSome);
+			didSome = (process_posted() || didSome);
+			didSome = (async_event_queue::exec() || didSome);
 			didSome = (do_process_events() || didSome);
 			if (!in_exec() && hadStrongSurfaces && !surface_manager().any_strong_surfaces())
 				throw main_window_closed_prematurely();
@@ -487,6 +491,38 @@ namespace neogfx
 		return didSome;
 	}
 
+	bool app::process_events_or_wait(i_event_processing_context& aContext)
+	{
+		bool didSome = process_events(aContext);
+		if (!didSome && iEventLoopMode == neogfx::event_loop_mode::Blocking)
+			wait_for_events();
+		return didSome;
+	}
+
+	neogfx::event_loop_mode app::event_loop_mode() const
+	{
+		return iEventLoopMode;
+	}
+
+	void app::set_event_loop_mode(neogfx::event_loop_mode aMode)
+	{
+		iEventLoopMode = aMode;
+	}
+
+	void app::post(const std::function<void()>& aCallback)
+	{
+		{
+			std::lock_guard<std::mutex> lg(iPostedMutex);
+			iPosted.push_back(aCallback);
+		}
+		wake();
+	}
+
+	void app::wake()
+	{
+		rendering_engine().wake();
+	}
+
 	bool app::do_process_events()
 	{
 		bool lastWindowClosed = false;
@@ -499,6 +535,52 @@ namespace neogfx
 		return didSome;
 	}
 
+	bool app::process_posted()
+	{
+		std::vector<std::function<void()>> posted;
+		{
+			std::lock_guard<std::mutex> lg(iPostedMutex);
+			posted.swap(iPosted);
+		}
+		for (auto& callback : posted)
+			callback();
+		return !posted.empty();
+	}
+
+	void app::wait_for_events()
+	{
+		if (iQuitResultCode.is_initialized() || async_event_queue::pending())
+			return;
+		{
+			std::lock_guard<std::mutex> lg(iPostedMutex);
+			if (!iPosted.empty())
+				return;
+		}
+		// With nothing due the wait only ends when woken (input, post() or wake()).
+		boost::optional<uint32_t> timeout;
+		auto nextTimerDeadline = callback_timer::next_deadline(*this);
+		if (nextTimerDeadline != boost::none)
+		{
+			// rounded up so that the timer is due when the wait ends
+			auto untilTimer = std::chrono::duration_cast<std::chrono::milliseconds>(*nextTimerDeadline - std::chrono::steady_clock::now()).count() + 1;
+			timeout = static_cast<uint32_t>(std::max<decltype(untilTimer)>(untilTimer, 1));
+		}
+		auto nextFrameTime = surface_manager().next_frame_time();
+		if (nextFrameTime != boost::none)
+		{
+			uint64_t now = program_elapsed_ms();
+			auto untilFrame = static_cast<uint32_t>(std::max(*nextFrameTime, now + 1) - now);
+			timeout = (timeout == boost::none ? untilFrame : std::min(*timeout, untilFrame));
+		}
+		if (rendering_engine().texture_manager().uploads_pending())
+		{
+			// staged uploads only progress when surfaces are rendered so come back for the next slice
+			uint32_t untilUpload = kStagedUploadInterval_ms;
+			timeout = (timeout == boost::none ? untilUpload : std::min(*timeout, untilUpload));
+		}
+		rendering_engine().wait_for_events(timeout);
+	}
+
 	bool app::key_pressed(scan_code_e aScanCode, key_code_e aKeyCode, key_modifiers_e aKeyModifiers)
 	{
 		if (aScanCode == ScanCode_LALT || aScanCode == ScanCode_RALT)
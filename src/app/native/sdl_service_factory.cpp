@@ -22,6 +22,7 @@
 #include "sdl_basic_services.hpp"
 #include "../../hid/native/sdl_keyboard.hpp"
 #include "../../gfx/native/sdl_renderer.hpp"
+#include "../../gfx/native/software_renderer.hpp"
 
 namespace neogfx
 {
@@ -38,6 +39,8 @@ namespace neogfx
 		}
 		virtual std::unique_ptr<i_rendering_engine> create_rendering_engine(renderer aRenderer, bool aDoubleBufferedWindows, i_basic_services& aBasicServices, i_keyboard& aKeyboard)
 		{
+			if (aRenderer == renderer::Software)
+				return std::make_unique<software_renderer>();
 			return std::make_unique<sdl_renderer>(aRenderer, aDoubleBufferedWindows, aBasicServices, aKeyboard);
 		}
 	};
@@ -18,11 +18,10 @@
 */
 
 #include <neogfx/neogfx.hpp>
-#include <sstream>
+#include <fstream>
 #include <boost/filesystem.hpp>
 #include <openssl/sha.h>
 #include <neolib/uri.hpp>
-#include <neolib/zip.hpp>
 #include <neogfx/app/resource.hpp>
 
 namespace neogfx
@@ -31,53 +30,12 @@ namespace neogfx
 		iManager{aManager}, iUri{aUri}, iSize{0}
 	{
 		neolib::uri uri{aUri};
-		if (uri.scheme() == "file")
-		{
-			if (uri.fragment().empty()) // individual asset file
-			{ 
-				iData.resize(static_cast<std::size_t>(boost::filesystem::file_size(uri.path())));
-				std::ifstream input(uri.path(), std::ios::binary | std::ios::in);
-				input.read(reinterpret_cast<char*>(data()), iData.size());
-				iSize = iData.size();
-			}
-			else // asset archive
-			{
-				neolib::zip archive{uri.path()};
-				for (std::size_t i = 0; i < archive.file_count(); ++i)
-				{
-					if (archive.file_path(i) == uri.fragment())
-					{
-						archive.extract_to(i, iData);
-						iSize = iData.size();
-					}
-				}
-			}
-		}
-		else if (uri.scheme().empty())
-		{
-			if (!uri.fragment().empty()) // asset archive
-			{
-				auto assetArchive = aManager.load_resource(":/" + uri.path());
-				neolib::zip archive{assetArchive->cdata(), assetArchive->size()};
-				for (std::size_t i = 0; i < archive.file_count(); ++i)
-				{
-					if (archive.file_path(i) == uri.fragment())
-					{
-						archive.extract_to(i, iData);
-						iSize = iData.size();
-					}
-					else
-					{
-						neolib::uri otherResource(uri);
-						otherResource.set_fragment(archive.file_path(i));
-						std::ostringstream oss;
-						oss << otherResource;
-						neolib::zip::buffer_type buffer;
-						archive.extract_to(i, buffer);
-						aManager.add_resource(oss.str(), &buffer[0], buffer.size());
-					}
-				}
-			}
+		if (uri.scheme() == "file" && uri.fragment().empty()) // individual asset file; archive entries are loaded via resource_manager
+		{ 
+			iData.resize(static_cast<std::size_t>(boost::filesystem::file_size(uri.path())));
+			std::ifstream input(uri.path(), std::ios::binary | std::ios::in);
+			input.read(reinterpret_cast<char*>(data()), iData.size());
+			iSize = iData.size();
 		}
 	}
 
@@ -86,6 +44,11 @@ namespace neogfx
 	{
 	}
 
+	resource::resource(i_resource_manager& aManager, const std::string& aUri, data_type&& aData) :
+		iManager{aManager}, iUri{aUri}, iSize{aData.size()}, iData{std::move(aData)}
+	{
+	}
+
 	resource::~resource()
 	{
 		iManager.cleanup();
@@ -0,0 +1,220 @@
+// resource_archive.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <algorithm>
+#include <zlib.h>
+#include <neogfx/app/resource_archive.hpp>
+
+namespace neogfx
+{
+	namespace
+	{
+		const uint32_t kEndOfCentralDirectorySignature = 0x06054b50u;
+		const uint32_t kCentralDirectoryHeaderSignature = 0x02014b50u;
+		const uint32_t kLocalFileHeaderSignature = 0x04034b50u;
+		const std::size_t kEndOfCentralDirectorySize = 22u;
+		const std::size_t kCentralDirectoryHeaderSize = 46u;
+		const std::size_t kLocalFileHeaderSize = 30u;
+		const std::size_t kMaxCommentSize = 0xFFFFu;
+		const uint16_t kFlagEncrypted = 0x0001u;
+
+		inline uint16_t read_u16(const uint8_t* aData)
+		{
+			return static_cast<uint16_t>(aData[0] | (aData[1] << 8));
+		}
+
+		inline uint32_t read_u32(const uint8_t* aData)
+		{
+			return static_cast<uint32_t>(aData[0]) | (static_cast<uint32_t>(aData[1]) << 8) | (static_cast<uint32_t>(aData[2]) << 16) | (static_cast<uint32_t>(aData[3]) << 24);
+		}
+	}
+
+	resource_archive::resource_archive(const std::string& aFilePath) :
+		iData{ nullptr }, iSize{ 0 }
+	{
+		try
+		{
+			iFile.open(aFilePath);
+		}
+		catch (const std::exception&)
+		{
+			throw failed_to_open_archive();
+		}
+		iData = reinterpret_cast<const uint8_t*>(iFile.data());
+		iSize = iFile.size();
+		index();
+	}
+
+	resource_archive::resource_archive(i_resource::pointer aArchiveResource) :
+		iResource{ aArchiveResource }, iData{ nullptr }, iSize{ 0 }
+	{
+		if (!iResource->available())
+			throw failed_to_open_archive();
+		iData = static_cast<const uint8_t*>(iResource->cdata());
+		iSize = iResource->size();
+		index();
+	}
+
+	std::size_t resource_archive::file_count() const
+	{
+		return iEntries.size();
+	}
+
+	const std::string& resource_archive::file_path(std::size_t aIndex) const
+	{
+		return iEntries[aIndex].path;
+	}
+
+	bool resource_archive::contains(const std::string& aFilePath) const
+	{
+		return iIndex.find(aFilePath) != iIndex.end();
+	}
+
+	std::size_t resource_archive::index_of(const std::string& aFilePath) const
+	{
+		auto existing = iIndex.find(aFilePath);
+		if (existing == iIndex.end())
+			throw entry_not_found();
+		return existing->second;
+	}
+
+	std::size_t resource_archive::file_size(std::size_t aIndex) const
+	{
+		return iEntries[aIndex].uncompressedSize;
+	}
+
+	bool resource_archive::is_stored(std::size_t aIndex) const
+	{
+		return iEntries[aIndex].method == kMethodStored;
+	}
+
+	const void* resource_archive::stored_data(std::size_t aIndex) const
+	{
+		if (!is_stored(aIndex))
+			throw unsupported_entry();
+		return entry_data(iEntries[aIndex]);
+	}
+
+	void resource_archive::extract_to(std::size_t aIndex, i_resource::data_type& aBuffer) const
+	{
+		const entry& e = iEntries[aIndex];
+		aBuffer.resize(e.uncompressedSize);
+		if (!aBuffer.empty())
+			extract_to(e, &aBuffer[0]);
+	}
+
+	std::string resource_archive::extract_to_string(std::size_t aIndex) const
+	{
+		const entry& e = iEntries[aIndex];
+		std::string result(e.uncompressedSize, '\0');
+		if (!result.empty())
+			extract_to(e, reinterpret_cast<uint8_t*>(&result[0]));
+		return result;
+	}
+
+	void resource_archive::index()
+	{
+		if (iSize < kEndOfCentralDirectorySize)
+			throw bad_archive();
+		const uint8_t* endOfCentralDirectory = nullptr;
+		std::size_t searchLimit = std::min(iSize, kEndOfCentralDirectorySize + kMaxCommentSize);
+		for (std::size_t back = kEndOfCentralDirectorySize; back <= searchLimit; ++back)
+		{
+			const uint8_t* candidate = iData + iSize - back;
+			if (read_u32(candidate) == kEndOfCentralDirectorySignature)
+			{
+				endOfCentralDirectory = candidate;
+				break;
+			}
+		}
+		if (endOfCentralDirectory == nullptr)
+			throw bad_archive();
+		uint16_t entryCount = read_u16(endOfCentralDirectory + 10);
+		uint32_t directorySize = read_u32(endOfCentralDirectory + 12);
+		uint32_t directoryOffset = read_u32(endOfCentralDirectory + 16);
+		if (static_cast<std::size_t>(directoryOffset) + directorySize > iSize)
+			throw bad_archive();
+		iEntries.reserve(entryCount);
+		const uint8_t* next = iData + directoryOffset;
+		const uint8_t* end = next + directorySize;
+		for (uint16_t i = 0; i < entryCount; ++i)
+		{
+			if (static_cast<std::size_t>(end - next) < kCentralDirectoryHeaderSize || read_u32(next) != kCentralDirectoryHeaderSignature)
+				throw bad_archive();
+			uint16_t flags = read_u16(next + 8);
+			uint16_t nameLength = read_u16(next + 28);
+			std::size_t headerLength = kCentralDirectoryHeaderSize + nameLength + read_u16(next + 30) + read_u16(next + 32);
+			if (static_cast<std::size_t>(end - next) < headerLength)
+				throw bad_archive();
+			std::string path{ reinterpret_cast<const char*>(next + kCentralDirectoryHeaderSize), nameLength };
+			if (!path.empty() && path.back() != '/' && (flags & kFlagEncrypted) == 0)
+			{
+				entry newEntry{ path, read_u16(next + 10), read_u32(next + 20), read_u32(next + 24), read_u32(next + 42) };
+				// stored data is handed out directly (stored_data()) sized by uncompressedSize but is bounds checked by compressedSize
+				if (newEntry.method == kMethodStored && newEntry.compressedSize != newEntry.uncompressedSize)
+					throw bad_archive();
+				iIndex[path] = iEntries.size();
+				iEntries.push_back(newEntry);
+			}
+			next += headerLength;
+		}
+	}
+
+	const uint8_t* resource_archive::entry_data(const entry& aEntry) const
+	{
+		if (static_cast<std::size_t>(aEntry.localHeaderOffset) + kLocalFileHeaderSize > iSize)
+			throw bad_archive();
+		const uint8_t* localHeader = iData + aEntry.localHeaderOffset;
+		if (read_u32(localHeader) != kLocalFileHeaderSignature)
+			throw bad_archive();
+		std::size_t dataOffset = aEntry.localHeaderOffset + kLocalFileHeaderSize + read_u16(localHeader + 26) + read_u16(localHeader + 28);
+		if (dataOffset + aEntry.compressedSize > iSize)
+			throw bad_archive();
+		return iData + dataOffset;
+	}
+
+	void resource_archive::extract_to(const entry& aEntry, uint8_t* aDestination) const
+	{
+		const uint8_t* source = entry_data(aEntry);
+		switch (aEntry.method)
+		{
+		case kMethodStored:
+			std::copy(source, source + aEntry.uncompressedSize, aDestination);
+			break;
+		case kMethodDeflated:
+			{
+				z_stream stream = {};
+				stream.next_in = const_cast<Bytef*>(source);
+				stream.avail_in = aEntry.compressedSize;
+				stream.next_out = aDestination;
+				stream.avail_out = aEntry.uncompressedSize;
+				if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+					throw decompression_failure();
+				int result = inflate(&stream, Z_FINISH);
+				inflateEnd(&stream);
+				if (result != Z_STREAM_END || stream.total_out != aEntry.uncompressedSize)
+					throw decompression_failure();
+			}
+			break;
+		default:
+			throw unsupported_entry();
+		}
+	}
+}
\ No newline at end of file
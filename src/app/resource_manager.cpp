@@ -18,12 +18,28 @@
 */
 
 #include <neogfx/neogfx.hpp>
+#include <neolib/uri.hpp>
 #include <neogfx/app/resource_manager.hpp>
 #include <neogfx/app/module_resource.hpp>
 #include <neogfx/app/resource.hpp>
 
 namespace neogfx
 {	
+	namespace
+	{
+		// An uncompressed archive entry referenced in place; keeps its archive (and so the mapping) alive.
+		class archive_entry_resource : public module_resource
+		{
+		public:
+			archive_entry_resource(const std::string& aUri, resource_archive::pointer aArchive, std::size_t aIndex) :
+				module_resource{ aUri, aArchive->stored_data(aIndex), aArchive->file_size(aIndex) }, iArchive{ aArchive }
+			{
+			}
+		private:
+			resource_archive::pointer iArchive;
+		};
+	}
+
 	resource_manager::resource_manager()
 	{
 	}
@@ -55,11 +71,46 @@ namespace neogfx
 			if (!ptr.expired())
 				return ptr.lock();
 		}
-		i_resource::pointer newResource = std::make_shared<resource>(*this, aUri);
+		i_resource::pointer newResource;
+		neolib::uri uri{ aUri };
+		if (!uri.fragment().empty() && (uri.scheme() == "file" || uri.scheme().empty()))
+		{
+			auto archive = load_archive(aUri);
+			if (!archive->contains(uri.fragment()))
+				newResource = std::make_shared<resource>(*this, aUri, nullptr, 0);
+			else
+			{
+				auto index = archive->index_of(uri.fragment());
+				if (archive->is_stored(index))
+					newResource = std::make_shared<archive_entry_resource>(aUri, archive, index);
+				else
+				{
+					i_resource::data_type data;
+					archive->extract_to(index, data);
+					newResource = std::make_shared<resource>(*this, aUri, std::move(data));
+				}
+			}
+		}
+		else
+			newResource = std::make_shared<resource>(*this, aUri);
 		iResources[aUri] = i_resource::weak_pointer(newResource);
 		return newResource;
 	}
 
+	resource_archive::pointer resource_manager::load_archive(const std::string& aUri)
+	{
+		neolib::uri uri{ aUri };
+		std::string key = (uri.scheme() == "file" ? uri.path() : ":/" + uri.path());
+		auto existing = iResourceArchives.find(key);
+		if (existing != iResourceArchives.end())
+			return existing->second;
+		resource_archive::pointer newArchive = (uri.scheme() == "file" ?
+			std::make_shared<resource_archive>(uri.path()) :
+			std::make_shared<resource_archive>(load_resource(key)));
+		iResourceArchives[key] = newArchive;
+		return newArchive;
+	}
+
 	void resource_manager::cleanup()
 	{
 		for (auto i = iResources.begin(); i != iResources.end();)
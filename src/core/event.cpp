@@ -24,17 +24,8 @@
 
 namespace neogfx
 { 
-	async_event_queue::async_event_queue(neolib::io_task& aIoTask) : iTimer{ aIoTask,
-		[this](neolib::callback_timer& aTimer)
-	{
-		event_list events;
-		events.swap(iEvents);
-		for (auto& e : events)
-			if (!e.second.second)
-				e.second.first();
-		if (!iEvents.empty() && !aTimer.waiting())
-			aTimer.again();
-	}, 10, false }
+	async_event_queue::async_event_queue() :
+		iExecuting(false)
 	{
 		if (sInstance != nullptr)
 			throw instance_exists();
@@ -55,23 +46,45 @@ namespace neogfx
 		throw no_instance();
 	}
 
+	bool async_event_queue::pending() const
+	{
+		return !iEvents.empty();
+	}
+
+	bool async_event_queue::exec()
+	{
+		if (iEvents.empty())
+			return false;
+		// Events are processed from a second list (whose capacity is kept between calls) so that handlers can queue further
+		// events; a nested exec() (e.g. from a modal event loop) processes from a list of its own.
+		event_list nestedEvents;
+		event_list& events = (iExecuting ? nestedEvents : iProcessing);
+		bool wasExecuting = iExecuting;
+		iExecuting = true;
+		events.swap(iEvents);
+		for (auto& e : events)
+			if (!e.destroyed)
+				e.handler();
+		events.clear();
+		iExecuting = wasExecuting;
+		return true;
+	}
+
 	void async_event_queue::add(const void* aEvent, callback aCallback, neolib::destroyable::destroyed_flag aDestroyedFlag)
 	{
-		iEvents.emplace(aEvent, std::make_pair(aCallback, aDestroyedFlag));
-		if (!iTimer.waiting())
-			iTimer.again();
+		iEvents.push_back(queued_event{ aEvent, aCallback, aDestroyedFlag });
 	}
 
 	void async_event_queue::remove(const void* aEvent)
 	{
-		auto events = iEvents.equal_range(aEvent);
-		if (events.first == events.second)
+		auto events = std::remove_if(iEvents.begin(), iEvents.end(), [aEvent](const queued_event& aQueuedEvent) { return aQueuedEvent.source == aEvent; });
+		if (events == iEvents.end())
 			throw event_not_found();
-		iEvents.erase(events.first, events.second);
+		iEvents.erase(events, iEvents.end());
 	}
 
 	bool async_event_queue::has(const void* aEvent) const
 	{
-		return iEvents.find(aEvent) != iEvents.end();
+		return std::find_if(iEvents.begin(), iEvents.end(), [aEvent](const queued_event& aQueuedEvent) { return aQueuedEvent.source == aEvent; }) != iEvents.end();
 	}
 }
\ No newline at end of file
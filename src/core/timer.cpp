@@ -0,0 +1,113 @@
+// timer.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <neogfx/core/timer.hpp>
+
+namespace neogfx
+{
+	namespace
+	{
+		std::mutex& timers_mutex()
+		{
+			static std::mutex sMutex;
+			return sMutex;
+		}
+
+		std::vector<const callback_timer*>& timers()
+		{
+			static std::vector<const callback_timer*> sTimers;
+			return sTimers;
+		}
+	}
+
+	callback_timer::callback_timer(neolib::io_task& aIoTask, callback aCallback, uint32_t aDuration_ms, bool aInitialWait) :
+		iIoTask(aIoTask),
+		iCallback(aCallback),
+		iDuration_ms(aDuration_ms),
+		iTimer(aIoTask, [this](neolib::callback_timer&) { expired(); }, aDuration_ms, aInitialWait)
+	{
+		if (aInitialWait)
+			iDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(iDuration_ms);
+		std::lock_guard<std::mutex> lg(timers_mutex());
+		timers().push_back(this);
+	}
+
+	callback_timer::~callback_timer()
+	{
+		std::lock_guard<std::mutex> lg(timers_mutex());
+		timers().erase(std::find(timers().begin(), timers().end(), this));
+	}
+
+	boost::optional<callback_timer::time_point> callback_timer::next_deadline(const neolib::io_task& aIoTask)
+	{
+		boost::optional<time_point> result;
+		std::lock_guard<std::mutex> lg(timers_mutex());
+		for (auto t : timers())
+			if (&t->iIoTask == &aIoTask && t->iDeadline != boost::none && (result == boost::none || *t->iDeadline < *result))
+				result = t->iDeadline;
+		return result;
+	}
+
+	bool callback_timer::waiting() const
+	{
+		return iDeadline != boost::none;
+	}
+
+	uint32_t callback_timer::duration() const
+	{
+		return iDuration_ms;
+	}
+
+	void callback_timer::set_duration(uint32_t aDuration_ms, bool aEffectiveImmediately)
+	{
+		iTimer.set_duration(aDuration_ms, aEffectiveImmediately);
+		iDuration_ms = aDuration_ms;
+		if (aEffectiveImmediately && waiting())
+			iDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(iDuration_ms);
+	}
+
+	void callback_timer::again()
+	{
+		iTimer.again();
+		iDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(iDuration_ms);
+	}
+
+	void callback_timer::again_if()
+	{
+		if (!waiting())
+			again();
+	}
+
+	void callback_timer::cancel()
+	{
+		iTimer.cancel();
+		iDeadline = boost::none;
+	}
+
+	void callback_timer::expired()
+	{
+		// the callback may destroy the timer so nothing is touched after it
+		iDeadline = boost::none;
+		iCallback(*this);
+	}
+}
\ No newline at end of file
@@ -30,6 +30,7 @@ namespace neogfx
 
 	physical_object::physical_object(const physical_object& aOther) :
 		iOrigin(aOther.iOrigin),
+		iBounds(aOther.iBounds),
 		iTimeOfLastUpdate(aOther.iTimeOfLastUpdate),
 		iCurrentPhysics(aOther.iCurrentPhysics),
 		iNextPhysics(aOther.iNextPhysics)
@@ -126,16 +127,33 @@ namespace neogfx
 		current_physics().iMass = aMass;
 	}
 
+	const physical_object::aabb_type& physical_object::bounds() const
+	{
+		return iBounds;
+	}
+
+	void physical_object::set_bounds(const aabb_type& aBounds)
+	{
+		iBounds = aBounds;
+	}
+
 	const physical_object::aabb_type& physical_object::aabb() const
 	{
+		iAxisAlignedBoundingBox.min = position() + iBounds.min;
+		iAxisAlignedBoundingBox.max = position() + iBounds.max;
 		return iAxisAlignedBoundingBox;
 	}
 
 	bool physical_object::collided(const i_physical_object& aOther) const
 	{
-		/* todo */
-		(void)aOther;
-		return false;
+		if (&aOther == this)
+			return false;
+		const aabb_type& ours = aabb();
+		const aabb_type& theirs = aOther.aabb();
+		for (uint32_t i = 0; i < 3; ++i)
+			if (ours.max[i] < theirs.min[i] || theirs.max[i] < ours.min[i])
+				return false;
+		return true;
 	}
 
 	bool physical_object::update(const optional_time_point& aNow, const vec3& aForce)
@@ -28,12 +28,15 @@ namespace neogfx
 {
 	sprite_plane::sprite_plane() : 
 		iEnableZSorting(false),
-		iG(6.67408e-11)
+		iEnableCollisionDetection(false),
+		iG(6.67408e-11),
+		iEnableBarnesHut(false),
+		iBarnesHutTheta(0.5)
 	{
 	}
 
 	sprite_plane::sprite_plane(i_widget& aParent) :
-		widget(aParent), iEnableZSorting(false), iG(6.67408e-11)
+		widget(aParent), iEnableZSorting(false), iEnableCollisionDetection(false), iG(6.67408e-11), iEnableBarnesHut(false), iBarnesHutTheta(0.5)
 	{
 		iSink = surface().native_surface().rendering_check([this]()
 		{
@@ -43,7 +46,7 @@ namespace neogfx
 	}
 
 	sprite_plane::sprite_plane(i_layout& aLayout) :
-		widget(aLayout), iEnableZSorting(false), iG(6.67408e-11)
+		widget(aLayout), iEnableZSorting(false), iEnableCollisionDetection(false), iG(6.67408e-11), iEnableBarnesHut(false), iBarnesHutTheta(0.5)
 	{
 		iSink = surface().native_surface().rendering_check([this]()
 		{
@@ -174,6 +177,18 @@ namespace neogfx
 		iEnableZSorting = aEnableZSorting;
 	}
 
+	void sprite_plane::enable_collision_detection(bool aEnableCollisionDetection)
+	{
+		iEnableCollisionDetection = aEnableCollisionDetection;
+		if (!iEnableCollisionDetection)
+			iCollisions.clear();
+	}
+
+	const sprite_plane::collision_list& sprite_plane::collisions() const
+	{
+		return iCollisions;
+	}
+
 	void sprite_plane::add_shape(i_shape& aShape)
 	{
 		iShapes.push_back(std::shared_ptr<i_shape>(std::shared_ptr<i_shape>(), &aShape));
@@ -235,6 +250,21 @@ namespace neogfx
 		iUniformGravity = aUniformGravity;
 	}
 
+	void sprite_plane::enable_barnes_hut(bool aEnableBarnesHut)
+	{
+		iEnableBarnesHut = aEnableBarnesHut;
+	}
+
+	scalar sprite_plane::barnes_hut_theta() const
+	{
+		return iBarnesHutTheta;
+	}
+
+	void sprite_plane::set_barnes_hut_theta(scalar aTheta)
+	{
+		iBarnesHutTheta = aTheta;
+	}
+
 	void sprite_plane::add_object(i_physical_object& aObject)
 	{
 		iObjects.push_back(std::shared_ptr<i_physical_object>(std::shared_ptr<i_physical_object>(), &aObject));
@@ -308,13 +338,24 @@ namespace neogfx
 		iUpdateBuffer.reserve(iSprites.size() + iObjects.size());
 		iUpdateBuffer.clear();
 		for (const auto& s : iSprites)
+		{
+			if (iEnableCollisionDetection)
+			{
+				rect boundingBox = s->bounding_box();
+				s->physics().set_bounds(i_physical_object::aabb_type{ vec3{ boundingBox.x, boundingBox.y, 0.0 }, vec3{ boundingBox.right(), boundingBox.bottom(), 0.0 } });
+			}
 			iUpdateBuffer.push_back(&s->physics());
+		}
 		for (const auto& s : iObjects)
 			iUpdateBuffer.push_back(&*s);
-		std::stable_sort(iUpdateBuffer.begin(), iUpdateBuffer.end(), [](i_physical_object* left, i_physical_object* right) ->bool
-		{
-			return left->mass() > right->mass();
-		});
+		bool barnesHut = (iEnableBarnesHut && iUniformGravity == boost::none && iG != 0.0);
+		if (barnesHut)
+			build_mass_tree();
+		else
+			std::stable_sort(iUpdateBuffer.begin(), iUpdateBuffer.end(), [](i_physical_object* left, i_physical_object* right) ->bool
+			{
+				return left->mass() > right->mass();
+			});
 		for (auto& o2 : iUpdateBuffer)
 		{
 			vec3 totalForce;
@@ -322,6 +363,8 @@ namespace neogfx
 				continue;
 			if (iUniformGravity != boost::none)
 				totalForce = *iUniformGravity * o2->mass();
+			else if (barnesHut)
+				totalForce = mass_tree_force(*o2);
 			else if (iG != 0.0)
 			{
 				for (auto& o1 : iUpdateBuffer)
@@ -341,7 +384,201 @@ namespace neogfx
 			}
 			updated = (o2->update(now, totalForce) || updated);
 		}
+		if (iEnableCollisionDetection)
+		{
+			detect_collisions();
+			for (std::size_t i = 0; i < iCollisions.size(); ++i)
+				objects_collided.trigger(*iCollisions[i].first, *iCollisions[i].second);
+		}
 		physics_applied.trigger();
 		return updated;
 	}
+
+	void sprite_plane::detect_collisions()
+	{
+		// Broad phase: sweep and prune along the axis with the greatest spread of AABB centres; candidate pairs are then
+		// confirmed by i_physical_object::collided().
+		iCollisions.clear();
+		iBroadPhaseBuffer.clear();
+		vec3 sum;
+		vec3 sumOfSquares;
+		for (auto o : iUpdateBuffer)
+		{
+			const auto& box = o->aabb();
+			iBroadPhaseBuffer.push_back(broad_phase_entry{ o, box.min, box.max });
+			vec3 centre = (box.min + box.max) / 2.0;
+			sum += centre;
+			sumOfSquares += centre * centre;
+		}
+		if (iBroadPhaseBuffer.size() < 2)
+			return;
+		uint32_t axis = 0;
+		scalar greatestVariance = -1.0;
+		for (uint32_t a = 0; a < 3; ++a)
+		{
+			scalar mean = sum[a] / iBroadPhaseBuffer.size();
+			scalar variance = sumOfSquares[a] / iBroadPhaseBuffer.size() - mean * mean;
+			if (variance > greatestVariance)
+			{
+				axis = a;
+				greatestVariance = variance;
+			}
+		}
+		uint32_t otherAxis1 = (axis + 1) % 3;
+		uint32_t otherAxis2 = (axis + 2) % 3;
+		std::sort(iBroadPhaseBuffer.begin(), iBroadPhaseBuffer.end(), [axis](const broad_phase_entry& aLeft, const broad_phase_entry& aRight)
+		{
+			return aLeft.min[axis] < aRight.min[axis];
+		});
+		iBroadPhaseActive.clear();
+		for (std::size_t i = 0; i < iBroadPhaseBuffer.size(); ++i)
+		{
+			const auto& entry = iBroadPhaseBuffer[i];
+			std::size_t stillActive = 0;
+			for (std::size_t j = 0; j < iBroadPhaseActive.size(); ++j)
+			{
+				const auto& other = iBroadPhaseBuffer[iBroadPhaseActive[j]];
+				if (other.max[axis] < entry.min[axis])
+					continue;
+				iBroadPhaseActive[stillActive++] = iBroadPhaseActive[j];
+				if (other.max[otherAxis1] < entry.min[otherAxis1] || entry.max[otherAxis1] < other.min[otherAxis1] ||
+					other.max[otherAxis2] < entry.min[otherAxis2] || entry.max[otherAxis2] < other.min[otherAxis2])
+					continue;
+				if (other.object->collided(*entry.object))
+					iCollisions.emplace_back(other.object, entry.object);
+			}
+			iBroadPhaseActive.resize(stillActive);
+			iBroadPhaseActive.push_back(i);
+		}
+	}
+
+	void sprite_plane::build_mass_tree()
+	{
+		// Barnes-Hut octree over a snapshot of the positions and masses of all objects with mass.
+		iMassBodies.clear();
+		iMassTree.clear();
+		for (auto o : iUpdateBuffer)
+			if (o->mass() != 0.0)
+				iMassBodies.push_back(mass_body{ o, o->position(), o->mass(), kNoMassTreeIndex });
+		if (iMassBodies.empty())
+			return;
+		vec3 minimum = iMassBodies[0].position;
+		vec3 maximum = minimum;
+		for (const auto& body : iMassBodies)
+			for (uint32_t a = 0; a < 3; ++a)
+			{
+				minimum[a] = std::min(minimum[a], body.position[a]);
+				maximum[a] = std::max(maximum[a], body.position[a]);
+			}
+		scalar halfSize = 0.0;
+		for (uint32_t a = 0; a < 3; ++a)
+			halfSize = std::max(halfSize, (maximum[a] - minimum[a]) / 2.0);
+		iMassTree.push_back(mass_node{ (minimum + maximum) / 2.0, halfSize * 1.001 + 1.0e-9, vec3{}, 0.0, kNoMassTreeIndex, kNoMassTreeIndex });
+		auto octant = [](const mass_node& aNode, const vec3& aPosition) -> uint32_t
+		{
+			return (aPosition[0] >= aNode.centre[0] ? 1 : 0) | (aPosition[1] >= aNode.centre[1] ? 2 : 0) | (aPosition[2] >= aNode.centre[2] ? 4 : 0);
+		};
+		for (uint32_t b = 0; b < static_cast<uint32_t>(iMassBodies.size()); ++b)
+		{
+			uint32_t node = 0;
+			for (uint32_t depth = 0;; ++depth)
+			{
+				if (iMassTree[node].firstChild != kNoMassTreeIndex)
+				{
+					node = iMassTree[node].firstChild + octant(iMassTree[node], iMassBodies[b].position);
+					continue;
+				}
+				if (iMassTree[node].firstBody == kNoMassTreeIndex || depth >= kMaxMassTreeDepth)
+				{
+					iMassBodies[b].next = iMassTree[node].firstBody;
+					iMassTree[node].firstBody = b;
+					break;
+				}
+				// occupied leaf: split it, move its (single) body down a level and carry on descending
+				uint32_t firstChild = static_cast<uint32_t>(iMassTree.size());
+				vec3 centre = iMassTree[node].centre;
+				scalar childHalfSize = iMassTree[node].halfSize / 2.0;
+				for (uint32_t c = 0; c < 8; ++c)
+				{
+					vec3 childCentre = centre;
+					for (uint32_t a = 0; a < 3; ++a)
+						childCentre[a] += ((c >> a) & 1) ? childHalfSize : -childHalfSize;
+					iMassTree.push_back(mass_node{ childCentre, childHalfSize, vec3{}, 0.0, kNoMassTreeIndex, kNoMassTreeIndex });
+				}
+				uint32_t existing = iMassTree[node].firstBody;
+				iMassTree[node].firstBody = kNoMassTreeIndex;
+				iMassTree[node].firstChild = firstChild;
+				iMassTree[firstChild + octant(iMassTree[node], iMassBodies[existing].position)].firstBody = existing;
+				node = firstChild + octant(iMassTree[node], iMassBodies[b].position);
+			}
+		}
+		// children always follow their parent so a reverse pass accumulates mass bottom up
+		for (auto n = iMassTree.size(); n-- > 0;)
+		{
+			auto& node = iMassTree[n];
+			vec3 weightedPosition;
+			scalar mass = 0.0;
+			if (node.firstChild != kNoMassTreeIndex)
+			{
+				for (uint32_t c = 0; c < 8; ++c)
+				{
+					const auto& child = iMassTree[node.firstChild + c];
+					mass += child.mass;
+					weightedPosition += child.centreOfMass * child.mass;
+				}
+			}
+			else
+			{
+				for (auto b = node.firstBody; b != kNoMassTreeIndex; b = iMassBodies[b].next)
+				{
+					mass += iMassBodies[b].mass;
+					weightedPosition += iMassBodies[b].position * iMassBodies[b].mass;
+				}
+			}
+			node.mass = mass;
+			node.centreOfMass = (mass != 0.0 ? weightedPosition / mass : node.centre);
+		}
+	}
+
+	vec3 sprite_plane::mass_tree_force(const i_physical_object& aObject) const
+	{
+		vec3 totalForce;
+		if (iMassTree.empty())
+			return totalForce;
+		const vec3& position = aObject.position();
+		scalar mass = aObject.mass();
+		iMassTreeStack.clear();
+		iMassTreeStack.push_back(0);
+		while (!iMassTreeStack.empty())
+		{
+			const auto& node = iMassTree[iMassTreeStack.back()];
+			iMassTreeStack.pop_back();
+			if (node.mass == 0.0)
+				continue;
+			if (node.firstChild == kNoMassTreeIndex)
+			{
+				for (auto b = node.firstBody; b != kNoMassTreeIndex; b = iMassBodies[b].next)
+				{
+					const auto& body = iMassBodies[b];
+					if (body.object == &aObject || body.object->collided(aObject))
+						continue;
+					vec3 r12 = position - body.position;
+					if (r12.magnitude() > 0.0)
+						totalForce += -iG * body.mass * mass * r12 / std::pow(r12.magnitude(), 3.0);
+				}
+				continue;
+			}
+			bool contains = true;
+			for (uint32_t a = 0; a < 3 && contains; ++a)
+				contains = (std::abs(position[a] - node.centre[a]) <= node.halfSize);
+			vec3 r12 = position - node.centreOfMass;
+			scalar distance = r12.magnitude();
+			if (!contains && distance > 0.0 && node.halfSize * 2.0 < iBarnesHutTheta * distance)
+				totalForce += -iG * node.mass * mass * r12 / std::pow(distance, 3.0);
+			else
+				for (uint32_t c = 0; c < 8; ++c)
+					iMassTreeStack.push_back(node.firstChild + c);
+		}
+		return totalForce;
+	}
 }
\ No newline at end of file
@@ -8,48 +8,17 @@ uniform int nGradientStartFrom;
 uniform float radGradientAngle;
 uniform int nGradientSize;
 uniform int nGradientShape;
-uniform int nStopCount;
 uniform vec2 posGradientCentre;
-uniform int nFilterSize;
-uniform sampler2DRect texStopPositions;
-uniform sampler2DRect texStopColours;
-uniform sampler2DRect texFilter;
+uniform int nLookupTableSize;
+uniform int nLookupTableRow;
+uniform sampler2DRect texLookupTable;
 in vec4 Color;
 out vec4 FragColor;
 
 vec4 gradient_colour(in float n)
 {
-	int l = 0;
-	int r = nStopCount - 1;
-	int found = -1;
-	float pos = 0.0;
-	if (n < 0.0)
-		n = 0.0;
-	if (n > 1.0)
-		n = 1.0;
-	while(found == -1)
-	{
-		int m = (l + r) / 2;
-		pos = texelFetch(texStopPositions, ivec2(m, 0)).r;
-		if (l > r)
-			found = r;
-		else
-		{
-			if (pos < n)
-				l = m + 1;
-			else if (pos > n)
-				r = m - 1;
-			else
-				found = m;
-		}
-	}
-	if (pos >= n && found != 0)
-		--found;
-	float firstPos = texelFetch(texStopPositions, ivec2(found, 0)).r;
-	float secondPos = texelFetch(texStopPositions, ivec2(found + 1, 0)).r;
-	vec4 firstColour = texelFetch(texStopColours, ivec2(found, 0));
-	vec4 secondColour = texelFetch(texStopColours, ivec2(found + 1, 0));
-	return mix(firstColour, secondColour, (n - firstPos) / (secondPos - firstPos));
+	n = clamp(n, 0.0, 1.0);
+	return texture(texLookupTable, vec2(0.5 + n * float(nLookupTableSize - 1), float(nLookupTableRow) + 0.5));
 }
 
 float ellipse_radius(float cx, float cy, float angle)
@@ -166,38 +135,9 @@ vec4 colour_at(vec2 viewPos)
 	return gradient_colour(gradientPos);
 }
 
-int to_1d(int x, int y, int width)
-{
-	if (x < 0)
-		x = 0;
-	if (x > width - 1)
-		x = width - 1;
-	if (y < 0)
-		y = 0;
-	if (y > width - 1)
-		y = width - 1;
-	return x + (y * width);
-}
-
 void main()
 {
 	vec2 viewPos = gl_FragCoord.xy;
 	viewPos.y = posViewportTop - viewPos.y;
-	int d = nFilterSize / 2;
-	if (texelFetch(texFilter, ivec2(d, d)).r == 1.0)
-	{
-		FragColor = colour_at(viewPos);
-	}
-	else
-	{
-		vec4 sum;
-		for (int fy = -d; fy <= d; ++fy)
-		{
-			for (int fx = -d; fx <= d; ++fx)
-			{
-				sum += (colour_at(viewPos + vec2(fx, fy)) * texelFetch(texFilter, ivec2(fx + d, fy + d)).r);
-			}
-		}
-		FragColor = sum;
-	}
+	FragColor = colour_at(viewPos);
 }
\ No newline at end of file
@@ -55,6 +55,7 @@ namespace neogfx
 		typedef std::vector<cluster> cluster_map_t;
 		mutable cluster_map_t iClusterMap;
 		mutable std::vector<character_type> iTextDirections;
+		mutable std::vector<text_category> iTextCategories;
 		mutable std::u32string iCodePointsBuffer;
 		typedef std::tuple<const char32_t*, const char32_t*, text_direction, bool, hb_script_t> glyph_run;
 		typedef std::vector<glyph_run> run_list;
@@ -721,7 +722,14 @@ namespace neogfx
 
 	glyph_text graphics_context::to_glyph_text(string::const_iterator aTextBegin, string::const_iterator aTextEnd, const font& aFont) const
 	{
-		return to_glyph_text(aTextBegin, aTextEnd, [&aFont](std::string::size_type) { return aFont; });
+		if (password())
+			return to_glyph_text(aTextBegin, aTextEnd, [&aFont](std::string::size_type) { return aFont; });
+		auto& cache = surface().rendering_engine().font_manager().shaped_text_cache();
+		auto key = shaped_text_cache::make_key(std::string(aTextBegin, aTextEnd), aFont, is_subpixel_rendering_on(), iMnemonic);
+		auto existing = cache.find(key);
+		if (existing != nullptr)
+			return *existing;
+		return cache.insert(key, to_glyph_text(aTextBegin, aTextEnd, [&aFont](std::string::size_type) { return aFont; }));
 	}
 
 	glyph_text graphics_context::to_glyph_text(string::const_iterator aTextBegin, string::const_iterator aTextEnd, std::function<font(std::string::size_type)> aFontSelector) const
@@ -736,7 +744,14 @@ namespace neogfx
 
 	glyph_text graphics_context::to_glyph_text(std::u32string::const_iterator aTextBegin, std::u32string::const_iterator aTextEnd, const font& aFont) const
 	{
-		return to_glyph_text(aTextBegin, aTextEnd, [&aFont](std::u32string::size_type) { return aFont; });
+		if (password())
+			return to_glyph_text(aTextBegin, aTextEnd, [&aFont](std::u32string::size_type) { return aFont; });
+		auto& cache = surface().rendering_engine().font_manager().shaped_text_cache();
+		auto key = shaped_text_cache::make_key(std::u32string(aTextBegin, aTextEnd), aFont, is_subpixel_rendering_on(), iMnemonic);
+		auto existing = cache.find(key);
+		if (existing != nullptr)
+			return *existing;
+		return cache.insert(key, to_glyph_text(aTextBegin, aTextEnd, [&aFont](std::u32string::size_type) { return aFont; }));
 	}
 
 	glyph_text graphics_context::to_glyph_text(std::u32string::const_iterator aTextBegin, std::u32string::const_iterator aTextEnd, std::function<font(std::u32string::size_type)> aFontSelector) const
@@ -1038,7 +1053,10 @@ namespace neogfx
 		auto& runs = iGlyphTextData->iRuns;
 		runs.clear();
 		auto const& emojiAtlas = surface().rendering_engine().font_manager().emoji_atlas();
-		text_category previousCategory = get_text_category(emojiAtlas, codePoints[0]);
+		auto& textCategories = iGlyphTextData->iTextCategories;
+		textCategories.resize(codePointCount);
+		get_text_categories(emojiAtlas, codePoints, codePoints + codePointCount, &textCategories[0]);
+		text_category previousCategory = textCategories[0];
 		if (iMnemonic != boost::none && codePoints[0] == static_cast<char32_t>(iMnemonic->second))
 			previousCategory = text_category::Mnemonic;
 		text_direction previousDirection = (previousCategory != text_category::RTL ? text_direction::LTR : text_direction::RTL);
@@ -1082,7 +1100,7 @@ namespace neogfx
 			}
 
 			hb_unicode_funcs_t* unicodeFuncs = static_cast<native_font_face::hb_handle*>(currentFont.native_font_face().aux_handle())->unicodeFuncs;
-			text_category currentCategory = get_text_category(emojiAtlas, codePoints[i]);
+			text_category currentCategory = textCategories[i];
 			if (iMnemonic != boost::none && codePoints[i] == static_cast<char32_t>(iMnemonic->second))
 				currentCategory = text_category::Mnemonic;
 			text_direction currentDirection = previousDirection;
@@ -1166,7 +1184,7 @@ namespace neogfx
 				{
 					for (std::size_t j = i + 1; j <= lastCodePointIndex; ++j)
 					{
-						text_direction nextDirection = bidi_check(get_text_category(emojiAtlas, codePoints[j]), get_text_direction(emojiAtlas, codePoints[j], currentDirection));
+						text_direction nextDirection = bidi_check(textCategories[j], get_text_direction(textCategories[j], currentDirection));
 						if (nextDirection == text_direction::RTL || nextDirection == text_direction::Digits_RTL)
 							break;
 						else if (nextDirection == text_direction::LTR || (j == lastCodePointIndex - 1 && currentLineHasLTR))
@@ -1278,6 +1296,8 @@ namespace neogfx
 							glyph.set_advance(advance);
 						}
 					}
+					else
+						glyph.fallback_font(font).native_font_face().prefetch_glyph(glyph);
 				}
 			}
 		}
@@ -0,0 +1,160 @@
+// graphics_operations.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <neogfx/gfx/graphics_operations.hpp>
+
+namespace neogfx
+{
+	namespace graphics_operation
+	{
+		namespace
+		{
+			template <typename Points>
+			rect points_bounding_rect(const Points& aPoints)
+			{
+				if (aPoints.empty())
+					return rect{};
+				point min{ aPoints[0].x, aPoints[0].y };
+				point max = min;
+				for (auto const& p : aPoints)
+				{
+					min.x = std::min<coordinate>(min.x, p.x);
+					max.x = std::max<coordinate>(max.x, p.x);
+					min.y = std::min<coordinate>(min.y, p.y);
+					max.y = std::max<coordinate>(max.y, p.y);
+				}
+				return rect{ min, max };
+			}
+
+			rect with_pen(rect aRect, const pen& aPen)
+			{
+				return aRect.inflate(aPen.width(), aPen.width());
+			}
+
+			rect circle_bounding_rect(const point& aCentre, dimension aRadius)
+			{
+				return rect{ aCentre - point{ aRadius, aRadius }, size{ aRadius * 2.0 } };
+			}
+		}
+
+		optional_rect bounding_rect(const operation& aOperation)
+		{
+			switch (static_cast<operation_type>(aOperation.which()))
+			{
+			case operation_type::SetPixel:
+				return rect{ static_variant_cast<const set_pixel&>(aOperation).point, size{ 1.0, 1.0 } };
+			case operation_type::DrawPixel:
+				return rect{ static_variant_cast<const draw_pixel&>(aOperation).point, size{ 1.0, 1.0 } };
+			case operation_type::DrawLine:
+				{
+					auto& op = static_variant_cast<const draw_line&>(aOperation);
+					return with_pen(rect{ point{ std::min(op.from.x, op.to.x), std::min(op.from.y, op.to.y) }, point{ std::max(op.from.x, op.to.x), std::max(op.from.y, op.to.y) } }, op.pen);
+				}
+			case operation_type::DrawRect:
+				return with_pen(static_variant_cast<const draw_rect&>(aOperation).rect, static_variant_cast<const draw_rect&>(aOperation).pen);
+			case operation_type::DrawRoundedRect:
+				return with_pen(static_variant_cast<const draw_rounded_rect&>(aOperation).rect, static_variant_cast<const draw_rounded_rect&>(aOperation).pen);
+			case operation_type::DrawCircle:
+				{
+					auto& op = static_variant_cast<const draw_circle&>(aOperation);
+					return with_pen(circle_bounding_rect(op.centre, op.radius), op.pen);
+				}
+			case operation_type::DrawArc:
+				{
+					auto& op = static_variant_cast<const draw_arc&>(aOperation);
+					return with_pen(circle_bounding_rect(op.centre, op.radius), op.pen);
+				}
+			case operation_type::DrawPath:
+				return with_pen(static_variant_cast<const draw_path&>(aOperation).path.bounding_rect(), static_variant_cast<const draw_path&>(aOperation).pen);
+			case operation_type::DrawShape:
+				return with_pen(points_bounding_rect(static_variant_cast<const draw_shape&>(aOperation).vertices), static_variant_cast<const draw_shape&>(aOperation).pen);
+			case operation_type::FillRect:
+				return static_variant_cast<const fill_rect&>(aOperation).rect;
+			case operation_type::FillRoundedRect:
+				return static_variant_cast<const fill_rounded_rect&>(aOperation).rect;
+			case operation_type::FillCircle:
+				return circle_bounding_rect(static_variant_cast<const fill_circle&>(aOperation).centre, static_variant_cast<const fill_circle&>(aOperation).radius);
+			case operation_type::FillArc:
+				return circle_bounding_rect(static_variant_cast<const fill_arc&>(aOperation).centre, static_variant_cast<const fill_arc&>(aOperation).radius);
+			case operation_type::FillPath:
+				return static_variant_cast<const fill_path&>(aOperation).path.bounding_rect();
+			case operation_type::FillShape:
+				return points_bounding_rect(static_variant_cast<const fill_shape&>(aOperation).vertices);
+			case operation_type::DrawGlyph:
+				{
+					// glyph bitmaps can extend past the advance and line height (bearings, accents) so allow a generous margin
+					auto& op = static_variant_cast<const draw_glyph&>(aOperation);
+					dimension margin = op.font.height() / 2.0;
+					return rect{ op.point, size{ op.glyph.advance().cx, op.font.height() } }.inflate(margin, margin);
+				}
+			case operation_type::DrawTexture:
+				return points_bounding_rect(static_variant_cast<const draw_texture&>(aOperation).textureMap);
+			default:
+				return optional_rect{};
+			}
+		}
+
+		void reorder(queue& aQueue)
+		{
+			queue result;
+			std::vector<rect> extents;
+			std::size_t barrier = 0;
+			for (auto const& existingBatch : aQueue)
+			{
+				for (auto const& op : existingBatch)
+				{
+					auto opRect = bounding_rect(op);
+					if (opRect == boost::none)
+					{
+						// state changes (scissor, clip, logical coordinates etc.) and clears are never moved past
+						result.push_back(batch{ { op } });
+						extents.push_back(rect{});
+						barrier = result.size();
+						continue;
+					}
+					// find the latest compatible batch which the operation can join without jumping over
+					// anything it overlaps
+					std::size_t target = result.size();
+					for (std::size_t i = result.size(); i-- > barrier;)
+					{
+						if (batchable(result[i].back(), op))
+						{
+							target = i;
+							break;
+						}
+						if (!extents[i].intersection(*opRect).empty())
+							break;
+					}
+					if (target != result.size())
+					{
+						result[target].push_back(op);
+						extents[target] = extents[target].combine(*opRect);
+					}
+					else
+					{
+						result.push_back(batch{ { op } });
+						extents.push_back(*opRect);
+					}
+				}
+			}
+			aQueue.swap(result);
+		}
+	}
+}
\ No newline at end of file
@@ -18,18 +18,131 @@
 */
 
 #include <neogfx/neogfx.hpp>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <libpng/png.h>
 #include <openssl/sha.h>
 #include <neogfx/gfx/image.hpp>
+#include <neogfx/app/app.hpp>
 #include <neogfx/app/resource_manager.hpp>
 
 namespace neogfx
 {
-	image::image(texture_sampling aSampling) : iColourFormat(neogfx::colour_format::RGBA8), iSampling(aSampling)
+	namespace
+	{
+		// Worker threads shared by all images loaded with image_loading::Asynchronous.
+		class decode_pool
+		{
+		public:
+			static decode_pool& instance()
+			{
+				static decode_pool sInstance;
+				return sInstance;
+			}
+		private:
+			decode_pool() : iStopping(false)
+			{
+				std::size_t threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 2u) - 1u;
+				for (std::size_t i = 0; i < threads; ++i)
+					iThreads.emplace_back([this]() { run(); });
+			}
+			~decode_pool()
+			{
+				{
+					std::lock_guard<std::mutex> lg(iMutex);
+					iStopping = true;
+					iJobs.clear();
+				}
+				iWorkAvailable.notify_all();
+				for (auto& thread : iThreads)
+					thread.join();
+			}
+		public:
+			void enqueue(const std::function<void()>& aJob)
+			{
+				{
+					std::lock_guard<std::mutex> lg(iMutex);
+					iJobs.push_back(aJob);
+				}
+				iWorkAvailable.notify_one();
+			}
+		private:
+			void run()
+			{
+				for (;;)
+				{
+					std::function<void()> job;
+					{
+						std::unique_lock<std::mutex> lock(iMutex);
+						iWorkAvailable.wait(lock, [this]() { return iStopping || !iJobs.empty(); });
+						if (iStopping)
+							return;
+						job = std::move(iJobs.front());
+						iJobs.pop_front();
+					}
+					job();
+				}
+			}
+		private:
+			std::mutex iMutex;
+			std::condition_variable iWorkAvailable;
+			std::deque<std::function<void()>> iJobs;
+			bool iStopping;
+			std::vector<std::thread> iThreads;
+		};
+
+		bool decode_png(const void* aData, std::size_t aSize, i_resource::data_type& aPixels, size& aExtents, boost::optional<std::string>& aError)
+		{
+			png_image image;
+			std::memset(&image, 0, (sizeof image));
+			image.version = PNG_IMAGE_VERSION;
+			if (png_image_begin_read_from_memory(&image, aData, aSize) != 0)
+			{
+				image.format = PNG_FORMAT_RGBA;
+				aPixels.resize(PNG_IMAGE_SIZE(image));
+				if (png_image_finish_read(&image, NULL, &aPixels[0], 0, NULL) != 0)
+				{
+					aExtents = size(image.width, image.height);
+					png_image_free(&image);
+					return true;
+				}
+				else
+				{
+					png_image_free(&image);
+					aError = image.message;
+					return false;
+				}
+			}
+			else
+			{
+				aError = image.message;
+				return false;
+			}
+		}
+	}
+
+	// Shared between an image and its decode job; the job only writes data, extents and error before setting
+	// finished, and resource is released on the GUI thread once the job has posted its completion.
+	struct image::decode_state
+	{
+		i_resource::pointer resource;
+		image* owner;
+		std::atomic<uint32_t> progress;
+		std::atomic<bool> finished;
+		data_type data;
+		neogfx::size extents;
+		boost::optional<std::string> error;
+	};
+
+	image::image(texture_sampling aSampling) : iColourFormat(neogfx::colour_format::RGBA8), iSampling(aSampling), iDecodePending(false)
 	{
 	}
 
-	image::image(const neogfx::size& aSize, const colour& aColour, texture_sampling aSampling) : iColourFormat(neogfx::colour_format::RGBA8), iSampling(aSampling)
+	image::image(const neogfx::size& aSize, const colour& aColour, texture_sampling aSampling) : iColourFormat(neogfx::colour_format::RGBA8), iSampling(aSampling), iDecodePending(false)
 	{
 		resize(aSize);
 		for (std::size_t y = 0; y < aSize.cx; ++y)
@@ -37,18 +150,28 @@ namespace neogfx
 				set_pixel(point(x, y), aColour);
 	}
 
-	image::image(const std::string& aUri, texture_sampling aSampling) : iResource(resource_manager::instance().load_resource(aUri)), iUri(aUri), iColourFormat(neogfx::colour_format::RGBA8), iSampling(aSampling)
+	image::image(const std::string& aUri, texture_sampling aSampling, image_loading aLoading) : iResource(resource_manager::instance().load_resource(aUri)), iUri(aUri), iColourFormat(neogfx::colour_format::RGBA8), iSampling(aSampling), iDecodePending(false)
 	{
 		if (available())
-			load();
+		{
+			if (aLoading == image_loading::Asynchronous)
+				load_async();
+			else
+				load();
+		}
 	}
 
 	image::~image()
 	{
+		if (iDecodeState != nullptr && iDecodeState->owner == this)
+			iDecodeState->owner = nullptr;
 	}
 
 	bool image::available() const
 	{
+		sync();
+		if (iDecodePending)
+			return false;
 		if (has_resource())
 			return resource().available();
 		else
@@ -57,6 +180,9 @@ namespace neogfx
 
 	std::pair<bool, double> image::downloading() const
 	{
+		sync();
+		if (iDecodePending)
+			return std::make_pair(true, static_cast<double>(iDecodeState->progress.load()));
 		if (has_resource())
 			return resource().downloading();
 		else
@@ -65,15 +191,17 @@ namespace neogfx
 
 	bool image::error() const
 	{
-		if (has_resource())
-			return resource().error();
+		sync();
+		if (has_resource() && resource().error())
+			return true;
 		else
 			return iError != boost::none;
 	}
 
 	const std::string& image::error_string() const
 	{
-		if (has_resource())
+		sync();
+		if (has_resource() && resource().error())
 			return resource().error_string();
 		else if (iError != boost::none)
 			return *iError;
@@ -88,6 +216,7 @@ namespace neogfx
 
 	const void* image::cdata() const
 	{
+		sync();
 		if (iData.empty())
 			throw no_data();
 		return &iData[0];
@@ -105,6 +234,7 @@ namespace neogfx
 
 	std::size_t image::size() const
 	{
+		sync();
 		return iData.size();
 	}
 
@@ -127,17 +257,20 @@ namespace neogfx
 
 	const size& image::extents() const
 	{
+		sync();
 		return iSize;
 	}
 
 	void image::resize(const neogfx::size& aNewSize)
 	{
+		sync();
 		iSize = aNewSize;
 		iData.resize(static_cast<std::size_t>(iSize.cx * iSize.cy * 4));
 	}
 
 	colour image::get_pixel(const point& aPoint) const
 	{
+		sync();
 		switch (iColourFormat)
 		{
 		case neogfx::colour_format::RGBA8:
@@ -152,6 +285,7 @@ namespace neogfx
 
 	void image::set_pixel(const point& aPoint, const colour& aColour)
 	{
+		sync();
 		switch (iColourFormat)
 		{
 		case neogfx::colour_format::RGBA8:
@@ -212,31 +346,73 @@ namespace neogfx
 
 	bool image::load_png()
 	{
-		png_image image;
-		std::memset(&image, 0, (sizeof image));
-		image.version = PNG_IMAGE_VERSION;
-		if (png_image_begin_read_from_memory(&image, resource().data(), resource().size()) != 0)
+		return decode_png(resource().data(), resource().size(), iData, iSize, iError);
+	}
+
+	void image::load_async()
+	{
+		if (recognize() != PngImage)
+			throw unknown_image_format();
+		iDecodePending = true;
+		iDecodeState = std::make_shared<decode_state>();
+		iDecodeState->resource = iResource;
+		iDecodeState->owner = this;
+		iDecodeState->progress = 0u;
+		iDecodeState->finished = false;
+		auto state = iDecodeState;
+		decode_pool::instance().enqueue([state]()
 		{
-			image.format = PNG_FORMAT_RGBA;
-			iData.resize(PNG_IMAGE_SIZE(image));
-			if (png_image_finish_read(&image, NULL, data(), 0, NULL) != 0)
+			state->progress = 50u;
+			try
 			{
-				iSize = neogfx::size(image.width, image.height);
-				png_image_free(&image);
-				return true;
+				decode_png(state->resource->cdata(), state->resource->size(), state->data, state->extents, state->error);
 			}
-			else
+			catch (const std::exception& e)
 			{
-				png_image_free(&image);
-				iError = image.message;
-				return false;
+				state->data.clear();
+				state->error = e.what();
 			}
-		}
+			state->progress = 100u;
+			state->finished = true;
+			try
+			{
+				app::instance().post([state]()
+				{
+					state->resource.reset();
+					if (state->owner != nullptr)
+						state->owner->decode_finished();
+				});
+			}
+			catch (...)
+			{
+				// no app to notify; available() still picks up the result
+			}
+		});
+	}
+
+	void image::sync() const
+	{
+		if (!iDecodePending || !iDecodeState->finished)
+			return;
+		iDecodePending = false;
+		iError = iDecodeState->error;
+		if (iError != boost::none)
+			return;
+		if (iDecodeState.use_count() == 1)
+			iData = std::move(iDecodeState->data);
 		else
-		{
-			iError = image.message;
-			return false;
-		}
+			iData = iDecodeState->data;
+		iSize = iDecodeState->extents;
+	}
+
+	void image::decode_finished()
+	{
+		iDecodeState->owner = nullptr;
+		sync();
+		if (error())
+			failed_to_download.trigger();
+		else
+			downloaded.trigger();
 	}
 
 }
\ No newline at end of file
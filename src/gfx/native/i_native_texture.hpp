@@ -34,6 +34,10 @@ namespace neogfx
 		virtual size extents() const = 0;
 		virtual size storage_extents() const = 0;
 		virtual void set_pixels(const rect& aRect, const void* aPixelData) = 0;
+		virtual void set_pixels(const rect& aRect, const void* aPixelData, bool aGenerateMipmaps) = 0;
+		virtual void set_storage_pixels(const rect& aStorageRect, const void* aPixelData, bool aGenerateMipmaps) = 0;
+		virtual void clear_pixels(const rect& aRect) = 0;
+		virtual void generate_mipmaps() = 0;
 	public:
 		virtual void* handle() const = 0;
 		virtual bool is_resident() const = 0;
@@ -25,6 +25,7 @@
 #include "../../hid/native/i_native_surface.hpp"
 #include "i_native_texture.hpp"
 #include "../text/native/i_native_font_face.hpp"
+#include "vertex_helpers.hpp"
 #include "opengl_graphics_context.hpp"
 #include "opengl_renderer.hpp" // todo: remove this #include when base class interface abstraction complete
 
@@ -56,142 +57,26 @@ namespace neogfx
 			return path_shape_to_gl_mode(aPath.shape());
 		}
 
-		enum class rect_type
+		inline rect texture_map_bounds(const texture_map& aTextureMap, const std::pair<vec2, vec2>& aLogicalCoordinates, const size& aSurfaceExtents)
 		{
-			Filled,
-			Outline
-		};
-
-		inline std::vector<xyz> rect_vertices(const rect& aRect, dimension aPixelAdjust, rect_type aType)
-		{
-			std::vector<xyz> result;
-			result.reserve(16);
-			if (aType == rect_type::Filled) // fill
-			{
-				result.push_back(xyz{ aRect.centre().x, aRect.centre().y });
-				result.push_back(xyz{ aRect.top_left().x, aRect.top_left().y });
-				result.push_back(xyz{ aRect.top_right().x, aRect.top_right().y });
-				result.push_back(xyz{ aRect.bottom_right().x, aRect.bottom_right().y });
-				result.push_back(xyz{ aRect.bottom_left().x, aRect.bottom_left().y });
-				result.push_back(xyz{ aRect.top_left().x, aRect.top_left().y });
-			}
-			else // draw (outline)
-			{
-				result.push_back(xyz{ aRect.top_left().x, aRect.top_left().y + aPixelAdjust });
-				result.push_back(xyz{ aRect.top_right().x, aRect.top_right().y + aPixelAdjust });
-				result.push_back(xyz{ aRect.top_right().x - aPixelAdjust, aRect.top_right().y });
-				result.push_back(xyz{ aRect.bottom_right().x - aPixelAdjust, aRect.bottom_right().y });
-				result.push_back(xyz{ aRect.bottom_right().x, aRect.bottom_right().y - aPixelAdjust });
-				result.push_back(xyz{ aRect.bottom_left().x, aRect.bottom_left().y - aPixelAdjust });
-				result.push_back(xyz{ aRect.bottom_left().x + aPixelAdjust, aRect.bottom_left().y });
-				result.push_back(xyz{ aRect.top_left().x + aPixelAdjust, aRect.top_left().y });
-			}
-			return result;
-		};
-
-		inline std::vector<xyz> arc_vertices(const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, bool aIncludeCentre)
-		{
-			std::vector<xyz> result;
-			angle arc = (aEndAngle != aStartAngle ? aEndAngle - aStartAngle : boost::math::constants::two_pi<angle>());
-			uint32_t segments = static_cast<uint32_t>(std::ceil(std::sqrt(aRadius) * 10.0) * arc / boost::math::constants::two_pi<angle>());
-			angle theta = arc / static_cast<angle>(segments);
-			result.reserve((segments + (aIncludeCentre ? 2 : 1)) * 2);
-			if (aIncludeCentre)
+			point min{ aTextureMap[0].x, aTextureMap[0].y };
+			point max = min;
+			for (auto& v : aTextureMap)
 			{
-				result.push_back(xyz{ aCentre.x, aCentre.y });
+				min.x = std::min(min.x, v.x);
+				max.x = std::max(max.x, v.x);
+				min.y = std::min(min.y, v.y);
+				max.y = std::max(max.y, v.y);
 			}
-			auto c = std::cos(theta);
-			auto s = std::sin(theta);
-			auto startCoordinate = mat22{ { std::cos(aStartAngle), std::sin(aStartAngle) },{ -std::sin(aStartAngle), std::cos(aStartAngle) } } *
-				vec2{ aRadius, 0.0 };
-			coordinate x = startCoordinate.x;
-			coordinate y = startCoordinate.y;
-			for (uint32_t i = 0; i < segments; ++i)
+			auto to_device = [&](const point& aPoint)
 			{
-				result.push_back(xyz{ x + aCentre.x, y + aCentre.y });
-				coordinate t = x;
-				x = c * x - s * y;
-				y = s * t + c * y;
-			}
-			return result;
-		}
-
-		inline std::vector<xyz> circle_vertices(const point& aCentre, dimension aRadius, angle aStartAngle, bool aIncludeCentre)
-		{
-			auto result = arc_vertices(aCentre, aRadius, aStartAngle, aStartAngle, aIncludeCentre);
-			result.push_back(result[aIncludeCentre ? 1 : 0]);
-			return result;
-		}
-
-		inline std::vector<xyz> rounded_rect_vertices(const rect& aRect, dimension aRadius, bool aIncludeCentre)
-		{
-			std::vector<xyz> result;
-			auto topLeft = arc_vertices(
-				aRect.top_left() + point{ aRadius, aRadius },
-				aRadius,
-				boost::math::constants::pi<coordinate>(),
-				boost::math::constants::pi<coordinate>() * 1.5,
-				false);
-			auto topRight = arc_vertices(
-				aRect.top_right() + point{ -aRadius, aRadius },
-				aRadius,
-				boost::math::constants::pi<coordinate>() * 1.5,
-				boost::math::constants::pi<coordinate>() * 2.0,
-				false);
-			auto bottomRight = arc_vertices(
-				aRect.bottom_right() + point{ -aRadius, -aRadius },
-				aRadius,
-				0.0,
-				boost::math::constants::pi<coordinate>() * 0.5,
-				false);
-			auto bottomLeft = arc_vertices(
-				aRect.bottom_left() + point{ aRadius, -aRadius },
-				aRadius,
-				boost::math::constants::pi<coordinate>() * 0.5,
-				boost::math::constants::pi<coordinate>(),
-				false);
-			result.reserve(topLeft.size() + topRight.size() + bottomRight.size() + bottomLeft.size() + (aIncludeCentre ? 9 : 8));
-			if (aIncludeCentre)
-			{
-				result.push_back(xyz{ aRect.centre().x, aRect.centre().y });
-			}
-			result.insert(result.end(), xyz{ (aRect.top_left() + point{ 0.0, aRadius }).x, (aRect.top_left() + point{ 0.0, aRadius }).y });
-			result.insert(result.end(), topLeft.begin(), topLeft.end());
-			result.insert(result.end(), xyz{ (aRect.top_left() + point{ aRadius, 0.0 }).x, (aRect.top_left() + point{ aRadius, 0.0 }).y });
-			result.insert(result.end(), xyz{ (aRect.top_right() + point{ -aRadius, 0.0 }).x, (aRect.top_right() + point{ -aRadius, 0.0 }).y });
-			result.insert(result.end(), topRight.begin(), topRight.end());
-			result.insert(result.end(), xyz{ (aRect.top_right() + point{ 0.0, aRadius }).x, (aRect.top_right() + point{ 0.0, aRadius }).y });
-			result.insert(result.end(), xyz{ (aRect.bottom_right() + point{ 0.0, -aRadius }).x, (aRect.bottom_right() + point{ 0.0, -aRadius }).y });
-			result.insert(result.end(), bottomRight.begin(), bottomRight.end());
-			result.insert(result.end(), xyz{ (aRect.bottom_right() + point{ -aRadius, 0.0 }).x, (aRect.bottom_right() + point{ -aRadius, 0.0 }).y });
-			result.insert(result.end(), xyz{ (aRect.bottom_left() + point{ aRadius, 0.0 }).x, (aRect.bottom_left() + point{ aRadius, 0.0 }).y });
-			result.insert(result.end(), bottomLeft.begin(), bottomLeft.end());
-			result.insert(result.end(), xyz{ (aRect.bottom_left() + point{ 0.0, -aRadius }).x, (aRect.bottom_left() + point{ 0.0, -aRadius }).y });
-			result.push_back(result[aIncludeCentre ? 1 : 0]);
-			return result;
-		}
-
-		inline double pixel_adjust(const dimension aWidth)
-		{
-			return static_cast<uint32_t>(aWidth) % 2 == 1 ? 0.5 : 0.0;
-		}
-
-		inline double pixel_adjust(const pen& aPen)
-		{
-			return pixel_adjust(aPen.width());
-		}
-
-		inline std::vector<xyz> line_loop_to_lines(const std::vector<xyz>& aLineLoop)
-		{
-			std::vector<xyz> result;
-			result.reserve(aLineLoop.size() * 2);
-			for (auto v = aLineLoop.begin(); v != aLineLoop.end(); ++v)
-			{
-				result.push_back(*v);
-				if (v != aLineLoop.begin() && v != aLineLoop.end() - 1)
-					result.push_back(*v);
-			}
-			return result;
+				return point{
+					(aPoint.x - aLogicalCoordinates.first.x) * aSurfaceExtents.cx / (aLogicalCoordinates.second.x - aLogicalCoordinates.first.x),
+					(aPoint.y - aLogicalCoordinates.second.y) * aSurfaceExtents.cy / (aLogicalCoordinates.first.y - aLogicalCoordinates.second.y) };
+			};
+			point a = to_device(min);
+			point b = to_device(max);
+			return rect{ point{ std::min(a.x, b.x), std::min(a.y, b.y) }, point{ std::max(a.x, b.x), std::max(a.y, b.y) } };
 		}
 	}
 
@@ -202,6 +87,7 @@ namespace neogfx
 		iLogicalCoordinates(aSurface.logical_coordinates()), 
 		iSmoothingMode(neogfx::smoothing_mode::None),
 		iSubpixelRendering(aRenderingEngine.is_subpixel_rendering_on()),
+		iVertexArrays(static_cast<opengl_renderer&>(aRenderingEngine).vertex_stream_buffer()),
 		iClipCounter(0),
 		iLineStippleActive(false)
 	{
@@ -217,6 +103,7 @@ namespace neogfx
 		iLogicalCoordinates(aSurface.logical_coordinates()),
 		iSmoothingMode(neogfx::smoothing_mode::None),
 		iSubpixelRendering(aRenderingEngine.is_subpixel_rendering_on()),
+		iVertexArrays(static_cast<opengl_renderer&>(aRenderingEngine).vertex_stream_buffer()),
 		iClipCounter(0),
 		iLineStippleActive(false)
 	{
@@ -232,6 +119,7 @@ namespace neogfx
 		iLogicalCoordinates(aOther.iLogicalCoordinates),
 		iSmoothingMode(aOther.iSmoothingMode), 
 		iSubpixelRendering(aOther.iSubpixelRendering),
+		iVertexArrays(static_cast<opengl_renderer&>(aOther.iRenderingEngine).vertex_stream_buffer()),
 		iClipCounter(0),
 		iLineStippleActive(false)
 	{
@@ -280,6 +168,8 @@ namespace neogfx
 
 	void opengl_graphics_context::flush()
 	{
+		if (iRenderingEngine.is_operation_reordering_on())
+			graphics_operation::reorder(iQueue);
 		while (!iQueue.empty())
 		{
 			const auto& opBatch = iQueue.front();
@@ -447,11 +337,7 @@ namespace neogfx
 				draw_glyphs(opBatch);
 				break;
 			case graphics_operation::operation_type::DrawTexture:
-				for (auto& op : opBatch)
-				{
-					const auto& args = static_variant_cast<const graphics_operation::draw_texture&>(op);
-					draw_texture(args.textureMap, args.texture, args.textureRect, args.colour, args.shaderEffect);
-				}
+				draw_textures(opBatch);
 				break;
 			}
 			iQueue.pop_front();
@@ -540,7 +426,7 @@ namespace neogfx
 		{
 			if (aPath.paths()[i].size() > 2)
 			{
-				iVertexArrays.vertices() = aPath.to_vertices(aPath.paths()[i]);
+				iVertexArrays.vertices() = aPath.to_vertices<vertex>(aPath.paths()[i]);
 				iVertexArrays.colours().assign(iVertexArrays.vertices().size(), std::array <uint8_t, 4>{ {0xFF, 0xFF, 0xFF, 0xFF}});
 				iVertexArrays.texture_coords().resize(iVertexArrays.vertices().size());
 				iVertexArrays.instantiate(*this, iRenderingEngine.active_shader_program());
@@ -557,7 +443,7 @@ namespace neogfx
 			{
 				if (innerPath.paths()[i].size() > 2)
 				{
-					iVertexArrays.vertices() = aPath.to_vertices(innerPath.paths()[i]);
+					iVertexArrays.vertices() = aPath.to_vertices<vertex>(innerPath.paths()[i]);
 					iVertexArrays.colours().assign(iVertexArrays.vertices().size(), std::array <uint8_t, 4>{ {0xFF, 0xFF, 0xFF, 0xFF}});
 					iVertexArrays.texture_coords().resize(iVertexArrays.vertices().size());
 					iVertexArrays.instantiate(*this, iRenderingEngine.active_shader_program());
@@ -646,36 +532,29 @@ namespace neogfx
 		iRenderingEngine.gradient_shader_program().set_uniform_variable("nGradientShape", static_cast<int>(aGradient.shape()));
 		basic_point<float> gradientCentre = (aGradient.centre() != boost::none ? *aGradient.centre() : point{});
 		iRenderingEngine.gradient_shader_program().set_uniform_variable("posGradientCentre", gradientCentre.x, gradientCentre.y);
-		auto combinedStops = aGradient.combined_stops();
-		iGradientStopPositions.reserve(combinedStops.size());
-		iGradientStopColours.reserve(combinedStops.size());
-		iGradientStopPositions.clear();
-		iGradientStopColours.clear();
-		for (const auto& stop : combinedStops)
+		// todo: remove the following cast when gradient textures abstracted in rendering engine base class interface
+		auto& renderer = static_cast<opengl_renderer&>(iRenderingEngine);
+		// extent (in pixels) of one gradient unit; only used to scale smoothing so the radial case is approximate
+		dimension gradientExtent = 0.0;
+		switch (aGradient.direction())
 		{
-			iGradientStopPositions.push_back(static_cast<float>(stop.first));
-			iGradientStopColours.push_back(std::array<float, 4>{ {stop.second.red<float>(), stop.second.green<float>(), stop.second.blue<float>(), stop.second.alpha<float>()}});
+		case gradient::Horizontal:
+			gradientExtent = aBoundingBox.cx;
+			break;
+		case gradient::Radial:
+			gradientExtent = std::min(aBoundingBox.cx, aBoundingBox.cy) / 2.0;
+			break;
+		default:
+			gradientExtent = aBoundingBox.cy;
+			break;
 		}
-		iRenderingEngine.gradient_shader_program().set_uniform_variable("nStopCount", static_cast<int>(iGradientStopPositions.size()));
-		iRenderingEngine.gradient_shader_program().set_uniform_variable("nFilterSize", static_cast<int>(opengl_renderer::GRADIENT_FILTER_SIZE));
-		auto filter = gaussian_filter<float, opengl_renderer::GRADIENT_FILTER_SIZE>(static_cast<float>(aGradient.smoothness() * 10.0));
-		// todo: remove the following cast when gradient textures abstracted in rendering engine base class interface
-		auto& gradientTextures = static_cast<opengl_renderer&>(iRenderingEngine).gradient_textures(); 
+		uint32_t lookupTableRow = renderer.gradient_lookup_table(aGradient, gradientExtent);
+		iRenderingEngine.gradient_shader_program().set_uniform_variable("nLookupTableSize", static_cast<int>(opengl_renderer::GRADIENT_LOOKUP_TABLE_SIZE));
+		iRenderingEngine.gradient_shader_program().set_uniform_variable("nLookupTableRow", static_cast<int>(lookupTableRow));
 		glCheck(glActiveTexture(GL_TEXTURE2));
 		glCheck(glClientActiveTexture(GL_TEXTURE2));
-		glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, gradientTextures[0]));
-		glCheck(glTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, 0, iGradientStopPositions.size(), 1, GL_RED, GL_FLOAT, &iGradientStopPositions[0]));
-		glCheck(glActiveTexture(GL_TEXTURE3));
-		glCheck(glClientActiveTexture(GL_TEXTURE3));
-		glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, gradientTextures[1]));
-		glCheck(glTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, 0, iGradientStopColours.size(), 1, GL_RGBA, GL_FLOAT, &iGradientStopColours[0]));
-		glCheck(glActiveTexture(GL_TEXTURE4));
-		glCheck(glClientActiveTexture(GL_TEXTURE4));
-		glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, gradientTextures[2]));
-		glCheck(glTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, 0, opengl_renderer::GRADIENT_FILTER_SIZE, opengl_renderer::GRADIENT_FILTER_SIZE, GL_RED, GL_FLOAT, &filter[0][0]));
-		iRenderingEngine.gradient_shader_program().set_uniform_variable("texStopPositions", 2);
-		iRenderingEngine.gradient_shader_program().set_uniform_variable("texStopColours", 3);
-		iRenderingEngine.gradient_shader_program().set_uniform_variable("texFilter", 4);
+		glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, renderer.gradient_lookup_table_texture()));
+		iRenderingEngine.gradient_shader_program().set_uniform_variable("texLookupTable", 2);
 		glCheck(glActiveTexture(GL_TEXTURE1));
 		glCheck(glClientActiveTexture(GL_TEXTURE1));
 	}
@@ -736,7 +615,7 @@ namespace neogfx
 	void opengl_graphics_context::draw_line(const point& aFrom, const point& aTo, const pen& aPen)
 	{
 		double pixelAdjust = pixel_adjust(aPen);
-		iVertexArrays.vertices().assign({ xyz{aFrom.x + pixelAdjust, aFrom.y + pixelAdjust}, xyz{aTo.x + pixelAdjust, aTo.y + pixelAdjust} });
+		iVertexArrays.vertices().assign({ make_vertex<vertex>(aFrom.x + pixelAdjust, aFrom.y + pixelAdjust), make_vertex<vertex>(aTo.x + pixelAdjust, aTo.y + pixelAdjust) });
 		iVertexArrays.texture_coords().resize(iVertexArrays.vertices().size());
 		iVertexArrays.colours().assign(iVertexArrays.vertices().size(), std::array <uint8_t, 4>{{aPen.colour().red(), aPen.colour().green(), aPen.colour().blue(), aPen.colour().alpha()}});
 		iVertexArrays.instantiate(*this, iRenderingEngine.active_shader_program());
@@ -748,7 +627,7 @@ namespace neogfx
 
 	void opengl_graphics_context::draw_rect(const rect& aRect, const pen& aPen)
 	{
-		iVertexArrays.vertices() = rect_vertices(aRect, pixel_adjust(aPen), rect_type::Outline);
+		iVertexArrays.vertices() = rect_vertices<vertex>(aRect, pixel_adjust(aPen), rect_type::Outline);
 		iVertexArrays.texture_coords().resize(iVertexArrays.vertices().size());
 		iVertexArrays.colours().assign(iVertexArrays.vertices().size(), std::array <uint8_t, 4>{ {aPen.colour().red(), aPen.colour().green(), aPen.colour().blue(), aPen.colour().alpha()}});
 		iVertexArrays.instantiate(*this, iRenderingEngine.active_shader_program());
@@ -761,7 +640,7 @@ namespace neogfx
 	void opengl_graphics_context::draw_rounded_rect(const rect& aRect, dimension aRadius, const pen& aPen)
 	{
 		double pixelAdjust = pixel_adjust(aPen);
-		iVertexArrays.vertices() = rounded_rect_vertices(aRect + point{ pixelAdjust, pixelAdjust }, aRadius, false);
+		iVertexArrays.vertices() = rounded_rect_vertices<vertex>(aRect + point{ pixelAdjust, pixelAdjust }, aRadius, false);
 		iVertexArrays.texture_coords().resize(iVertexArrays.vertices().size());
 		iVertexArrays.colours().assign(iVertexArrays.vertices().size(), std::array <uint8_t, 4>{ {aPen.colour().red(), aPen.colour().green(), aPen.colour().blue(), aPen.colour().alpha()}});
 		iVertexArrays.instantiate(*this, iRenderingEngine.active_shader_program());
@@ -773,7 +652,7 @@ namespace neogfx
 
 	void opengl_graphics_context::draw_circle(const point& aCentre, dimension aRadius, const pen& aPen, angle aStartAngle)
 	{
-		iVertexArrays.vertices() = circle_vertices(aCentre, aRadius, aStartAngle, false);
+		iVertexArrays.vertices() = circle_vertices<vertex>(aCentre, aRadius, aStartAngle, false);
 		iVertexArrays.texture_coords().resize(iVertexArrays.vertices().size());
 		iVertexArrays.colours().assign(iVertexArrays.vertices().size(), std::array <uint8_t, 4>{{aPen.colour().red(), aPen.colour().green(), aPen.colour().blue(), aPen.colour().alpha()}});
 
@@ -786,7 +665,7 @@ namespace neogfx
 
 	void opengl_graphics_context::draw_arc(const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, const pen& aPen)
 	{
-		iVertexArrays.vertices() = line_loop_to_lines(arc_vertices(aCentre, aRadius, aStartAngle, aEndAngle, false));
+		iVertexArrays.vertices() = line_loop_to_lines(arc_vertices<vertex>(aCentre, aRadius, aStartAngle, aEndAngle, false));
 		iVertexArrays.texture_coords().resize(iVertexArrays.vertices().size());
 		iVertexArrays.colours().assign(iVertexArrays.vertices().size(), std::array <uint8_t, 4>{ {aPen.colour().red(), aPen.colour().green(), aPen.colour().blue(), aPen.colour().alpha()}});
 		iVertexArrays.instantiate(*this, iRenderingEngine.active_shader_program());
@@ -805,7 +684,7 @@ namespace neogfx
 				if (aPath.shape() == path::ConvexPolygon)
 					clip_to(aPath, aPen.width());
 
-				iVertexArrays.vertices() = aPath.to_vertices(aPath.paths()[i]);
+				iVertexArrays.vertices() = aPath.to_vertices<vertex>(aPath.paths()[i]);
 				iVertexArrays.texture_coords().resize(iVertexArrays.vertices().size());
 				iVertexArrays.colours().assign(iVertexArrays.vertices().size(), std::array <uint8_t, 4>{{aPen.colour().red(), aPen.colour().green(), aPen.colour().blue(), aPen.colour().alpha()}});
 				iVertexArrays.instantiate(*this, iRenderingEngine.active_shader_program());
@@ -821,7 +700,7 @@ namespace neogfx
 	{
 		iVertexArrays.vertices().clear();
 		for (auto const& v : aVertices)
-			iVertexArrays.vertices().push_back(xyz{ v[0], v[1] });
+			iVertexArrays.vertices().push_back(make_vertex<vertex>(v[0], v[1]));
 		iVertexArrays.vertices().push_back(iVertexArrays.vertices()[0]);
 		iVertexArrays.texture_coords().resize(iVertexArrays.vertices().size());
 		iVertexArrays.colours().assign(iVertexArrays.vertices().size(),
@@ -856,9 +735,16 @@ namespace neogfx
 		for (const auto& op : aFillRectOps)
 		{
 			auto& drawOp = static_variant_cast<const graphics_operation::fill_rect&>(op);
-			auto rv = rect_vertices(drawOp.rect, 0.0, rect_type::Filled);
-			iVertexArrays.vertices().insert(iVertexArrays.vertices().end(), rv.begin(), rv.end());
-			iVertexArrays.texture_coords().insert(iVertexArrays.texture_coords().end(), 6, std::array<double, 2>{});
+			iVertexArrays.vertices().insert(iVertexArrays.vertices().end(),
+			{
+				make_vertex<vertex>(drawOp.rect.top_left().x, drawOp.rect.top_left().y),
+				make_vertex<vertex>(drawOp.rect.top_right().x, drawOp.rect.top_right().y),
+				make_vertex<vertex>(drawOp.rect.bottom_right().x, drawOp.rect.bottom_right().y),
+				make_vertex<vertex>(drawOp.rect.top_left().x, drawOp.rect.top_left().y),
+				make_vertex<vertex>(drawOp.rect.bottom_right().x, drawOp.rect.bottom_right().y),
+				make_vertex<vertex>(drawOp.rect.bottom_left().x, drawOp.rect.bottom_left().y)
+			});
+			iVertexArrays.texture_coords().insert(iVertexArrays.texture_coords().end(), 6, texture_coord{});
 			auto c = drawOp.fill.is<colour>() ?
 				std::array<uint8_t, 4>{{
 						static_variant_cast<const colour&>(drawOp.fill).red(),
@@ -871,8 +757,7 @@ namespace neogfx
 
 		iVertexArrays.instantiate(*this, iRenderingEngine.active_shader_program());
 
-		for (std::size_t i = 0; i < iVertexArrays.vertices().size(); i += 6)
-			glCheck(glDrawArrays(GL_TRIANGLE_FAN, i, 6));
+		glCheck(glDrawArrays(GL_TRIANGLES, 0, iVertexArrays.vertices().size()));
 
 		if (firstOp.fill.is<gradient>())
 			gradient_off();
@@ -886,7 +771,7 @@ namespace neogfx
 		if (aFill.is<gradient>())
 			gradient_on(static_variant_cast<const gradient&>(aFill), aRect);
 
-		iVertexArrays.vertices() = rounded_rect_vertices(aRect, aRadius, true);
+		iVertexArrays.vertices() = rounded_rect_vertices<vertex>(aRect, aRadius, true);
 		iVertexArrays.texture_coords().resize(iVertexArrays.vertices().size());
 		iVertexArrays.colours().assign(iVertexArrays.vertices().size(), aFill.is<colour>() ?
 			std::array <uint8_t, 4>{ {
@@ -908,7 +793,7 @@ namespace neogfx
 		if (aFill.is<gradient>())
 			gradient_on(static_variant_cast<const gradient&>(aFill), rect{ aCentre - point{ aRadius, aRadius }, size{ aRadius * 2.0 } });
 
-		iVertexArrays.vertices() = circle_vertices(aCentre, aRadius, 0.0, true);
+		iVertexArrays.vertices() = circle_vertices<vertex>(aCentre, aRadius, 0.0, true);
 		iVertexArrays.texture_coords().resize(iVertexArrays.vertices().size());
 		iVertexArrays.colours().assign(iVertexArrays.vertices().size(), aFill.is<colour>() ?
 			std::array <uint8_t, 4>{ {
@@ -930,7 +815,7 @@ namespace neogfx
 		if (aFill.is<gradient>())
 			gradient_on(static_variant_cast<const gradient&>(aFill), rect{ aCentre - point{ aRadius, aRadius }, size{ aRadius * 2.0 } });
 		
-		iVertexArrays.vertices() = arc_vertices(aCentre, aRadius, aStartAngle, aEndAngle, true);
+		iVertexArrays.vertices() = arc_vertices<vertex>(aCentre, aRadius, aStartAngle, aEndAngle, true);
 		iVertexArrays.texture_coords().resize(iVertexArrays.vertices().size());
 		iVertexArrays.colours().assign(iVertexArrays.vertices().size(), aFill.is<colour>() ?
 			std::array <uint8_t, 4>{ {
@@ -966,7 +851,7 @@ namespace neogfx
 				if (aFill.is<gradient>())
 					gradient_on(static_variant_cast<const gradient&>(aFill), rect{ point{ min.x, min.y }, size{ max.x - min.y, max.y - min.y } });
 
-				iVertexArrays.vertices() = aPath.to_vertices(aPath.paths()[i]);
+				iVertexArrays.vertices() = aPath.to_vertices<vertex>(aPath.paths()[i]);
 				iVertexArrays.colours().assign(iVertexArrays.vertices().size(), aFill.is<colour>() ?
 					std::array <uint8_t, 4>{ {
 							static_variant_cast<const colour&>(aFill).red(),
@@ -1015,11 +900,10 @@ namespace neogfx
 		for (auto const& op : aFillShapeOps)
 		{
 			auto& drawOp = static_variant_cast<const graphics_operation::fill_shape&>(op);
-			for (auto const& v : drawOp.vertices)
-				iVertexArrays.vertices().push_back(xyz{ v[0], v[1] });
-			iVertexArrays.vertices().push_back(xyz{ drawOp.vertices[1][0], drawOp.vertices[1][1] });
-			auto vertexCount = drawOp.vertices.size() + 1;
-			iVertexArrays.texture_coords().insert(iVertexArrays.texture_coords().end(), vertexCount, std::array<double, 2>{});
+			auto triangles = triangle_fan_to_triangles<vertex>(drawOp.vertices);
+			iVertexArrays.vertices().insert(iVertexArrays.vertices().end(), triangles.begin(), triangles.end());
+			auto vertexCount = triangles.size();
+			iVertexArrays.texture_coords().insert(iVertexArrays.texture_coords().end(), vertexCount, texture_coord{});
 			iVertexArrays.colours().insert(iVertexArrays.colours().end(), vertexCount, drawOp.fill.is<colour>() ?
 				std::array <uint8_t, 4>{ {
 						static_variant_cast<const colour&>(drawOp.fill).red(),
@@ -1031,14 +915,7 @@ namespace neogfx
 
 		iVertexArrays.instantiate(*this, iRenderingEngine.active_shader_program());
 
-		std::size_t idx = 0;
-		for (auto const& op : aFillShapeOps)
-		{
-			auto& drawOp = static_variant_cast<const graphics_operation::fill_shape&>(op);
-			auto vertexCount = drawOp.vertices.size() + 1;
-			glCheck(glDrawArrays(GL_TRIANGLE_FAN, idx, vertexCount));
-			idx += vertexCount;
-		}
+		glCheck(glDrawArrays(GL_TRIANGLES, 0, iVertexArrays.vertices().size()));
 
 		if (firstOp.fill.is<gradient>())
 			gradient_off();
@@ -1046,15 +923,14 @@ namespace neogfx
 
 	namespace
 	{
-		std::vector<std::array<double, 2>> texture_vertices(const size& aTextureStorageSize, const rect& aTextureRect, const std::pair<vec2, vec2>& aLogicalCoordinates)
+		std::array<std::array<float, 2>, 4> texture_vertices(const size& aTextureStorageSize, const rect& aTextureRect, const std::pair<vec2, vec2>& aLogicalCoordinates)
 		{
-			typedef std::array<double, 2> xy;
-			std::vector<xy> result;
 			rect normalizedRect = aTextureRect / aTextureStorageSize;
-			result.push_back(xy{ normalizedRect.top_left().x, normalizedRect.top_left().y });
-			result.push_back(xy{ normalizedRect.top_right().x, normalizedRect.top_right().y });
-			result.push_back(xy{ normalizedRect.bottom_right().x, normalizedRect.bottom_right().y });
-			result.push_back(xy{ normalizedRect.bottom_left().x, normalizedRect.bottom_left().y });
+			std::array<std::array<float, 2>, 4> result{ {
+				make_vertex<std::array<float, 2>>(normalizedRect.top_left().x, normalizedRect.top_left().y),
+				make_vertex<std::array<float, 2>>(normalizedRect.top_right().x, normalizedRect.top_right().y),
+				make_vertex<std::array<float, 2>>(normalizedRect.bottom_right().x, normalizedRect.bottom_right().y),
+				make_vertex<std::array<float, 2>>(normalizedRect.bottom_left().x, normalizedRect.bottom_left().y) } };
 			if (aLogicalCoordinates.first.y < aLogicalCoordinates.second.y)
 			{
 				std::swap(result[0][1], result[2][1]);
@@ -1112,6 +988,9 @@ namespace neogfx
 		if (iVertexArrays.vertices().empty())
 			return;
 
+		// upload any glyphs the batch had to rasterize synchronously
+		iRenderingEngine.font_manager().update_glyph_atlas();
+
 		glCheck(glActiveTexture(GL_TEXTURE1));
 		glCheck(glClientActiveTexture(GL_TEXTURE1));
 		glCheck(glEnable(GL_TEXTURE_2D));
@@ -1149,11 +1028,33 @@ namespace neogfx
 		}
 		else
 		{
+			// sub-pixel glyphs blend with what is already in the output texture so a barrier is only needed
+			// before a glyph that overlaps one drawn since the last barrier
+			std::vector<rect> group;
+			std::size_t groupStart = 0;
 			for (std::size_t i = 0; i < iVertexArrays.vertices().size(); i += 4)
 			{
-				glCheck(glTextureBarrierNV());
-				glCheck(glDrawArrays(GL_QUADS, i, 4));
+				rect glyphRect{
+					point{ iVertexArrays.vertices()[i][0], iVertexArrays.vertices()[i][1] },
+					point{ iVertexArrays.vertices()[i + 2][0], iVertexArrays.vertices()[i + 2][1] } };
+				bool overlaps = false;
+				for (auto const& r : group)
+					if (!r.intersection(glyphRect).empty())
+					{
+						overlaps = true;
+						break;
+					}
+				if (overlaps)
+				{
+					glCheck(glTextureBarrierNV());
+					glCheck(glDrawArrays(GL_QUADS, groupStart, i - groupStart));
+					group.clear();
+					groupStart = i;
+				}
+				group.push_back(glyphRect);
 			}
+			glCheck(glTextureBarrierNV());
+			glCheck(glDrawArrays(GL_QUADS, groupStart, iVertexArrays.vertices().size() - groupStart));
 		}
 
 		glCheck(glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(iPreviousTexture)));
@@ -1161,11 +1062,18 @@ namespace neogfx
 
 	void opengl_graphics_context::draw_texture(const texture_map& aTextureMap, const i_texture& aTexture, const rect& aTextureRect, const optional_colour& aColour, shader_effect aShaderEffect)
 	{
-		if (aTexture.is_empty())
+		graphics_operation::batch batch;
+		batch.push_back(graphics_operation::draw_texture{ aTextureMap, aTexture, aTextureRect, aColour, aShaderEffect });
+		draw_textures(batch);
+	}
+
+	void opengl_graphics_context::draw_textures(const graphics_operation::batch& aDrawTextureOps)
+	{
+		auto& firstOp = static_variant_cast<const graphics_operation::draw_texture&>(aDrawTextureOps.front());
+
+		if (firstOp.texture.is_empty())
 			return;
-		rect textureRect = aTextureRect;
-		if (aTexture.type() == i_texture::SubTexture)
-			textureRect.position() += static_cast<const i_sub_texture&>(aTexture).atlas_location().top_left();
+
 		glCheck(glActiveTexture(GL_TEXTURE1));
 		glCheck(glClientActiveTexture(GL_TEXTURE1));
 		glCheck(glEnable(GL_TEXTURE_2D));
@@ -1174,21 +1082,34 @@ namespace neogfx
 		GLint previousTexture;
 		glCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
 		glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-		glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, aTexture.sampling() == texture_sampling::NormalMipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
-		glCheck(glBindTexture(GL_TEXTURE_2D, reinterpret_cast<GLuint>(aTexture.native_texture()->handle())));
-		if (!aTexture.native_texture()->is_resident())
+		glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, firstOp.texture.sampling() == texture_sampling::NormalMipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+		glCheck(glBindTexture(GL_TEXTURE_2D, reinterpret_cast<GLuint>(firstOp.texture.native_texture()->handle())));
+		if (!firstOp.texture.native_texture()->is_resident())
 			throw texture_not_resident();
 
 		iVertexArrays.vertices().clear();
-		for (auto& v : aTextureMap)
-			iVertexArrays.vertices().push_back(vertex{ v.x, v.y });
-		iVertexArrays.texture_coords() = texture_vertices(aTexture.storage_extents(), textureRect + point{1.0, 1.0}, logical_coordinates());
-		colour c{0xFF, 0xFF, 0xFF, 0xFF};
-		if (aColour != boost::none)
-			c = *aColour;
-		iVertexArrays.colours().assign(aTextureMap.size(), std::array<uint8_t, 4>{ {c.red(), c.green(), c.blue(), c.alpha()}});
-
-		use_shader_program usp{ *this, iRenderingEngine, aShaderEffect == shader_effect::Monochrome ?
+		iVertexArrays.texture_coords().clear();
+		iVertexArrays.colours().clear();
+
+		for (auto const& op : aDrawTextureOps)
+		{
+			auto& drawOp = static_variant_cast<const graphics_operation::draw_texture&>(op);
+			for (auto& v : drawOp.textureMap)
+				iVertexArrays.vertices().push_back(make_vertex<vertex>(v.x, v.y));
+			rect textureRect = drawOp.textureRect;
+			if (drawOp.texture.type() == i_texture::SubTexture)
+				textureRect.position() += static_cast<const i_sub_texture&>(drawOp.texture).atlas_location().top_left();
+			if (iRenderingEngine.texture_manager().uploads_pending())
+				iRenderingEngine.texture_manager().texture_drawn(*drawOp.texture.native_texture(), textureRect, iSurface, texture_map_bounds(drawOp.textureMap, logical_coordinates(), iSurface.surface_size()));
+			auto textureCoords = texture_vertices(drawOp.texture.storage_extents(), textureRect + point{ 1.0, 1.0 }, logical_coordinates());
+			iVertexArrays.texture_coords().insert(iVertexArrays.texture_coords().end(), textureCoords.begin(), textureCoords.end());
+			colour c{ 0xFF, 0xFF, 0xFF, 0xFF };
+			if (drawOp.colour != boost::none)
+				c = *drawOp.colour;
+			iVertexArrays.colours().insert(iVertexArrays.colours().end(), drawOp.textureMap.size(), std::array<uint8_t, 4>{ {c.red(), c.green(), c.blue(), c.alpha()}});
+		}
+
+		use_shader_program usp{ *this, iRenderingEngine, firstOp.shaderEffect == shader_effect::Monochrome ?
 			iRenderingEngine.monochrome_shader_program() :
 			iRenderingEngine.texture_shader_program() };
 
@@ -1196,13 +1117,13 @@ namespace neogfx
 
 		iVertexArrays.instantiate(*this, iRenderingEngine.active_shader_program());
 
-		glCheck(glDrawArrays(GL_QUADS, 0, 4));
+		glCheck(glDrawArrays(GL_QUADS, 0, iVertexArrays.vertices().size()));
 		glCheck(glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture)));
 	}
 
 	opengl_graphics_context::vertex opengl_graphics_context::to_shader_vertex(const point& aPoint) const
 	{
-		return vertex{{aPoint.x, aPoint.y, 0.0}};
+		return make_vertex<vertex>(aPoint.x, aPoint.y);
 	}
 
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -54,7 +54,8 @@ namespace neogfx
 			{
 			}
 		};
-		typedef xyz vertex;
+		typedef opengl_standard_vertex_arrays::vertex_array::value_type vertex;
+		typedef opengl_standard_vertex_arrays::texture_coord_array::value_type texture_coord;
 	public:
 		opengl_graphics_context(i_rendering_engine& aRenderingEngine, const i_native_surface& aSurface);
 		opengl_graphics_context(i_rendering_engine& aRenderingEngine, const i_native_surface& aSurface, const i_widget& aWidget);
@@ -105,6 +106,7 @@ namespace neogfx
 		void fill_shape(const graphics_operation::batch& aFillShapeOps);
 		void draw_glyphs(const graphics_operation::batch& aDrawGlyphOps);
 		void draw_texture(const texture_map& aTextureMap, const i_texture& aTexture, const rect& aTextureRect, const optional_colour& aColour, shader_effect aShaderEffect);
+		void draw_textures(const graphics_operation::batch& aDrawTextureOps);
 	private:
 		void apply_scissor();
 		void apply_logical_operation();
@@ -126,8 +128,6 @@ namespace neogfx
 		std::vector<rect> iScissorRects;
 		GLint iPreviousTexture;
 		bool iLineStippleActive;
-		std::vector<float> iGradientStopPositions;
-		std::vector<std::array<float, 4>> iGradientStopColours;
 		font iLastDrawGlyphFallbackFont;
 		boost::optional<uint8_t> iLastDrawGlyphFallbackFontIndex;
 	};
@@ -20,6 +20,9 @@
 #pragma once
 
 #include <neogfx/neogfx.hpp>
+#include <cstddef>
+#include <array>
+#include <algorithm>
 #include <neogfx/gfx/i_rendering_engine.hpp>
 #include "opengl.hpp"
 #include "i_native_graphics_context.hpp"
@@ -40,185 +43,195 @@ namespace neogfx
 			glCheck(glBindVertexArray(iPreviousVertexArrayBindingHandle));
 			glCheck(glDeleteVertexArrays(1, &iHandle));
 		}
+	public:
+		GLuint handle() const
+		{
+			return iHandle;
+		}
 	private:
 		GLint iPreviousVertexArrayBindingHandle;
 		GLuint iHandle;
 	};
 
+	struct opengl_standard_vertex
+	{
+		std::array<float, 3> xyz;
+		std::array<uint8_t, 4> rgba;
+		std::array<float, 2> st;
+	};
+
+	// Persistently mapped vertex buffer split into segments which are written in turn (ring buffer); a fence is
+	// placed when a segment is left and waited on before it is reused so the GPU is never reading what we write.
 	template <typename T>
-	class opengl_buffer
+	class opengl_stream_buffer
 	{
 	public:
 		typedef T value_type;
+		static const std::size_t SegmentCount = 3;
 	public:
-		opengl_buffer(std::size_t aSize, std::size_t aElementSize) :
-			iSize{ aSize }, iElementSize { aElementSize	}
+		struct segment_too_small : std::logic_error { segment_too_small() : std::logic_error("neogfx::opengl_stream_buffer::segment_too_small") {} };
+	public:
+		opengl_stream_buffer(std::size_t aSegmentSize) :
+			iSegmentSize{ aSegmentSize }, iSegment{ 0 }, iSegmentUsed{ 0 }, iFences{}
 		{
-			glCheck(glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &iPreviousBindingHandle));
-			glCheck(glGenBuffers(1, &iHandle));
-			glCheck(glBindBuffer(GL_ARRAY_BUFFER, iHandle));
-			glCheck(glBufferData(GL_ARRAY_BUFFER, iSize * iElementSize * sizeof(value_type), nullptr, GL_DYNAMIC_DRAW));
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glCheck(glCreateBuffers(1, &iHandle));
+			glCheck(glNamedBufferStorage(iHandle, capacity() * sizeof(value_type), nullptr, flags));
+			glCheck(iMemory = static_cast<value_type*>(glMapNamedBufferRange(iHandle, 0, capacity() * sizeof(value_type), flags)));
 		}
-		~opengl_buffer()
+		~opengl_stream_buffer()
 		{
-			glCheck(glBindBuffer(GL_ARRAY_BUFFER, iPreviousBindingHandle));
+			for (auto fence : iFences)
+				if (fence != nullptr)
+					glCheck(glDeleteSync(fence));
+			glCheck(glUnmapNamedBuffer(iHandle));
 			glCheck(glDeleteBuffers(1, &iHandle));
 		}
 	public:
-		std::size_t size() const
+		std::size_t segment_size() const
 		{
-			return iSize;
+			return iSegmentSize;
 		}
-		std::size_t element_size() const
+		std::size_t capacity() const
 		{
-			return iElementSize;
+			return iSegmentSize * SegmentCount;
 		}
 		GLuint handle() const
 		{
 			return iHandle;
 		}
-	private:
-		const std::size_t iSize;
-		const std::size_t iElementSize;
-		GLint iPreviousBindingHandle;
-		GLuint iHandle;
-	};
-
-	template <typename T>
-	class opengl_vertex_attrib_array
-	{
-	public:
-		typedef T value_type;
-	public:
-		opengl_vertex_attrib_array(opengl_buffer<value_type>& aBuffer, const i_rendering_engine::i_shader_program& aShaderProgram, const std::string& aVariableName)
+		std::size_t allocate(std::size_t aCount)
 		{
-			glCheck(glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &iPreviousBindingHandle));
-			GLuint index = reinterpret_cast<GLuint>(aShaderProgram.variable(aVariableName));
-			glCheck(glEnableVertexAttribArray(index));
-			glCheck(glBindBuffer(GL_ARRAY_BUFFER, aBuffer.handle()));
-			glCheck(glVertexAttribPointer(index, aBuffer.element_size(), std::is_same<value_type, double>() ? GL_DOUBLE : GL_UNSIGNED_BYTE, GL_FALSE, 0, 0));
+			if (aCount > iSegmentSize)
+				throw segment_too_small();
+			if (iSegmentUsed + aCount > iSegmentSize)
+			{
+				glCheck(iFences[iSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+				iSegment = (iSegment + 1) % SegmentCount;
+				iSegmentUsed = 0;
+				wait(iSegment);
+			}
+			std::size_t result = iSegment * iSegmentSize + iSegmentUsed;
+			iSegmentUsed += aCount;
+			return result;
 		}
-		~opengl_vertex_attrib_array()
+		value_type* data(std::size_t aIndex)
 		{
-			glCheck(glBindBuffer(GL_ARRAY_BUFFER, iPreviousBindingHandle));
+			return iMemory + aIndex;
 		}
 	private:
-		GLint iPreviousBindingHandle;
+		void wait(std::size_t aSegment)
+		{
+			if (iFences[aSegment] == nullptr)
+				return;
+			GLenum result = GL_TIMEOUT_EXPIRED;
+			while (result == GL_TIMEOUT_EXPIRED)
+				glCheck(result = glClientWaitSync(iFences[aSegment], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000));
+			glCheck(glDeleteSync(iFences[aSegment]));
+			iFences[aSegment] = nullptr;
+		}
+	private:
+		const std::size_t iSegmentSize;
+		std::size_t iSegment;
+		std::size_t iSegmentUsed;
+		std::array<GLsync, SegmentCount> iFences;
+		GLuint iHandle;
+		value_type* iMemory;
 	};
 
 	class opengl_standard_vertex_arrays
 	{
 	public:
-		typedef std::vector<std::array<double, 3>> vertex_array;
+		typedef opengl_standard_vertex vertex;
+		typedef std::vector<std::array<float, 3>> vertex_array;
 		typedef std::vector<std::array<uint8_t, 4>> colour_array;
-		typedef std::vector<std::array<double, 2>> texture_coord_array;
+		typedef std::vector<std::array<float, 2>> texture_coord_array;
+		typedef opengl_stream_buffer<vertex> stream_buffer;
+		typedef std::unique_ptr<stream_buffer> stream_buffer_pointer;
+		static const std::size_t InitialSegmentSize = 4096;
 	private:
-		class buffer_instance
+		class instance
 		{
 		public:
-			buffer_instance(std::size_t aSize) :
-				iSize{ aSize },
-				iPositionBuffer{ aSize, 3 },
-				iColourBuffer{ aSize, 4 },
-				iTextureCoordBuffer{ aSize, 2 }
+			instance(const i_rendering_engine::i_shader_program& aShaderProgram)
 			{
+				attribute(aShaderProgram, "VertexPosition", 3, GL_FLOAT, offsetof(vertex, xyz));
+				attribute(aShaderProgram, "VertexColor", 4, GL_UNSIGNED_BYTE, offsetof(vertex, rgba));
+				attribute(aShaderProgram, "VertexTextureCoord", 2, GL_FLOAT, offsetof(vertex, st));
 			}
 		public:
-			std::size_t size() const
-			{
-				return iSize;
-			}
-			opengl_buffer<double>& position_buffer()
-			{ 
-				return iPositionBuffer; 
-			}
-			opengl_buffer<uint8_t>& colour_buffer()
+			void bind(const stream_buffer& aBuffer, std::size_t aFirstVertex)
 			{
-				return iColourBuffer;
-			}
-			opengl_buffer<double>& texture_coord_buffer()
-			{
-				return iTextureCoordBuffer;
+				glCheck(glVertexArrayVertexBuffer(iVao.handle(), 0, aBuffer.handle(), aFirstVertex * sizeof(vertex), sizeof(vertex)));
 			}
 		private:
-			std::size_t iSize;
-			opengl_buffer<double> iPositionBuffer;
-			opengl_buffer<uint8_t> iColourBuffer;
-			opengl_buffer<double> iTextureCoordBuffer;
-		};
-		class instance
-		{
-		public:
-			instance(const i_rendering_engine::i_shader_program& aShaderProgram, opengl_buffer<double>& aPositionBuffer, opengl_buffer<uint8_t>& aColourBuffer, opengl_buffer<double>& aTextureCoordBuffer) :
-				iVertexPositionAttribArray{ aPositionBuffer, aShaderProgram, "VertexPosition" },
-				iVertexColorAttribArray{ aColourBuffer, aShaderProgram, "VertexColor" },
-				iVertexTextureCoordAttribArray{ aTextureCoordBuffer, aShaderProgram, "VertexTextureCoord" }
+			void attribute(const i_rendering_engine::i_shader_program& aShaderProgram, const std::string& aVariableName, GLint aSize, GLenum aType, std::size_t aOffset)
 			{
+				GLuint index = reinterpret_cast<GLuint>(aShaderProgram.variable(aVariableName));
+				glCheck(glEnableVertexArrayAttrib(iVao.handle(), index));
+				glCheck(glVertexArrayAttribFormat(iVao.handle(), index, aSize, aType, GL_FALSE, static_cast<GLuint>(aOffset)));
+				glCheck(glVertexArrayAttribBinding(iVao.handle(), index, 0));
 			}
 		private:
 			opengl_vertex_array iVao;
-			opengl_vertex_attrib_array<double> iVertexPositionAttribArray;
-			opengl_vertex_attrib_array<uint8_t> iVertexColorAttribArray;
-			opengl_vertex_attrib_array<double> iVertexTextureCoordAttribArray;
 		};
 	public:
-		opengl_standard_vertex_arrays() :
+		// The stream buffer is shared by all the vertex arrays of a renderer and is created on first use.
+		opengl_standard_vertex_arrays(stream_buffer_pointer& aBuffer) :
 			iShaderProgram{ nullptr },
-			iBufferInstance{ std::make_unique<buffer_instance>(32) }
+			iBuffer{ aBuffer }
 		{
 		}
 	public:
-		std::vector<std::array<double, 3>>& vertices()
+		vertex_array& vertices()
 		{
 			return iVertices;
 		}
-		std::vector<std::array<uint8_t, 4>>& colours()
+		colour_array& colours()
 		{
 			return iColours;
 		}
-		std::vector<std::array<double, 2>>& texture_coords()
+		texture_coord_array& texture_coords()
 		{
 			return iTextureCoords;
 		}
 		void instantiate(i_native_graphics_context& aGraphicsContext, i_rendering_engine::i_shader_program& aShaderProgram)
 		{
-			if (buffers().size() < vertices().size())
+			if (iBuffer == nullptr || iBuffer->segment_size() < vertices().size())
 			{
-				iInstance.reset();
-				iBufferInstance.reset();
-				iBufferInstance = std::make_unique<buffer_instance>(vertices().size() * 2);
+				iBuffer.reset();
+				iBuffer = std::make_unique<stream_buffer>(std::max(vertices().size() * 2, std::size_t{ InitialSegmentSize }));
 			}
-			void* data;
-			glCheck(data = glMapNamedBuffer(buffers().position_buffer().handle(), GL_WRITE_ONLY));
-			std::memcpy(data, &vertices()[0][0], vertices().size() * sizeof(vertices()[0]));
-			glCheck(glUnmapNamedBuffer(buffers().position_buffer().handle()));
-			glCheck(data = glMapNamedBuffer(buffers().colour_buffer().handle(), GL_WRITE_ONLY));
-			std::memcpy(data, &colours()[0][0], colours().size() * sizeof(colours()[0]));
-			glCheck(glUnmapNamedBuffer(buffers().colour_buffer().handle()));
-			glCheck(data = glMapNamedBuffer(buffers().texture_coord_buffer().handle(), GL_WRITE_ONLY));
-			std::memcpy(data, &texture_coords()[0][0], texture_coords().size() * sizeof(texture_coords()[0]));
-			glCheck(glUnmapNamedBuffer(buffers().texture_coord_buffer().handle()));
 			if (iInstance.get() == nullptr || iShaderProgram != &aShaderProgram)
 			{
 				iShaderProgram = &aShaderProgram;
 				iInstance.reset();
-				iInstance = std::make_unique<instance>(aShaderProgram, buffers().position_buffer(), buffers().colour_buffer(), buffers().texture_coord_buffer());
+				iInstance = std::make_unique<instance>(aShaderProgram);
+			}
+			std::size_t first = buffer().allocate(vertices().size());
+			vertex* destination = buffer().data(first);
+			for (std::size_t i = 0; i < vertices().size(); ++i, ++destination)
+			{
+				destination->xyz = vertices()[i];
+				destination->rgba = i < colours().size() ? colours()[i] : std::array<uint8_t, 4>{};
+				destination->st = i < texture_coords().size() ? texture_coords()[i] : std::array<float, 2>{};
 			}
+			iInstance->bind(buffer(), first);
 			if (iShaderProgram->has_projection_matrix())
 				iShaderProgram->set_projection_matrix(aGraphicsContext);
 		}
 	private:
-		buffer_instance& buffers()
+		stream_buffer& buffer()
 		{
-			return *iBufferInstance;
+			return *iBuffer;
 		}
 	private:
 		i_rendering_engine::i_shader_program* iShaderProgram;
-		std::unique_ptr<buffer_instance> iBufferInstance;
+		stream_buffer_pointer& iBuffer;
 		std::unique_ptr<instance> iInstance;
-		std::vector<std::array<double, 3>> iVertices;
-		std::vector<std::array<uint8_t, 4>> iColours;
-		std::vector<std::array<double, 2>> iTextureCoords;
+		vertex_array iVertices;
+		colour_array iColours;
+		texture_coord_array iTextureCoords;
 	};
 
 	class use_shader_program
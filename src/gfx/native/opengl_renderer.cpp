@@ -19,6 +19,7 @@
 
 #include <neogfx/neogfx.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
 #ifdef _WIN32
 #include <D2d1.h>
 #endif
@@ -222,18 +223,17 @@ namespace neogfx
 		iRenderer{aRenderer},
 		iFontManager{*this, iScreenMetrics},
 		iActiveProgram{iShaderPrograms.end()},
-		iSubpixelRendering{false}
+		iSubpixelRendering{false},
+		iOperationReordering{false},
+		iGradientLookupTableClock{0}
 	{
 	}
 
 	opengl_renderer::~opengl_renderer()
 	{
-		if (iGradientTextures != boost::none)
-		{
-			glCheck(glDeleteTextures(1, &(*iGradientTextures)[0]));
-			glCheck(glDeleteTextures(1, &(*iGradientTextures)[1]));
-			glCheck(glDeleteTextures(1, &(*iGradientTextures)[2]));
-		}
+		if (iGradientLookupTableTexture != boost::none)
+			glCheck(glDeleteTextures(1, &*iGradientLookupTableTexture));
+		iVertexStreamBuffer.reset();
 	}
 
 	renderer opengl_renderer::renderer() const
@@ -681,36 +681,130 @@ namespace neogfx
 		}
 	}
 
-	const std::array<GLuint, 3>& opengl_renderer::gradient_textures() const
+	bool opengl_renderer::is_operation_reordering_on() const
+	{
+		return iOperationReordering;
+	}
+
+	void opengl_renderer::operation_reordering_on()
+	{
+		iOperationReordering = true;
+	}
+
+	void opengl_renderer::operation_reordering_off()
+	{
+		iOperationReordering = false;
+	}
+
+	std::size_t opengl_renderer::gradient_lookup_table_key_hash::operator()(const gradient_lookup_table_key& aKey) const
+	{
+		std::size_t seed = 0;
+		for (const auto& stop : aKey.stops)
+		{
+			boost::hash_combine(seed, stop.first);
+			boost::hash_combine(seed, stop.second.value());
+		}
+		boost::hash_combine(seed, aKey.smoothness);
+		boost::hash_combine(seed, aKey.extent);
+		return seed;
+	}
+
+	GLuint opengl_renderer::gradient_lookup_table_texture() const
 	{
 		// todo: use texture class
 		glCheck(glEnable(GL_TEXTURE_RECTANGLE));
-		if (iGradientTextures == boost::none)
+		if (iGradientLookupTableTexture == boost::none)
 		{
-			iGradientTextures.emplace(std::array<GLuint, 3>{});
-			glCheck(glGenTextures(1, &(*iGradientTextures)[0]));
-			glCheck(glGenTextures(1, &(*iGradientTextures)[1]));
-			glCheck(glGenTextures(1, &(*iGradientTextures)[2]));
+			iGradientLookupTableTexture.emplace(0);
+			glCheck(glGenTextures(1, &*iGradientLookupTableTexture));
 			GLint previousTexture;
 			glCheck(glGetIntegerv(GL_TEXTURE_BINDING_RECTANGLE, &previousTexture));
-			glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, (*iGradientTextures)[0]));
-			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
-			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
-			static const std::array<float, gradient::MaxStops> sZeroStopPositions = {};
-			glCheck(glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_R32F, static_cast<GLsizei>(gradient::MaxStops), 1, 0, GL_RED, GL_FLOAT, &sZeroStopPositions[0]));
-			glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, (*iGradientTextures)[1]));
-			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
-			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
-			static const std::array<std::array<uint8_t, 4>, gradient::MaxStops> sZeroStopColours = {};
-			glCheck(glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGBA, static_cast<GLsizei>(gradient::MaxStops), 1, 0, GL_RGBA, GL_FLOAT, &sZeroStopColours[0]));
-			glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, (*iGradientTextures)[2]));
-			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
-			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
-			static const std::array<float, GRADIENT_FILTER_SIZE * GRADIENT_FILTER_SIZE> sFilter = {};
-			glCheck(glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_R32F, GRADIENT_FILTER_SIZE, GRADIENT_FILTER_SIZE, 0, GL_RED, GL_FLOAT, &sFilter[0]));
+			glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, *iGradientLookupTableTexture));
+			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+			glCheck(glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGBA8, GRADIENT_LOOKUP_TABLE_SIZE, GRADIENT_LOOKUP_TABLE_CACHE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
 			glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, previousTexture));
 		}
-		return *iGradientTextures;
+		return *iGradientLookupTableTexture;
+	}
+
+	uint32_t opengl_renderer::gradient_lookup_table(const gradient& aGradient, dimension aExtent) const
+	{
+		gradient_lookup_table_key key{ aGradient.combined_stops(), aGradient.smoothness(), 
+			aGradient.smoothness() != 0.0 ? static_cast<uint32_t>(std::ceil(std::max(aExtent, 1.0))) : 0u };
+		auto existing = iGradientLookupTableIndex.find(key);
+		if (existing != iGradientLookupTableIndex.end())
+		{
+			iGradientLookupTables[existing->second].lastUsed = ++iGradientLookupTableClock;
+			return existing->second;
+		}
+		uint32_t row;
+		if (iGradientLookupTables.size() < GRADIENT_LOOKUP_TABLE_CACHE_SIZE)
+		{
+			row = static_cast<uint32_t>(iGradientLookupTables.size());
+			iGradientLookupTables.push_back(gradient_lookup_table_entry{ key, 0 });
+		}
+		else
+		{
+			auto leastRecentlyUsed = std::min_element(iGradientLookupTables.begin(), iGradientLookupTables.end(), 
+				[](const gradient_lookup_table_entry& aLeft, const gradient_lookup_table_entry& aRight)
+			{
+				return aLeft.lastUsed < aRight.lastUsed;
+			});
+			row = static_cast<uint32_t>(leastRecentlyUsed - iGradientLookupTables.begin());
+			iGradientLookupTableIndex.erase(leastRecentlyUsed->key);
+			leastRecentlyUsed->key = key;
+		}
+		iGradientLookupTables[row].lastUsed = ++iGradientLookupTableClock;
+		iGradientLookupTableIndex.emplace(std::move(key), row);
+
+		std::vector<std::array<float, 4>> samples(GRADIENT_LOOKUP_TABLE_SIZE);
+		for (uint32_t i = 0; i < GRADIENT_LOOKUP_TABLE_SIZE; ++i)
+		{
+			colour sample = aGradient.at(static_cast<double>(i) / (GRADIENT_LOOKUP_TABLE_SIZE - 1));
+			samples[i] = std::array<float, 4>{ {sample.red<float>(), sample.green<float>(), sample.blue<float>(), sample.alpha<float>()} };
+		}
+		if (iGradientLookupTables[row].key.extent != 0)
+		{
+			// Across the gradient the smoothing filter (a GRADIENT_FILTER_SIZE square gaussian over pixels) reduces to a 1D gaussian 
+			// along it so it is applied here, once, in texels rather than per fragment.
+			double texelsPerPixel = static_cast<double>(GRADIENT_LOOKUP_TABLE_SIZE - 1) / iGradientLookupTables[row].key.extent;
+			double sigma = aGradient.smoothness() * 10.0 * texelsPerPixel;
+			int32_t radius = static_cast<int32_t>(std::min<double>(std::ceil((GRADIENT_FILTER_SIZE / 2) * texelsPerPixel), GRADIENT_LOOKUP_TABLE_SIZE - 1));
+			std::vector<float> kernel(radius * 2 + 1);
+			float kernelSum = 0.0f;
+			for (int32_t k = -radius; k <= radius; ++k)
+				kernelSum += (kernel[k + radius] = static_cast<float>(std::exp(-(k * k) / (2.0 * sigma * sigma))));
+			std::vector<std::array<float, 4>> smoothed(GRADIENT_LOOKUP_TABLE_SIZE, std::array<float, 4>{});
+			for (int32_t i = 0; i < static_cast<int32_t>(GRADIENT_LOOKUP_TABLE_SIZE); ++i)
+				for (int32_t k = -radius; k <= radius; ++k)
+				{
+					const auto& sample = samples[std::min(std::max(i + k, 0), static_cast<int32_t>(GRADIENT_LOOKUP_TABLE_SIZE) - 1)];
+					float weight = kernel[k + radius] / kernelSum;
+					for (std::size_t c = 0; c < 4; ++c)
+						smoothed[i][c] += sample[c] * weight;
+				}
+			samples.swap(smoothed);
+		}
+		std::vector<std::array<uint8_t, 4>> texels(GRADIENT_LOOKUP_TABLE_SIZE);
+		for (uint32_t i = 0; i < GRADIENT_LOOKUP_TABLE_SIZE; ++i)
+			for (std::size_t c = 0; c < 4; ++c)
+				texels[i][c] = static_cast<uint8_t>(std::min(std::max(samples[i][c], 0.0f), 1.0f) * 255.0f + 0.5f);
+
+		gradient_lookup_table_texture();
+		GLint previousTexture;
+		glCheck(glGetIntegerv(GL_TEXTURE_BINDING_RECTANGLE, &previousTexture));
+		glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, *iGradientLookupTableTexture));
+		glCheck(glTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, row, GRADIENT_LOOKUP_TABLE_SIZE, 1, GL_RGBA, GL_UNSIGNED_BYTE, &texels[0][0]));
+		glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, previousTexture));
+		return row;
+	}
+
+	opengl_standard_vertex_arrays::stream_buffer_pointer& opengl_renderer::vertex_stream_buffer()
+	{
+		return iVertexStreamBuffer;
 	}
 
 	bool opengl_renderer::process_events()
@@ -22,10 +22,12 @@
 #include <neogfx/neogfx.hpp>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include "opengl.hpp"
 #include <neogfx/gfx/i_rendering_engine.hpp>
 #include <neogfx/gfx/text/font_manager.hpp>
 #include "opengl_texture_manager.hpp"
+#include "opengl_helpers.hpp"
 
 std::string glErrorString(GLenum aErrorCode);
 GLenum glCheckError(const char* file, unsigned int line);
@@ -126,13 +128,43 @@ namespace neogfx
 		virtual bool is_subpixel_rendering_on() const;
 		virtual void subpixel_rendering_on();
 		virtual void subpixel_rendering_off();
+		virtual bool is_operation_reordering_on() const;
+		virtual void operation_reordering_on();
+		virtual void operation_reordering_off();
 	public:
 		static const uint32_t GRADIENT_FILTER_SIZE = 33;
-		const std::array<GLuint, 3>& gradient_textures() const; // todo: use texture class and add to base class interface
+		static const uint32_t GRADIENT_LOOKUP_TABLE_SIZE = 1024;
+		static const uint32_t GRADIENT_LOOKUP_TABLE_CACHE_SIZE = 64;
+		GLuint gradient_lookup_table_texture() const; // todo: use texture class and add to base class interface
+		uint32_t gradient_lookup_table(const gradient& aGradient, dimension aExtent) const;
+		opengl_standard_vertex_arrays::stream_buffer_pointer& vertex_stream_buffer();
 	public:
 		virtual bool process_events();
 	private:
 		shader_programs::iterator create_shader_program(const shaders& aShaders, const std::vector<std::string>& aVariables);
+	private:
+		// A baked gradient (one row of the lookup table texture) depends only on its stops and smoothness (plus, if smoothed, the
+		// extent in pixels the smoothing filter is relative to).
+		struct gradient_lookup_table_key
+		{
+			gradient::colour_stop_list stops;
+			double smoothness;
+			uint32_t extent;
+			bool operator==(const gradient_lookup_table_key& aOther) const
+			{
+				return stops == aOther.stops && smoothness == aOther.smoothness && extent == aOther.extent;
+			}
+		};
+		struct gradient_lookup_table_key_hash
+		{
+			std::size_t operator()(const gradient_lookup_table_key& aKey) const;
+		};
+		struct gradient_lookup_table_entry
+		{
+			gradient_lookup_table_key key;
+			uint64_t lastUsed;
+		};
+		typedef std::unordered_map<gradient_lookup_table_key, uint32_t, gradient_lookup_table_key_hash> gradient_lookup_table_index;
 	private:
 		neogfx::renderer iRenderer;
 		detail::screen_metrics iScreenMetrics;		
@@ -147,6 +179,11 @@ namespace neogfx
 		shader_programs::iterator iGlyphSubpixelProgram;
 		shader_programs::iterator iGradientProgram;
 		bool iSubpixelRendering;
-		mutable boost::optional<std::array<GLuint, 3>> iGradientTextures;
+		bool iOperationReordering;
+		mutable boost::optional<GLuint> iGradientLookupTableTexture;
+		mutable std::vector<gradient_lookup_table_entry> iGradientLookupTables;
+		mutable gradient_lookup_table_index iGradientLookupTableIndex;
+		mutable uint64_t iGradientLookupTableClock;
+		opengl_standard_vertex_arrays::stream_buffer_pointer iVertexStreamBuffer;
 	};
 }
\ No newline at end of file
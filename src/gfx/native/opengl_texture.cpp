@@ -89,7 +89,7 @@ namespace neogfx
 		}
 	}
 
-	opengl_texture::opengl_texture(const i_image& aImage) :
+	opengl_texture::opengl_texture(const i_image& aImage, texture_upload aUpload) :
 		iSampling(aImage.sampling()),
 		iSize(aImage.extents()), 
 		iStorageSize{size{std::max(std::pow(2.0, std::ceil(std::log2(iSize.cx + 2))), 16.0), std::max(std::pow(2.0, std::ceil(std::log2(iSize.cy + 2))), 16.0)}},
@@ -115,6 +115,17 @@ namespace neogfx
 			switch (aImage.colour_format())
 			{
 			case colour_format::RGBA8:
+				if (aUpload == texture_upload::Staged)
+				{
+					// storage only (cleared to transparent); pixels are uploaded later by texture_manager::process_uploads
+					glCheck(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, static_cast<GLsizei>(iStorageSize.cx), static_cast<GLsizei>(iStorageSize.cy), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+					glCheck(glClearTexImage(iHandle, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+					if (iSampling == texture_sampling::NormalMipmap)
+					{
+						glCheck(glGenerateMipmap(GL_TEXTURE_2D));
+					}
+				}
+				else
 				{
 					const uint8_t* imageData = static_cast<const uint8_t*>(aImage.data());
 					std::vector<uint8_t> data(iStorageSize.cx * 4 * iStorageSize.cy);
@@ -163,6 +174,16 @@ namespace neogfx
 	}
 
 	void opengl_texture::set_pixels(const rect& aRect, const void* aPixelData)
+	{
+		set_pixels(aRect, aPixelData, true);
+	}
+
+	void opengl_texture::set_pixels(const rect& aRect, const void* aPixelData, bool aGenerateMipmaps)
+	{
+		set_storage_pixels(aRect + point{ 1.0, 1.0 }, aPixelData, aGenerateMipmaps);
+	}
+
+	void opengl_texture::set_storage_pixels(const rect& aStorageRect, const void* aPixelData, bool aGenerateMipmaps)
 	{
 		GLint previousTexture;
 		if (iSampling == texture_sampling::Normal || iSampling == texture_sampling::NormalMipmap)
@@ -170,9 +191,9 @@ namespace neogfx
 			glCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
 			glCheck(glBindTexture(GL_TEXTURE_2D, iHandle));
 			glCheck(glTexSubImage2D(GL_TEXTURE_2D, 0,
-				static_cast<GLint>(aRect.x + 1.0), static_cast<GLint>(aRect.y + 1.0), static_cast<GLsizei>(aRect.cx), static_cast<GLsizei>(aRect.cy),
+				static_cast<GLint>(aStorageRect.x), static_cast<GLint>(aStorageRect.y), static_cast<GLsizei>(aStorageRect.cx), static_cast<GLsizei>(aStorageRect.cy),
 				GL_RGBA, GL_UNSIGNED_BYTE, aPixelData));
-			if (iSampling == texture_sampling::NormalMipmap)
+			if (iSampling == texture_sampling::NormalMipmap && aGenerateMipmaps)
 			{
 				glCheck(glGenerateMipmap(GL_TEXTURE_2D));
 			}
@@ -182,6 +203,29 @@ namespace neogfx
 			throw multisample_texture_initialization_unsupported();
 	}
 
+	void opengl_texture::clear_pixels(const rect& aRect)
+	{
+		if (iSampling == texture_sampling::Normal || iSampling == texture_sampling::NormalMipmap)
+		{
+			glCheck(glClearTexSubImage(iHandle, 0,
+				static_cast<GLint>(aRect.x + 1.0), static_cast<GLint>(aRect.y + 1.0), 0, static_cast<GLsizei>(aRect.cx), static_cast<GLsizei>(aRect.cy), 1,
+				GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+		}
+		else
+			throw multisample_texture_initialization_unsupported();
+	}
+
+	void opengl_texture::generate_mipmaps()
+	{
+		if (iSampling != texture_sampling::NormalMipmap)
+			return;
+		GLint previousTexture;
+		glCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
+		glCheck(glBindTexture(GL_TEXTURE_2D, iHandle));
+		glCheck(glGenerateMipmap(GL_TEXTURE_2D));
+		glCheck(glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture)));
+	}
+
 	void* opengl_texture::handle() const
 	{
 		return reinterpret_cast<void*>(iHandle);
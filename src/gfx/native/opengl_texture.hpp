@@ -34,13 +34,17 @@ namespace neogfx
 		struct multisample_texture_initialization_unsupported : std::runtime_error{ multisample_texture_initialization_unsupported() : std::runtime_error("neogfx::opengl_texture::multisample_texture_initialization_unsupported") {} };
 	public:
 		opengl_texture(const neogfx::size& aExtents, texture_sampling aSampling = texture_sampling::NormalMipmap, const optional_colour& aColour = optional_colour());
-		opengl_texture(const i_image& aImage);
+		opengl_texture(const i_image& aImage, texture_upload aUpload = texture_upload::Immediate);
 		~opengl_texture();
 	public:
 		virtual texture_sampling sampling() const;
 		virtual size extents() const;
 		virtual size storage_extents() const;
 		virtual void set_pixels(const rect& aRect, const void* aPixelData);
+		virtual void set_pixels(const rect& aRect, const void* aPixelData, bool aGenerateMipmaps);
+		virtual void set_storage_pixels(const rect& aStorageRect, const void* aPixelData, bool aGenerateMipmaps);
+		virtual void clear_pixels(const rect& aRect);
+		virtual void generate_mipmaps();
 	public:
 		virtual void* handle() const;
 		virtual bool is_resident() const;
@@ -28,11 +28,23 @@ namespace neogfx
 		return add_texture(std::make_shared<opengl_texture>(aExtents, aSampling, aColour));
 	}
 
-	std::unique_ptr<i_native_texture> opengl_texture_manager::create_texture(const i_image& aImage)
+	std::unique_ptr<i_native_texture> opengl_texture_manager::create_texture(const i_image& aImage, texture_upload aUpload)
 	{
 		auto existing = find_texture(aImage);
 		if (existing != textures().end())
 			return join_texture(*existing->lock());
-		return add_texture(std::make_shared<opengl_texture>(aImage));
+		auto newTexture = std::make_shared<opengl_texture>(aImage, aUpload);
+		if (aUpload == texture_upload::Staged)
+		{
+			// upload includes the one pixel border around the image so edge sampling matches an immediate upload
+			std::size_t width = static_cast<std::size_t>(aImage.extents().cx);
+			std::size_t height = static_cast<std::size_t>(aImage.extents().cy);
+			i_resource::data_type pixels((width + 2) * (height + 2) * 4);
+			const uint8_t* imageData = static_cast<const uint8_t*>(aImage.cdata());
+			for (std::size_t y = 0; y < height; ++y)
+				std::copy(imageData + y * width * 4, imageData + (y + 1) * width * 4, &pixels[((y + 1) * (width + 2) + 1) * 4]);
+			queue_upload(newTexture, rect{ point{ -1.0, -1.0 }, size{ static_cast<dimension>(width + 2), static_cast<dimension>(height + 2) } }, std::move(pixels));
+		}
+		return add_texture(newTexture);
 	}
 }
\ No newline at end of file
@@ -28,6 +28,6 @@ namespace neogfx
 	{
 	public:
 		virtual std::unique_ptr<i_native_texture> create_texture(const neogfx::size& aExtents, texture_sampling aSampling = texture_sampling::NormalMipmap, const optional_colour& aColour = optional_colour());
-		virtual std::unique_ptr<i_native_texture> create_texture(const i_image& aImage);
+		virtual std::unique_ptr<i_native_texture> create_texture(const i_image& aImage, texture_upload aUpload = texture_upload::Immediate);
 	};
 }
\ No newline at end of file
@@ -49,9 +49,12 @@ namespace neogfx
 		opengl_renderer(aRenderer),
 		iDoubleBuffering(aDoubleBufferedWindows),
 		iBasicServices(aBasicServices), iKeyboard(aKeyboard), iCreatingWindow(0), 
-		iContext(nullptr), iActiveContextSurface(nullptr)
+		iContext(nullptr), iActiveContextSurface(nullptr), iWakePending(false)
 	{
 		sdl_instance::instantiate();
+		iWakeEventType = SDL_RegisterEvents(1);
+		if (iWakeEventType == static_cast<uint32_t>(-1))
+			iWakeEventType = SDL_USEREVENT;
 		SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, aDoubleBufferedWindows ? 1 : 0);
 		switch (aRenderer)
 		{
@@ -201,12 +204,36 @@ namespace neogfx
 			return false;
 	}
 
+	bool sdl_renderer::wait_for_events(const boost::optional<uint32_t>& aTimeout_ms)
+	{
+		// Peek only (null event); the event, if any, is left for queue_events() to dispatch.
+		if (aTimeout_ms == boost::none)
+			return SDL_WaitEvent(NULL) == 1;
+		return SDL_WaitEventTimeout(NULL, static_cast<int>(*aTimeout_ms)) == 1;
+	}
+
+	void sdl_renderer::wake()
+	{
+		if (iWakePending.exchange(true))
+			return;
+		SDL_Event event;
+		SDL_zero(event);
+		event.type = iWakeEventType;
+		if (SDL_PushEvent(&event) != 1)
+			iWakePending = false;
+	}
+
 	bool sdl_renderer::queue_events()
 	{
 		bool queuedEvents = false;
 		SDL_Event event;
 		while (SDL_PollEvent(&event))
 		{
+			if (event.type == iWakeEventType)
+			{
+				iWakePending = false;
+				continue;
+			}
 			queuedEvents = true;
 			switch (event.type)
 			{
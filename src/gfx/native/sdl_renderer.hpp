@@ -22,6 +22,7 @@
 #include <neogfx/neogfx.hpp>
 #include <set>
 #include <map>
+#include <atomic>
 #include "opengl_renderer.hpp"
 #include <neogfx/app/i_basic_services.hpp>
 #include <neogfx/hid/keyboard.hpp>
@@ -56,6 +57,8 @@ namespace neogfx
 		virtual void render_now();
 	public:
 		virtual bool process_events();
+		virtual bool wait_for_events(const boost::optional<uint32_t>& aTimeout_ms);
+		virtual void wake();
 	private:
 		bool queue_events();
 	private:
@@ -66,5 +69,7 @@ namespace neogfx
 		opengl_context iContext;
 		uint32_t iCreatingWindow;
 		const i_native_surface* iActiveContextSurface;
+		uint32_t iWakeEventType;
+		std::atomic<bool> iWakePending;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,257 @@
+// software_frame_buffer.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <algorithm>
+#include "software_frame_buffer.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NEOGFX_SOFTWARE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace neogfx
+{
+	namespace
+	{
+		inline uint32_t div255(uint32_t aValue)
+		{
+			aValue += 128;
+			return (aValue + (aValue >> 8)) >> 8;
+		}
+
+		inline software_frame_buffer::pixel blend_pixel(software_frame_buffer::pixel aSource, software_frame_buffer::pixel aDestination)
+		{
+			uint32_t alpha = aSource >> 24;
+			if (alpha == 0xFF)
+				return aSource;
+			if (alpha == 0x00)
+				return aDestination;
+			uint32_t inverseAlpha = 0xFF - alpha;
+			software_frame_buffer::pixel result = 0;
+			for (uint32_t shift = 0; shift < 32; shift += 8)
+				result |= div255(((aSource >> shift) & 0xFF) * alpha + ((aDestination >> shift) & 0xFF) * inverseAlpha) << shift;
+			return result;
+		}
+	}
+
+	software_frame_buffer::software_frame_buffer() :
+		iWidth(0), iHeight(0)
+	{
+	}
+
+	software_frame_buffer::software_frame_buffer(const size& aExtents, const colour& aColour) :
+		iWidth(static_cast<int32_t>(std::ceil(aExtents.cx))),
+		iHeight(static_cast<int32_t>(std::ceil(aExtents.cy))),
+		iPixels(static_cast<std::size_t>(iWidth) * iHeight, to_pixel(aColour))
+	{
+	}
+
+	size software_frame_buffer::extents() const
+	{
+		return size{ static_cast<dimension>(iWidth), static_cast<dimension>(iHeight) };
+	}
+
+	int32_t software_frame_buffer::width() const
+	{
+		return iWidth;
+	}
+
+	int32_t software_frame_buffer::height() const
+	{
+		return iHeight;
+	}
+
+	void software_frame_buffer::resize(const size& aExtents)
+	{
+		int32_t newWidth = static_cast<int32_t>(std::ceil(aExtents.cx));
+		int32_t newHeight = static_cast<int32_t>(std::ceil(aExtents.cy));
+		if (newWidth == iWidth && newHeight == iHeight)
+			return;
+		std::vector<pixel> newPixels(static_cast<std::size_t>(newWidth) * newHeight);
+		for (int32_t y = 0; y < std::min(iHeight, newHeight); ++y)
+			std::copy(scanline(y), scanline(y) + std::min(iWidth, newWidth), &newPixels[static_cast<std::size_t>(y) * newWidth]);
+		iWidth = newWidth;
+		iHeight = newHeight;
+		iPixels.swap(newPixels);
+	}
+
+	const software_frame_buffer::pixel* software_frame_buffer::pixels() const
+	{
+		return iPixels.empty() ? nullptr : &iPixels[0];
+	}
+
+	software_frame_buffer::pixel* software_frame_buffer::pixels()
+	{
+		return iPixels.empty() ? nullptr : &iPixels[0];
+	}
+
+	const software_frame_buffer::pixel* software_frame_buffer::scanline(int32_t aY) const
+	{
+		return &iPixels[static_cast<std::size_t>(aY) * iWidth];
+	}
+
+	software_frame_buffer::pixel* software_frame_buffer::scanline(int32_t aY)
+	{
+		return &iPixels[static_cast<std::size_t>(aY) * iWidth];
+	}
+
+	colour software_frame_buffer::get_pixel(int32_t aX, int32_t aY) const
+	{
+		if (aX < 0 || aY < 0 || aX >= iWidth || aY >= iHeight)
+			return colour{ 0x00, 0x00, 0x00, 0x00 };
+		return to_colour(scanline(aY)[aX]);
+	}
+
+	void software_frame_buffer::set_pixel(int32_t aX, int32_t aY, const colour& aColour)
+	{
+		if (aX < 0 || aY < 0 || aX >= iWidth || aY >= iHeight)
+			return;
+		scanline(aY)[aX] = to_pixel(aColour);
+	}
+
+	void software_frame_buffer::fill_span(int32_t aX, int32_t aY, int32_t aLength, const colour& aColour)
+	{
+		if (!clip_span(aX, aY, aLength))
+			return;
+		pixel* destination = scanline(aY) + aX;
+		const pixel value = to_pixel(aColour);
+#ifdef NEOGFX_SOFTWARE_SSE2
+		const __m128i source = _mm_set1_epi32(static_cast<int>(value));
+		for (; aLength >= 4; aLength -= 4, destination += 4)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination), source);
+#endif
+		std::fill(destination, destination + aLength, value);
+	}
+
+	void software_frame_buffer::blend_span(int32_t aX, int32_t aY, int32_t aLength, const colour& aColour)
+	{
+		if (aColour.alpha() == 0xFF)
+		{
+			fill_span(aX, aY, aLength, aColour);
+			return;
+		}
+		if (aColour.alpha() == 0x00 || !clip_span(aX, aY, aLength))
+			return;
+		pixel* destination = scanline(aY) + aX;
+		const pixel value = to_pixel(aColour);
+#ifdef NEOGFX_SOFTWARE_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i alpha = _mm_set1_epi16(static_cast<short>(aColour.alpha()));
+		const __m128i inverseAlpha = _mm_set1_epi16(static_cast<short>(0xFF - aColour.alpha()));
+		const __m128i sourceTerm = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(value)), zero), alpha), _mm_set1_epi16(128));
+		for (; aLength >= 4; aLength -= 4, destination += 4)
+		{
+			__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination));
+			__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inverseAlpha), sourceTerm);
+			__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inverseAlpha), sourceTerm);
+			lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+			hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm_packus_epi16(lo, hi));
+		}
+#endif
+		for (; aLength > 0; --aLength, ++destination)
+			*destination = blend_pixel(value, *destination);
+	}
+
+	void software_frame_buffer::blend_span(int32_t aX, int32_t aY, int32_t aLength, const pixel* aSource)
+	{
+		int32_t sourceOffset = 0;
+		if (!clip_span(aX, aY, aLength, &sourceOffset))
+			return;
+		pixel* destination = scanline(aY) + aX;
+		const pixel* source = aSource + sourceOffset;
+#ifdef NEOGFX_SOFTWARE_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i maxComponent = _mm_set1_epi16(0xFF);
+		const __m128i rounding = _mm_set1_epi16(128);
+		for (; aLength >= 4; aLength -= 4, destination += 4, source += 4)
+		{
+			__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+			__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination));
+			__m128i sLo = _mm_unpacklo_epi8(s, zero);
+			__m128i sHi = _mm_unpackhi_epi8(s, zero);
+			__m128i aLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			__m128i aHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			__m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(sLo, aLo), _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(maxComponent, aLo))), rounding);
+			__m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(sHi, aHi), _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(maxComponent, aHi))), rounding);
+			lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+			hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm_packus_epi16(lo, hi));
+		}
+#endif
+		for (; aLength > 0; --aLength, ++destination, ++source)
+			*destination = blend_pixel(*source, *destination);
+	}
+
+	void software_frame_buffer::xor_span(int32_t aX, int32_t aY, int32_t aLength, const pixel* aSource)
+	{
+		int32_t sourceOffset = 0;
+		if (!clip_span(aX, aY, aLength, &sourceOffset))
+			return;
+		pixel* destination = scanline(aY) + aX;
+		const pixel* source = aSource + sourceOffset;
+		for (; aLength > 0; --aLength, ++destination, ++source)
+			if ((*source >> 24) != 0x00)
+				*destination ^= (*source & 0x00FFFFFF);
+	}
+
+	void software_frame_buffer::fill_rect(const rect& aRect, const colour& aColour)
+	{
+		int32_t x = static_cast<int32_t>(std::ceil(aRect.x - 0.5));
+		int32_t length = static_cast<int32_t>(std::ceil(aRect.right() - 0.5)) - x;
+		int32_t top = std::max(static_cast<int32_t>(std::ceil(aRect.y - 0.5)), 0);
+		int32_t bottom = std::min(static_cast<int32_t>(std::ceil(aRect.bottom() - 0.5)), iHeight);
+		for (int32_t y = top; y < bottom; ++y)
+			fill_span(x, y, length, aColour);
+	}
+
+	software_frame_buffer::pixel software_frame_buffer::to_pixel(const colour& aColour)
+	{
+		return static_cast<pixel>(aColour.red()) |
+			(static_cast<pixel>(aColour.green()) << 8) |
+			(static_cast<pixel>(aColour.blue()) << 16) |
+			(static_cast<pixel>(aColour.alpha()) << 24);
+	}
+
+	colour software_frame_buffer::to_colour(pixel aPixel)
+	{
+		return colour{
+			static_cast<colour::component>(aPixel & 0xFF),
+			static_cast<colour::component>((aPixel >> 8) & 0xFF),
+			static_cast<colour::component>((aPixel >> 16) & 0xFF),
+			static_cast<colour::component>((aPixel >> 24) & 0xFF) };
+	}
+
+	bool software_frame_buffer::clip_span(int32_t& aX, int32_t aY, int32_t& aLength, int32_t* aSourceOffset) const
+	{
+		if (aY < 0 || aY >= iHeight || aLength <= 0)
+			return false;
+		if (aX < 0)
+		{
+			if (aSourceOffset != nullptr)
+				*aSourceOffset = -aX;
+			aLength += aX;
+			aX = 0;
+		}
+		if (aX + aLength > iWidth)
+			aLength = iWidth - aX;
+		return aLength > 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+// software_frame_buffer.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <vector>
+#include <neogfx/core/geometry.hpp>
+#include <neogfx/core/colour.hpp>
+
+namespace neogfx
+{
+	// In-memory RGBA8 render target (top-down rows, non-premultiplied alpha, bytes in R, G, B, A memory order so the
+	// contents can be handed directly to anything expecting GL_RGBA/GL_UNSIGNED_BYTE data).
+	// Blending matches glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA) as used by opengl_graphics_context.
+	class software_frame_buffer
+	{
+	public:
+		typedef uint32_t pixel;
+	public:
+		software_frame_buffer();
+		software_frame_buffer(const size& aExtents, const colour& aColour = colour{ 0x00, 0x00, 0x00, 0x00 });
+	public:
+		size extents() const;
+		int32_t width() const;
+		int32_t height() const;
+		void resize(const size& aExtents);
+		const pixel* pixels() const;
+		pixel* pixels();
+		const pixel* scanline(int32_t aY) const;
+		pixel* scanline(int32_t aY);
+		colour get_pixel(int32_t aX, int32_t aY) const;
+		void set_pixel(int32_t aX, int32_t aY, const colour& aColour);
+	public:
+		void fill_span(int32_t aX, int32_t aY, int32_t aLength, const colour& aColour);
+		void blend_span(int32_t aX, int32_t aY, int32_t aLength, const colour& aColour);
+		void blend_span(int32_t aX, int32_t aY, int32_t aLength, const pixel* aSource);
+		void xor_span(int32_t aX, int32_t aY, int32_t aLength, const pixel* aSource);
+		void fill_rect(const rect& aRect, const colour& aColour);
+	public:
+		static pixel to_pixel(const colour& aColour);
+		static colour to_colour(pixel aPixel);
+	private:
+		bool clip_span(int32_t& aX, int32_t aY, int32_t& aLength, int32_t* aSourceOffset = nullptr) const;
+	private:
+		int32_t iWidth;
+		int32_t iHeight;
+		std::vector<pixel> iPixels;
+	};
+}
\ No newline at end of file
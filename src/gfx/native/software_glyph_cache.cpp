@@ -0,0 +1,111 @@
+// software_glyph_cache.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include "../text/native/native_font_face.hpp"
+#include "../text/native/glyph_bitmap.hpp"
+#include "software_glyph_cache.hpp"
+
+namespace neogfx
+{
+	software_glyph_cache::software_glyph_cache() :
+		iBudget{ kDefaultBudget },
+		iMemoryUsage{ 0u },
+		iUse{ 0u },
+		iUseAtLastTrim{ 0u }
+	{
+	}
+
+	uint64_t software_glyph_cache::budget() const
+	{
+		return iBudget;
+	}
+
+	void software_glyph_cache::set_budget(uint64_t aBudgetInBytes)
+	{
+		iBudget = aBudgetInBytes;
+	}
+
+	uint64_t software_glyph_cache::memory_usage() const
+	{
+		return iMemoryUsage;
+	}
+
+	const software_glyph_cache::glyph_bitmap& software_glyph_cache::rasterize(const i_native_font_face& aFace, const glyph& aGlyph)
+	{
+		key glyphKey{ aFace.family_name(), aFace.style_name(), aFace.size(), aFace.horizontal_dpi(), aFace.vertical_dpi(), aGlyph.value(), aGlyph.subpixel() };
+		auto existing = iGlyphs.find(glyphKey);
+		if (existing != iGlyphs.end())
+		{
+			existing->second.lastUsed = ++iUse;
+			iUseOrder.splice(iUseOrder.end(), iUseOrder, existing->second.use);
+			return existing->second.bitmap;
+		}
+
+		FT_Face face = static_cast<FT_Face>(aFace.handle());
+		freetypeCheck(FT_Load_Glyph(face, aGlyph.value(), aGlyph.subpixel() ? FT_LOAD_TARGET_LCD : FT_LOAD_TARGET_NORMAL));
+		freetypeCheck(FT_Render_Glyph(face->glyph, aGlyph.subpixel() ? FT_RENDER_MODE_LCD : FT_RENDER_MODE_NORMAL));
+		const FT_Bitmap& bitmap = face->glyph->bitmap;
+
+		glyph_bitmap result;
+		result.subpixel = aGlyph.subpixel();
+		result.width = static_cast<int32_t>(bitmap.width / (aGlyph.subpixel() ? 3 : 1));
+		result.height = static_cast<int32_t>(bitmap.rows);
+		result.placement = point{
+			face->glyph->metrics.horiBearingX / 64.0,
+			(face->glyph->metrics.horiBearingY - face->glyph->metrics.height) / 64.0 };
+		if (aGlyph.subpixel())
+		{
+			// same sub-pixel FIR filter as glyph_rasterizer::rasterize
+			result.coverage.resize(static_cast<std::size_t>(result.width) * result.height * 3);
+			if (result.width > 0)
+				for (uint32_t y = 0; y < bitmap.rows; ++y)
+					lcd_filter_row(bitmap.buffer + bitmap.pitch * static_cast<std::ptrdiff_t>(y), static_cast<uint32_t>(result.width) * 3, &result.coverage[y * result.width * 3]);
+		}
+		else
+		{
+			result.coverage.resize(static_cast<std::size_t>(result.width) * result.height);
+			for (uint32_t y = 0; y < bitmap.rows; ++y)
+				std::copy(bitmap.buffer + bitmap.pitch * static_cast<std::ptrdiff_t>(y), bitmap.buffer + bitmap.pitch * static_cast<std::ptrdiff_t>(y) + bitmap.width, result.coverage.begin() + y * result.width);
+		}
+
+		iMemoryUsage += memory_usage(result);
+		auto use = iUseOrder.insert(iUseOrder.end(), glyphKey);
+		return iGlyphs.emplace(glyphKey, entry{ std::move(result), ++iUse, use }).first->second.bitmap;
+	}
+
+	void software_glyph_cache::trim()
+	{
+		while (iBudget != 0u && iMemoryUsage > iBudget && !iUseOrder.empty())
+		{
+			auto coldest = iGlyphs.find(iUseOrder.front());
+			if (coldest->second.lastUsed > iUseAtLastTrim)
+				break;
+			iMemoryUsage -= memory_usage(coldest->second.bitmap);
+			iGlyphs.erase(coldest);
+			iUseOrder.pop_front();
+		}
+		iUseAtLastTrim = iUse;
+	}
+
+	uint64_t software_glyph_cache::memory_usage(const glyph_bitmap& aBitmap)
+	{
+		return sizeof(glyph_map::value_type) + aBitmap.coverage.capacity();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+// software_glyph_cache.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <map>
+#include <list>
+#include <tuple>
+#include <vector>
+#include <neogfx/core/geometry.hpp>
+#include <neogfx/gfx/text/font.hpp>
+#include <neogfx/gfx/text/glyph.hpp>
+
+namespace neogfx
+{
+	class i_native_font_face;
+
+	// Coverage bitmaps of glyphs drawn by software_graphics_context. Like the glyph atlas it is kept under a byte
+	// budget: trim() (called once a frame has been rendered) evicts least recently used glyphs not used since the
+	// previous trim so glyph references held while a frame is rendered stay valid.
+	class software_glyph_cache
+	{
+	public:
+		struct glyph_bitmap
+		{
+			int32_t width;
+			int32_t height;
+			point placement;
+			bool subpixel;
+			std::vector<uint8_t> coverage;
+		};
+	private:
+		// keyed on face attributes rather than face address as native font faces come and go with their fonts
+		typedef std::tuple<std::string, std::string, font::point_size, dimension, dimension, glyph::value_type, bool> key;
+		typedef std::list<key> use_list;
+		struct entry
+		{
+			glyph_bitmap bitmap;
+			uint64_t lastUsed;
+			use_list::iterator use;
+		};
+		typedef std::map<key, entry> glyph_map;
+	public:
+		static const uint64_t kDefaultBudget = 8u * 1024u * 1024u;
+	public:
+		software_glyph_cache();
+	public:
+		uint64_t budget() const;
+		void set_budget(uint64_t aBudgetInBytes);
+		uint64_t memory_usage() const;
+		const glyph_bitmap& rasterize(const i_native_font_face& aFace, const glyph& aGlyph);
+		void trim();
+	private:
+		static uint64_t memory_usage(const glyph_bitmap& aBitmap);
+	private:
+		glyph_map iGlyphs;
+		use_list iUseOrder;
+		uint64_t iBudget;
+		uint64_t iMemoryUsage;
+		uint64_t iUse;
+		uint64_t iUseAtLastTrim;
+	};
+}
\ No newline at end of file
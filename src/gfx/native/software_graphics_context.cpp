@@ -0,0 +1,1168 @@
+// software_graphics_context.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <limits>
+#include <neogfx/app/app.hpp>
+#include <neogfx/gfx/text/glyph.hpp>
+#include <neogfx/gfx/i_rendering_engine.hpp>
+#include <neogfx/gfx/i_sub_texture.hpp>
+#include <neogfx/gfx/text/i_emoji_atlas.hpp>
+#include "../../hid/native/i_native_surface.hpp"
+#include "i_native_texture.hpp"
+#include "vertex_helpers.hpp"
+#include "software_graphics_context.hpp"
+
+namespace neogfx
+{
+	namespace
+	{
+		inline uint32_t div255(uint32_t aValue)
+		{
+			aValue += 128;
+			return (aValue + (aValue >> 8)) >> 8;
+		}
+
+		software_frame_buffer::pixel sample(const software_frame_buffer& aTexture, const rect& aTextureRect, double aU, double aV, bool aBilinear)
+		{
+			auto texel = [&](int32_t aX, int32_t aY)
+			{
+				aX = std::max(static_cast<int32_t>(aTextureRect.x), std::min(aX, static_cast<int32_t>(aTextureRect.right()) - 1));
+				aY = std::max(static_cast<int32_t>(aTextureRect.y), std::min(aY, static_cast<int32_t>(aTextureRect.bottom()) - 1));
+				return aTexture.scanline(aY)[aX];
+			};
+			if (!aBilinear)
+				return texel(static_cast<int32_t>(std::floor(aU)), static_cast<int32_t>(std::floor(aV)));
+			double u = aU - 0.5;
+			double v = aV - 0.5;
+			int32_t x = static_cast<int32_t>(std::floor(u));
+			int32_t y = static_cast<int32_t>(std::floor(v));
+			uint32_t fx = static_cast<uint32_t>((u - x) * 256.0);
+			uint32_t fy = static_cast<uint32_t>((v - y) * 256.0);
+			software_frame_buffer::pixel p00 = texel(x, y), p10 = texel(x + 1, y), p01 = texel(x, y + 1), p11 = texel(x + 1, y + 1);
+			software_frame_buffer::pixel result = 0;
+			for (uint32_t shift = 0; shift < 32; shift += 8)
+			{
+				uint32_t top = ((p00 >> shift) & 0xFF) * (256 - fx) + ((p10 >> shift) & 0xFF) * fx;
+				uint32_t bottom = ((p01 >> shift) & 0xFF) * (256 - fx) + ((p11 >> shift) & 0xFF) * fx;
+				result |= (((top * (256 - fy) + bottom * fy) >> 16) & 0xFF) << shift;
+			}
+			return result;
+		}
+
+		inline double ellipse_radius(double aCx, double aCy, double aAngle)
+		{
+			return aCx * aCy / std::sqrt(aCx * aCx * std::sin(aAngle) * std::sin(aAngle) + aCy * aCy * std::cos(aAngle) * std::cos(aAngle));
+		}
+	}
+
+	software_graphics_context::software_graphics_context(const i_native_surface& aSurface, software_frame_buffer& aFrameBuffer, software_glyph_cache& aGlyphCache) :
+		iSurface(aSurface),
+		iFrameBuffer(aFrameBuffer),
+		iGlyphCache(aGlyphCache),
+		iLogicalCoordinateSystem(aSurface.logical_coordinate_system()),
+		iLogicalCoordinates(aSurface.logical_coordinates()),
+		iSmoothingMode(neogfx::smoothing_mode::AntiAlias),
+		iSubpixelRendering(false),
+		iClipCounter(0)
+	{
+		update_bounds();
+	}
+
+	software_graphics_context::software_graphics_context(const i_native_surface& aSurface, software_frame_buffer& aFrameBuffer, software_glyph_cache& aGlyphCache, const i_widget& aWidget) :
+		iSurface(aSurface),
+		iFrameBuffer(aFrameBuffer),
+		iGlyphCache(aGlyphCache),
+		iLogicalCoordinateSystem(aWidget.logical_coordinate_system()),
+		iLogicalCoordinates(aSurface.logical_coordinates()),
+		iSmoothingMode(neogfx::smoothing_mode::AntiAlias),
+		iSubpixelRendering(false),
+		iClipCounter(0)
+	{
+		update_bounds();
+	}
+
+	software_graphics_context::software_graphics_context(const software_graphics_context& aOther) :
+		iSurface(aOther.iSurface),
+		iFrameBuffer(aOther.iFrameBuffer),
+		iGlyphCache(aOther.iGlyphCache),
+		iLogicalCoordinateSystem(aOther.iLogicalCoordinateSystem),
+		iLogicalCoordinates(aOther.iLogicalCoordinates),
+		iSmoothingMode(aOther.iSmoothingMode),
+		iSubpixelRendering(aOther.iSubpixelRendering),
+		iClipCounter(0)
+	{
+		update_bounds();
+	}
+
+	software_graphics_context::~software_graphics_context()
+	{
+		flush();
+	}
+
+	std::unique_ptr<i_native_graphics_context> software_graphics_context::clone() const
+	{
+		return std::unique_ptr<i_native_graphics_context>(new software_graphics_context(*this));
+	}
+
+	const i_native_surface& software_graphics_context::surface() const
+	{
+		return iSurface;
+	}
+
+	software_frame_buffer& software_graphics_context::frame_buffer() const
+	{
+		return iFrameBuffer;
+	}
+
+	rect software_graphics_context::rendering_area(bool aConsiderScissor) const
+	{
+		rect result{ point{}, iFrameBuffer.extents() };
+		if (aConsiderScissor && scissor_rect() != boost::none)
+			result = result.intersection(*scissor_rect());
+		return result;
+	}
+
+	void software_graphics_context::enqueue(const graphics_operation::operation& aOperation)
+	{
+		if (!iQueue.empty() && graphics_operation::batchable(iQueue.back().back(), aOperation))
+			iQueue.back().push_back(aOperation);
+		else
+			iQueue.push_back(graphics_operation::batch{ { aOperation } });
+	}
+
+	void software_graphics_context::flush()
+	{
+		update_bounds();
+		while (!iQueue.empty())
+		{
+			const auto& opBatch = iQueue.front();
+			switch (opBatch.front().which())
+			{
+			case graphics_operation::operation_type::SetLogicalCoordinateSystem:
+				for (auto& op : opBatch)
+					set_logical_coordinate_system(static_variant_cast<const graphics_operation::set_logical_coordinate_system&>(op).system);
+				break;
+			case graphics_operation::operation_type::SetLogicalCoordinates:
+				for (auto& op : opBatch)
+					set_logical_coordinates(static_variant_cast<const graphics_operation::set_logical_coordinates&>(op).coordinates);
+				break;
+			case graphics_operation::operation_type::ScissorOn:
+				for (auto& op : opBatch)
+					scissor_on(static_variant_cast<const graphics_operation::scissor_on&>(op).rect);
+				break;
+			case graphics_operation::operation_type::ScissorOff:
+				for (auto& op : opBatch)
+				{
+					(void)op;
+					scissor_off();
+				}
+				break;
+			case graphics_operation::operation_type::ClipToRect:
+				for (auto& op : opBatch)
+					clip_to(static_variant_cast<const graphics_operation::clip_to_rect&>(op).rect);
+				break;
+			case graphics_operation::operation_type::ClipToPath:
+				for (auto& op : opBatch)
+					clip_to(static_variant_cast<const graphics_operation::clip_to_path&>(op).path, static_variant_cast<const graphics_operation::clip_to_path&>(op).pathOutline);
+				break;
+			case graphics_operation::operation_type::ResetClip:
+				for (auto& op : opBatch)
+				{
+					(void)op;
+					reset_clip();
+				}
+				break;
+			case graphics_operation::operation_type::SetSmoothingMode:
+				for (auto& op : opBatch)
+					set_smoothing_mode(static_variant_cast<const graphics_operation::set_smoothing_mode&>(op).smoothingMode);
+				break;
+			case graphics_operation::operation_type::PushLogicalOperation:
+				for (auto& op : opBatch)
+					push_logical_operation(static_variant_cast<const graphics_operation::push_logical_operation&>(op).logicalOperation);
+				break;
+			case graphics_operation::operation_type::PopLogicalOperation:
+				for (auto& op : opBatch)
+				{
+					(void)op;
+					pop_logical_operation();
+				}
+				break;
+			case graphics_operation::operation_type::LineStippleOn:
+				for (auto& op : opBatch)
+					line_stipple_on(static_variant_cast<const graphics_operation::line_stipple_on&>(op).factor, static_variant_cast<const graphics_operation::line_stipple_on&>(op).pattern);
+				break;
+			case graphics_operation::operation_type::LineStippleOff:
+				for (auto& op : opBatch)
+				{
+					(void)op;
+					line_stipple_off();
+				}
+				break;
+			case graphics_operation::operation_type::SubpixelRenderingOn:
+				subpixel_rendering_on();
+				break;
+			case graphics_operation::operation_type::SubpixelRenderingOff:
+				subpixel_rendering_off();
+				break;
+			case graphics_operation::operation_type::Clear:
+				for (auto& op : opBatch)
+					clear(static_variant_cast<const graphics_operation::clear&>(op).colour);
+				break;
+			case graphics_operation::operation_type::SetPixel:
+				for (auto& op : opBatch)
+					set_pixel(static_variant_cast<const graphics_operation::set_pixel&>(op).point, static_variant_cast<const graphics_operation::set_pixel&>(op).colour);
+				break;
+			case graphics_operation::operation_type::DrawPixel:
+				for (auto& op : opBatch)
+					draw_pixel(static_variant_cast<const graphics_operation::draw_pixel&>(op).point, static_variant_cast<const graphics_operation::draw_pixel&>(op).colour);
+				break;
+			case graphics_operation::operation_type::DrawLine:
+				for (auto& op : opBatch)
+				{
+					const auto& args = static_variant_cast<const graphics_operation::draw_line&>(op);
+					draw_line(args.from, args.to, args.pen);
+				}
+				break;
+			case graphics_operation::operation_type::DrawRect:
+				for (auto& op : opBatch)
+				{
+					const auto& args = static_variant_cast<const graphics_operation::draw_rect&>(op);
+					draw_rect(args.rect, args.pen);
+				}
+				break;
+			case graphics_operation::operation_type::DrawRoundedRect:
+				for (auto& op : opBatch)
+				{
+					const auto& args = static_variant_cast<const graphics_operation::draw_rounded_rect&>(op);
+					draw_rounded_rect(args.rect, args.radius, args.pen);
+				}
+				break;
+			case graphics_operation::operation_type::DrawCircle:
+				for (auto& op : opBatch)
+				{
+					const auto& args = static_variant_cast<const graphics_operation::draw_circle&>(op);
+					draw_circle(args.centre, args.radius, args.pen, args.startAngle);
+				}
+				break;
+			case graphics_operation::operation_type::DrawArc:
+				for (auto& op : opBatch)
+				{
+					const auto& args = static_variant_cast<const graphics_operation::draw_arc&>(op);
+					draw_arc(args.centre, args.radius, args.startAngle, args.endAngle, args.pen);
+				}
+				break;
+			case graphics_operation::operation_type::DrawPath:
+				for (auto& op : opBatch)
+				{
+					const auto& args = static_variant_cast<const graphics_operation::draw_path&>(op);
+					draw_path(args.path, args.pen);
+				}
+				break;
+			case graphics_operation::operation_type::DrawShape:
+				for (auto& op : opBatch)
+				{
+					const auto& args = static_variant_cast<const graphics_operation::draw_shape&>(op);
+					draw_shape(args.vertices, args.pen);
+				}
+				break;
+			case graphics_operation::operation_type::FillRect:
+				for (auto& op : opBatch)
+				{
+					const auto& args = static_variant_cast<const graphics_operation::fill_rect&>(op);
+					fill_rect(args.rect, args.fill);
+				}
+				break;
+			case graphics_operation::operation_type::FillRoundedRect:
+				for (auto& op : opBatch)
+				{
+					const auto& args = static_variant_cast<const graphics_operation::fill_rounded_rect&>(op);
+					fill_rounded_rect(args.rect, args.radius, args.fill);
+				}
+				break;
+			case graphics_operation::operation_type::FillCircle:
+				for (auto& op : opBatch)
+				{
+					const auto& args = static_variant_cast<const graphics_operation::fill_circle&>(op);
+					fill_circle(args.centre, args.radius, args.fill);
+				}
+				break;
+			case graphics_operation::operation_type::FillArc:
+				for (auto& op : opBatch)
+				{
+					const auto& args = static_variant_cast<const graphics_operation::fill_arc&>(op);
+					fill_arc(args.centre, args.radius, args.startAngle, args.endAngle, args.fill);
+				}
+				break;
+			case graphics_operation::operation_type::FillPath:
+				for (auto& op : opBatch)
+					fill_path(static_variant_cast<const graphics_operation::fill_path&>(op).path, static_variant_cast<const graphics_operation::fill_path&>(op).fill);
+				break;
+			case graphics_operation::operation_type::FillShape:
+				for (auto& op : opBatch)
+				{
+					const auto& args = static_variant_cast<const graphics_operation::fill_shape&>(op);
+					fill_shape(args.vertices, args.fill);
+				}
+				break;
+			case graphics_operation::operation_type::DrawGlyph:
+				for (auto& op : opBatch)
+				{
+					const auto& args = static_variant_cast<const graphics_operation::draw_glyph&>(op);
+					draw_glyph(args.point, args.glyph, args.font, args.colour);
+				}
+				break;
+			case graphics_operation::operation_type::DrawTexture:
+				for (auto& op : opBatch)
+				{
+					const auto& args = static_variant_cast<const graphics_operation::draw_texture&>(op);
+					draw_texture(args.textureMap, args.texture, args.textureRect, args.colour, args.shaderEffect);
+				}
+				break;
+			}
+			iQueue.pop_front();
+		}
+	}
+
+	const std::pair<vec2, vec2>& software_graphics_context::logical_coordinates() const
+	{
+		return get_logical_coordinates(surface().surface_size(), iLogicalCoordinateSystem, iLogicalCoordinates);
+	}
+
+	neogfx::logical_coordinate_system software_graphics_context::logical_coordinate_system() const
+	{
+		return iLogicalCoordinateSystem;
+	}
+
+	void software_graphics_context::set_logical_coordinate_system(neogfx::logical_coordinate_system aSystem)
+	{
+		iLogicalCoordinateSystem = aSystem;
+	}
+
+	void software_graphics_context::set_logical_coordinates(const std::pair<vec2, vec2>& aCoordinates) const
+	{
+		iLogicalCoordinates = aCoordinates;
+	}
+
+	void software_graphics_context::scissor_on(const rect& aRect)
+	{
+		iScissorRects.push_back(aRect);
+		update_bounds();
+	}
+
+	void software_graphics_context::scissor_off()
+	{
+		iScissorRects.pop_back();
+		update_bounds();
+	}
+
+	optional_rect software_graphics_context::scissor_rect() const
+	{
+		if (iScissorRects.empty())
+			return optional_rect();
+		rect result = *iScissorRects.begin();
+		for (auto& r : iScissorRects)
+			result = result.intersection(r);
+		return result;
+	}
+
+	void software_graphics_context::clip_to(const rect& aRect)
+	{
+		++iClipCounter;
+		iClipMask.assign(static_cast<std::size_t>(iFrameBuffer.width()) * iFrameBuffer.height(), 0x00);
+		rect clipRect = to_device(aRect);
+		int32_t left = std::max(static_cast<int32_t>(std::ceil(clipRect.x - 0.5)), 0);
+		int32_t right = std::min(static_cast<int32_t>(std::ceil(clipRect.right() - 0.5)), iFrameBuffer.width());
+		int32_t top = std::max(static_cast<int32_t>(std::ceil(clipRect.y - 0.5)), 0);
+		int32_t bottom = std::min(static_cast<int32_t>(std::ceil(clipRect.bottom() - 0.5)), iFrameBuffer.height());
+		for (int32_t y = top; y < bottom; ++y)
+			for (int32_t x = left; x < right; ++x)
+				iClipMask[static_cast<std::size_t>(y) * iFrameBuffer.width() + x] = 0xFF;
+	}
+
+	void software_graphics_context::clip_to(const path& aPath, dimension aPathOutline)
+	{
+		++iClipCounter;
+		iClipMask.assign(static_cast<std::size_t>(iFrameBuffer.width()) * iFrameBuffer.height(), 0x00);
+		span_bounds all{ 0, 0, iFrameBuffer.width(), iFrameBuffer.height() };
+		rasterize(path_polygons(aPath), all, [this](int32_t aY, int32_t aX, int32_t aLength, const uint8_t* aCoverage)
+		{
+			std::copy(aCoverage, aCoverage + aLength, &iClipMask[static_cast<std::size_t>(aY) * iFrameBuffer.width() + aX]);
+		});
+		if (aPathOutline != 0)
+		{
+			path innerPath = aPath;
+			innerPath.deflate(aPathOutline);
+			rasterize(path_polygons(innerPath), all, [this](int32_t aY, int32_t aX, int32_t aLength, const uint8_t* aCoverage)
+			{
+				uint8_t* mask = &iClipMask[static_cast<std::size_t>(aY) * iFrameBuffer.width() + aX];
+				for (int32_t i = 0; i < aLength; ++i)
+					mask[i] = static_cast<uint8_t>(div255(mask[i] * (0xFF - aCoverage[i])));
+			});
+		}
+	}
+
+	void software_graphics_context::reset_clip()
+	{
+		if (iClipCounter > 0 && --iClipCounter == 0)
+			iClipMask.clear();
+	}
+
+	smoothing_mode software_graphics_context::smoothing_mode() const
+	{
+		return iSmoothingMode;
+	}
+
+	void software_graphics_context::set_smoothing_mode(neogfx::smoothing_mode aSmoothingMode)
+	{
+		iSmoothingMode = aSmoothingMode;
+	}
+
+	void software_graphics_context::push_logical_operation(logical_operation aLogicalOperation)
+	{
+		iLogicalOperationStack.push_back(aLogicalOperation);
+	}
+
+	void software_graphics_context::pop_logical_operation()
+	{
+		if (!iLogicalOperationStack.empty())
+			iLogicalOperationStack.pop_back();
+	}
+
+	void software_graphics_context::line_stipple_on(uint32_t aFactor, uint16_t aPattern)
+	{
+		iLineStipple = std::make_pair(std::max<uint32_t>(aFactor, 1), aPattern);
+	}
+
+	void software_graphics_context::line_stipple_off()
+	{
+		iLineStipple = boost::none;
+	}
+
+	bool software_graphics_context::is_subpixel_rendering_on() const
+	{
+		return iSubpixelRendering;
+	}
+
+	void software_graphics_context::subpixel_rendering_on()
+	{
+		iSubpixelRendering = true;
+	}
+
+	void software_graphics_context::subpixel_rendering_off()
+	{
+		iSubpixelRendering = false;
+	}
+
+	void software_graphics_context::clear(const colour& aColour)
+	{
+		for (int32_t y = bounds().top; y < bounds().bottom; ++y)
+			iFrameBuffer.fill_span(bounds().left, y, bounds().right - bounds().left, aColour);
+	}
+
+	void software_graphics_context::set_pixel(const point& aPoint, const colour& aColour)
+	{
+		point devicePoint = to_device(aPoint);
+		int32_t x = static_cast<int32_t>(std::floor(devicePoint.x));
+		int32_t y = static_cast<int32_t>(std::floor(devicePoint.y));
+		if (x >= bounds().left && x < bounds().right && y >= bounds().top && y < bounds().bottom)
+			iFrameBuffer.set_pixel(x, y, aColour.with_alpha(0xFF));
+	}
+
+	void software_graphics_context::draw_pixel(const point& aPoint, const colour& aColour)
+	{
+		fill_rect(rect{ aPoint, size{ 1.0, 1.0 } }, aColour);
+	}
+
+	void software_graphics_context::draw_line(const point& aFrom, const point& aTo, const pen& aPen)
+	{
+		double pixelAdjust = pixel_adjust(aPen);
+		fill_polygons(line_polygons({ xyz{ aFrom.x + pixelAdjust, aFrom.y + pixelAdjust }, xyz{ aTo.x + pixelAdjust, aTo.y + pixelAdjust } }, false, aPen), aPen.colour(), rect{});
+	}
+
+	void software_graphics_context::draw_rect(const rect& aRect, const pen& aPen)
+	{
+		fill_polygons(line_polygons(rect_vertices(aRect, pixel_adjust(aPen), rect_type::Outline), false, aPen), aPen.colour(), rect{});
+	}
+
+	void software_graphics_context::draw_rounded_rect(const rect& aRect, dimension aRadius, const pen& aPen)
+	{
+		double pixelAdjust = pixel_adjust(aPen);
+		fill_polygons(line_polygons(rounded_rect_vertices(aRect + point{ pixelAdjust, pixelAdjust }, aRadius, false), true, aPen), aPen.colour(), rect{});
+	}
+
+	void software_graphics_context::draw_circle(const point& aCentre, dimension aRadius, const pen& aPen, angle aStartAngle)
+	{
+		fill_polygons(line_polygons(circle_vertices(aCentre, aRadius, aStartAngle, false), true, aPen), aPen.colour(), rect{});
+	}
+
+	void software_graphics_context::draw_arc(const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, const pen& aPen)
+	{
+		fill_polygons(line_polygons(arc_vertices(aCentre, aRadius, aStartAngle, aEndAngle, false), true, aPen), aPen.colour(), rect{});
+	}
+
+	void software_graphics_context::draw_path(const path& aPath, const pen& aPen)
+	{
+		switch (aPath.shape())
+		{
+		case path::ConvexPolygon:
+			clip_to(aPath, aPen.width());
+			fill_polygons(path_polygons(aPath), aPen.colour(), rect{});
+			reset_clip();
+			break;
+		case path::Lines:
+		case path::LineStrip:
+		case path::LineLoop:
+			for (std::size_t i = 0; i < aPath.paths().size(); ++i)
+			{
+				if (aPath.paths()[i].size() <= 2)
+					continue;
+				auto vertices = aPath.to_vertices(aPath.paths()[i]);
+				if (aPath.shape() == path::LineLoop)
+					vertices.push_back(vertices[0]);
+				fill_polygons(line_polygons(vertices, aPath.shape() != path::Lines, aPen), aPen.colour(), rect{});
+			}
+			break;
+		default:
+			fill_polygons(path_polygons(aPath), aPen.colour(), rect{});
+			break;
+		}
+	}
+
+	void software_graphics_context::draw_shape(const vec2_list& aVertices, const pen& aPen)
+	{
+		if (aVertices.empty())
+			return;
+		std::vector<vertex> vertices;
+		vertices.reserve(aVertices.size() + 1);
+		for (auto const& v : aVertices)
+			vertices.push_back(xyz{ v[0], v[1] });
+		vertices.push_back(vertices[0]);
+		fill_polygons(line_polygons(vertices, true, aPen), aPen.colour(), rect{});
+	}
+
+	void software_graphics_context::fill_rect(const rect& aRect, const fill& aFill)
+	{
+		if (aRect.empty())
+			return;
+		rect deviceRect = to_device(aRect);
+		bool pixelAligned = deviceRect.x == std::floor(deviceRect.x) && deviceRect.y == std::floor(deviceRect.y) &&
+			deviceRect.cx == std::floor(deviceRect.cx) && deviceRect.cy == std::floor(deviceRect.cy);
+		if (!pixelAligned && iSmoothingMode == neogfx::smoothing_mode::AntiAlias)
+		{
+			fill_polygons(polygon_list{ { deviceRect.top_left(), deviceRect.top_right(), deviceRect.bottom_right(), deviceRect.bottom_left() } }, aFill, aRect);
+			return;
+		}
+		if (aFill.is<gradient>())
+			gradient_on(static_variant_cast<const gradient&>(aFill), aRect);
+		int32_t left = static_cast<int32_t>(std::ceil(deviceRect.x - 0.5));
+		int32_t right = static_cast<int32_t>(std::ceil(deviceRect.right() - 0.5));
+		int32_t top = std::max(static_cast<int32_t>(std::ceil(deviceRect.y - 0.5)), bounds().top);
+		int32_t bottom = std::min(static_cast<int32_t>(std::ceil(deviceRect.bottom() - 0.5)), bounds().bottom);
+		for (int32_t y = top; y < bottom; ++y)
+			compose_span(y, left, right - left, nullptr, aFill);
+	}
+
+	void software_graphics_context::fill_rounded_rect(const rect& aRect, dimension aRadius, const fill& aFill)
+	{
+		if (aRect.empty())
+			return;
+		fill_polygons(polygon_list{ to_device(rounded_rect_vertices(aRect, aRadius, false)) }, aFill, aRect);
+	}
+
+	void software_graphics_context::fill_circle(const point& aCentre, dimension aRadius, const fill& aFill)
+	{
+		fill_polygons(polygon_list{ to_device(circle_vertices(aCentre, aRadius, 0.0, false)) }, aFill, rect{ aCentre - point{ aRadius, aRadius }, size{ aRadius * 2.0 } });
+	}
+
+	void software_graphics_context::fill_arc(const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, const fill& aFill)
+	{
+		fill_polygons(polygon_list{ to_device(arc_vertices(aCentre, aRadius, aStartAngle, aEndAngle, true)) }, aFill, rect{ aCentre - point{ aRadius, aRadius }, size{ aRadius * 2.0 } });
+	}
+
+	void software_graphics_context::fill_path(const path& aPath, const fill& aFill)
+	{
+		fill_polygons(path_polygons(aPath), aFill, aPath.bounding_rect());
+	}
+
+	void software_graphics_context::fill_shape(const vec2_list& aVertices, const fill& aFill)
+	{
+		if (aVertices.empty())
+			return;
+		polygon shape;
+		shape.reserve(aVertices.size());
+		vec2 min = aVertices[0];
+		vec2 max = min;
+		for (auto const& v : aVertices)
+		{
+			shape.push_back(to_device(point{ v.x, v.y }));
+			min.x = std::min(min.x, v.x);
+			max.x = std::max(max.x, v.x);
+			min.y = std::min(min.y, v.y);
+			max.y = std::max(max.y, v.y);
+		}
+		fill_polygons(polygon_list{ shape }, aFill, rect{ point{ min.x, min.y }, size{ max.x - min.x, max.y - min.y } });
+	}
+
+	void software_graphics_context::draw_glyph(const point& aPoint, const glyph& aGlyph, const font& aFont, const colour& aColour)
+	{
+		if (aGlyph.is_emoji())
+		{
+			auto const& emojiAtlas = app::instance().rendering_engine().font_manager().emoji_atlas();
+			auto const& emojiTexture = emojiAtlas.emoji_texture(aGlyph.value());
+			draw_texture(rect{ aPoint, size{ aFont.height(), aFont.height() } }.to_vector(), emojiTexture, rect{ point{}, emojiTexture.extents() }, optional_colour{}, shader_effect::None);
+			return;
+		}
+
+		if (aGlyph.is_whitespace())
+			return;
+
+		const software_glyph_cache::glyph_bitmap& glyphBitmap = iGlyphCache.rasterize(!aGlyph.use_fallback() ? aFont.native_font_face() : aGlyph.fallback_font(aFont).native_font_face(), aGlyph);
+		if (glyphBitmap.width == 0 || glyphBitmap.height == 0)
+			return;
+
+		point glyphOrigin(aPoint.x + glyphBitmap.placement.x,
+			logical_coordinates().first.y < logical_coordinates().second.y ?
+				aPoint.y + (glyphBitmap.placement.y + -aFont.descender()) :
+				aPoint.y + aFont.height() - (glyphBitmap.placement.y + -aFont.descender()) - glyphBitmap.height);
+		rect glyphRect = to_device(rect{ glyphOrigin, size{ static_cast<dimension>(glyphBitmap.width), static_cast<dimension>(glyphBitmap.height) } });
+		int32_t left = static_cast<int32_t>(std::floor(glyphRect.x + 0.5));
+		int32_t top = static_cast<int32_t>(std::floor(glyphRect.y + 0.5));
+
+		if (!glyphBitmap.subpixel)
+		{
+			for (int32_t row = 0; row < glyphBitmap.height; ++row)
+				compose_span(top + row, left, glyphBitmap.width, &glyphBitmap.coverage[static_cast<std::size_t>(row) * glyphBitmap.width], aColour);
+			return;
+		}
+
+		// per-channel coverage; mirrors the subpixel glyph shader (destination alpha is left opaque)
+		for (int32_t row = 0; row < glyphBitmap.height; ++row)
+		{
+			int32_t y = top + row;
+			if (y < bounds().top || y >= bounds().bottom)
+				continue;
+			software_frame_buffer::pixel* destination = iFrameBuffer.scanline(y);
+			for (int32_t column = 0; column < glyphBitmap.width; ++column)
+			{
+				int32_t x = left + column;
+				if (x < bounds().left || x >= bounds().right)
+					continue;
+				uint32_t alpha = aColour.alpha();
+				if (iClipCounter != 0)
+					alpha = div255(alpha * iClipMask[static_cast<std::size_t>(y) * iFrameBuffer.width() + x]);
+				const uint8_t* coverage = &glyphBitmap.coverage[(static_cast<std::size_t>(row) * glyphBitmap.width + column) * 3];
+				software_frame_buffer::pixel d = destination[x];
+				const uint32_t source[] = { aColour.red(), aColour.green(), aColour.blue() };
+				software_frame_buffer::pixel result = 0xFF000000;
+				for (uint32_t channel = 0; channel < 3; ++channel)
+				{
+					uint32_t a = div255(coverage[channel] * alpha);
+					result |= div255(source[channel] * a + ((d >> (channel * 8)) & 0xFF) * (0xFF - a)) << (channel * 8);
+				}
+				destination[x] = result;
+			}
+		}
+	}
+
+	void software_graphics_context::draw_texture(const texture_map& aTextureMap, const i_texture& aTexture, const rect& aTextureRect, const optional_colour& aColour, shader_effect aShaderEffect)
+	{
+		if (aTexture.is_empty())
+			return;
+		if (!aTexture.native_texture()->is_resident())
+			throw texture_not_resident();
+		rect textureRect = aTextureRect;
+		if (aTexture.type() == i_texture::SubTexture)
+			textureRect.position() += static_cast<const i_sub_texture&>(aTexture).atlas_location().top_left();
+		textureRect.position() += point{ 1.0, 1.0 };
+		const software_frame_buffer& source = *static_cast<const software_frame_buffer*>(aTexture.native_texture()->handle());
+
+		point min = to_device(point{ aTextureMap[0].x, aTextureMap[0].y });
+		point max = min;
+		for (auto& v : aTextureMap)
+		{
+			point p = to_device(point{ v.x, v.y });
+			min.x = std::min(min.x, p.x);
+			max.x = std::max(max.x, p.x);
+			min.y = std::min(min.y, p.y);
+			max.y = std::max(max.y, p.y);
+		}
+		rect destination{ min, max };
+		if (destination.empty())
+			return;
+		auto& textureManager = app::instance().rendering_engine().texture_manager();
+		if (textureManager.uploads_pending())
+			textureManager.texture_drawn(*aTexture.native_texture(), textureRect - point{ 1.0, 1.0 }, iSurface, destination);
+
+		int32_t left = std::max(static_cast<int32_t>(std::ceil(destination.x - 0.5)), bounds().left);
+		int32_t right = std::min(static_cast<int32_t>(std::ceil(destination.right() - 0.5)), bounds().right);
+		int32_t top = std::max(static_cast<int32_t>(std::ceil(destination.y - 0.5)), bounds().top);
+		int32_t bottom = std::min(static_cast<int32_t>(std::ceil(destination.bottom() - 0.5)), bounds().bottom);
+		if (left >= right || top >= bottom)
+			return;
+
+		colour c = (aColour != boost::none ? *aColour : colour::White);
+		double scaleX = textureRect.cx / destination.cx;
+		double scaleY = textureRect.cy / destination.cy;
+		bool bilinear = (scaleX != 1.0 || scaleY != 1.0);
+		for (int32_t y = top; y < bottom; ++y)
+		{
+			iSourceSpan.resize(right - left);
+			double v = textureRect.y + (y + 0.5 - destination.y) * scaleY;
+			for (int32_t x = left; x < right; ++x)
+			{
+				double u = textureRect.x + (x + 0.5 - destination.x) * scaleX;
+				software_frame_buffer::pixel texel = sample(source, textureRect, u, v, bilinear);
+				uint32_t red = div255((texel & 0xFF) * c.red());
+				uint32_t green = div255(((texel >> 8) & 0xFF) * c.green());
+				uint32_t blue = div255(((texel >> 16) & 0xFF) * c.blue());
+				uint32_t alpha = div255(((texel >> 24) & 0xFF) * c.alpha());
+				if (aShaderEffect == shader_effect::Monochrome)
+					red = green = blue = static_cast<uint32_t>(red * 0.299 + green * 0.587 + blue * 0.114 + 0.5);
+				iSourceSpan[x - left] = red | (green << 8) | (blue << 16) | (alpha << 24);
+			}
+			compose_source_span(y, left, right - left, nullptr);
+		}
+	}
+
+	point software_graphics_context::to_device(const point& aPoint) const
+	{
+		const auto& logicalCoordinates = logical_coordinates();
+		return point{
+			(aPoint.x - logicalCoordinates.first.x) * iFrameBuffer.width() / (logicalCoordinates.second.x - logicalCoordinates.first.x),
+			(aPoint.y - logicalCoordinates.second.y) * iFrameBuffer.height() / (logicalCoordinates.first.y - logicalCoordinates.second.y) };
+	}
+
+	point software_graphics_context::to_device(const vertex& aVertex) const
+	{
+		return to_device(point{ aVertex[0], aVertex[1] });
+	}
+
+	software_graphics_context::polygon software_graphics_context::to_device(const std::vector<vertex>& aVertices) const
+	{
+		polygon result;
+		result.reserve(aVertices.size());
+		for (auto const& v : aVertices)
+			result.push_back(to_device(v));
+		return result;
+	}
+
+	rect software_graphics_context::to_device(const rect& aRect) const
+	{
+		point topLeft = to_device(aRect.top_left());
+		point bottomRight = to_device(aRect.bottom_right());
+		return rect{
+			point{ std::min(topLeft.x, bottomRight.x), std::min(topLeft.y, bottomRight.y) },
+			point{ std::max(topLeft.x, bottomRight.x), std::max(topLeft.y, bottomRight.y) } };
+	}
+
+	software_graphics_context::polygon_list software_graphics_context::path_polygons(const path& aPath) const
+	{
+		polygon_list result;
+		for (auto const& subPath : aPath.paths())
+		{
+			if (subPath.size() <= 2)
+				continue;
+			result.emplace_back();
+			result.back().reserve(subPath.size());
+			for (auto const& p : subPath)
+				result.back().push_back(to_device(p + aPath.position()));
+		}
+		return result;
+	}
+
+	software_graphics_context::polygon_list software_graphics_context::line_polygons(const std::vector<vertex>& aVertices, bool aLineStrip, const pen& aPen) const
+	{
+		polygon_list result;
+		const double halfWidth = std::max(aPen.width(), 1.0) / 2.0;
+		uint32_t stippleCounter = 0;
+		auto addQuad = [&](const point& aFrom, const point& aTo, const point& aNormal)
+		{
+			result.push_back(polygon{ aFrom + aNormal, aTo + aNormal, aTo - aNormal, aFrom - aNormal });
+		};
+		auto addSegment = [&](const point& aFrom, const point& aTo)
+		{
+			point delta = aTo - aFrom;
+			double length = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+			if (length == 0.0)
+				return;
+			point direction{ delta.x / length, delta.y / length };
+			point normal{ -direction.y * halfWidth, direction.x * halfWidth };
+			if (iLineStipple == boost::none)
+			{
+				addQuad(aFrom, aTo, normal);
+				return;
+			}
+			boost::optional<double> dashStart;
+			for (double position = 0.0; position < length; position += 1.0, ++stippleCounter)
+			{
+				bool on = ((iLineStipple->second >> ((stippleCounter / iLineStipple->first) % 16)) & 1) != 0;
+				if (on && dashStart == boost::none)
+					dashStart = position;
+				else if (!on && dashStart != boost::none)
+				{
+					addQuad(aFrom + direction * point{ *dashStart, *dashStart }, aFrom + direction * point{ position, position }, normal);
+					dashStart = boost::none;
+				}
+			}
+			if (dashStart != boost::none)
+				addQuad(aFrom + direction * point{ *dashStart, *dashStart }, aTo, normal);
+		};
+		if (aLineStrip)
+		{
+			for (std::size_t i = 1; i < aVertices.size(); ++i)
+				addSegment(to_device(aVertices[i - 1]), to_device(aVertices[i]));
+		}
+		else
+		{
+			for (std::size_t i = 1; i < aVertices.size(); i += 2)
+				addSegment(to_device(aVertices[i - 1]), to_device(aVertices[i]));
+		}
+		return result;
+	}
+
+	const software_graphics_context::span_bounds& software_graphics_context::bounds() const
+	{
+		return iBounds;
+	}
+
+	void software_graphics_context::update_bounds()
+	{
+		iBounds = span_bounds{ 0, 0, iFrameBuffer.width(), iFrameBuffer.height() };
+		auto sr = scissor_rect();
+		if (sr != boost::none)
+		{
+			int32_t left = static_cast<int32_t>(std::ceil(sr->x));
+			int32_t top = static_cast<int32_t>(std::ceil(sr->y));
+			iBounds.left = std::max(iBounds.left, left);
+			iBounds.top = std::max(iBounds.top, top);
+			iBounds.right = std::min(iBounds.right, left + static_cast<int32_t>(std::ceil(sr->cx)));
+			iBounds.bottom = std::min(iBounds.bottom, top + static_cast<int32_t>(std::ceil(sr->cy)));
+		}
+	}
+
+	void software_graphics_context::rasterize(const polygon_list& aPolygons, const span_bounds& aBounds, const span_handler& aHandler)
+	{
+		struct edge
+		{
+			double x0;
+			double y0;
+			double x1;
+			double y1;
+			int32_t winding;
+		};
+		std::vector<edge> edges;
+		double minX = std::numeric_limits<double>::max();
+		double minY = std::numeric_limits<double>::max();
+		double maxX = std::numeric_limits<double>::lowest();
+		double maxY = std::numeric_limits<double>::lowest();
+		for (auto const& p : aPolygons)
+		{
+			if (p.size() < 3)
+				continue;
+			for (std::size_t i = 0; i < p.size(); ++i)
+			{
+				const point& from = p[i];
+				const point& to = p[(i + 1) % p.size()];
+				minX = std::min(minX, from.x);
+				maxX = std::max(maxX, from.x);
+				minY = std::min(minY, from.y);
+				maxY = std::max(maxY, from.y);
+				if (from.y == to.y)
+					continue;
+				if (from.y < to.y)
+					edges.push_back(edge{ from.x, from.y, to.x, to.y, 1 });
+				else
+					edges.push_back(edge{ to.x, to.y, from.x, from.y, -1 });
+			}
+		}
+		if (edges.empty())
+			return;
+
+		int32_t top = std::max(static_cast<int32_t>(std::floor(minY)), aBounds.top);
+		int32_t bottom = std::min(static_cast<int32_t>(std::ceil(maxY)), aBounds.bottom);
+		int32_t left = std::max(static_cast<int32_t>(std::floor(minX)), aBounds.left);
+		int32_t right = std::min(static_cast<int32_t>(std::ceil(maxX)), aBounds.right);
+		if (top >= bottom || left >= right)
+			return;
+
+		// non-zero winding; anti-aliasing uses four sub-scanlines with exact horizontal coverage, otherwise pixel
+		// centres are sampled as with non-multisampled OpenGL rasterization
+		const bool antiAlias = (iSmoothingMode == neogfx::smoothing_mode::AntiAlias);
+		const uint32_t samples = antiAlias ? 4 : 1;
+		const float weight = 1.0f / samples;
+		iCoverageAccumulator.resize(right - left);
+		iCoverage.resize(right - left);
+		std::vector<std::pair<double, int32_t>> crossings;
+		for (int32_t y = top; y < bottom; ++y)
+		{
+			std::fill(iCoverageAccumulator.begin(), iCoverageAccumulator.end(), 0.0f);
+			int32_t spanLeft = right;
+			int32_t spanRight = left;
+			for (uint32_t s = 0; s < samples; ++s)
+			{
+				double sampleY = y + (s + 0.5) / samples;
+				crossings.clear();
+				for (auto const& e : edges)
+					if (sampleY >= e.y0 && sampleY < e.y1)
+						crossings.emplace_back(e.x0 + (sampleY - e.y0) * (e.x1 - e.x0) / (e.y1 - e.y0), e.winding);
+				if (crossings.size() < 2)
+					continue;
+				std::sort(crossings.begin(), crossings.end());
+				int32_t winding = 0;
+				for (std::size_t i = 0; i + 1 < crossings.size(); ++i)
+				{
+					winding += crossings[i].second;
+					if (winding == 0)
+						continue;
+					double from = std::max(crossings[i].first, static_cast<double>(left));
+					double to = std::min(crossings[i + 1].first, static_cast<double>(right));
+					if (antiAlias)
+					{
+						if (to <= from)
+							continue;
+						int32_t first = static_cast<int32_t>(std::floor(from));
+						int32_t last = static_cast<int32_t>(std::floor(to));
+						if (first == last)
+							iCoverageAccumulator[first - left] += static_cast<float>(to - from) * weight;
+						else
+						{
+							iCoverageAccumulator[first - left] += static_cast<float>(first + 1 - from) * weight;
+							for (int32_t x = first + 1; x < last; ++x)
+								iCoverageAccumulator[x - left] += weight;
+							if (last < right)
+								iCoverageAccumulator[last - left] += static_cast<float>(to - last) * weight;
+						}
+						spanLeft = std::min(spanLeft, first);
+						spanRight = std::max(spanRight, std::min(last + 1, right));
+					}
+					else
+					{
+						int32_t first = std::max(static_cast<int32_t>(std::ceil(from - 0.5)), left);
+						int32_t last = std::min(static_cast<int32_t>(std::ceil(to - 0.5)), right);
+						if (first >= last)
+							continue;
+						for (int32_t x = first; x < last; ++x)
+							iCoverageAccumulator[x - left] += weight;
+						spanLeft = std::min(spanLeft, first);
+						spanRight = std::max(spanRight, last);
+					}
+				}
+			}
+			if (spanLeft >= spanRight)
+				continue;
+			for (int32_t x = spanLeft; x < spanRight; ++x)
+				iCoverage[x - left] = static_cast<uint8_t>(std::min(iCoverageAccumulator[x - left], 1.0f) * 255.0f + 0.5f);
+			aHandler(y, spanLeft, spanRight - spanLeft, &iCoverage[spanLeft - left]);
+		}
+	}
+
+	void software_graphics_context::fill_polygons(const polygon_list& aPolygons, const fill& aFill, const rect& aFillBoundingBox)
+	{
+		if (aFill.is<gradient>())
+			gradient_on(static_variant_cast<const gradient&>(aFill), aFillBoundingBox);
+		rasterize(aPolygons, bounds(), [this, &aFill](int32_t aY, int32_t aX, int32_t aLength, const uint8_t* aCoverage)
+		{
+			compose_span(aY, aX, aLength, aCoverage, aFill);
+		});
+	}
+
+	void software_graphics_context::compose_span(int32_t aY, int32_t aX, int32_t aLength, const uint8_t* aCoverage, const colour& aColour)
+	{
+		bool logicalOperation = !iLogicalOperationStack.empty() && iLogicalOperationStack.back() != logical_operation::None;
+		if (aCoverage == nullptr && iClipCounter == 0 && !logicalOperation)
+		{
+			if (aY < bounds().top || aY >= bounds().bottom)
+				return;
+			int32_t left = std::max(aX, bounds().left);
+			int32_t right = std::min(aX + aLength, bounds().right);
+			if (left < right)
+				iFrameBuffer.blend_span(left, aY, right - left, aColour);
+			return;
+		}
+		iSourceSpan.assign(aLength, software_frame_buffer::to_pixel(aColour));
+		compose_source_span(aY, aX, aLength, aCoverage);
+	}
+
+	void software_graphics_context::compose_span(int32_t aY, int32_t aX, int32_t aLength, const uint8_t* aCoverage, const fill& aFill)
+	{
+		if (aFill.is<colour>())
+		{
+			compose_span(aY, aX, aLength, aCoverage, static_variant_cast<const colour&>(aFill));
+			return;
+		}
+		iSourceSpan.resize(aLength);
+		for (int32_t i = 0; i < aLength; ++i)
+		{
+			double position = gradient_position(point{ aX + i + 0.5, aY + 0.5 });
+			iSourceSpan[i] = iGradientLookupTable[static_cast<std::size_t>(position * (iGradientLookupTable.size() - 1) + 0.5)];
+		}
+		compose_source_span(aY, aX, aLength, aCoverage);
+	}
+
+	void software_graphics_context::compose_source_span(int32_t aY, int32_t aX, int32_t aLength, const uint8_t* aCoverage)
+	{
+		if (aY < bounds().top || aY >= bounds().bottom)
+			return;
+		int32_t left = std::max(aX, bounds().left);
+		int32_t right = std::min(aX + aLength, bounds().right);
+		if (left >= right)
+			return;
+		int32_t offset = left - aX;
+		software_frame_buffer::pixel* source = &iSourceSpan[offset];
+		const uint8_t* coverage = (aCoverage != nullptr ? aCoverage + offset : nullptr);
+		const uint8_t* mask = (iClipCounter != 0 ? &iClipMask[static_cast<std::size_t>(aY) * iFrameBuffer.width() + left] : nullptr);
+		if (coverage != nullptr || mask != nullptr)
+		{
+			for (int32_t i = 0; i < right - left; ++i)
+			{
+				uint32_t alpha = source[i] >> 24;
+				if (coverage != nullptr)
+					alpha = div255(alpha * coverage[i]);
+				if (mask != nullptr)
+					alpha = div255(alpha * mask[i]);
+				source[i] = (source[i] & 0x00FFFFFF) | (alpha << 24);
+			}
+		}
+		if (!iLogicalOperationStack.empty() && iLogicalOperationStack.back() == logical_operation::Xor)
+			iFrameBuffer.xor_span(left, aY, right - left, source);
+		else
+			iFrameBuffer.blend_span(left, aY, right - left, source);
+	}
+
+	void software_graphics_context::gradient_on(const gradient& aGradient, const rect& aBoundingBox)
+	{
+		iGradientBoundingBox = to_device(aBoundingBox);
+		if (iGradient != boost::none && *iGradient == aGradient)
+			return;
+		iGradient = aGradient;
+		for (std::size_t i = 0; i < iGradientLookupTable.size(); ++i)
+			iGradientLookupTable[i] = software_frame_buffer::to_pixel(aGradient.at(static_cast<double>(i) / (iGradientLookupTable.size() - 1)));
+	}
+
+	double software_graphics_context::gradient_position(const point& aDevicePosition) const
+	{
+		// port of colour_at() in gradient.frag (smoothness filter not applied)
+		const gradient& g = *iGradient;
+		const rect& box = iGradientBoundingBox;
+		double result = 0.0;
+		switch (g.direction())
+		{
+		case gradient::Vertical:
+			result = (aDevicePosition.y - box.y) / box.cy;
+			break;
+		case gradient::Horizontal:
+			result = (aDevicePosition.x - box.x) / box.cx;
+			break;
+		case gradient::Diagonal:
+			{
+				point centre{ box.cx / 2.0, box.cy / 2.0 };
+				double angle = 0.0;
+				if (g.orientation().is<gradient::corner_e>())
+				{
+					switch (static_variant_cast<gradient::corner_e>(g.orientation()))
+					{
+					case gradient::TopLeft:
+						angle = std::atan2(centre.y, -centre.x);
+						break;
+					case gradient::TopRight:
+						angle = std::atan2(-centre.y, -centre.x);
+						break;
+					case gradient::BottomRight:
+						angle = std::atan2(-centre.y, centre.x);
+						break;
+					case gradient::BottomLeft:
+						angle = std::atan2(centre.y, centre.x);
+						break;
+					}
+				}
+				else
+					angle = static_variant_cast<double>(g.orientation());
+				double x = aDevicePosition.x - box.x - centre.x;
+				double y = (box.cy - (aDevicePosition.y - box.y)) - centre.y;
+				result = (std::sin(angle) * x + std::cos(angle) * y + centre.y) / box.cy;
+			}
+			break;
+		case gradient::Radial:
+			{
+				point pos = aDevicePosition - box.top_left();
+				point s{ box.cx, box.cy };
+				point gradientCentre = (g.centre() != boost::none ? *g.centre() : point{});
+				point centre{ s.x / 2.0 * (gradientCentre.x + 1.0), s.y / 2.0 * (gradientCentre.y + 1.0) };
+				auto distance = [](const point& aLeft, const point& aRight) { return std::sqrt((aLeft.x - aRight.x) * (aLeft.x - aRight.x) + (aLeft.y - aRight.y) * (aLeft.y - aRight.y)); };
+				const point corners[] = { point{}, point{ 0.0, s.y }, s, point{ s.x, 0.0 } };
+				point nearestCorner = corners[0];
+				point farthestCorner = corners[0];
+				for (auto const& corner : corners)
+				{
+					if (distance(centre, corner) < distance(centre, nearestCorner))
+						nearestCorner = corner;
+					if (distance(centre, corner) > distance(centre, farthestCorner))
+						farthestCorner = corner;
+				}
+				double r = 0.0;
+				double theta = std::atan2(pos.y - centre.y, pos.x - centre.x);
+				if (g.shape() == gradient::Ellipse)
+				{
+					switch (g.size())
+					{
+					default:
+					case gradient::ClosestSide:
+						r = ellipse_radius(std::min(centre.x, s.x - centre.x), std::min(centre.y, s.y - centre.y), theta);
+						break;
+					case gradient::FarthestSide:
+						r = ellipse_radius(std::max(centre.x, s.x - centre.x), std::max(centre.y, s.y - centre.y), theta);
+						break;
+					case gradient::ClosestCorner:
+						r = ellipse_radius(std::abs(centre.x - nearestCorner.x), std::abs(centre.y - nearestCorner.y), theta);
+						break;
+					case gradient::FarthestCorner:
+						r = ellipse_radius(std::abs(centre.x - farthestCorner.x), std::abs(centre.y - farthestCorner.y), theta);
+						break;
+					}
+				}
+				else
+				{
+					switch (g.size())
+					{
+					default:
+					case gradient::ClosestSide:
+						r = std::min(std::min(centre.x, centre.y), std::min(s.x - centre.x, s.y - centre.y));
+						break;
+					case gradient::FarthestSide:
+						r = std::max(std::max(centre.x, centre.y), std::max(s.x - centre.x, s.y - centre.y));
+						break;
+					case gradient::ClosestCorner:
+						r = distance(nearestCorner, centre);
+						break;
+					case gradient::FarthestCorner:
+						r = distance(farthestCorner, centre);
+						break;
+					}
+				}
+				double d = distance(centre, pos);
+				result = (d < r ? d / r : 1.0);
+			}
+			break;
+		}
+		if (result != result)
+			result = 0.0;
+		return std::max(0.0, std::min(result, 1.0));
+	}
+}
\ No newline at end of file
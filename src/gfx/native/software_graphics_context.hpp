@@ -0,0 +1,142 @@
+// software_graphics_context.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <array>
+#include <functional>
+#include <boost/optional.hpp>
+#include "i_native_graphics_context.hpp"
+#include "software_frame_buffer.hpp"
+#include "software_glyph_cache.hpp"
+
+namespace neogfx
+{
+	class i_widget;
+
+	// Renders the graphics operation queue into a software_frame_buffer without touching a GPU; textures drawn
+	// with this context must be software textures (see software_texture_manager).
+	class software_graphics_context : public i_native_graphics_context
+	{
+	private:
+		typedef xyz vertex;
+		typedef std::vector<point> polygon;
+		typedef std::vector<polygon> polygon_list;
+		typedef std::function<void(int32_t aY, int32_t aX, int32_t aLength, const uint8_t* aCoverage)> span_handler;
+		struct span_bounds
+		{
+			int32_t left;
+			int32_t top;
+			int32_t right;
+			int32_t bottom;
+		};
+		typedef std::array<software_frame_buffer::pixel, 256> gradient_lookup_table;
+	public:
+		software_graphics_context(const i_native_surface& aSurface, software_frame_buffer& aFrameBuffer, software_glyph_cache& aGlyphCache);
+		software_graphics_context(const i_native_surface& aSurface, software_frame_buffer& aFrameBuffer, software_glyph_cache& aGlyphCache, const i_widget& aWidget);
+		software_graphics_context(const software_graphics_context& aOther);
+		~software_graphics_context();
+	public:
+		std::unique_ptr<i_native_graphics_context> clone() const override;
+	public:
+		const i_native_surface& surface() const override;
+		software_frame_buffer& frame_buffer() const;
+		rect rendering_area(bool aConsiderScissor = true) const;
+	public:
+		void enqueue(const graphics_operation::operation& aOperation) override;
+		void flush() override;
+	public:
+		const std::pair<vec2, vec2>& logical_coordinates() const override;
+	private:
+		neogfx::logical_coordinate_system logical_coordinate_system() const;
+		void set_logical_coordinate_system(neogfx::logical_coordinate_system aSystem);
+		void set_logical_coordinates(const std::pair<vec2, vec2>& aCoordinates) const;
+		void scissor_on(const rect& aRect);
+		void scissor_off();
+		optional_rect scissor_rect() const;
+		void clip_to(const rect& aRect);
+		void clip_to(const path& aPath, dimension aPathOutline);
+		void reset_clip();
+		neogfx::smoothing_mode smoothing_mode() const;
+		void set_smoothing_mode(neogfx::smoothing_mode aSmoothingMode);
+		void push_logical_operation(logical_operation aLogicalOperation);
+		void pop_logical_operation();
+		void line_stipple_on(uint32_t aFactor, uint16_t aPattern);
+		void line_stipple_off();
+		bool is_subpixel_rendering_on() const;
+		void subpixel_rendering_on();
+		void subpixel_rendering_off();
+		void clear(const colour& aColour);
+		void set_pixel(const point& aPoint, const colour& aColour);
+		void draw_pixel(const point& aPoint, const colour& aColour);
+		void draw_line(const point& aFrom, const point& aTo, const pen& aPen);
+		void draw_rect(const rect& aRect, const pen& aPen);
+		void draw_rounded_rect(const rect& aRect, dimension aRadius, const pen& aPen);
+		void draw_circle(const point& aCentre, dimension aRadius, const pen& aPen, angle aStartAngle);
+		void draw_arc(const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, const pen& aPen);
+		void draw_path(const path& aPath, const pen& aPen);
+		void draw_shape(const vec2_list& aVertices, const pen& aPen);
+		void fill_rect(const rect& aRect, const fill& aFill);
+		void fill_rounded_rect(const rect& aRect, dimension aRadius, const fill& aFill);
+		void fill_circle(const point& aCentre, dimension aRadius, const fill& aFill);
+		void fill_arc(const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, const fill& aFill);
+		void fill_path(const path& aPath, const fill& aFill);
+		void fill_shape(const vec2_list& aVertices, const fill& aFill);
+		void draw_glyph(const point& aPoint, const glyph& aGlyph, const font& aFont, const colour& aColour);
+		void draw_texture(const texture_map& aTextureMap, const i_texture& aTexture, const rect& aTextureRect, const optional_colour& aColour, shader_effect aShaderEffect);
+	private:
+		point to_device(const point& aPoint) const;
+		point to_device(const vertex& aVertex) const;
+		polygon to_device(const std::vector<vertex>& aVertices) const;
+		rect to_device(const rect& aRect) const;
+		polygon_list path_polygons(const path& aPath) const;
+		polygon_list line_polygons(const std::vector<vertex>& aVertices, bool aLineStrip, const pen& aPen) const;
+		const span_bounds& bounds() const;
+		void update_bounds();
+		void rasterize(const polygon_list& aPolygons, const span_bounds& aBounds, const span_handler& aHandler);
+		void fill_polygons(const polygon_list& aPolygons, const fill& aFill, const rect& aFillBoundingBox);
+		void compose_span(int32_t aY, int32_t aX, int32_t aLength, const uint8_t* aCoverage, const colour& aColour);
+		void compose_span(int32_t aY, int32_t aX, int32_t aLength, const uint8_t* aCoverage, const fill& aFill);
+		void compose_source_span(int32_t aY, int32_t aX, int32_t aLength, const uint8_t* aCoverage);
+		void gradient_on(const gradient& aGradient, const rect& aBoundingBox);
+		double gradient_position(const point& aDevicePosition) const;
+	private:
+		const i_native_surface& iSurface;
+		software_frame_buffer& iFrameBuffer;
+		software_glyph_cache& iGlyphCache;
+		graphics_operation::queue iQueue;
+		neogfx::logical_coordinate_system iLogicalCoordinateSystem;
+		mutable std::pair<vec2, vec2> iLogicalCoordinates;
+		neogfx::smoothing_mode iSmoothingMode;
+		bool iSubpixelRendering;
+		std::vector<logical_operation> iLogicalOperationStack;
+		std::vector<rect> iScissorRects;
+		span_bounds iBounds;
+		uint32_t iClipCounter;
+		std::vector<uint8_t> iClipMask;
+		boost::optional<std::pair<uint32_t, uint16_t>> iLineStipple;
+		boost::optional<gradient> iGradient;
+		gradient_lookup_table iGradientLookupTable;
+		rect iGradientBoundingBox;
+		std::vector<float> iCoverageAccumulator;
+		std::vector<uint8_t> iCoverage;
+		std::vector<software_frame_buffer::pixel> iSourceSpan;
+	};
+}
\ No newline at end of file
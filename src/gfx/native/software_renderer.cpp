@@ -0,0 +1,319 @@
+// software_renderer.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <chrono>
+#include <neolib/raii.hpp>
+#include <neogfx/app/app.hpp>
+#include <neogfx/hid/surface_manager.hpp>
+#include "../../gui/window/native/software_window.hpp"
+#include "software_renderer.hpp"
+
+namespace neogfx
+{
+	dimension detail::software_screen_metrics::horizontal_dpi() const
+	{
+		return kDpi;
+	}
+
+	dimension detail::software_screen_metrics::vertical_dpi() const
+	{
+		return kDpi;
+	}
+
+	bool detail::software_screen_metrics::metrics_available() const
+	{
+		return false;
+	}
+
+	size detail::software_screen_metrics::extents() const
+	{
+		throw unsupported_function();
+	}
+
+	dimension detail::software_screen_metrics::em_size() const
+	{
+		throw unsupported_function();
+	}
+
+	i_screen_metrics::subpixel_format_e detail::software_screen_metrics::subpixel_format() const
+	{
+		return SubpixelFormatNone;
+	}
+
+	software_renderer::software_renderer() :
+		iFontManager{ *this, iScreenMetrics },
+		iActiveContextSurface{ nullptr },
+		iCreatingWindow{ 0u },
+		iSubpixelRendering{ false },
+		iOperationReordering{ false },
+		iWakePending{ false }
+	{
+	}
+
+	software_renderer::~software_renderer()
+	{
+	}
+
+	renderer software_renderer::renderer() const
+	{
+		return neogfx::renderer::Software;
+	}
+
+	bool software_renderer::double_buffering() const
+	{
+		return false;
+	}
+
+	void software_renderer::initialize()
+	{
+	}
+
+	const i_native_surface* software_renderer::active_context_surface() const
+	{
+		return iActiveContextSurface;
+	}
+
+	void software_renderer::activate_context(const i_native_surface& aSurface)
+	{
+		iActiveContextSurface = &aSurface;
+	}
+
+	void software_renderer::deactivate_context()
+	{
+		iActiveContextSurface = nullptr;
+	}
+
+	i_rendering_engine::opengl_context software_renderer::create_context(const i_native_surface&)
+	{
+		return nullptr;
+	}
+
+	void software_renderer::destroy_context(opengl_context)
+	{
+	}
+
+	const i_screen_metrics& software_renderer::screen_metrics() const
+	{
+		return iScreenMetrics;
+	}
+
+	std::unique_ptr<i_native_window> software_renderer::create_window(i_surface_manager& aSurfaceManager, i_window& aWindow, const video_mode& aVideoMode, const std::string& aWindowTitle, window_style aStyle)
+	{
+		return create_window(aSurfaceManager, aWindow, size{ static_cast<dimension>(aVideoMode.width()), static_cast<dimension>(aVideoMode.height()) }, aWindowTitle, aStyle);
+	}
+
+	std::unique_ptr<i_native_window> software_renderer::create_window(i_surface_manager& aSurfaceManager, i_window& aWindow, const size& aDimensions, const std::string& aWindowTitle, window_style aStyle)
+	{
+		return create_window(aSurfaceManager, aWindow, point{}, aDimensions, aWindowTitle, aStyle);
+	}
+
+	std::unique_ptr<i_native_window> software_renderer::create_window(i_surface_manager& aSurfaceManager, i_window& aWindow, const point& aPosition, const size& aDimensions, const std::string&, window_style aStyle)
+	{
+		neolib::scoped_counter sc(iCreatingWindow);
+		return std::unique_ptr<i_native_window>(new software_window(*this, aSurfaceManager, aWindow, aPosition, aDimensions, aStyle));
+	}
+
+	std::unique_ptr<i_native_window> software_renderer::create_window(i_surface_manager& aSurfaceManager, i_window& aWindow, i_native_surface&, const video_mode& aVideoMode, const std::string& aWindowTitle, window_style aStyle)
+	{
+		return create_window(aSurfaceManager, aWindow, aVideoMode, aWindowTitle, aStyle);
+	}
+
+	std::unique_ptr<i_native_window> software_renderer::create_window(i_surface_manager& aSurfaceManager, i_window& aWindow, i_native_surface&, const size& aDimensions, const std::string& aWindowTitle, window_style aStyle)
+	{
+		return create_window(aSurfaceManager, aWindow, aDimensions, aWindowTitle, aStyle);
+	}
+
+	std::unique_ptr<i_native_window> software_renderer::create_window(i_surface_manager& aSurfaceManager, i_window& aWindow, i_native_surface&, const point& aPosition, const size& aDimensions, const std::string& aWindowTitle, window_style aStyle)
+	{
+		return create_window(aSurfaceManager, aWindow, aPosition, aDimensions, aWindowTitle, aStyle);
+	}
+
+	bool software_renderer::creating_window() const
+	{
+		return iCreatingWindow != 0;
+	}
+
+	i_font_manager& software_renderer::font_manager()
+	{
+		return iFontManager;
+	}
+
+	i_texture_manager& software_renderer::texture_manager()
+	{
+		return iTextureManager;
+	}
+
+	bool software_renderer::shader_program_active() const
+	{
+		return false;
+	}
+
+	void software_renderer::activate_shader_program(i_native_graphics_context&, i_shader_program&)
+	{
+		throw no_shader_programs();
+	}
+
+	void software_renderer::deactivate_shader_program()
+	{
+		throw no_shader_program_active();
+	}
+
+	const i_rendering_engine::i_shader_program& software_renderer::active_shader_program() const
+	{
+		throw no_shader_program_active();
+	}
+
+	i_rendering_engine::i_shader_program& software_renderer::active_shader_program()
+	{
+		throw no_shader_program_active();
+	}
+
+	const i_rendering_engine::i_shader_program& software_renderer::default_shader_program() const
+	{
+		throw no_shader_programs();
+	}
+
+	i_rendering_engine::i_shader_program& software_renderer::default_shader_program()
+	{
+		throw no_shader_programs();
+	}
+
+	const i_rendering_engine::i_shader_program& software_renderer::texture_shader_program() const
+	{
+		throw no_shader_programs();
+	}
+
+	i_rendering_engine::i_shader_program& software_renderer::texture_shader_program()
+	{
+		throw no_shader_programs();
+	}
+
+	const i_rendering_engine::i_shader_program& software_renderer::monochrome_shader_program() const
+	{
+		throw no_shader_programs();
+	}
+
+	i_rendering_engine::i_shader_program& software_renderer::monochrome_shader_program()
+	{
+		throw no_shader_programs();
+	}
+
+	const i_rendering_engine::i_shader_program& software_renderer::glyph_shader_program(bool) const
+	{
+		throw no_shader_programs();
+	}
+
+	i_rendering_engine::i_shader_program& software_renderer::glyph_shader_program(bool)
+	{
+		throw no_shader_programs();
+	}
+
+	const i_rendering_engine::i_shader_program& software_renderer::gradient_shader_program() const
+	{
+		throw no_shader_programs();
+	}
+
+	i_rendering_engine::i_shader_program& software_renderer::gradient_shader_program()
+	{
+		throw no_shader_programs();
+	}
+
+	bool software_renderer::is_subpixel_rendering_on() const
+	{
+		return iSubpixelRendering;
+	}
+
+	void software_renderer::subpixel_rendering_on()
+	{
+		if (!iSubpixelRendering)
+		{
+			iSubpixelRendering = true;
+			subpixel_rendering_changed.trigger();
+		}
+	}
+
+	void software_renderer::subpixel_rendering_off()
+	{
+		if (iSubpixelRendering)
+		{
+			iSubpixelRendering = false;
+			subpixel_rendering_changed.trigger();
+		}
+	}
+
+	bool software_renderer::is_operation_reordering_on() const
+	{
+		return iOperationReordering;
+	}
+
+	void software_renderer::operation_reordering_on()
+	{
+		iOperationReordering = true;
+	}
+
+	void software_renderer::operation_reordering_off()
+	{
+		iOperationReordering = false;
+	}
+
+	void software_renderer::render_now()
+	{
+		app::instance().surface_manager().render_surfaces();
+	}
+
+	bool software_renderer::process_events()
+	{
+		// the only events are those pushed onto the windows themselves (e.g. synthesized input)
+		bool didSome = false;
+		for (std::size_t s = 0; s < app::instance().surface_manager().surface_count(); ++s)
+		{
+			auto& surface = app::instance().surface_manager().surface(s);
+			while (!surface.destroyed() && surface.native_surface().pump_event())
+				didSome = true;
+		}
+		return didSome;
+	}
+
+	bool software_renderer::wait_for_events(const boost::optional<uint32_t>& aTimeout_ms)
+	{
+		std::unique_lock<std::mutex> lock(iWakeMutex);
+		bool woken = true;
+		if (aTimeout_ms == boost::none)
+			iWakeCondition.wait(lock, [this]() { return iWakePending; });
+		else
+			woken = iWakeCondition.wait_for(lock, std::chrono::milliseconds(*aTimeout_ms), [this]() { return iWakePending; });
+		iWakePending = false;
+		return woken;
+	}
+
+	void software_renderer::wake()
+	{
+		{
+			std::lock_guard<std::mutex> lg(iWakeMutex);
+			iWakePending = true;
+		}
+		iWakeCondition.notify_one();
+	}
+
+	software_glyph_cache& software_renderer::glyph_cache()
+	{
+		return iGlyphCache;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+// software_renderer.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <mutex>
+#include <condition_variable>
+#include <neogfx/gfx/i_rendering_engine.hpp>
+#include <neogfx/gfx/text/font_manager.hpp>
+#include "software_texture_manager.hpp"
+#include "software_glyph_cache.hpp"
+
+namespace neogfx
+{
+	namespace detail
+	{
+		// Fixed metrics so that headless rendering is the same on every machine.
+		class software_screen_metrics : public i_screen_metrics
+		{
+		public:
+			struct unsupported_function : std::logic_error { unsupported_function() : std::logic_error("neogfx::detail::software_screen_metrics::unsupported_function") {} };
+		public:
+			static const uint32_t kDpi = 96;
+		public:
+			virtual dimension horizontal_dpi() const;
+			virtual dimension vertical_dpi() const;
+			virtual bool metrics_available() const;
+			virtual size extents() const;
+			virtual dimension em_size() const;
+			virtual subpixel_format_e subpixel_format() const;
+		};
+	}
+
+	// Headless rendering engine: windows are in-memory software_frame_buffers rendered by software_graphics_context
+	// so no display or GPU is needed. Selected with renderer::Software (the "--software" program option).
+	class software_renderer : public i_rendering_engine
+	{
+	public:
+		struct no_shader_programs : std::logic_error { no_shader_programs() : std::logic_error("neogfx::software_renderer::no_shader_programs") {} };
+	public:
+		software_renderer();
+		~software_renderer();
+	public:
+		virtual neogfx::renderer renderer() const;
+		virtual bool double_buffering() const;
+		virtual void initialize();
+		virtual const i_native_surface* active_context_surface() const;
+		virtual void activate_context(const i_native_surface& aSurface);
+		virtual void deactivate_context();
+		virtual opengl_context create_context(const i_native_surface& aSurface);
+		virtual void destroy_context(opengl_context aContext);
+		virtual const i_screen_metrics& screen_metrics() const;
+		virtual std::unique_ptr<i_native_window> create_window(i_surface_manager& aSurfaceManager, i_window& aWindow, const video_mode& aVideoMode, const std::string& aWindowTitle, window_style aStyle);
+		virtual std::unique_ptr<i_native_window> create_window(i_surface_manager& aSurfaceManager, i_window& aWindow, const size& aDimensions, const std::string& aWindowTitle, window_style aStyle);
+		virtual std::unique_ptr<i_native_window> create_window(i_surface_manager& aSurfaceManager, i_window& aWindow, const point& aPosition, const size& aDimensions, const std::string& aWindowTitle, window_style aStyle);
+		virtual std::unique_ptr<i_native_window> create_window(i_surface_manager& aSurfaceManager, i_window& aWindow, i_native_surface& aParent, const video_mode& aVideoMode, const std::string& aWindowTitle, window_style aStyle);
+		virtual std::unique_ptr<i_native_window> create_window(i_surface_manager& aSurfaceManager, i_window& aWindow, i_native_surface& aParent, const size& aDimensions, const std::string& aWindowTitle, window_style aStyle);
+		virtual std::unique_ptr<i_native_window> create_window(i_surface_manager& aSurfaceManager, i_window& aWindow, i_native_surface& aParent, const point& aPosition, const size& aDimensions, const std::string& aWindowTitle, window_style aStyle);
+		virtual bool creating_window() const;
+		virtual i_font_manager& font_manager();
+		virtual i_texture_manager& texture_manager();
+		virtual bool shader_program_active() const;
+		virtual void activate_shader_program(i_native_graphics_context& aGraphicsContext, i_shader_program& aProgram);
+		virtual void deactivate_shader_program();
+		virtual const i_shader_program& active_shader_program() const;
+		virtual i_shader_program& active_shader_program();
+		virtual const i_shader_program& default_shader_program() const;
+		virtual i_shader_program& default_shader_program();
+		virtual const i_shader_program& texture_shader_program() const;
+		virtual i_shader_program& texture_shader_program();
+		virtual const i_shader_program& monochrome_shader_program() const;
+		virtual i_shader_program& monochrome_shader_program();
+		virtual const i_shader_program& glyph_shader_program(bool aSubpixel) const;
+		virtual i_shader_program& glyph_shader_program(bool aSubpixel);
+		virtual const i_shader_program& gradient_shader_program() const;
+		virtual i_shader_program& gradient_shader_program();
+	public:
+		virtual bool is_subpixel_rendering_on() const;
+		virtual void subpixel_rendering_on();
+		virtual void subpixel_rendering_off();
+		virtual bool is_operation_reordering_on() const;
+		virtual void operation_reordering_on();
+		virtual void operation_reordering_off();
+	public:
+		virtual void render_now();
+	public:
+		virtual bool process_events();
+		virtual bool wait_for_events(const boost::optional<uint32_t>& aTimeout_ms);
+		virtual void wake();
+	public:
+		software_glyph_cache& glyph_cache();
+	private:
+		detail::software_screen_metrics iScreenMetrics;
+		software_texture_manager iTextureManager;
+		neogfx::font_manager iFontManager;
+		software_glyph_cache iGlyphCache;
+		const i_native_surface* iActiveContextSurface;
+		uint32_t iCreatingWindow;
+		bool iSubpixelRendering;
+		bool iOperationReordering;
+		std::mutex iWakeMutex;
+		std::condition_variable iWakeCondition;
+		bool iWakePending;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+// software_texture.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include "software_texture.hpp"
+
+namespace neogfx
+{
+	software_texture::software_texture(const neogfx::size& aExtents, texture_sampling aSampling, const optional_colour& aColour) :
+		iSampling(aSampling),
+		iSize(aExtents),
+		iStorage(size{ iSize.cx + 2.0, iSize.cy + 2.0 }),
+		iUri("neogfx::software_texture::internal")
+	{
+		if (aColour != boost::none)
+			iStorage.fill_rect(rect{ point{ 1.0, 1.0 }, size{ iSize } }, *aColour);
+	}
+
+	software_texture::software_texture(const i_image& aImage) :
+		iSampling(aImage.sampling()),
+		iSize(aImage.extents()),
+		iStorage(size{ iSize.cx + 2.0, iSize.cy + 2.0 }),
+		iUri(aImage.uri())
+	{
+		switch (aImage.colour_format())
+		{
+		case colour_format::RGBA8:
+			set_pixels(rect{ point{}, size{ iSize } }, aImage.data());
+			break;
+		default:
+			throw unsupported_colour_format();
+		}
+	}
+
+	software_texture::~software_texture()
+	{
+	}
+
+	texture_sampling software_texture::sampling() const
+	{
+		return iSampling;
+	}
+
+	size software_texture::extents() const
+	{
+		return iSize;
+	}
+
+	size software_texture::storage_extents() const
+	{
+		return iStorage.extents();
+	}
+
+	void software_texture::set_pixels(const rect& aRect, const void* aPixelData)
+	{
+		set_pixels(aRect, aPixelData, true);
+	}
+
+	void software_texture::set_pixels(const rect& aRect, const void* aPixelData, bool aGenerateMipmaps)
+	{
+		set_storage_pixels(aRect + point{ 1.0, 1.0 }, aPixelData, aGenerateMipmaps);
+	}
+
+	void software_texture::set_storage_pixels(const rect& aStorageRect, const void* aPixelData, bool)
+	{
+		const software_frame_buffer::pixel* source = static_cast<const software_frame_buffer::pixel*>(aPixelData);
+		int32_t x = static_cast<int32_t>(aStorageRect.x);
+		int32_t y = static_cast<int32_t>(aStorageRect.y);
+		int32_t cx = static_cast<int32_t>(aStorageRect.cx);
+		int32_t cy = static_cast<int32_t>(aStorageRect.cy);
+		for (int32_t row = 0; row < cy; ++row)
+		{
+			if (y + row < 0 || y + row >= iStorage.height())
+				continue;
+			for (int32_t column = 0; column < cx; ++column)
+				if (x + column >= 0 && x + column < iStorage.width())
+					iStorage.scanline(y + row)[x + column] = source[row * cx + column];
+		}
+	}
+
+	void software_texture::clear_pixels(const rect& aRect)
+	{
+		std::vector<software_frame_buffer::pixel> transparent(static_cast<std::size_t>(aRect.cx) * static_cast<std::size_t>(aRect.cy));
+		set_pixels(aRect, transparent.empty() ? nullptr : &transparent[0], false);
+	}
+
+	void software_texture::generate_mipmaps()
+	{
+	}
+
+	void* software_texture::handle() const
+	{
+		return &iStorage;
+	}
+
+	bool software_texture::is_resident() const
+	{
+		return true;
+	}
+
+	const std::string& software_texture::uri() const
+	{
+		return iUri;
+	}
+}
\ No newline at end of file
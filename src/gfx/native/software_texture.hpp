@@ -0,0 +1,60 @@
+// software_texture.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <neogfx/core/geometry.hpp>
+#include <neogfx/gfx/i_image.hpp>
+#include "i_native_texture.hpp"
+#include "software_frame_buffer.hpp"
+
+namespace neogfx
+{
+	// CPU resident texture for use with software_graphics_context; as with opengl_texture the pixel storage has a one
+	// pixel border so texture coordinates are interchangeable between the two backends. handle() returns the
+	// storage (a software_frame_buffer).
+	class software_texture : public i_native_texture
+	{
+	public:
+		struct unsupported_colour_format : std::runtime_error { unsupported_colour_format() : std::runtime_error("neogfx::software_texture::unsupported_colour_format") {} };
+	public:
+		software_texture(const neogfx::size& aExtents, texture_sampling aSampling = texture_sampling::NormalMipmap, const optional_colour& aColour = optional_colour());
+		software_texture(const i_image& aImage);
+		~software_texture();
+	public:
+		texture_sampling sampling() const override;
+		size extents() const override;
+		size storage_extents() const override;
+		void set_pixels(const rect& aRect, const void* aPixelData) override;
+		void set_pixels(const rect& aRect, const void* aPixelData, bool aGenerateMipmaps) override;
+		void set_storage_pixels(const rect& aStorageRect, const void* aPixelData, bool aGenerateMipmaps) override;
+		void clear_pixels(const rect& aRect) override;
+		void generate_mipmaps() override;
+	public:
+		void* handle() const override;
+		bool is_resident() const override;
+		const std::string& uri() const override;
+	private:
+		texture_sampling iSampling;
+		basic_size<uint32_t> iSize;
+		mutable software_frame_buffer iStorage;
+		std::string iUri;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+// vertex_helpers.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <vector>
+#include <boost/math/constants/constants.hpp>
+#include <neogfx/core/geometry.hpp>
+#include <neogfx/gfx/pen.hpp>
+
+namespace neogfx
+{
+	enum class rect_type
+	{
+		Filled,
+		Outline
+	};
+
+	// The helpers build vertices of any std::array based type so the OpenGL back end can build float vertices directly.
+	template <typename Vertex>
+	inline Vertex make_vertex(coordinate aX, coordinate aY)
+	{
+		typedef typename Vertex::value_type value_type;
+		return Vertex{ { static_cast<value_type>(aX), static_cast<value_type>(aY) } };
+	}
+
+	template <typename Vertex = xyz>
+	inline std::vector<Vertex> rect_vertices(const rect& aRect, dimension aPixelAdjust, rect_type aType)
+	{
+		std::vector<Vertex> result;
+		result.reserve(16);
+		if (aType == rect_type::Filled) // fill
+		{
+			result.push_back(make_vertex<Vertex>(aRect.centre().x, aRect.centre().y));
+			result.push_back(make_vertex<Vertex>(aRect.top_left().x, aRect.top_left().y));
+			result.push_back(make_vertex<Vertex>(aRect.top_right().x, aRect.top_right().y));
+			result.push_back(make_vertex<Vertex>(aRect.bottom_right().x, aRect.bottom_right().y));
+			result.push_back(make_vertex<Vertex>(aRect.bottom_left().x, aRect.bottom_left().y));
+			result.push_back(make_vertex<Vertex>(aRect.top_left().x, aRect.top_left().y));
+		}
+		else // draw (outline)
+		{
+			result.push_back(make_vertex<Vertex>(aRect.top_left().x, aRect.top_left().y + aPixelAdjust));
+			result.push_back(make_vertex<Vertex>(aRect.top_right().x, aRect.top_right().y + aPixelAdjust));
+			result.push_back(make_vertex<Vertex>(aRect.top_right().x - aPixelAdjust, aRect.top_right().y));
+			result.push_back(make_vertex<Vertex>(aRect.bottom_right().x - aPixelAdjust, aRect.bottom_right().y));
+			result.push_back(make_vertex<Vertex>(aRect.bottom_right().x, aRect.bottom_right().y - aPixelAdjust));
+			result.push_back(make_vertex<Vertex>(aRect.bottom_left().x, aRect.bottom_left().y - aPixelAdjust));
+			result.push_back(make_vertex<Vertex>(aRect.bottom_left().x + aPixelAdjust, aRect.bottom_left().y));
+			result.push_back(make_vertex<Vertex>(aRect.top_left().x + aPixelAdjust, aRect.top_left().y));
+		}
+		return result;
+	};
+
+	template <typename Vertex = xyz>
+	inline std::vector<Vertex> arc_vertices(const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, bool aIncludeCentre)
+	{
+		std::vector<Vertex> result;
+		angle arc = (aEndAngle != aStartAngle ? aEndAngle - aStartAngle : boost::math::constants::two_pi<angle>());
+		uint32_t segments = static_cast<uint32_t>(std::ceil(std::sqrt(aRadius) * 10.0) * arc / boost::math::constants::two_pi<angle>());
+		angle theta = arc / static_cast<angle>(segments);
+		result.reserve((segments + (aIncludeCentre ? 2 : 1)) * 2);
+		if (aIncludeCentre)
+		{
+			result.push_back(make_vertex<Vertex>(aCentre.x, aCentre.y));
+		}
+		auto c = std::cos(theta);
+		auto s = std::sin(theta);
+		auto startCoordinate = mat22{ { std::cos(aStartAngle), std::sin(aStartAngle) },{ -std::sin(aStartAngle), std::cos(aStartAngle) } } *
+			vec2{ aRadius, 0.0 };
+		coordinate x = startCoordinate.x;
+		coordinate y = startCoordinate.y;
+		for (uint32_t i = 0; i < segments; ++i)
+		{
+			result.push_back(make_vertex<Vertex>(x + aCentre.x, y + aCentre.y));
+			coordinate t = x;
+			x = c * x - s * y;
+			y = s * t + c * y;
+		}
+		return result;
+	}
+
+	template <typename Vertex = xyz>
+	inline std::vector<Vertex> circle_vertices(const point& aCentre, dimension aRadius, angle aStartAngle, bool aIncludeCentre)
+	{
+		auto result = arc_vertices<Vertex>(aCentre, aRadius, aStartAngle, aStartAngle, aIncludeCentre);
+		result.push_back(result[aIncludeCentre ? 1 : 0]);
+		return result;
+	}
+
+	template <typename Vertex = xyz>
+	inline std::vector<Vertex> rounded_rect_vertices(const rect& aRect, dimension aRadius, bool aIncludeCentre)
+	{
+		std::vector<Vertex> result;
+		auto topLeft = arc_vertices<Vertex>(
+			aRect.top_left() + point{ aRadius, aRadius },
+			aRadius,
+			boost::math::constants::pi<coordinate>(),
+			boost::math::constants::pi<coordinate>() * 1.5,
+			false);
+		auto topRight = arc_vertices<Vertex>(
+			aRect.top_right() + point{ -aRadius, aRadius },
+			aRadius,
+			boost::math::constants::pi<coordinate>() * 1.5,
+			boost::math::constants::pi<coordinate>() * 2.0,
+			false);
+		auto bottomRight = arc_vertices<Vertex>(
+			aRect.bottom_right() + point{ -aRadius, -aRadius },
+			aRadius,
+			0.0,
+			boost::math::constants::pi<coordinate>() * 0.5,
+			false);
+		auto bottomLeft = arc_vertices<Vertex>(
+			aRect.bottom_left() + point{ aRadius, -aRadius },
+			aRadius,
+			boost::math::constants::pi<coordinate>() * 0.5,
+			boost::math::constants::pi<coordinate>(),
+			false);
+		result.reserve(topLeft.size() + topRight.size() + bottomRight.size() + bottomLeft.size() + (aIncludeCentre ? 9 : 8));
+		if (aIncludeCentre)
+		{
+			result.push_back(make_vertex<Vertex>(aRect.centre().x, aRect.centre().y));
+		}
+		result.push_back(make_vertex<Vertex>(aRect.top_left().x, aRect.top_left().y + aRadius));
+		result.insert(result.end(), topLeft.begin(), topLeft.end());
+		result.push_back(make_vertex<Vertex>(aRect.top_left().x + aRadius, aRect.top_left().y));
+		result.push_back(make_vertex<Vertex>(aRect.top_right().x - aRadius, aRect.top_right().y));
+		result.insert(result.end(), topRight.begin(), topRight.end());
+		result.push_back(make_vertex<Vertex>(aRect.top_right().x, aRect.top_right().y + aRadius));
+		result.push_back(make_vertex<Vertex>(aRect.bottom_right().x, aRect.bottom_right().y - aRadius));
+		result.insert(result.end(), bottomRight.begin(), bottomRight.end());
+		result.push_back(make_vertex<Vertex>(aRect.bottom_right().x - aRadius, aRect.bottom_right().y));
+		result.push_back(make_vertex<Vertex>(aRect.bottom_left().x + aRadius, aRect.bottom_left().y));
+		result.insert(result.end(), bottomLeft.begin(), bottomLeft.end());
+		result.push_back(make_vertex<Vertex>(aRect.bottom_left().x, aRect.bottom_left().y - aRadius));
+		result.push_back(result[aIncludeCentre ? 1 : 0]);
+		return result;
+	}
+
+	inline double pixel_adjust(const dimension aWidth)
+	{
+		return static_cast<uint32_t>(aWidth) % 2 == 1 ? 0.5 : 0.0;
+	}
+
+	inline double pixel_adjust(const pen& aPen)
+	{
+		return pixel_adjust(aPen.width());
+	}
+
+	template <typename Vertex>
+	inline std::vector<Vertex> line_loop_to_lines(const std::vector<Vertex>& aLineLoop)
+	{
+		std::vector<Vertex> result;
+		result.reserve(aLineLoop.size() * 2);
+		for (auto v = aLineLoop.begin(); v != aLineLoop.end(); ++v)
+		{
+			result.push_back(*v);
+			if (v != aLineLoop.begin() && v != aLineLoop.end() - 1)
+				result.push_back(*v);
+		}
+		return result;
+	}
+
+	template <typename Vertex = xyz>
+	inline std::vector<Vertex> triangle_fan_to_triangles(const vec2_list& aTriangleFan)
+	{
+		std::vector<Vertex> result;
+		if (aTriangleFan.size() < 3)
+			return result;
+		result.reserve((aTriangleFan.size() - 1) * 3);
+		for (std::size_t i = 1; i < aTriangleFan.size(); ++i)
+		{
+			auto const& next = (i + 1 < aTriangleFan.size() ? aTriangleFan[i + 1] : aTriangleFan[1]);
+			result.push_back(make_vertex<Vertex>(aTriangleFan[0][0], aTriangleFan[0][1]));
+			result.push_back(make_vertex<Vertex>(aTriangleFan[i][0], aTriangleFan[i][1]));
+			result.push_back(make_vertex<Vertex>(next[0], next[1]));
+		}
+		return result;
+	}
+}
\ No newline at end of file
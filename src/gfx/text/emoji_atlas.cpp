@@ -24,7 +24,7 @@
 #include <boost/filesystem.hpp>
 #include <neolib/string_utils.hpp>
 #include <neolib/file.hpp>
-#include <neolib/zip.hpp>
+#include <neogfx/app/resource_manager.hpp>
 #include <neogfx/gfx/image.hpp>
 #include <neogfx/gfx/text/emoji_atlas.hpp>
 
@@ -32,21 +32,23 @@ namespace neogfx
 {
 	emoji_atlas::emoji_atlas(i_texture_manager& aTextureManager) : 
 		kFilePath{ neolib::program_directory() + "/emoji.zip" },
-		iTextureAtlas{ aTextureManager.create_texture_atlas(size{ 1024.0, 1024.0}) }
+		iTextureAtlas{ aTextureManager.create_texture_atlas(size{ 1024.0, 1024.0}) },
+		iSingleEmojiBlockIndex(0x110000 / 256),
+		iSingleEmojiBlocks(1)
 	{
 		try
 		{
-			neolib::zip zipFile(kFilePath);
-			std::istringstream metaDataFile{ zipFile.extract_to_string(zipFile.index_of("meta.json")) };
+			auto zipFile = resource_manager::instance().load_archive("file:///" + kFilePath);
+			std::istringstream metaDataFile{ zipFile->extract_to_string(zipFile->index_of("meta.json")) };
 			boost::property_tree::ptree metaData;
 			boost::property_tree::read_json(metaDataFile, metaData);
 			for (auto const& set : metaData.get_child("sets"))
 			{
 				dimension size = set.second.get<dimension>("size");
 				std::string location = set.second.get<std::string>("location");
-				for (std::size_t i = 0; i < zipFile.file_count(); ++i)
+				for (std::size_t i = 0; i < zipFile->file_count(); ++i)
 				{
-					auto const& filePath = zipFile.file_path(i);
+					auto const& filePath = zipFile->file_path(i);
 					if (filePath.find(location) == 0)
 					{
 						std::u32string codePoints;
@@ -66,6 +68,16 @@ namespace neogfx
 						{
 							iEmojis[codePoints][size] = filePath;
 							iEmojiMap[codePoints] = boost::optional<emoji_id>{};
+							if (codePoints.size() == 1 && codePoints[0] < 0x110000)
+							{
+								auto& blockIndex = iSingleEmojiBlockIndex[codePoints[0] / 256];
+								if (blockIndex == 0)
+								{
+									blockIndex = static_cast<uint16_t>(iSingleEmojiBlocks.size());
+									iSingleEmojiBlocks.push_back(emoji_block{});
+								}
+								iSingleEmojiBlocks[blockIndex].set(codePoints[0] % 256);
+							}
 						}
 					}
 				}
@@ -78,9 +90,9 @@ namespace neogfx
 
 	bool emoji_atlas::is_emoji(char32_t aCodePoint) const
 	{
-		std::u32string str;
-		str += aCodePoint;
-		return is_emoji(str);
+		if (aCodePoint >= 0x110000)
+			return false;
+		return iSingleEmojiBlocks[iSingleEmojiBlockIndex[aCodePoint / 256]].test(aCodePoint % 256);
 	}
 
 	bool emoji_atlas::is_emoji(const std::u32string& aCodePoints) const
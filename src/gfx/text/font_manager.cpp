@@ -19,6 +19,12 @@
 
 #include <neogfx/neogfx.hpp>
 #include <neolib/string_utils.hpp>
+#include <map>
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <ctime>
 #include <boost/filesystem.hpp>
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -27,6 +33,8 @@
 #include <neogfx/gfx/text/font_manager.hpp>
 #include "../../gfx/text/native/native_font_face.hpp"
 #include "../../gfx/text/native/native_font.hpp"
+#include "../../gfx/text/native/glyph_rasterizer.hpp"
+#include "../../gfx/native/i_native_texture.hpp"
 
 namespace neogfx
 {
@@ -59,6 +67,7 @@ namespace neogfx
 			void* aux_handle() const override { return iFontFace.aux_handle(); }
 			uint32_t glyph_index(char32_t aCodePoint) const override { return iFontFace.glyph_index(aCodePoint); }
 			i_glyph_texture& glyph_texture(const glyph& aGlyph) const override { return iFontFace.glyph_texture(aGlyph); }
+			void prefetch_glyph(const glyph& aGlyph) const override { iFontFace.prefetch_glyph(aGlyph); }
 		public:
 			void add_ref() override { iFontFace.add_ref(); }
 			void release() override { iFontFace.release(); }
@@ -110,6 +119,27 @@ namespace neogfx
 #endif
 			}
 
+			std::string get_font_catalog_path()
+			{
+#ifdef WIN32
+				const char* localAppData = std::getenv("LOCALAPPDATA");
+				boost::filesystem::path catalogDirectory = localAppData != nullptr ?
+					boost::filesystem::path{ localAppData } : boost::filesystem::temp_directory_path();
+#else
+				// per user cache directory (XDG base directory specification), never the shared temporary directory
+				boost::filesystem::path catalogDirectory;
+				const char* cacheHome = std::getenv("XDG_CACHE_HOME");
+				const char* home = std::getenv("HOME");
+				if (cacheHome != nullptr && boost::filesystem::path{ cacheHome }.is_absolute())
+					catalogDirectory = cacheHome;
+				else if (home != nullptr && *home != '\0')
+					catalogDirectory = boost::filesystem::path{ home } / ".cache";
+				else
+					return std::string{};
+#endif
+				return (catalogDirectory / "neogfx" / "font_catalog").string();
+			}
+
 			fallback_font_info default_fallback_font_info()
 			{
 #ifdef WIN32
@@ -121,6 +151,107 @@ namespace neogfx
 		}
 	}
 
+	namespace detail
+	{
+		// Cached results of scanning the system font directory, keyed on file path; entries with a zero face count
+		// record files that are not loadable fonts so they are not probed again on every startup.
+		struct font_catalog_entry
+		{
+			uintmax_t fileSize;
+			std::time_t lastWriteTime;
+			std::string familyName;
+			FT_Long faceCount;
+			native_font::style_map styles;
+		};
+		typedef std::map<std::string, font_catalog_entry> font_catalog;
+
+		const std::string kFontCatalogHeader = "neogfx font catalog 1";
+
+		font_catalog load_font_catalog(const std::string& aCatalogPath)
+		{
+			font_catalog result;
+			std::ifstream input{ aCatalogPath };
+			std::string line;
+			if (!std::getline(input, line) || line != kFontCatalogHeader)
+				return result;
+			while (std::getline(input, line))
+			{
+				std::vector<std::string> fields;
+				std::istringstream lineStream{ line };
+				for (std::string field; std::getline(lineStream, field, '\t');)
+					fields.push_back(field);
+				if (fields.size() < 5)
+					continue;
+				try
+				{
+					font_catalog_entry entry;
+					entry.fileSize = std::stoull(fields[1]);
+					entry.lastWriteTime = static_cast<std::time_t>(std::stoll(fields[2]));
+					entry.familyName = fields[3];
+					entry.faceCount = static_cast<FT_Long>(std::stol(fields[4]));
+					if ((fields.size() - 5) % 3 != 0)
+						continue;
+					for (std::size_t i = 5; i < fields.size(); i += 3)
+						entry.styles.emplace(static_cast<font::style_e>(std::stoul(fields[i])), std::make_pair(fields[i + 1], static_cast<FT_Long>(std::stol(fields[i + 2]))));
+					result[fields[0]] = entry;
+				}
+				catch (const std::exception&)
+				{
+				}
+			}
+			return result;
+		}
+
+		void save_font_catalog(const std::string& aCatalogPath, const font_catalog& aCatalog)
+		{
+			auto is_storable = [](const std::string& aString) { return aString.find_first_of("\t\r\n") == std::string::npos; };
+			if (aCatalogPath.empty())
+				return;
+			try
+			{
+				boost::filesystem::path catalogPath{ aCatalogPath };
+				boost::filesystem::create_directories(catalogPath.parent_path());
+#ifndef WIN32
+				boost::filesystem::permissions(catalogPath.parent_path(), boost::filesystem::owner_all);
+#endif
+				// written under a unique name and renamed into place so concurrently starting instances cannot interfere
+				boost::filesystem::path tempPath = catalogPath.parent_path() / boost::filesystem::unique_path(catalogPath.filename().string() + ".%%%%-%%%%-%%%%-%%%%.tmp");
+				boost::system::error_code ec;
+				{
+					std::ofstream output{ tempPath.string(), std::ios::out | std::ios::trunc };
+					output << kFontCatalogHeader << "\n";
+					for (const auto& e : aCatalog)
+					{
+						if (!is_storable(e.first) || !is_storable(e.second.familyName))
+							continue;
+						bool storable = true;
+						for (const auto& s : e.second.styles)
+							storable = storable && is_storable(s.second.first);
+						if (!storable)
+							continue;
+						output << e.first << '\t' << e.second.fileSize << '\t' << static_cast<long long>(e.second.lastWriteTime) << '\t' << e.second.familyName << '\t' << e.second.faceCount;
+						for (const auto& s : e.second.styles)
+							output << '\t' << static_cast<uint32_t>(s.first) << '\t' << s.second.first << '\t' << s.second.second;
+						output << "\n";
+					}
+					output.close();
+					if (!output)
+					{
+						boost::filesystem::remove(tempPath, ec);
+						return;
+					}
+				}
+				boost::filesystem::rename(tempPath, catalogPath, ec);
+				if (ec)
+					boost::filesystem::remove(tempPath, ec);
+			}
+			catch (const std::exception&)
+			{
+				// The catalog is only a cache; failing to write it just means a full rescan next time.
+			}
+		}
+	}
+
 	fallback_font_info::fallback_font_info(std::vector<std::string> aFallbackFontFamilies) :
 		iFallbackFontFamilies(std::move(aFallbackFontFamilies))
 	{
@@ -142,7 +273,11 @@ namespace neogfx
 		iDefaultSystemFontInfo{ detail::platform_specific::default_system_font_info() },
 		iDefaultFallbackFontInfo{ detail::platform_specific::default_fallback_font_info() },
 		iGlyphAtlas{ aRenderingEngine.texture_manager(), size{1024.0, 1024.0} },
-		iEmojiAtlas{ aRenderingEngine.texture_manager() }
+		iEmojiAtlas{ aRenderingEngine.texture_manager() },
+		iGlyphAtlasBudget{ 64u * 1024u * 1024u },
+		iGlyphUse{ 0u },
+		iGlyphUseAtLastTrim{ 0u },
+		iGlyphRasterizer{ std::make_unique<neogfx::glyph_rasterizer>() }
 	{
 		FT_Error error = FT_Init_FreeType(&iFontLib);
 		if (error)
@@ -150,17 +285,40 @@ namespace neogfx
 			throw error_initializing_font_library();
 		}
 		std::string fontsDirectory = detail::platform_specific::get_system_font_directory();
+		std::string catalogPath = detail::platform_specific::get_font_catalog_path();
+		detail::font_catalog oldCatalog = detail::load_font_catalog(catalogPath);
+		detail::font_catalog newCatalog;
+		bool catalogChanged = false;
 		for (boost::filesystem::directory_iterator file(fontsDirectory); file != boost::filesystem::directory_iterator(); ++file)
 		{
 			if (!boost::filesystem::is_regular_file(file->status())) 
 				continue;
-			try
+			std::string fileName = file->path().string();
+			boost::system::error_code ec;
+			uintmax_t fileSize = boost::filesystem::file_size(file->path(), ec);
+			std::time_t lastWriteTime = ec ? 0 : boost::filesystem::last_write_time(file->path(), ec);
+			if (ec)
+				continue;
+			auto existing = oldCatalog.find(fileName);
+			if (existing != oldCatalog.end() && existing->second.fileSize == fileSize && existing->second.lastWriteTime == lastWriteTime)
 			{
-				if (is_font_file(file->path().string()))
+				const auto& entry = newCatalog.emplace(*existing).first->second;
+				if (entry.faceCount != 0)
 				{
-					auto font = iNativeFonts.emplace(iNativeFonts.end(), iRenderingEngine, iFontLib, file->path().string());
+					auto font = iNativeFonts.emplace(iNativeFonts.end(), iRenderingEngine, iFontLib, fileName, entry.familyName, entry.faceCount, entry.styles);
 					iFontFamilies[neolib::make_ci_string(font->family_name())].push_back(font);
 				}
+				continue;
+			}
+			catalogChanged = true;
+			detail::font_catalog_entry entry{ fileSize, lastWriteTime, std::string{}, 0, native_font::style_map{} };
+			try
+			{
+				auto font = iNativeFonts.emplace(iNativeFonts.end(), iRenderingEngine, iFontLib, fileName);
+				iFontFamilies[neolib::make_ci_string(font->family_name())].push_back(font);
+				entry.familyName = font->family_name();
+				entry.faceCount = font->face_count();
+				entry.styles = font->styles();
 			}
 			catch (native_font::failed_to_load_font&)
 			{
@@ -169,13 +327,20 @@ namespace neogfx
 			{
 				throw;
 			}
+			newCatalog.emplace(fileName, entry);
 		}
+		if (catalogChanged || newCatalog.size() != oldCatalog.size())
+			detail::save_font_catalog(catalogPath, newCatalog);
 	}
 
 	font_manager::~font_manager()
 	{
+		iShapedTextCache.clear();
 		iFontFamilies.clear();
+		// every face belongs to one of our native fonts so they are all destroyed here, while the glyph rasterizer
+		// and atlas they deregister from in their destructors still exist
 		iNativeFonts.clear();
+		assert(iFaces.empty());
 		FT_Done_FreeType(iFontLib);
 	}
 
@@ -332,6 +497,140 @@ namespace neogfx
 		return iEmojiAtlas;
 	}
 
+	const neogfx::shaped_text_cache& font_manager::shaped_text_cache() const
+	{
+		return iShapedTextCache;
+	}
+
+	neogfx::shaped_text_cache& font_manager::shaped_text_cache()
+	{
+		return iShapedTextCache;
+	}
+
+	uint64_t font_manager::glyph_atlas_budget() const
+	{
+		return iGlyphAtlasBudget;
+	}
+
+	void font_manager::set_glyph_atlas_budget(uint64_t aBudgetInBytes)
+	{
+		iGlyphAtlasBudget = aBudgetInBytes;
+	}
+
+	void font_manager::trim_glyph_atlas()
+	{
+		// Evicts a page at a time, coldest first: a page is as cold as its most recently used glyph. Pages
+		// used since the last trim are never evicted so glyphs referenced by the frame just rendered survive.
+		// The budget covers both the atlas textures and the CPU copies of their pages kept for staging.
+		while (iGlyphAtlasBudget != 0u && iGlyphAtlas.memory_usage() + glyph_staging_usage() > iGlyphAtlasBudget && iGlyphAtlas.statistics().size() > 1u)
+		{
+			std::map<const i_native_texture*, uint64_t> pageUse;
+			for (auto face : iFaces)
+				face->glyph_page_use(pageUse);
+			auto coldest = std::min_element(pageUse.begin(), pageUse.end(),
+				[](const std::pair<const i_native_texture* const, uint64_t>& aLhs, const std::pair<const i_native_texture* const, uint64_t>& aRhs) { return aLhs.second < aRhs.second; });
+			if (coldest == pageUse.end() || coldest->second > iGlyphUseAtLastTrim)
+				break;
+			for (auto face : iFaces)
+				face->evict_glyphs(*coldest->first);
+			iGlyphPages.erase(coldest->first);
+		}
+		iGlyphUseAtLastTrim = iGlyphUse;
+	}
+
+	void font_manager::update_glyph_atlas()
+	{
+		glyph_rasterizer::completed_glyphs completed;
+		iGlyphRasterizer->take_completed(completed);
+		// a face cancels its outstanding requests when it is destroyed so every result here is for a live face
+		for (auto const& g : completed)
+			std::get<0>(g.first)->install_glyph(std::get<1>(g.first), std::get<2>(g.first), g.second);
+		upload_glyphs();
+	}
+
+	void font_manager::add_face(native_font_face& aFace)
+	{
+		iFaces.insert(&aFace);
+	}
+
+	void font_manager::remove_face(native_font_face& aFace)
+	{
+		assert(iFaces.find(&aFace) != iFaces.end());
+		iGlyphRasterizer->cancel(aFace);
+		iFaces.erase(&aFace);
+	}
+
+	uint64_t font_manager::next_glyph_use()
+	{
+		return ++iGlyphUse;
+	}
+
+	glyph_rasterizer& font_manager::glyph_rasterizer()
+	{
+		return *iGlyphRasterizer;
+	}
+
+	uint64_t font_manager::glyph_staging_usage() const
+	{
+		uint64_t result = 0u;
+		for (auto const& p : iGlyphPages)
+			result += p.second.pixels.size() * sizeof(rasterized_glyph::pixel);
+		return result;
+	}
+
+	void font_manager::stage_glyph(const i_sub_texture& aGlyphTexture, const rasterized_glyph& aGlyph)
+	{
+		// glyphs are accumulated in a CPU copy of their atlas page and the page's dirty rows uploaded in one go
+		auto texture = aGlyphTexture.native_texture();
+		auto& page = iGlyphPages[texture.get()];
+		if (page.texture.expired())
+		{
+			page.texture = texture;
+			page.width = static_cast<uint32_t>(texture->storage_extents().cx);
+			page.height = static_cast<uint32_t>(texture->storage_extents().cy);
+			page.pixels.assign(static_cast<std::size_t>(page.width) * page.height, rasterized_glyph::pixel{});
+			page.dirtyTop = page.height;
+			page.dirtyBottom = 0u;
+		}
+		uint32_t x = static_cast<uint32_t>(aGlyphTexture.atlas_location().x);
+		uint32_t y = static_cast<uint32_t>(aGlyphTexture.atlas_location().y);
+		if (x >= page.width || y >= page.height)
+			return;
+		uint32_t cx = std::min(aGlyph.width, page.width - x);
+		uint32_t cy = std::min(aGlyph.height, page.height - y);
+		for (uint32_t row = 0; row < cy; ++row)
+		{
+			auto source = aGlyph.pixels.begin() + static_cast<std::ptrdiff_t>(row) * aGlyph.width;
+			std::copy(source, source + cx, page.pixels.begin() + (static_cast<std::ptrdiff_t>(y) + row) * page.width + x);
+		}
+		page.dirtyTop = std::min(page.dirtyTop, y);
+		page.dirtyBottom = std::max(page.dirtyBottom, y + cy);
+	}
+
+	void font_manager::upload_glyphs()
+	{
+		for (auto p = iGlyphPages.begin(); p != iGlyphPages.end();)
+		{
+			auto& page = p->second;
+			auto texture = page.texture.lock();
+			if (texture == nullptr)
+			{
+				p = iGlyphPages.erase(p);
+				continue;
+			}
+			if (page.dirtyTop < page.dirtyBottom)
+			{
+				// whole rows so the staged pixels are contiguous; atlas locations are storage coordinates
+				texture->set_storage_pixels(
+					rect{ point{ 0.0, static_cast<coordinate>(page.dirtyTop) }, size{ static_cast<dimension>(page.width), static_cast<dimension>(page.dirtyBottom - page.dirtyTop) } },
+					&page.pixels[static_cast<std::size_t>(page.dirtyTop) * page.width], true);
+				page.dirtyTop = page.height;
+				page.dirtyBottom = 0u;
+			}
+			++p;
+		}
+	}
+
 	i_native_font& font_manager::find_font(const std::string& aFamilyName, const std::string& aStyleName, font::point_size aSize)
 	{
 		auto family = iFontFamilies.find(neolib::make_ci_string(aFamilyName));
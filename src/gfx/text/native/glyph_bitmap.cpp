@@ -0,0 +1,151 @@
+// glyph_bitmap.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <algorithm>
+#include "glyph_bitmap.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NEOGFX_GLYPH_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define NEOGFX_GLYPH_AVX2
+#include <immintrin.h>
+#endif
+
+namespace neogfx
+{
+	namespace
+	{
+		// The filter coefficients are multiples of 1/32 so truncating b * k / 32 in integers matches truncating
+		// the product with the double coefficients exactly.
+		inline uint8_t lcd_filter(uint32_t aLeft2, uint32_t aLeft1, uint32_t aCentre, uint32_t aRight1, uint32_t aRight2)
+		{
+			return static_cast<uint8_t>(((aLeft2 * 3u) >> 5) + ((aLeft1 * 6u) >> 5) + ((aCentre * 14u) >> 5) + ((aRight1 * 6u) >> 5) + ((aRight2 * 3u) >> 5));
+		}
+
+		inline uint8_t lcd_filter_clamped(const uint8_t* aSource, uint32_t aWidth, uint32_t aX)
+		{
+			auto at = [aSource, aWidth](int64_t aIndex) -> uint32_t { return aSource[std::min<int64_t>(std::max<int64_t>(0, aIndex), aWidth - 1)]; };
+			return lcd_filter(at(aX - 2ll), at(aX - 1ll), at(aX), at(aX + 1ll), at(aX + 2ll));
+		}
+	}
+
+	void lcd_filter_row(const uint8_t* aSource, uint32_t aWidth, uint8_t* aDestination)
+	{
+		uint32_t x = 0;
+		for (; x < aWidth && x < 2u; ++x)
+			aDestination[x] = lcd_filter_clamped(aSource, aWidth, x);
+		// interior sub-pixels have all four neighbours inside the row so need no clamping
+#ifdef NEOGFX_GLYPH_AVX2
+		const __m256i outer = _mm256_set1_epi16(3);
+		const __m256i inner = _mm256_set1_epi16(6);
+		const __m256i centre = _mm256_set1_epi16(14);
+		for (; x + 16u + 2u <= aWidth; x += 16u)
+		{
+			const uint8_t* s = aSource + x;
+			__m256i sum = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s - 2))), outer), 5);
+			sum = _mm256_add_epi16(sum, _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s - 1))), inner), 5));
+			sum = _mm256_add_epi16(sum, _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s))), centre), 5));
+			sum = _mm256_add_epi16(sum, _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 1))), inner), 5));
+			sum = _mm256_add_epi16(sum, _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 2))), outer), 5));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aDestination + x), _mm_packus_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)));
+		}
+#endif
+#ifdef NEOGFX_GLYPH_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i outer128 = _mm_set1_epi16(3);
+		const __m128i inner128 = _mm_set1_epi16(6);
+		const __m128i centre128 = _mm_set1_epi16(14);
+		for (; x + 16u + 2u <= aWidth; x += 16u)
+		{
+			__m128i lo = zero;
+			__m128i hi = zero;
+			const int offsets[] = { -2, -1, 0, 1, 2 };
+			const __m128i coefficients[] = { outer128, inner128, centre128, inner128, outer128 };
+			for (int tap = 0; tap < 5; ++tap)
+			{
+				__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSource + x + offsets[tap]));
+				lo = _mm_add_epi16(lo, _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), coefficients[tap]), 5));
+				hi = _mm_add_epi16(hi, _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), coefficients[tap]), 5));
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aDestination + x), _mm_packus_epi16(lo, hi));
+		}
+#endif
+		for (; x + 2u < aWidth; ++x)
+			aDestination[x] = lcd_filter(aSource[x - 2], aSource[x - 1], aSource[x], aSource[x + 1], aSource[x + 2]);
+		for (; x < aWidth; ++x)
+			aDestination[x] = lcd_filter_clamped(aSource, aWidth, x);
+	}
+
+	void subpixels_to_rgba(const uint8_t* aSource, uint32_t aSubpixels, uint8_t* aDestination)
+	{
+		uint32_t x = 0;
+#ifdef NEOGFX_GLYPH_AVX2
+		// AVX2 implies SSSE3 so a byte shuffle spreads four RGB triples into four RGBA pixels
+		const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		for (; x + 16u <= aSubpixels; x += 12u, aDestination += 16)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aDestination), _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(aSource + x)), spread));
+#endif
+		for (; x + 3u <= aSubpixels; x += 3u, aDestination += 4)
+		{
+			aDestination[0] = aSource[x];
+			aDestination[1] = aSource[x + 1];
+			aDestination[2] = aSource[x + 2];
+			aDestination[3] = 0x00;
+		}
+		if (x < aSubpixels)
+		{
+			aDestination[0] = aSource[x];
+			aDestination[1] = x + 1u < aSubpixels ? aSource[x + 1] : 0x00;
+			aDestination[2] = 0x00;
+			aDestination[3] = 0x00;
+		}
+	}
+
+	void coverage_to_rgba(const uint8_t* aSource, uint32_t aPixels, uint8_t* aDestination)
+	{
+		uint32_t x = 0;
+#ifdef NEOGFX_GLYPH_AVX2
+		for (; x + 8u <= aPixels; x += 8u, aDestination += 32)
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(aDestination), _mm256_slli_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(aSource + x))), 24));
+#endif
+#ifdef NEOGFX_GLYPH_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		for (; x + 16u <= aPixels; x += 16u, aDestination += 64)
+		{
+			__m128i coverage = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSource + x));
+			__m128i lo = _mm_unpacklo_epi8(zero, coverage);
+			__m128i hi = _mm_unpackhi_epi8(zero, coverage);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aDestination), _mm_unpacklo_epi16(zero, lo));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aDestination + 16), _mm_unpackhi_epi16(zero, lo));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aDestination + 32), _mm_unpacklo_epi16(zero, hi));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aDestination + 48), _mm_unpackhi_epi16(zero, hi));
+		}
+#endif
+		for (; x < aPixels; ++x, aDestination += 4)
+		{
+			aDestination[0] = 0x00;
+			aDestination[1] = 0x00;
+			aDestination[2] = 0x00;
+			aDestination[3] = aSource[x];
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+// glyph_bitmap.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+
+namespace neogfx
+{
+	// Kernels for turning FreeType glyph bitmaps into atlas pixels (SSE2/AVX2 where the compiler targets them).
+
+	// Runs one row of an FT_RENDER_MODE_LCD bitmap (aWidth sub-pixels) through the sub-pixel FIR filter
+	// { 1.5, 3, 7, 3, 1.5 } / 16, each tap truncated and neighbours clamped to the row.
+	void lcd_filter_row(const uint8_t* aSource, uint32_t aWidth, uint8_t* aDestination);
+	// Packs filtered sub-pixels into RGBA pixels (R, G, B, 0); a final partial pixel has its missing channels zeroed.
+	void subpixels_to_rgba(const uint8_t* aSource, uint32_t aSubpixels, uint8_t* aDestination);
+	// Expands greyscale coverage into RGBA pixels (0, 0, 0, coverage).
+	void coverage_to_rgba(const uint8_t* aSource, uint32_t aPixels, uint8_t* aDestination);
+}
\ No newline at end of file
@@ -0,0 +1,215 @@
+// glyph_rasterizer.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <algorithm>
+#include "native_font_face.hpp"
+#include "glyph_bitmap.hpp"
+#include "glyph_rasterizer.hpp"
+
+namespace neogfx
+{
+	glyph_rasterizer::glyph_rasterizer() : 
+		iNextTicket(0u), iStopping(false)
+	{
+		std::size_t threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 2u) - 1u;
+		if (threads > kMaxThreads)
+			threads = kMaxThreads;
+		for (std::size_t i = 0; i < threads; ++i)
+		{
+			FT_Library library;
+			if (FT_Init_FreeType(&library) != 0)
+				break;
+			iThreads.emplace_back([this, library]() { run(library); });
+		}
+	}
+
+	glyph_rasterizer::~glyph_rasterizer()
+	{
+		{
+			std::lock_guard<std::mutex> lg(iMutex);
+			iStopping = true;
+			iJobs.clear();
+		}
+		iWorkAvailable.notify_all();
+		for (auto& thread : iThreads)
+			thread.join();
+	}
+
+	void glyph_rasterizer::request(const native_font_face& aFace, const face_source& aSource, uint32_t aGlyphIndex, bool aSubpixel)
+	{
+		if (iThreads.empty())
+			return;
+		glyph_key key{ &aFace, aGlyphIndex, aSubpixel };
+		{
+			std::lock_guard<std::mutex> lg(iMutex);
+			if (iRequests.find(key) != iRequests.end())
+				return;
+			iRequests[key] = ++iNextTicket;
+			iJobs.push_back(job{ key, aSource, iNextTicket });
+		}
+		iWorkAvailable.notify_one();
+	}
+
+	bool glyph_rasterizer::take(const native_font_face& aFace, uint32_t aGlyphIndex, bool aSubpixel, rasterized_glyph& aResult)
+	{
+		glyph_key key{ &aFace, aGlyphIndex, aSubpixel };
+		std::lock_guard<std::mutex> lg(iMutex);
+		auto request = iRequests.find(key);
+		if (request == iRequests.end())
+			return false;
+		// the caller needs the glyph now so a request still queued or in progress is abandoned
+		iRequests.erase(request);
+		auto completed = iCompleted.find(key);
+		if (completed == iCompleted.end())
+			return false;
+		aResult = std::move(completed->second);
+		iCompleted.erase(completed);
+		return true;
+	}
+
+	void glyph_rasterizer::take_completed(completed_glyphs& aResults)
+	{
+		std::lock_guard<std::mutex> lg(iMutex);
+		for (auto& completed : iCompleted)
+		{
+			iRequests.erase(completed.first);
+			aResults.emplace_back(completed.first, std::move(completed.second));
+		}
+		iCompleted.clear();
+	}
+
+	void glyph_rasterizer::cancel(const native_font_face& aFace)
+	{
+		std::lock_guard<std::mutex> lg(iMutex);
+		iJobs.erase(std::remove_if(iJobs.begin(), iJobs.end(), [&aFace](const job& aJob) { return std::get<0>(aJob.key) == &aFace; }), iJobs.end());
+		for (auto r = iRequests.begin(); r != iRequests.end();)
+		{
+			if (std::get<0>(r->first) == &aFace)
+				r = iRequests.erase(r);
+			else
+				++r;
+		}
+		for (auto c = iCompleted.begin(); c != iCompleted.end();)
+		{
+			if (std::get<0>(c->first) == &aFace)
+				c = iCompleted.erase(c);
+			else
+				++c;
+		}
+	}
+
+	void glyph_rasterizer::rasterize(FT_Face aFace, uint32_t aGlyphIndex, bool aSubpixel, rasterized_glyph& aResult)
+	{
+		freetypeCheck(FT_Load_Glyph(aFace, aGlyphIndex, aSubpixel ? FT_LOAD_TARGET_LCD : FT_LOAD_TARGET_NORMAL));
+		freetypeCheck(FT_Render_Glyph(aFace->glyph, aSubpixel ? FT_RENDER_MODE_LCD : FT_RENDER_MODE_NORMAL));
+		const FT_Bitmap& bitmap = aFace->glyph->bitmap;
+
+		aResult.extents = neogfx::size{ static_cast<dimension>(bitmap.width / (aSubpixel ? 3.0 : 1.0)), static_cast<dimension>(bitmap.rows) };
+		aResult.placement = point{
+			aFace->glyph->metrics.horiBearingX / 64.0,
+			(aFace->glyph->metrics.horiBearingY - aFace->glyph->metrics.height) / 64.0 };
+		aResult.width = static_cast<uint32_t>(std::ceil(aResult.extents.cx)) + 2u;
+		aResult.height = bitmap.rows + 2u;
+		aResult.pixels.assign(static_cast<std::size_t>(aResult.width) * aResult.height, rasterized_glyph::pixel{});
+
+		if (bitmap.width == 0)
+			return;
+		if (aSubpixel)
+		{
+			std::vector<uint8_t> filtered(bitmap.width);
+			for (uint32_t y = 0; y < bitmap.rows; y++)
+			{
+				lcd_filter_row(bitmap.buffer + bitmap.pitch * static_cast<std::ptrdiff_t>(y), bitmap.width, &filtered[0]);
+				subpixels_to_rgba(&filtered[0], bitmap.width, &aResult.pixels[1 + (y + 1) * static_cast<std::size_t>(aResult.width)][0]);
+			}
+		}
+		else
+		{
+			for (uint32_t y = 0; y < bitmap.rows; y++)
+				coverage_to_rgba(bitmap.buffer + bitmap.pitch * static_cast<std::ptrdiff_t>(y), bitmap.width, &aResult.pixels[1 + (y + 1) * static_cast<std::size_t>(aResult.width)][0]);
+		}
+	}
+
+	void glyph_rasterizer::run(FT_Library aLibrary)
+	{
+		worker_face_map faces;
+		for (;;)
+		{
+			job nextJob;
+			{
+				std::unique_lock<std::mutex> lock(iMutex);
+				iWorkAvailable.wait(lock, [this]() { return iStopping || !iJobs.empty(); });
+				if (iStopping)
+					break;
+				nextJob = std::move(iJobs.front());
+				iJobs.pop_front();
+			}
+			rasterized_glyph result;
+			bool rasterized = false;
+			try
+			{
+				rasterize(worker_face(aLibrary, faces, nextJob.source), std::get<1>(nextJob.key), std::get<2>(nextJob.key), result);
+				rasterized = true;
+			}
+			catch (...)
+			{
+				// left to the synchronous fallback when the glyph is drawn
+			}
+			std::lock_guard<std::mutex> lg(iMutex);
+			auto request = iRequests.find(nextJob.key);
+			if (request == iRequests.end() || request->second != nextJob.ticket)
+				continue;
+			if (rasterized)
+				iCompleted[nextJob.key] = std::move(result);
+			else
+				iRequests.erase(request);
+		}
+		for (auto& face : faces)
+			FT_Done_Face(face.second);
+		FT_Done_FreeType(aLibrary);
+	}
+
+	FT_Face glyph_rasterizer::worker_face(FT_Library aLibrary, worker_face_map& aFaces, const face_source& aSource)
+	{
+		worker_face_key key{ aSource.fileName, aSource.faceIndex, aSource.size, aSource.dpi };
+		auto existingFace = aFaces.find(key);
+		if (existingFace != aFaces.end())
+			return existingFace->second;
+		if (aFaces.size() >= kMaxWorkerFaces)
+		{
+			for (auto& face : aFaces)
+				FT_Done_Face(face.second);
+			aFaces.clear();
+		}
+		FT_Face newFace;
+		freetypeCheck(FT_New_Face(aLibrary, aSource.fileName.c_str(), aSource.faceIndex, &newFace));
+		try
+		{
+			freetypeCheck(FT_Set_Char_Size(newFace, 0, static_cast<FT_F26Dot6>(aSource.size * 64), static_cast<FT_UInt>(aSource.dpi.cx), static_cast<FT_UInt>(aSource.dpi.cy)));
+			freetypeCheck(FT_Select_Charmap(newFace, FT_ENCODING_UNICODE));
+		}
+		catch (...)
+		{
+			FT_Done_Face(newFace);
+			throw;
+		}
+		return aFaces[key] = newFace;
+	}
+}
\ No newline at end of file
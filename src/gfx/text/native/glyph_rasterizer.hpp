@@ -0,0 +1,102 @@
+// glyph_rasterizer.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <array>
+#include <vector>
+#include <deque>
+#include <map>
+#include <tuple>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <neogfx/core/geometry.hpp>
+#include <neogfx/gfx/text/font.hpp>
+
+namespace neogfx
+{
+	class native_font_face;
+
+	// A glyph ready to be copied into a glyph atlas page: RGBA pixels (coverage in alpha, or per channel for
+	// sub-pixel glyphs) surrounded by a one pixel transparent border.
+	struct rasterized_glyph
+	{
+		typedef std::array<uint8_t, 4> pixel;
+		neogfx::size extents;
+		point placement;
+		uint32_t width;
+		uint32_t height;
+		std::vector<pixel> pixels;
+	};
+
+	// Rasterizes glyphs for newly shaped text on worker threads ahead of them being drawn. Each worker has its
+	// own FT_Library and opens its own faces from the font file as FreeType objects cannot be shared between
+	// threads.
+	class glyph_rasterizer
+	{
+	public:
+		struct face_source
+		{
+			std::string fileName;
+			FT_Long faceIndex;
+			font::point_size size;
+			neogfx::size dpi;
+		};
+		typedef std::tuple<const native_font_face*, uint32_t, bool> glyph_key;
+		typedef std::vector<std::pair<glyph_key, rasterized_glyph>> completed_glyphs;
+	private:
+		struct job
+		{
+			glyph_key key;
+			face_source source;
+			uint64_t ticket;
+		};
+		typedef std::tuple<std::string, FT_Long, font::point_size, neogfx::size> worker_face_key;
+		typedef std::map<worker_face_key, FT_Face> worker_face_map;
+	private:
+		static const std::size_t kMaxThreads = 2u;
+		static const std::size_t kMaxWorkerFaces = 16u;
+	public:
+		glyph_rasterizer();
+		~glyph_rasterizer();
+	public:
+		void request(const native_font_face& aFace, const face_source& aSource, uint32_t aGlyphIndex, bool aSubpixel);
+		bool take(const native_font_face& aFace, uint32_t aGlyphIndex, bool aSubpixel, rasterized_glyph& aResult);
+		void take_completed(completed_glyphs& aResults);
+		void cancel(const native_font_face& aFace);
+	public:
+		static void rasterize(FT_Face aFace, uint32_t aGlyphIndex, bool aSubpixel, rasterized_glyph& aResult);
+	private:
+		void run(FT_Library aLibrary);
+		static FT_Face worker_face(FT_Library aLibrary, worker_face_map& aFaces, const face_source& aSource);
+	private:
+		std::mutex iMutex;
+		std::condition_variable iWorkAvailable;
+		std::deque<job> iJobs;
+		std::map<glyph_key, uint64_t> iRequests;
+		std::map<glyph_key, rasterized_glyph> iCompleted;
+		uint64_t iNextTicket;
+		bool iStopping;
+		std::vector<std::thread> iThreads;
+	};
+}
\ No newline at end of file
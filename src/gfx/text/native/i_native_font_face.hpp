@@ -58,6 +58,7 @@ namespace neogfx
 		virtual void* aux_handle() const = 0;
 		virtual uint32_t glyph_index(char32_t aCodePoint) const = 0;
 		virtual i_glyph_texture& glyph_texture(const glyph& aGlyph) const = 0;
+		virtual void prefetch_glyph(const glyph& aGlyph) const = 0;
 	public:
 		virtual void add_ref() = 0;
 		virtual void release() = 0;
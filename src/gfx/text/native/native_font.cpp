@@ -25,23 +25,25 @@
 namespace neogfx
 {
 	native_font::native_font(i_rendering_engine& aRenderingEngine, FT_Library aFontLib, const std::string aFileName) :
-		iRenderingEngine(aRenderingEngine), iFontLib(aFontLib), iSource(filename_type(aFileName)), iCache{}, iFaceCount(0)
+		iRenderingEngine(aRenderingEngine), iFontLib(aFontLib), iSource(filename_type(aFileName)), iFaceCount(0)
 	{
 		register_face(0);
 		for (FT_Long f = 1; f < iFaceCount; ++f)
 			register_face(f);
-		iCache.clear();
-		iCache.shrink_to_fit();
+		iMappedFile.close();
+	}
+
+	native_font::native_font(i_rendering_engine& aRenderingEngine, FT_Library aFontLib, const std::string aFileName, const std::string& aFamilyName, FT_Long aFaceCount, const style_map& aStyleMap) :
+		iRenderingEngine(aRenderingEngine), iFontLib(aFontLib), iSource(filename_type(aFileName)), iFamilyName(aFamilyName), iFaceCount(aFaceCount), iStyleMap(aStyleMap)
+	{
 	}
 
 	native_font::native_font(i_rendering_engine& aRenderingEngine, FT_Library aFontLib, const void* aData, std::size_t aSizeInBytes) :
-		iRenderingEngine(aRenderingEngine), iFontLib(aFontLib), iSource(memory_block_type(aData, aSizeInBytes)), iCache{}, iFaceCount(0)
+		iRenderingEngine(aRenderingEngine), iFontLib(aFontLib), iSource(memory_block_type(aData, aSizeInBytes)), iFaceCount(0)
 	{
 		register_face(0);
 		for (FT_Long f = 1; f < iFaceCount; ++f)
 			register_face(f);
-		iCache.clear();
-		iCache.shrink_to_fit();
 	}
 
 	native_font::~native_font()
@@ -73,6 +75,26 @@ namespace neogfx
 		return std::next(iStyleMap.begin(), aStyleIndex)->second.first;
 	}
 
+	FT_Long native_font::face_count() const
+	{
+		return iFaceCount;
+	}
+
+	const native_font::style_map& native_font::styles() const
+	{
+		return iStyleMap;
+	}
+
+	bool native_font::has_file() const
+	{
+		return iSource.is<filename_type>();
+	}
+
+	const native_font::filename_type& native_font::file_name() const
+	{
+		return static_variant_cast<const filename_type&>(iSource);
+	}
+
 	namespace
 	{
 		uint32_t matching_bits(uint32_t lhs, uint32_t rhs)
@@ -145,10 +167,7 @@ namespace neogfx
 			aFace.update_handle(nullptr);
 		}
 		if (iFaceUsage.empty())
-		{
-			iCache.clear();
-			iCache.shrink_to_fit();
-		}
+			iMappedFile.close();
 	}
 
 	void native_font::register_face(FT_Long aFaceIndex)
@@ -183,17 +202,21 @@ namespace neogfx
 		FT_Face face;
 		if (iSource.is<filename_type>())
 		{
-			if (iCache.empty())
+			if (!iMappedFile.is_open())
 			{
-				std::size_t fileSize = static_cast<std::size_t>(boost::filesystem::file_size(static_variant_cast<const filename_type&>(iSource)));
-				iCache.resize(fileSize);
-				std::ifstream file{ static_variant_cast<const filename_type&>(iSource).c_str(), std::ios::in | std::ios::binary };
-				file.read(reinterpret_cast<char*>(&iCache[0]), fileSize);
+				try
+				{
+					iMappedFile.open(static_variant_cast<const filename_type&>(iSource));
+				}
+				catch (const std::exception&)
+				{
+					throw failed_to_load_font();
+				}
 			}
 			FT_Error error = FT_New_Memory_Face(
 				iFontLib,
-				static_cast<const FT_Byte*>(&iCache[0]),
-				iCache.size(),
+				reinterpret_cast<const FT_Byte*>(iMappedFile.data()),
+				static_cast<FT_Long>(iMappedFile.size()),
 				aFaceIndex,
 				&face);
 			if (error)
@@ -22,6 +22,7 @@
 #include <neogfx/neogfx.hpp>
 #include <unordered_map>
 #include <tuple>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <neolib/variant.hpp>
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -37,9 +38,9 @@ namespace neogfx
 	public:
 		typedef std::string filename_type;
 		typedef std::pair<const void*, std::size_t> memory_block_type;
+		typedef std::multimap<font::style_e, std::pair<std::string, FT_Long>> style_map;
 	private:
 		typedef neolib::variant<filename_type, memory_block_type> source_type;
-		typedef std::multimap<font::style_e, std::pair<std::string, FT_Long>> style_map;
 		typedef std::map<std::tuple<FT_Long, font::point_size, size>, std::unique_ptr<i_native_font_face>> face_map;
 		typedef std::unordered_map<i_native_font_face*, uint32_t> usage_map;
 	public:
@@ -47,6 +48,7 @@ namespace neogfx
 		struct no_matching_style_found : std::runtime_error { no_matching_style_found() : std::runtime_error("neogfx::native_font::no_matching_style_found") {} };
 	public:
 		native_font(i_rendering_engine& aRenderingEngine, FT_Library aFontLib, const std::string aFileName);
+		native_font(i_rendering_engine& aRenderingEngine, FT_Library aFontLib, const std::string aFileName, const std::string& aFamilyName, FT_Long aFaceCount, const style_map& aStyleMap);
 		native_font(i_rendering_engine& aRenderingEngine, FT_Library aFontLib, const void* aData, std::size_t aSizeInBytes);
 		~native_font();
 	public:
@@ -57,6 +59,11 @@ namespace neogfx
 		virtual const std::string& style_name(std::size_t aStyleIndex) const;
 		virtual i_native_font_face& create_face(font::style_e aStyle, font::point_size aSize, const i_device_resolution& aDevice);
 		virtual i_native_font_face& create_face(const std::string& aStyleName, font::point_size aSize, const i_device_resolution& aDevice);
+	public:
+		FT_Long face_count() const;
+		const style_map& styles() const;
+		bool has_file() const;
+		const filename_type& file_name() const;
 	public:
 		virtual void add_ref(i_native_font_face& aFace);
 		virtual void release(i_native_font_face& aFace);
@@ -69,7 +76,7 @@ namespace neogfx
 		i_rendering_engine& iRenderingEngine;
 		FT_Library iFontLib;
 		source_type iSource;
-		std::vector<unsigned char> iCache;
+		boost::iostreams::mapped_file_source iMappedFile;
 		std::string iFamilyName;
 		FT_Long iFaceCount;
 		style_map iStyleMap;
@@ -24,11 +24,13 @@
 #include FT_OUTLINE_H
 #include FT_BITMAP_H
 #include FT_LCD_FILTER_H
-#include "../../native/opengl.hpp"
 #include "../../native/i_native_texture.hpp"
+#include "native_font.hpp"
 #include "native_font_face.hpp"
+#include "glyph_rasterizer.hpp"
 #include <neogfx/gfx/text/glyph.hpp>
 #include <neogfx/gfx/i_rendering_engine.hpp>
+#include <neogfx/gfx/text/font_manager.hpp>
 
 namespace neogfx
 {
@@ -37,10 +39,16 @@ namespace neogfx
 	{
 		freetypeCheck(FT_Set_Char_Size(iHandle, 0, static_cast<FT_F26Dot6>(aSize * 64), static_cast<FT_UInt>(iPixelDensityDpi.cx), static_cast<FT_UInt>(iPixelDensityDpi.cy)));
 		freetypeCheck(FT_Select_Charmap(iHandle, FT_ENCODING_UNICODE));
+		static_cast<font_manager&>(iRenderingEngine.font_manager()).add_face(*this);
 	}
 
 	native_font_face::~native_font_face()
 	{
+		// faces are owned by their native font and the font manager destroys its native fonts before its own members
+		// so it is still alive here (asserted in ~font_manager)
+		for (auto const& g : iGlyphs)
+			destroy_glyph(g.second.first);
+		static_cast<font_manager&>(iRenderingEngine.font_manager()).remove_face(*this);
 		FT_Done_Face(iHandle);
 		if (iFallbackFont != nullptr)
 			iFallbackFont->release();
@@ -176,68 +184,31 @@ namespace neogfx
 
 	i_glyph_texture& native_font_face::glyph_texture(const glyph& aGlyph) const
 	{
+		auto& fontManager = static_cast<font_manager&>(iRenderingEngine.font_manager());
 		auto existingGlyph = iGlyphs.find(std::make_pair(aGlyph.value(), aGlyph.subpixel()));
 		if (existingGlyph != iGlyphs.end())
-			return existingGlyph->second;
-
-		freetypeCheck(FT_Load_Glyph(iHandle, aGlyph.value(), aGlyph.subpixel() ? FT_LOAD_TARGET_LCD : FT_LOAD_TARGET_NORMAL));
-		freetypeCheck(FT_Render_Glyph(iHandle->glyph, aGlyph.subpixel() ? FT_RENDER_MODE_LCD : FT_RENDER_MODE_NORMAL));
-		FT_Bitmap& bitmap = iHandle->glyph->bitmap;
-
-		auto& subTexture = iRenderingEngine.font_manager().glyph_atlas().create_sub_texture(
-			neogfx::size{ static_cast<dimension>(bitmap.width / (aGlyph.subpixel() ? 3.0 : 1.0)), static_cast<dimension>(bitmap.rows) },
-			texture_sampling::Normal);
-		rect glyphRect{ subTexture.atlas_location() };
-		i_glyph_texture& glyphTexture = iGlyphs.insert(std::make_pair(std::make_pair(aGlyph.value(), aGlyph.subpixel()),
-			neogfx::glyph_texture{
-				subTexture,
-				point{
-					iHandle->glyph->metrics.horiBearingX / 64.0,
-					(iHandle->glyph->metrics.horiBearingY - iHandle->glyph->metrics.height) / 64.0 } })).first->second;
-
-		iGlyphTextureData.clear();
-		iGlyphTextureData.resize(static_cast<std::size_t>(glyphRect.cx * glyphRect.cy));
-		iSubpixelGlyphTextureData.clear();
-		iSubpixelGlyphTextureData.resize(static_cast<std::size_t>(glyphRect.cx * glyphRect.cy));
-
-		const GLubyte* textureData = 0;
-		
-		if (aGlyph.subpixel())
 		{
-			// sub-pixel FIR filter.
-			static double coefficients[] = { 1.5/16.0, 3.0/16.0, 7.0/16.0, 3.0/16.0, 1.5/16.0 };
-			for (uint32_t y = 0; y < bitmap.rows; y++)
-			{
-				for (uint32_t x = 0; x < bitmap.width; x++)
-				{
-					uint8_t alpha = 0;
-					for (int32_t z = 0; z < 5; ++z)
-						alpha += static_cast<uint8_t>(bitmap.buffer[std::max<int32_t>(0, x - z + 2) + bitmap.pitch * y] * coefficients[z]);
-					iSubpixelGlyphTextureData[(x / 3 + 1) + (y + 1) * static_cast<std::size_t>(glyphRect.cx)][x % 3] = alpha;
-				}
-			}
-			textureData = &iSubpixelGlyphTextureData[0][0];
-		}
-		else
-		{
-			for (uint32_t y = 0; y < bitmap.rows; y++)
-				for (uint32_t x = 0; x < bitmap.width; x++)
-					iGlyphTextureData[(x + 1) + (y + 1) * static_cast<std::size_t>(glyphRect.cx)] =
-						(x >= bitmap.width || y >= bitmap.rows) ? 0 : bitmap.buffer[x + bitmap.pitch * y];
-			textureData = &iGlyphTextureData[0];
+			existingGlyph->second.second = fontManager.next_glyph_use();
+			return existingGlyph->second.first;
 		}
 
-		GLint previousTexture;
-		glCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
-		glCheck(glBindTexture(GL_TEXTURE_2D, reinterpret_cast<GLuint>(glyphTexture.texture().native_texture()->handle())));
-
-		glCheck(glTexSubImage2D(GL_TEXTURE_2D, 0,
-			static_cast<GLint>(glyphRect.x), static_cast<GLint>(glyphRect.y), static_cast<GLsizei>(glyphRect.cx), static_cast<GLsizei>(glyphRect.cy), 
-			aGlyph.subpixel() ? GL_RGBA : GL_ALPHA, GL_UNSIGNED_BYTE, &textureData[0]));
-
-		glCheck(glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture)));
+		// needed for this frame: take the background result if it is ready, otherwise rasterize it here
+		rasterized_glyph rasterizedGlyph;
+		if (!fontManager.glyph_rasterizer().take(*this, aGlyph.value(), aGlyph.subpixel(), rasterizedGlyph))
+			glyph_rasterizer::rasterize(iHandle, aGlyph.value(), aGlyph.subpixel(), rasterizedGlyph);
+		return install_glyph(aGlyph.value(), aGlyph.subpixel(), rasterizedGlyph);
+	}
 
-		return glyphTexture;
+	void native_font_face::prefetch_glyph(const glyph& aGlyph) const
+	{
+		if (iHandle == nullptr || iGlyphs.find(std::make_pair(aGlyph.value(), aGlyph.subpixel())) != iGlyphs.end())
+			return;
+		// worker threads open their own faces so only fonts loaded from a file can be rasterized in the background
+		auto const& thisFont = static_cast<const neogfx::native_font&>(iFont);
+		if (!thisFont.has_file())
+			return;
+		static_cast<font_manager&>(iRenderingEngine.font_manager()).glyph_rasterizer().request(*this,
+			glyph_rasterizer::face_source{ thisFont.file_name(), iHandle->face_index, iSize, iPixelDensityDpi }, aGlyph.value(), aGlyph.subpixel());
 	}
 
 	void native_font_face::add_ref()
@@ -249,4 +220,46 @@ namespace neogfx
 	{
 		native_font().release(*this);
 	}
+
+	i_glyph_texture& native_font_face::install_glyph(uint32_t aGlyphIndex, bool aSubpixel, const rasterized_glyph& aRasterizedGlyph) const
+	{
+		auto& fontManager = static_cast<font_manager&>(iRenderingEngine.font_manager());
+		auto existingGlyph = iGlyphs.find(std::make_pair(aGlyphIndex, aSubpixel));
+		if (existingGlyph != iGlyphs.end())
+			return existingGlyph->second.first;
+		auto& subTexture = fontManager.glyph_atlas().create_sub_texture(aRasterizedGlyph.extents, texture_sampling::Normal);
+		i_glyph_texture& glyphTexture = iGlyphs.insert(std::make_pair(std::make_pair(aGlyphIndex, aSubpixel),
+			std::make_pair(neogfx::glyph_texture{ subTexture, aRasterizedGlyph.placement }, fontManager.next_glyph_use()))).first->second.first;
+		fontManager.stage_glyph(subTexture, aRasterizedGlyph);
+		return glyphTexture;
+	}
+
+	void native_font_face::glyph_page_use(std::map<const i_native_texture*, uint64_t>& aPageUse) const
+	{
+		for (auto const& g : iGlyphs)
+		{
+			auto& lastUse = aPageUse[g.second.first.texture().atlas_texture().native_texture().get()];
+			lastUse = std::max(lastUse, g.second.second);
+		}
+	}
+
+	void native_font_face::evict_glyphs(const i_native_texture& aPage)
+	{
+		for (auto g = iGlyphs.begin(); g != iGlyphs.end();)
+		{
+			if (g->second.first.texture().atlas_texture().native_texture().get() == &aPage)
+			{
+				destroy_glyph(g->second.first);
+				g = iGlyphs.erase(g);
+			}
+			else
+				++g;
+		}
+	}
+
+	void native_font_face::destroy_glyph(const neogfx::glyph_texture& aGlyphTexture)
+	{
+		auto& glyphAtlas = iRenderingEngine.font_manager().glyph_atlas();
+		glyphAtlas.destroy_sub_texture(glyphAtlas.sub_texture(aGlyphTexture.texture().atlas_id()));
+	}
 }
\ No newline at end of file
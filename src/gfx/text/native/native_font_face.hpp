@@ -21,6 +21,7 @@
 
 #include <neogfx/neogfx.hpp>
 #include <unordered_map>
+#include <map>
 #include <boost/functional/hash.hpp>
 #include <boost/pool/pool_alloc.hpp>
 #include <ft2build.h>
@@ -68,11 +69,13 @@ namespace neogfx
 namespace neogfx
 {
 	class i_rendering_engine;
+	class i_native_texture;
+	struct rasterized_glyph;
 
 	class native_font_face : public i_native_font_face
 	{
 	private:
-		typedef std::unordered_map<std::pair<uint32_t, bool>, neogfx::glyph_texture, boost::hash<std::pair<uint32_t, bool>>> glyph_map;
+		typedef std::unordered_map<std::pair<uint32_t, bool>, std::pair<neogfx::glyph_texture, uint64_t>, boost::hash<std::pair<uint32_t, bool>>> glyph_map;
 		typedef std::unordered_map<std::pair<uint32_t, uint32_t>, dimension, boost::hash<std::pair<uint32_t, uint32_t>>, std::equal_to<std::pair<uint32_t, uint32_t>>, 
 			boost::fast_pool_allocator<std::pair<const std::pair<uint32_t, uint32_t>, dimension>>> kerning_table;
 	public:
@@ -118,9 +121,16 @@ namespace neogfx
 		void* aux_handle() const override;
 		uint32_t glyph_index(char32_t aCodePoint) const override;
 		i_glyph_texture& glyph_texture(const glyph& aGlyph) const override;
+		void prefetch_glyph(const glyph& aGlyph) const override;
 	public:
 		void add_ref() override;
 		void release() override;
+	public:
+		i_glyph_texture& install_glyph(uint32_t aGlyphIndex, bool aSubpixel, const rasterized_glyph& aRasterizedGlyph) const;
+		void glyph_page_use(std::map<const i_native_texture*, uint64_t>& aPageUse) const;
+		void evict_glyphs(const i_native_texture& aPage);
+	private:
+		void destroy_glyph(const neogfx::glyph_texture& aGlyphTexture);
 	private:
 		i_rendering_engine& iRenderingEngine;
 		i_native_font& iFont;
@@ -132,8 +142,6 @@ namespace neogfx
 		mutable std::unique_ptr<hb_handle> iAuxHandle;
 		mutable std::unique_ptr<i_native_font_face> iFallbackFont;
 		mutable glyph_map iGlyphs;
-		mutable std::vector<GLubyte> iGlyphTextureData;
-		mutable std::vector<std::array<GLubyte, 4>> iSubpixelGlyphTextureData;
 		bool iHasKerning;
 		mutable kerning_table iKerningTable;
 		mutable boost::optional<bool> iHasFallback;
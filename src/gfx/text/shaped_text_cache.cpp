@@ -0,0 +1,144 @@
+// shaped_text_cache.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <neogfx/neogfx.hpp>
+#include <boost/functional/hash.hpp>
+#include <neogfx/gfx/text/shaped_text_cache.hpp>
+
+namespace neogfx
+{
+	bool shaped_text_cache::key::operator==(const key& aOther) const
+	{
+		return face == aOther.face && style == aOther.style && subpixel == aOther.subpixel && mnemonicPrefix == aOther.mnemonicPrefix &&
+			utf32 == aOther.utf32 && text == aOther.text;
+	}
+
+	std::size_t shaped_text_cache::key_hash::operator()(const key& aKey) const
+	{
+		std::size_t seed = std::hash<std::string>()(aKey.text);
+		boost::hash_combine(seed, aKey.utf32);
+		boost::hash_combine(seed, aKey.face);
+		boost::hash_combine(seed, static_cast<uint32_t>(aKey.style));
+		boost::hash_combine(seed, aKey.subpixel);
+		boost::hash_combine(seed, aKey.mnemonicPrefix);
+		return seed;
+	}
+
+	shaped_text_cache::shaped_text_cache(std::size_t aCapacityInBytes) :
+		iCapacity{ aCapacityInBytes }, iMemoryUsage{ 0u }, iHits{ 0u }, iMisses{ 0u }
+	{
+	}
+
+	const glyph_text* shaped_text_cache::find(const key& aKey)
+	{
+		auto existing = iIndex.find(aKey);
+		if (existing == iIndex.end())
+		{
+			++iMisses;
+			return nullptr;
+		}
+		++iHits;
+		iEntries.splice(iEntries.begin(), iEntries, existing->second);
+		return &existing->second->second;
+	}
+
+	const glyph_text& shaped_text_cache::insert(const key& aKey, const glyph_text& aGlyphText)
+	{
+		auto existing = iIndex.find(aKey);
+		if (existing != iIndex.end())
+		{
+			iMemoryUsage -= cost(existing->second->first, existing->second->second);
+			iEntries.erase(existing->second);
+			iIndex.erase(existing);
+		}
+		iEntries.emplace_front(aKey, aGlyphText);
+		iIndex.emplace(aKey, iEntries.begin());
+		iMemoryUsage += cost(aKey, aGlyphText);
+		const glyph_text& result = iEntries.front().second;
+		trim();
+		return iEntries.empty() ? aGlyphText : result;
+	}
+
+	void shaped_text_cache::clear()
+	{
+		iIndex.clear();
+		iEntries.clear();
+		iMemoryUsage = 0u;
+	}
+
+	std::size_t shaped_text_cache::capacity() const
+	{
+		return iCapacity;
+	}
+
+	void shaped_text_cache::set_capacity(std::size_t aCapacityInBytes)
+	{
+		iCapacity = aCapacityInBytes;
+		trim();
+	}
+
+	std::size_t shaped_text_cache::memory_usage() const
+	{
+		return iMemoryUsage;
+	}
+
+	uint64_t shaped_text_cache::hits() const
+	{
+		return iHits;
+	}
+
+	uint64_t shaped_text_cache::misses() const
+	{
+		return iMisses;
+	}
+
+	void shaped_text_cache::reset_counters()
+	{
+		iHits = 0u;
+		iMisses = 0u;
+	}
+
+	shaped_text_cache::key shaped_text_cache::make_key(const std::string& aText, const font& aFont, bool aSubpixel, const boost::optional<std::pair<bool, char>>& aMnemonic)
+	{
+		return key{ aText, false, &aFont.native_font_face(), aFont.style(), aSubpixel, aMnemonic != boost::none ? aMnemonic->second : '\0' };
+	}
+
+	shaped_text_cache::key shaped_text_cache::make_key(const std::u32string& aText, const font& aFont, bool aSubpixel, const boost::optional<std::pair<bool, char>>& aMnemonic)
+	{
+		return key{ std::string(reinterpret_cast<const char*>(aText.data()), aText.size() * sizeof(char32_t)), true, &aFont.native_font_face(), aFont.style(), aSubpixel, aMnemonic != boost::none ? aMnemonic->second : '\0' };
+	}
+
+	std::size_t shaped_text_cache::cost(const key& aKey, const glyph_text& aGlyphText)
+	{
+		// two copies of the key (list and index) plus the glyphs themselves
+		return sizeof(entry_list::value_type) + sizeof(entry_map::value_type) + aKey.text.size() * 2u + 
+			static_cast<std::size_t>(aGlyphText.cend() - aGlyphText.cbegin()) * sizeof(glyph);
+	}
+
+	void shaped_text_cache::trim()
+	{
+		while (iMemoryUsage > iCapacity && !iEntries.empty())
+		{
+			iMemoryUsage -= cost(iEntries.back().first, iEntries.back().second);
+			iIndex.erase(iEntries.back().first);
+			iEntries.pop_back();
+		}
+	}
+}
\ No newline at end of file
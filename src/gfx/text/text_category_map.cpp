@@ -0,0 +1,72 @@
+// text_category_map.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <map>
+#include <neogfx/gfx/text/text_category_map.hpp>
+
+namespace neogfx
+{
+	namespace detail
+	{
+		text_category_table::text_category_table() :
+			iBlockIndex(CodePointCount >> BlockShift)
+		{
+			const std::size_t rangeCount = sizeof(TEXT_CATEGORY_MAP) / sizeof(TEXT_CATEGORY_MAP[0]);
+			std::map<block, uint16_t> uniqueBlocks;
+			std::size_t range = 0;
+			for (uint32_t blockIndex = 0; blockIndex < iBlockIndex.size(); ++blockIndex)
+			{
+				block categories;
+				for (uint32_t i = 0; i < BlockSize; ++i)
+				{
+					uint32_t codePoint = (blockIndex << BlockShift) + i;
+					while (range + 1 < rangeCount && TEXT_CATEGORY_MAP[range + 1].first <= codePoint)
+						++range;
+					categories[i] = TEXT_CATEGORY_MAP[range].second;
+				}
+				auto existing = uniqueBlocks.find(categories);
+				if (existing == uniqueBlocks.end())
+				{
+					existing = uniqueBlocks.insert(std::make_pair(categories, static_cast<uint16_t>(iBlocks.size()))).first;
+					iBlocks.push_back(categories);
+				}
+				iBlockIndex[blockIndex] = existing->second;
+			}
+		}
+
+		const text_category_table& text_category_table::instance()
+		{
+			static const text_category_table sTable;
+			return sTable;
+		}
+	}
+
+	void get_text_categories(const i_emoji_atlas& aEmojiAtlas, const char32_t* aBegin, const char32_t* aEnd, text_category* aResult)
+	{
+		auto const& table = detail::text_category_table::instance();
+		for (; aBegin != aEnd; ++aBegin, ++aResult)
+		{
+			if (*aBegin >= 0x100 && aEmojiAtlas.is_emoji(*aBegin))
+				*aResult = text_category::Emoji;
+			else
+				*aResult = table.category(*aBegin);
+		}
+	}
+}
\ No newline at end of file
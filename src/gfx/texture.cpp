@@ -39,8 +39,8 @@ namespace neogfx
 	{
 	}
 
-	texture::texture(const i_image& aImage) :
-		iNativeTexture(app::instance().rendering_engine().texture_manager().create_texture(aImage))
+	texture::texture(const i_image& aImage, texture_upload aUpload) :
+		iNativeTexture(app::instance().rendering_engine().texture_manager().create_texture(aImage, aUpload))
 	{
 	}
 
@@ -54,13 +54,20 @@ namespace neogfx
 		return entry.first->second.second;
 	}
 
-	i_sub_texture& texture_atlas::create_sub_texture(const i_image& aImage)
+	i_sub_texture& texture_atlas::create_sub_texture(const i_image& aImage, texture_upload aUpload)
 	{
 		auto newSpace = allocate_space(aImage.extents(), aImage.sampling());
 		++iNextId;
 		auto entry = iEntries.insert(std::make_pair(iNextId, std::make_pair(newSpace.first, neogfx::sub_texture{ iNextId, newSpace.first->first, newSpace.second, aImage.extents() })));
-		entry.first->second.second.set_pixels(aImage);
-		return entry.first->second.second;
+		auto& newSubTexture = entry.first->second.second;
+		if (aUpload == texture_upload::Staged)
+		{
+			const uint8_t* imageData = static_cast<const uint8_t*>(aImage.cdata());
+			iTextureManager.queue_upload(newSubTexture.native_texture(), rect{ newSubTexture.atlas_location().position(), aImage.extents() }, i_resource::data_type(imageData, imageData + aImage.size()));
+		}
+		else
+			newSubTexture.set_pixels(aImage);
+		return newSubTexture;
 	}
 
 	void texture_atlas::destroy_sub_texture(i_sub_texture& aSubTexture)
@@ -68,12 +75,26 @@ namespace neogfx
 		auto iterEntry = iEntries.find(aSubTexture.atlas_id());
 		if (iterEntry == iEntries.end())
 			throw sub_texture_not_found();
-		auto rectEntry = iterEntry->second.second.atlas_location();
-		auto space = iterEntry->second.first->second.used.find(rectEntry);
-		if (space != iterEntry->second.first->second.used.end())
-			iterEntry->second.first->second.used.erase(space);
-		iterEntry->second.first->second.freed.insert(rectEntry);
+		auto page = iterEntry->second.first;
+		if (iTextureManager.uploads_pending())
+			iTextureManager.cancel_uploads(*page->first.native_texture(), iterEntry->second.second.atlas_location());
+		page->second.remove(iterEntry->second.second.atlas_location());
 		iEntries.erase(iterEntry);
+		if (page->second.used.empty() && iPages.size() > 1)
+			iPages.erase(page);
+	}
+
+	std::vector<i_texture_atlas::page_statistics> texture_atlas::statistics() const
+	{
+		std::vector<page_statistics> result;
+		for (auto const& page : iPages)
+			result.push_back(page_statistics{ page.first.extents(), page.second.usedArea, page.second.freedArea, static_cast<uint32_t>(page.second.used.size()) });
+		return result;
+	}
+
+	uint64_t texture_atlas::memory_usage() const
+	{
+		return static_cast<uint64_t>(iPages.size()) * static_cast<uint64_t>(page_size().cx * page_size().cy) * 4u;
 	}
 
 	const size& texture_atlas::page_size() const
@@ -90,12 +111,17 @@ namespace neogfx
 	{
 		if (iPages.empty())
 			create_page(aSampling);
+		// allow for the one pixel border; mipmapped pages keep power of two sizes to limit bleeding between
+		// neighbours at lower mip levels, everything else is packed tightly
+		size space = (aSampling == texture_sampling::NormalMipmap ?
+			size{ std::max(std::pow(2.0, std::ceil(std::log2(aSize.cx + 2.0))), 16.0), std::max(std::pow(2.0, std::ceil(std::log2(aSize.cy + 2.0))), 16.0) } :
+			size{ std::ceil(aSize.cx) + 2.0, std::ceil(aSize.cy) + 2.0 });
 		rect result;
 		for (auto iterPage = iPages.begin(); iterPage != iPages.end(); ++iterPage)
-			if (iterPage->first.sampling() == aSampling && iterPage->second.insert(size{ std::max(std::pow(2.0, std::ceil(std::log2(aSize.cx + 2.0))), 16.0), std::max(std::pow(2.0, std::ceil(std::log2(aSize.cy + 2.0))), 16.0) }, result))
+			if (iterPage->first.sampling() == aSampling && iterPage->second.insert(space, result))
 				return std::make_pair(iterPage, result);
 		auto iterPage = create_page(aSampling);
-		if (iterPage->second.insert(size{ std::max(std::pow(2.0, std::ceil(std::log2(aSize.cx + 2.0))), 16.0), std::max(std::pow(2.0, std::ceil(std::log2(aSize.cy + 2.0))), 16.0) }, result))
+		if (iterPage->second.insert(space, result))
 			return std::make_pair(iterPage, result);
 		iPages.erase(iterPage);
 		throw texture_too_big_for_atlas();
@@ -51,6 +51,22 @@ namespace neogfx
 		{
 			iTexture->set_pixels(aRect, aPixelData);
 		}
+		virtual void set_pixels(const rect& aRect, const void* aPixelData, bool aGenerateMipmaps)
+		{
+			iTexture->set_pixels(aRect, aPixelData, aGenerateMipmaps);
+		}
+		virtual void set_storage_pixels(const rect& aStorageRect, const void* aPixelData, bool aGenerateMipmaps)
+		{
+			iTexture->set_storage_pixels(aStorageRect, aPixelData, aGenerateMipmaps);
+		}
+		virtual void clear_pixels(const rect& aRect)
+		{
+			iTexture->clear_pixels(aRect);
+		}
+		virtual void generate_mipmaps()
+		{
+			iTexture->generate_mipmaps();
+		}
 	public:
 		virtual void* handle() const
 		{
@@ -68,6 +84,11 @@ namespace neogfx
 		std::shared_ptr<i_native_texture> iTexture;
 	};
 
+	texture_manager::texture_manager() :
+		iUploadBudget{ kDefaultUploadBudget }
+	{
+	}
+
 	std::unique_ptr<i_native_texture> texture_manager::join_texture(const i_native_texture& aTexture)
 	{
 		for (auto i = iTextures.begin(); i != iTextures.end(); ++i)
@@ -96,6 +117,92 @@ namespace neogfx
 		return std::make_unique<texture_atlas>(*this, aSize);
 	}
 
+	std::size_t texture_manager::upload_budget() const
+	{
+		return iUploadBudget;
+	}
+
+	void texture_manager::set_upload_budget(std::size_t aBytesPerFrame)
+	{
+		iUploadBudget = aBytesPerFrame;
+	}
+
+	void texture_manager::queue_upload(std::shared_ptr<i_native_texture> aTexture, const rect& aRect, i_resource::data_type aPixels)
+	{
+		// the area may hold a previous occupant's pixels (atlas) or be uninitialized; it reads as transparent until uploaded
+		aTexture->clear_pixels(aRect);
+		iPendingUploads.push_back(pending_upload{ aTexture, aRect, std::move(aPixels), 0u, upload_damage{} });
+	}
+
+	void texture_manager::cancel_uploads(const i_native_texture& aTexture, const rect& aRect)
+	{
+		for (auto i = iPendingUploads.begin(); i != iPendingUploads.end();)
+		{
+			auto texture = i->texture.lock();
+			if (texture == nullptr || (texture->handle() == aTexture.handle() && !i->area.intersection(aRect).empty()))
+				i = iPendingUploads.erase(i);
+			else
+				++i;
+		}
+	}
+
+	bool texture_manager::uploads_pending() const
+	{
+		return !iPendingUploads.empty();
+	}
+
+	void texture_manager::texture_drawn(const i_native_texture& aTexture, const rect& aTextureRect, const i_native_surface& aSurface, const rect& aSurfaceRect)
+	{
+		// whatever was drawn from a partially uploaded area has to be repainted once that area is complete
+		for (auto& upload : iPendingUploads)
+		{
+			auto texture = upload.texture.lock();
+			if (texture == nullptr || texture->handle() != aTexture.handle() || upload.area.intersection(aTextureRect).empty())
+				continue;
+			auto existing = std::find_if(upload.damage.begin(), upload.damage.end(), [&aSurface](const upload_damage::value_type& aDamage) { return aDamage.first == &aSurface; });
+			if (existing != upload.damage.end())
+				existing->second = existing->second.combine(aSurfaceRect);
+			else
+				upload.damage.emplace_back(&aSurface, aSurfaceRect);
+		}
+	}
+
+	texture_manager::upload_damage texture_manager::process_uploads()
+	{
+		upload_damage result;
+		std::size_t budget = iUploadBudget;
+		bool first = true;
+		while (!iPendingUploads.empty())
+		{
+			auto& upload = iPendingUploads.front();
+			auto texture = upload.texture.lock();
+			std::size_t rowSize = static_cast<std::size_t>(upload.area.cx) * 4u;
+			uint32_t rowCount = static_cast<uint32_t>(upload.area.cy);
+			if (texture == nullptr || rowSize == 0u || upload.rowsUploaded >= rowCount)
+			{
+				iPendingUploads.pop_front();
+				continue;
+			}
+			uint32_t rows = static_cast<uint32_t>(std::min<std::size_t>(rowCount - upload.rowsUploaded, budget / rowSize));
+			if (rows == 0u)
+			{
+				if (!first)
+					break;
+				rows = 1u; // always make progress
+			}
+			texture->set_pixels(rect{ upload.area.x, upload.area.y + upload.rowsUploaded, upload.area.cx, static_cast<dimension>(rows) }, &upload.pixels[upload.rowsUploaded * rowSize], false);
+			upload.rowsUploaded += rows;
+			budget -= std::min(budget, rows * rowSize);
+			first = false;
+			if (upload.rowsUploaded < rowCount)
+				break;
+			texture->generate_mipmaps();
+			result.insert(result.end(), upload.damage.begin(), upload.damage.end());
+			iPendingUploads.pop_front();
+		}
+		return result;
+	}
+
 	const texture_manager::texture_list& texture_manager::textures() const
 	{
 		return iTextures;
@@ -149,7 +149,7 @@ namespace neogfx
 		app::event_processing_context epc(app::instance(), "neogfx::dialog");
 		while (iResult == boost::none)
 		{
-			app::instance().process_events(epc);
+			app::instance().process_events_or_wait(epc);
 			if (surface().destroyed() && iResult == boost::none)
 				iResult = Rejected;
 		}
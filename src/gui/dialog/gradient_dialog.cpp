@@ -30,7 +30,7 @@ namespace neogfx
 		preview_box(gradient_dialog& aOwner) :
 			framed_widget(aOwner.iPreviewGroupBox.item_layout()),
 			iOwner(aOwner),
-			iAnimationTimer{ app::instance(), [this](neolib::callback_timer& aTimer)
+			iAnimationTimer{ app::instance(), [this](callback_timer& aTimer)
 			{
 				aTimer.again();
 				animate();
@@ -96,7 +96,7 @@ namespace neogfx
 		}
 	private:
 		gradient_dialog& iOwner;
-		neolib::callback_timer iAnimationTimer;
+		callback_timer iAnimationTimer;
 		bool iTracking;
 	};
 
@@ -84,6 +84,7 @@ namespace neogfx
 	void grid_layout::set_dimensions(cell_coordinate aRows, cell_coordinate aColumns)
 	{
 		iDimensions = cell_dimensions{aColumns, aRows};
+		invalidate_size_hints();
 	}
 
 	bool grid_layout::is_item_at_position(cell_coordinate aRow, cell_coordinate aColumn) const
@@ -426,6 +427,7 @@ namespace neogfx
 	void grid_layout::add_span(const cell_coordinates& aFrom, const cell_coordinates& aTo)
 	{
 		iSpans.push_back(std::make_pair(aFrom, aTo));
+		invalidate_size_hints();
 		if (owner() != 0)
 			owner()->ultimate_ancestor().layout_items(true);
 	}
@@ -435,7 +437,6 @@ namespace neogfx
 		if (!enabled())
 			return;
 		owner()->layout_items_started();
-		next_layout_id();
 		validate();
 		set_position(aPosition);
 		set_extents(aSize);
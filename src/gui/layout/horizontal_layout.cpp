@@ -72,7 +72,6 @@ namespace neogfx
 		if (!enabled())
 			return;
 		owner()->layout_items_started();
-		next_layout_id();
 		validate();
 		layout::do_layout_items<layout::column_major<horizontal_layout>>(aPosition, aSize);
 		owner()->layout_items_completed();
@@ -26,6 +26,18 @@
 
 namespace neogfx
 {
+	namespace
+	{
+		void release_parent_layout(const i_layout& aLayout, layout_item& aItem)
+		{
+			if (!aItem.get().is<layout_item::widget_pointer>())
+				return;
+			auto& w = *static_variant_cast<layout_item::widget_pointer&>(aItem.get());
+			if (w.has_parent_layout() && &w.parent_layout() == &aLayout)
+				w.set_parent_layout(nullptr);
+		}
+	}
+
 	layout::device_metrics_forwarder::device_metrics_forwarder(i_layout& aOwner) :
 		iOwner(aOwner)
 	{
@@ -75,7 +87,7 @@ namespace neogfx
 		iMinimumSize{},
 		iMaximumSize{},
 		iLayoutStarted(false),
-		iLayoutId(0),
+		iSizeHintsId(0),
 		iInvalidated(false)
 	{
 	}
@@ -91,7 +103,7 @@ namespace neogfx
 		iMinimumSize{},
 		iMaximumSize{},
 		iLayoutStarted(false),
-		iLayoutId(0),
+		iSizeHintsId(0),
 		iInvalidated(false)
 	{
 		aParent.set_layout(*this);
@@ -109,7 +121,7 @@ namespace neogfx
 		iMinimumSize{},
 		iMaximumSize{},
 		iLayoutStarted(false),
-		iLayoutId(0),
+		iSizeHintsId(0),
 		iInvalidated(false)
 	{
 		aParent.add_item(*this);
@@ -157,6 +169,7 @@ namespace neogfx
 		iItems.push_back(item(*this, aWidget));
 		if (iOwner != nullptr)
 			iItems.back().set_owner(iOwner);
+		aWidget.set_parent_layout(this);
 	}
 
 	void layout::add_item_at(item_index aPosition, i_widget& aWidget)
@@ -169,6 +182,7 @@ namespace neogfx
 		auto i = iItems.insert(std::next(iItems.begin(), aPosition), item(*this, aWidget));
 		if (iOwner != nullptr)
 			i->set_owner(iOwner);
+		aWidget.set_parent_layout(this);
 	}
 
 	void layout::add_item(std::shared_ptr<i_widget> aWidget)
@@ -179,6 +193,7 @@ namespace neogfx
 		iItems.push_back(item(*this, aWidget));
 		if (iOwner != nullptr)
 			iItems.back().set_owner(iOwner);
+		aWidget->set_parent_layout(this);
 	}
 
 	void layout::add_item_at(item_index aPosition, std::shared_ptr<i_widget> aWidget)
@@ -191,6 +206,7 @@ namespace neogfx
 		auto i = iItems.insert(std::next(iItems.begin(), aPosition), item(*this, aWidget));
 		if (iOwner != nullptr)
 			i->set_owner(iOwner);
+		aWidget->set_parent_layout(this);
 	}
 
 	void layout::add_item(i_layout& aLayout)
@@ -319,6 +335,8 @@ namespace neogfx
 		invalidate();
 		item_list toRemove;
 		toRemove.splice(toRemove.begin(), items());
+		for (auto& i : toRemove)
+			release_parent_layout(*this, i);
 	}
 
 	layout::item_index layout::item_count() const
@@ -432,6 +450,7 @@ namespace neogfx
 		if (iMargins != newMargins)
 		{
 			iMargins = newMargins;
+			invalidate_size_hints();
 			if (iOwner != nullptr && aUpdateLayout)
 				iOwner->ultimate_ancestor().layout_items(true);
 		}
@@ -447,6 +466,7 @@ namespace neogfx
 		if (iSpacing != aSpacing)
 		{
 			iSpacing = units_converter(*this).to_device_units(aSpacing);
+			invalidate_size_hints();
 			if (iOwner != nullptr)
 				iOwner->ultimate_ancestor().layout_items(true);
 		}
@@ -459,7 +479,11 @@ namespace neogfx
 
 	void layout::set_always_use_spacing(bool aAlwaysUseSpacing)
 	{
-		iAlwaysUseSpacing = aAlwaysUseSpacing;
+		if (iAlwaysUseSpacing != aAlwaysUseSpacing)
+		{
+			iAlwaysUseSpacing = aAlwaysUseSpacing;
+			invalidate_size_hints();
+		}
 	}
 
 	neogfx::alignment layout::alignment() const
@@ -500,24 +524,35 @@ namespace neogfx
 		return iEnabled;
 	}
 
-	uint32_t layout::layout_id() const
+	uint32_t layout::size_hints_id() const
 	{
-		return iLayoutId;
+		return iSizeHintsId;
 	}
 
-	void layout::next_layout_id()
+	void layout::invalidate_size_hints()
 	{
-		if (++iLayoutId == static_cast<uint32_t>(-1))
-			iLayoutId = 0;
-		for (auto& item : items())
-			if (item.get().is<item::widget_pointer>())
+		// Items cache their size hints against this id; changing it makes them ask their widgets and layouts again.
+		// Our own size hints may have changed as a result so the item representing this layout is invalidated too.
+		++iSizeHintsId;
+		if (iParent != nullptr)
+			iParent->invalidate_size_hints();
+		else if (iOwner != nullptr && iOwner->has_parent_layout())
+			iOwner->parent_layout().invalidate_size_hints(*iOwner);
+	}
+
+	bool layout::invalidate_size_hints(i_widget& aWidget)
+	{
+		// The widget's own layout item lives in its parent layout which is this layout or one nested within it.
+		if (!aWidget.has_parent_layout())
+			return false;
+		auto& itemLayout = aWidget.parent_layout();
+		for (const i_layout* l = &itemLayout; l != nullptr; l = l->parent())
+			if (l == this)
 			{
-				auto& widget = *static_variant_cast<item::widget_pointer&>(item.get());
-				if (widget.has_layout())
-					widget.layout().next_layout_id();
+				itemLayout.invalidate_size_hints();
+				return true;
 			}
-			else if (item.get().is<item::layout_pointer>())
-				static_variant_cast<item::layout_pointer&>(item.get())->next_layout_id();
+		return false;
 	}
 
 	bool layout::invalidated() const
@@ -527,6 +562,7 @@ namespace neogfx
 
 	void layout::invalidate()
 	{
+		invalidate_size_hints();
 		if (iInvalidated)
 			return;
 		iInvalidated = true;
@@ -600,6 +636,7 @@ namespace neogfx
 		if (iSizePolicy != aSizePolicy)
 		{
 			iSizePolicy = aSizePolicy;
+			invalidate_size_hints();
 			if (iOwner != nullptr && aUpdateLayout)
 				iOwner->ultimate_ancestor().layout_items(true);
 		}
@@ -623,6 +660,7 @@ namespace neogfx
 		if (iWeight != aWeight)
 		{
 			iWeight = aWeight;
+			invalidate_size_hints();
 			if (iOwner != nullptr && aUpdateLayout)
 				iOwner->ultimate_ancestor().layout_items(true);
 		}
@@ -646,6 +684,7 @@ namespace neogfx
 		if (iMinimumSize != newMinimumSize)
 		{
 			iMinimumSize = newMinimumSize;
+			invalidate_size_hints();
 			if (iOwner != nullptr && aUpdateLayout)
 				iOwner->ultimate_ancestor().layout_items(true);
 		}
@@ -669,6 +708,7 @@ namespace neogfx
 		if (iMaximumSize != newMaximumSize)
 		{
 			iMaximumSize = newMaximumSize;
+			invalidate_size_hints();
 			if (iOwner != nullptr && aUpdateLayout)
 				iOwner->ultimate_ancestor().layout_items(true);
 		}
@@ -713,6 +753,7 @@ namespace neogfx
 		invalidate();
 		item_list toRemove;
 		toRemove.splice(toRemove.begin(), items(), aItem);
+		release_parent_layout(*this, toRemove.front());
 		if (iOwner != nullptr)
 			iOwner->ultimate_ancestor().layout_items(true);
 	}
@@ -23,33 +23,42 @@
 
 namespace neogfx
 {
+	namespace
+	{
+		uint32_t& size_hints_epoch()
+		{
+			static uint32_t sEpoch;
+			return sEpoch;
+		}
+	}
+
 	layout_item::layout_item(i_layout& aParent, i_widget& aWidget) :
-		iParent(aParent), iPointerWrapper(widget_pointer(widget_pointer(), &aWidget)), iLayoutId(-1, -1)
+		iParent(aParent), iPointerWrapper(widget_pointer(widget_pointer(), &aWidget)), iMinimumSizeHints{}, iMaximumSizeHints{}
 	{
 	}
 
 	layout_item::layout_item(i_layout& aParent, std::shared_ptr<i_widget> aWidget) :
-		iParent(aParent), iPointerWrapper(aWidget), iLayoutId(-1, -1)
+		iParent(aParent), iPointerWrapper(aWidget), iMinimumSizeHints{}, iMaximumSizeHints{}
 	{
 	}
 
 	layout_item::layout_item(i_layout& aParent, i_layout& aLayout) :
-		iParent(aParent), iPointerWrapper(layout_pointer(layout_pointer(), &aLayout)), iLayoutId(-1, -1)
+		iParent(aParent), iPointerWrapper(layout_pointer(layout_pointer(), &aLayout)), iMinimumSizeHints{}, iMaximumSizeHints{}
 	{
 	}
 
 	layout_item::layout_item(i_layout& aParent, std::shared_ptr<i_layout> aLayout) :
-		iParent(aParent), iPointerWrapper(aLayout), iLayoutId(-1, -1)
+		iParent(aParent), iPointerWrapper(aLayout), iMinimumSizeHints{}, iMaximumSizeHints{}
 	{
 	}
 
 	layout_item::layout_item(i_layout& aParent, i_spacer& aSpacer) :
-		iParent(aParent), iPointerWrapper(spacer_pointer(spacer_pointer(), &aSpacer)), iLayoutId(-1, -1)
+		iParent(aParent), iPointerWrapper(spacer_pointer(spacer_pointer(), &aSpacer)), iMinimumSizeHints{}, iMaximumSizeHints{}
 	{
 	}
 
 	layout_item::layout_item(i_layout& aParent, std::shared_ptr<i_spacer> aSpacer) :
-		iParent(aParent), iPointerWrapper(aSpacer), iLayoutId(-1, -1)
+		iParent(aParent), iPointerWrapper(aSpacer), iMinimumSizeHints{}, iMaximumSizeHints{}
 	{
 	}
 
@@ -166,21 +175,18 @@ namespace neogfx
 	{
 		if (!visible())
 			return size{};
-		if (iLayoutId.first == iParent.layout_id())
-			return iMinimumSize;
-		else
-		{
-			iMinimumSize = wrapped_geometry().minimum_size(aAvailableSpace);
-			iLayoutId.first = iParent.layout_id();
-			return iMinimumSize;
-		}
+		auto cached = find_size_hint(iMinimumSizeHints, aAvailableSpace);
+		if (cached != nullptr)
+			return cached->value;
+		auto id = size_hints_id();
+		size result = wrapped_geometry().minimum_size(aAvailableSpace);
+		cache_size_hint(iMinimumSizeHints, id, aAvailableSpace, result);
+		return result;
 	}
 
 	void layout_item::set_minimum_size(const optional_size& aMinimumSize, bool aUpdateLayout)
 	{
 		wrapped_geometry().set_minimum_size(aMinimumSize, aUpdateLayout);
-		if (aMinimumSize != boost::none)
-			iMinimumSize = *aMinimumSize;
 	}
 
 	bool layout_item::has_maximum_size() const
@@ -192,21 +198,18 @@ namespace neogfx
 	{
 		if (!visible())
 			return size{ std::numeric_limits<size::dimension_type>::max(), std::numeric_limits<size::dimension_type>::max() };
-		if (iLayoutId.second == iParent.layout_id())
-			return iMaximumSize;
-		else
-		{
-			iMaximumSize = wrapped_geometry().maximum_size(aAvailableSpace);
-			iLayoutId.second = iParent.layout_id();
-			return iMaximumSize;
-		}
+		auto cached = find_size_hint(iMaximumSizeHints, aAvailableSpace);
+		if (cached != nullptr)
+			return cached->value;
+		auto id = size_hints_id();
+		size result = wrapped_geometry().maximum_size(aAvailableSpace);
+		cache_size_hint(iMaximumSizeHints, id, aAvailableSpace, result);
+		return result;
 	}
 
 	void layout_item::set_maximum_size(const optional_size& aMaximumSize, bool aUpdateLayout)
 	{
 		wrapped_geometry().set_maximum_size(aMaximumSize, aUpdateLayout);
-		if (aMaximumSize != boost::none)
-			iMaximumSize = *aMaximumSize;
 	}
 
 	bool layout_item::has_margins() const
@@ -236,4 +239,36 @@ namespace neogfx
 	{
 		return iPointerWrapper == aOther.iPointerWrapper;
 	}
+
+	void layout_item::invalidate_all_size_hints()
+	{
+		++size_hints_epoch();
+	}
+
+	std::pair<uint32_t, uint32_t> layout_item::size_hints_id() const
+	{
+		return std::make_pair(iParent.size_hints_id(), size_hints_epoch());
+	}
+
+	const layout_item::size_hint* layout_item::find_size_hint(const size_hints& aHints, const optional_size& aAvailableSpace) const
+	{
+		auto id = size_hints_id();
+		if (aAvailableSpace == boost::none)
+			return aHints.unconstrained.valid && aHints.unconstrained.id == id ? &aHints.unconstrained : nullptr;
+		for (const auto& hint : aHints.constrained)
+			if (hint.valid && hint.id == id && hint.availableSpace == aAvailableSpace)
+				return &hint;
+		return nullptr;
+	}
+
+	void layout_item::cache_size_hint(size_hints& aHints, const std::pair<uint32_t, uint32_t>& aId, const optional_size& aAvailableSpace, const size& aValue) const
+	{
+		if (aAvailableSpace == boost::none)
+		{
+			aHints.unconstrained = size_hint{ true, aId, aAvailableSpace, aValue };
+			return;
+		}
+		aHints.constrained[1] = aHints.constrained[0];
+		aHints.constrained[0] = size_hint{ true, aId, aAvailableSpace, aValue };
+	}
 }
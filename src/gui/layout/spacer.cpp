@@ -95,6 +95,8 @@ namespace neogfx
 		if (iExpansionPolicy != aExpansionPolicy)
 		{
 			iExpansionPolicy = aExpansionPolicy;
+			if (iParent != 0)
+				iParent->invalidate_size_hints();
 			if (iParent != 0 && iParent->owner() != 0)
 				iParent->owner()->ultimate_ancestor().layout_items(true);
 		}
@@ -142,6 +144,8 @@ namespace neogfx
 		if (iSizePolicy != aSizePolicy)
 		{
 			iSizePolicy = aSizePolicy;
+			if (iParent != 0)
+				iParent->invalidate_size_hints();
 			if (iParent != 0 && iParent->owner() != 0 && aUpdateLayout)
 				iParent->owner()->ultimate_ancestor().layout_items(true);
 		}
@@ -165,6 +169,8 @@ namespace neogfx
 		if (iWeight != aWeight)
 		{
 			iWeight = aWeight;
+			if (iParent != 0)
+				iParent->invalidate_size_hints();
 			if (iParent != 0 && iParent->owner() != 0 && aUpdateLayout)
 				iParent->owner()->ultimate_ancestor().layout_items(true);
 		}
@@ -188,6 +194,8 @@ namespace neogfx
 		if (iMinimumSize != newMinimumSize)
 		{
 			iMinimumSize = newMinimumSize;
+			if (iParent != 0)
+				iParent->invalidate_size_hints();
 			if (iParent != 0 && iParent->owner() != 0 && aUpdateLayout)
 				iParent->owner()->ultimate_ancestor().layout_items(true);
 		}
@@ -211,6 +219,8 @@ namespace neogfx
 		if (iMaximumSize != newMaximumSize)
 		{
 			iMaximumSize = newMaximumSize;
+			if (iParent != 0)
+				iParent->invalidate_size_hints();
 			if (iParent != 0 && iParent->owner() != 0 && aUpdateLayout)
 				iParent->owner()->ultimate_ancestor().layout_items(true);
 		}
@@ -89,7 +89,6 @@ namespace neogfx
 		if (!enabled())
 			return;
 		owner()->layout_items_started();
-		next_layout_id();
 		validate();
 		for (auto& item : items())
 		{
@@ -125,6 +125,7 @@ namespace neogfx
 		if (iStyle != aStyle)
 		{
 			iStyle = aStyle;
+			invalidate_size_hints();
 			if (has_managing_layout())
 				managing_layout().layout_items(true);
 		}
@@ -18,7 +18,7 @@
 */
 
 #include <neogfx/neogfx.hpp>
-#include <neolib/timer.hpp>
+#include <neogfx/core/timer.hpp>
 #include <neolib/destroyable.hpp>
 #include <neogfx/app/app.hpp>
 #include <neogfx/gui/layout/i_layout.hpp>
@@ -27,11 +27,11 @@
 
 namespace neogfx
 {
-	class header_view::updater : private neolib::callback_timer
+	class header_view::updater : private callback_timer
 	{
 	public:
 		updater(header_view& aParent) :
-			neolib::callback_timer(app::instance(), [this, &aParent](neolib::callback_timer&)
+			callback_timer(app::instance(), [this, &aParent](callback_timer&)
 			{
 				neolib::destroyable::destroyed_flag destroyed(*this);
 				iParent.layout().set_spacing(iParent.separator_width());
@@ -75,6 +75,8 @@ namespace neogfx
 				app::event_processing_context epc(app::instance(), "neogfx::header_view::updater");
 				for (uint32_t c = 0; c < 1000 && iRow < iParent.model().rows(); ++c, ++iRow)
 				{
+					if (!iParent.model().row_cached(iRow))
+						continue;
 					iParent.update_from_row(iRow, false);
 					if (c % 25 == 0 && app::instance().program_elapsed_ms() - since > 20)
 					{
@@ -265,6 +267,33 @@ namespace neogfx
 		iUpdater.reset(new updater(*this));
 	}
 
+	void header_view::items_added(const i_item_model&, item_model_index::value_type, uint32_t)
+	{
+		if (iBatchUpdatesInProgress)
+			return;
+		iSectionWidths.resize(model().columns());
+		iUpdater.reset();
+		iUpdater.reset(new updater(*this));
+	}
+
+	void header_view::items_changed(const i_item_model&, item_model_index::value_type, uint32_t)
+	{
+		if (iBatchUpdatesInProgress)
+			return;
+		iSectionWidths.resize(model().columns());
+		iUpdater.reset();
+		iUpdater.reset(new updater(*this));
+	}
+
+	void header_view::items_removed(const i_item_model&, item_model_index::value_type, uint32_t)
+	{
+		if (iBatchUpdatesInProgress)
+			return;
+		iSectionWidths.resize(model().columns());
+		iUpdater.reset();
+		iUpdater.reset(new updater(*this));
+	}
+
 	void header_view::items_sorted(const i_item_model&)
 	{
 		iUpdater.reset();
@@ -197,8 +197,12 @@ namespace neogfx
 		size oldSize = minimum_size();
 		iTexture = aTexture;
 		image_changed.trigger();
-		if (oldSize != minimum_size() && has_managing_layout())
-			managing_layout().layout_items(true);
+		if (oldSize != minimum_size())
+		{
+			invalidate_size_hints();
+			if (has_managing_layout())
+				managing_layout().layout_items(true);
+		}
 		update();
 	}
 
@@ -207,8 +211,12 @@ namespace neogfx
 		size oldSize = minimum_size();
 		iTexture = aImage;
 		image_changed.trigger();
-		if (oldSize != minimum_size() && has_managing_layout())
-			managing_layout().layout_items(true);
+		if (oldSize != minimum_size())
+		{
+			invalidate_size_hints();
+			if (has_managing_layout())
+				managing_layout().layout_items(true);
+		}
 		update();
 	}
 
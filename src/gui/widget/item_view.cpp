@@ -227,6 +227,7 @@ namespace neogfx
 	{
 		scrollable_widget::paint(aGraphicsContext);
 		auto first = first_visible_item(aGraphicsContext);
+		model().rows_in_view(first.first, last_visible_item(aGraphicsContext).first);
 		bool finished = false;
 		for (item_model_index::value_type row = first.first; row < model().rows() && !finished; ++row)
 		{
@@ -271,7 +272,7 @@ namespace neogfx
 			auto item = item_at(aPosition);
 			if (item != boost::none)
 				selection_model().set_current_index(*item);
-			iMouseTracker = std::make_shared<neolib::callback_timer>(app::instance(), [this](neolib::callback_timer& aTimer)
+			iMouseTracker = std::make_shared<callback_timer>(app::instance(), [this](callback_timer& aTimer)
 			{
 				aTimer.again();
 				auto item = item_at(surface().mouse_position() - origin());
@@ -414,6 +415,11 @@ namespace neogfx
 		}
 	}
 
+	optional_rect item_view::scrolled_area() const
+	{
+		return item_display_rect();
+	}
+
 	void item_view::column_info_changed(const i_item_model&, item_model_index::value_type)
 	{
 		if (iBatchUpdatesInProgress)
@@ -446,8 +452,33 @@ namespace neogfx
 		update();
 	}
 
+	void item_view::items_added(const i_item_model&, item_model_index::value_type, uint32_t)
+	{
+		if (iBatchUpdatesInProgress)
+			return;
+		update_scrollbar_visibility();
+		update();
+	}
+
+	void item_view::items_changed(const i_item_model&, item_model_index::value_type, uint32_t)
+	{
+		if (iBatchUpdatesInProgress)
+			return;
+		update_scrollbar_visibility();
+		update();
+	}
+
+	void item_view::items_removed(const i_item_model&, item_model_index::value_type, uint32_t)
+	{
+		if (iBatchUpdatesInProgress)
+			return;
+		update_scrollbar_visibility();
+		update();
+	}
+
 	void item_view::items_sorted(const i_item_model&)
 	{
+		update_scrollbar_visibility();
 		update();
 	}
 
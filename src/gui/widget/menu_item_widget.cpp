@@ -266,7 +266,7 @@ namespace neogfx
 		{
 			if (menu_item().type() == i_menu_item::SubMenu && menu().type() == i_menu::Popup)
 			{
-				iSubMenuOpener = std::make_unique<neolib::callback_timer>(app::instance(), [this](neolib::callback_timer&)
+				iSubMenuOpener = std::make_unique<callback_timer>(app::instance(), [this](callback_timer&)
 				{
 					if (!menu_item().sub_menu().is_open())
 					{
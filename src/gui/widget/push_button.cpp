@@ -26,7 +26,7 @@ namespace neogfx
 {
 	push_button::push_button(const std::string& aText, push_button_style aStyle) :
 		button(aText, (aStyle == push_button_style::Normal || aStyle == push_button_style::ButtonBox ? alignment::Centre : alignment::Left) | alignment::VCentre),
-		iAnimator(app::instance(), [this](neolib::callback_timer&){ animate(); }, 20, false), 
+		iAnimator(app::instance(), [this](callback_timer&){ animate(); }, 20, false), 
 		iAnimationFrame(0),
 		iStyle(aStyle)
 	{
@@ -41,7 +41,7 @@ namespace neogfx
 	
 	push_button::push_button(i_widget& aParent, const std::string& aText, push_button_style aStyle) :
 		button(aParent, aText, (aStyle == push_button_style::Normal || aStyle == push_button_style::ButtonBox ? alignment::Centre : alignment::Left) | alignment::VCentre),
-		iAnimator(app::instance(), [this](neolib::callback_timer&){ animate(); }, 20, false), 
+		iAnimator(app::instance(), [this](callback_timer&){ animate(); }, 20, false), 
 		iAnimationFrame(0),
 		iStyle(aStyle)
 	{
@@ -56,7 +56,7 @@ namespace neogfx
 
 	push_button::push_button(i_layout& aLayout, const std::string& aText, push_button_style aStyle) :
 		button(aLayout, aText, (aStyle == push_button_style::Normal || aStyle == push_button_style::ButtonBox ? alignment::Centre : alignment::Left) | alignment::VCentre),
-		iAnimator(app::instance(), [this](neolib::callback_timer&){ animate(); }, 20, false),
+		iAnimator(app::instance(), [this](callback_timer&){ animate(); }, 20, false),
 		iAnimationFrame(0),
 		iStyle(aStyle)
 	{
@@ -357,13 +357,17 @@ namespace neogfx
 		}
 	}
 
-	void scrollable_widget::scrollbar_updated(const i_scrollbar& aScrollbar, i_scrollbar::update_reason_e)
+	void scrollable_widget::scrollbar_updated(const i_scrollbar& aScrollbar, i_scrollbar::update_reason_e aReason)
 	{
 		if (iIgnoreScrollbarUpdates)
 			return;
 		point scrollPosition = units_converter(*this).from_device_units(point(static_cast<coordinate>(horizontal_scrollbar().position()), static_cast<coordinate>(vertical_scrollbar().position())));
-		if (iOldScrollPosition != scrollPosition)
+		bool blitted = false;
+		bool scrolled = (iOldScrollPosition != scrollPosition);
+		if (scrolled)
 		{
+			if (aReason == i_scrollbar::ScrolledUp || aReason == i_scrollbar::ScrolledDown)
+				blitted = scroll_blit(aScrollbar, -(scrollPosition - iOldScrollPosition));
 			for (auto& c : children())
 			{
 				point delta = -(scrollPosition - iOldScrollPosition);
@@ -382,7 +386,44 @@ namespace neogfx
 				iOldScrollPosition.x = scrollPosition.x;
 			}
 		}
-		update(true);
+		// a range change that leaves the position alone only alters the scrollbar itself
+		if (blitted || (!scrolled && aReason == i_scrollbar::AttributeChanged))
+			update(to_client_coordinates(scrollbar_geometry(*this, aScrollbar)));
+		else
+			update(true);
+	}
+
+	optional_rect scrollable_widget::scrolled_area() const
+	{
+		return optional_rect{};
+	}
+
+	bool scrollable_widget::scroll_blit(const i_scrollbar& aScrollbar, const point& aDelta)
+	{
+		// Moves what is already on the surface and repaints only the exposed strip; only possible if everything
+		// within the scrolled area moves by the same amount.
+		auto area = scrolled_area();
+		if (area == boost::none || aScrollbar.style() == scrollbar_style::Menu)
+			return false;
+		if (!has_surface() || surface().destroyed() || effectively_hidden() || layout_items_in_progress())
+			return false;
+		rect blitArea = area->intersection(default_clip_rect());
+		if (blitArea.empty())
+			return false;
+		delta blitDelta{ aScrollbar.type() == scrollbar_type::Horizontal ? aDelta.x : 0.0, aScrollbar.type() == scrollbar_type::Vertical ? aDelta.y : 0.0 };
+		for (auto& c : children())
+		{
+			if (c->hidden())
+				continue;
+			if (aScrollbar.type() == scrollbar_type::Vertical && (scrolling_disposition(*c) & ScrollChildWidgetVertically) == ScrollChildWidgetVertically)
+				continue;
+			if (aScrollbar.type() == scrollbar_type::Horizontal && (scrolling_disposition(*c) & ScrollChildWidgetHorizontally) == ScrollChildWidgetHorizontally)
+				continue;
+			if (!blitArea.intersection(to_client_coordinates(c->window_rect())).empty())
+				return false;
+		}
+		surface().scroll_surface(to_window_coordinates(blitArea), blitDelta);
+		return true;
 	}
 
 	colour scrollable_widget::scrollbar_colour(const i_scrollbar&) const
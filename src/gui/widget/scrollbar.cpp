@@ -511,7 +511,7 @@ namespace neogfx
 		{
 		case ElementUpButton:
 			set_position(position() - step());
-			iTimer = std::make_shared<neolib::callback_timer>(app::instance(), [this](neolib::callback_timer& aTimer)
+			iTimer = std::make_shared<callback_timer>(app::instance(), [this](callback_timer& aTimer)
 			{
 				aTimer.set_duration(50);
 				aTimer.again();
@@ -521,7 +521,7 @@ namespace neogfx
 			break;
 		case ElementDownButton:
 			set_position(position() + step());
-			iTimer = std::make_shared<neolib::callback_timer>(app::instance(), [this](neolib::callback_timer& aTimer)
+			iTimer = std::make_shared<callback_timer>(app::instance(), [this](callback_timer& aTimer)
 			{
 				aTimer.set_duration(50);
 				aTimer.again();
@@ -531,7 +531,7 @@ namespace neogfx
 			break;
 		case ElementPageUpArea:
 			set_position(position() - page());
-			iTimer = std::make_shared<neolib::callback_timer>(app::instance(), [this](neolib::callback_timer& aTimer)
+			iTimer = std::make_shared<callback_timer>(app::instance(), [this](callback_timer& aTimer)
 			{
 				aTimer.set_duration(50);
 				aTimer.again();
@@ -541,7 +541,7 @@ namespace neogfx
 			break;
 		case ElementPageDownArea:
 			set_position(position() + page());
-			iTimer = std::make_shared<neolib::callback_timer>(app::instance(), [this](neolib::callback_timer& aTimer)
+			iTimer = std::make_shared<callback_timer>(app::instance(), [this](callback_timer& aTimer)
 			{
 				aTimer.set_duration(50);
 				aTimer.again();
@@ -600,7 +600,7 @@ namespace neogfx
 		if (iScrollTrackPosition == boost::none)
 		{
 			iScrollTrackPosition = iContainer.as_widget().surface().mouse_position();
-			iTimer = std::make_shared<neolib::callback_timer>(app::instance(), [this](neolib::callback_timer& aTimer)
+			iTimer = std::make_shared<callback_timer>(app::instance(), [this](callback_timer& aTimer)
 			{
 				aTimer.again();
 				point delta = iContainer.as_widget().surface().mouse_position() - *iScrollTrackPosition;
@@ -140,13 +140,15 @@ namespace neogfx
 		iType(aType),
 		iReadOnly(false),
 		iWordWrap(aType == MultiLine),
+		iLazyLayout(false),
 		iPassword(false),
 		iAlignment(neogfx::alignment::Left|neogfx::alignment::Top),
 		iPersistDefaultStyle(false),
 		iGlyphColumns(1),
+		iEstimatedLines(0),
 		iCursorAnimationStartTime(app::instance().program_elapsed_ms()),
 		iTabStopHint("0000"),
-		iAnimator(app::instance(), [this](neolib::callback_timer&)
+		iAnimator(app::instance(), [this](callback_timer&)
 		{
 			iAnimator.again();
 			animate();
@@ -160,13 +162,15 @@ namespace neogfx
 		iType(aType),
 		iReadOnly(false),
 		iWordWrap(aType == MultiLine),
+		iLazyLayout(false),
 		iPassword(false),
 		iAlignment(neogfx::alignment::Left | neogfx::alignment::Top),
 		iPersistDefaultStyle(false),
 		iGlyphColumns(1),
+		iEstimatedLines(0),
 		iCursorAnimationStartTime(app::instance().program_elapsed_ms()),
 		iTabStopHint("0000"),
-		iAnimator(app::instance(), [this](neolib::callback_timer&)
+		iAnimator(app::instance(), [this](callback_timer&)
 		{
 			iAnimator.again();
 			animate();
@@ -180,13 +184,15 @@ namespace neogfx
 		iType(aType),
 		iReadOnly(false),
 		iWordWrap(aType == MultiLine),
+		iLazyLayout(false),
 		iPassword(false),
 		iAlignment(neogfx::alignment::Left | neogfx::alignment::Top),
 		iPersistDefaultStyle(false),
 		iGlyphColumns(1),
+		iEstimatedLines(0),
 		iCursorAnimationStartTime(app::instance().program_elapsed_ms()),
 		iTabStopHint("0000"),
-		iAnimator(app::instance(), [this](neolib::callback_timer&)
+		iAnimator(app::instance(), [this](callback_timer&)
 		{
 			iAnimator.again();
 			animate();
@@ -245,26 +251,25 @@ namespace neogfx
 		{
 			const auto& column = *iterColumn;
 			const auto& lines = column.lines();
-			auto line = std::lower_bound(lines.begin(), lines.end(), glyph_line{ {}, {}, {}, vertical_scrollbar().position(), {} },
-				[](const glyph_line& left, const glyph_line& right) { return left.ypos < right.ypos; });
-			if (line != lines.begin() && (line == lines.end() || line->ypos > vertical_scrollbar().position()))
+			auto line = ypos_to_line(lines, vertical_scrollbar().position());
+			if (line == lines.end() && !lines.empty())
 				--line;
 			if (line == lines.end())
 				continue;
-			auto y = line->ypos;
-			for (auto paintLine = line; paintLine != lines.end(); y += (paintLine++)->extents.cy)
+			auto y = line_ypos(lines, line);
+			for (auto paintLine = line; paintLine != lines.end(); y += (paintLine++)->first.extents.cy)
 			{
 				point linePos = client_rect(false).top_left() + point{ -horizontal_scrollbar().position(), y - vertical_scrollbar().position() };
-				if (linePos.y + paintLine->extents.cy < client_rect(false).top() || linePos.y + paintLine->extents.cy < update_rect().top())
+				if (linePos.y + paintLine->first.extents.cy < client_rect(false).top() || linePos.y + paintLine->first.extents.cy < update_rect().top())
 					continue;
 				if (linePos.y > client_rect(false).bottom() || linePos.y > update_rect().bottom())
 					break;
-				auto textDirection = glyph_text_direction(paintLine->lineStart.second, paintLine->lineEnd.second);
+				auto textDirection = glyph_text_direction(paintLine->first.start(), paintLine->first.end());
 				if (iAlignment == alignment::Left && textDirection == text_direction::RTL ||
 					iAlignment == alignment::Right && textDirection == text_direction::LTR)
-					linePos.x += column.width() - column.margins().right - aGraphicsContext.from_device_units(size{ paintLine->extents.cx, 0 }).cx;
+					linePos.x += column.width() - column.margins().right - aGraphicsContext.from_device_units(size{ paintLine->first.extents.cx, 0 }).cx;
 				else if (iAlignment == alignment::Centre)
-					linePos.x += std::ceil((column.width() - aGraphicsContext.from_device_units(size{ paintLine->extents.cx, 0 }).cx) / 2);
+					linePos.x += std::ceil((column.width() - aGraphicsContext.from_device_units(size{ paintLine->first.extents.cx, 0 }).cx) / 2);
 				else
 					linePos.x += column.margins().left;
 				draw_glyphs(aGraphicsContext, linePos, column, paintLine);
@@ -310,7 +315,7 @@ namespace neogfx
 			set_cursor_glyph_position(hit_test(aPosition), (aKeyModifiers & KeyModifier_SHIFT) == KeyModifier_NONE);
 			if (capturing())
 			{
-				iDragger.emplace(app::instance(), [this](neolib::callback_timer& aTimer)
+				iDragger.emplace(app::instance(), [this](callback_timer& aTimer)
 				{
 					aTimer.again();
 					set_cursor_glyph_position(hit_test(surface().mouse_position() - origin()), false);
@@ -545,6 +550,7 @@ namespace neogfx
 			}
 			break;
 		case UsvStageDone:
+			refine_lines();
 			make_cursor_visible();
 			break;
 		default:
@@ -559,6 +565,11 @@ namespace neogfx
 		return app::instance().current_style().colour().mid(background_colour());
 	}
 
+	optional_rect text_edit::scrolled_area() const
+	{
+		return client_rect();
+	}
+
 	bool text_edit::can_undo() const
 	{
 		/* todo */
@@ -755,7 +766,7 @@ namespace neogfx
 			{
 				auto currentPosition = glyph_position(cursor_glyph_position());
 				if (currentPosition.line != currentPosition.column->lines().begin())
-					cursor().set_position(from_glyph(iGlyphs.begin() + hit_test(point{ currentPosition.pos.x, (currentPosition.line - 1)->ypos }, false)).first, aMoveAnchor);
+					cursor().set_position(from_glyph(iGlyphs.begin() + hit_test(point{ currentPosition.pos.x, line_ypos(currentPosition.column->lines(), currentPosition.line - 1) }, false)).first, aMoveAnchor);
 			}
 			break;
 		case cursor::Down:
@@ -764,7 +775,7 @@ namespace neogfx
 				if (currentPosition.line != currentPosition.column->lines().end())
 				{
 					if (currentPosition.line + 1 != currentPosition.column->lines().end())
-						cursor().set_position(from_glyph(iGlyphs.begin() + hit_test(point{ currentPosition.pos.x, (currentPosition.line + 1)->ypos }, false)).first, aMoveAnchor);
+						cursor().set_position(from_glyph(iGlyphs.begin() + hit_test(point{ currentPosition.pos.x, line_ypos(currentPosition.column->lines(), currentPosition.line + 1) }, false)).first, aMoveAnchor);
 					else if (currentPosition.lineEnd != iGlyphs.end() && currentPosition.lineEnd->is_whitespace() && currentPosition.lineEnd->value() == U'\n')
 						cursor().set_position(iText.size(), aMoveAnchor);
 				}
@@ -808,6 +819,20 @@ namespace neogfx
 		}
 	}
 
+	bool text_edit::lazy_layout() const
+	{
+		return iLazyLayout;
+	}
+
+	void text_edit::set_lazy_layout(bool aLazyLayout)
+	{
+		if (iLazyLayout != aLazyLayout)
+		{
+			iLazyLayout = aLazyLayout;
+			refresh_paragraph(iText.begin(), 0);
+		}
+	}
+
 	bool text_edit::password() const
 	{
 		return iPassword;
@@ -895,8 +920,8 @@ namespace neogfx
 		glyph_lines::const_iterator line;
 		for (; column != iGlyphColumns.end(); ++column)
 		{
-			line = std::lower_bound(column->lines().begin(), column->lines().end(), glyph_line{ {}, { aGlyphPosition, iGlyphs.begin() + aGlyphPosition }, {}, 0.0, {} },
-				[](const glyph_line& left, const glyph_line& right) { return left.lineStart.first < right.lineStart.first; });
+			line = std::lower_bound(column->lines().begin(), column->lines().end(), aGlyphPosition,
+				[](const glyph_lines::value_type& aLine, position_type aPosition) { return aLine.first.start_index() < aPosition; });
 			if (line != column->lines().end())
 				break;
 		}
@@ -907,16 +932,16 @@ namespace neogfx
 		{
 			if (line == lines.end())
 			{
-				if (aGlyphPosition <= lines.back().lineEnd.first || (!iGlyphs.back().is_whitespace() || iGlyphs.back().value() != U'\n'))
+				if (aGlyphPosition <= (lines.end() - 1)->first.end_index() || (!iGlyphs.back().is_whitespace() || iGlyphs.back().value() != U'\n'))
 					--line;
 			}
-			else if (aGlyphPosition < line->lineStart.first)
+			else if (aGlyphPosition < line->first.start_index())
 				--line;
 		}
 		if (line != lines.end())
 		{
-			position_type lineStart = line->lineStart.first;
-			position_type lineEnd = line->lineEnd.first;
+			position_type lineStart = line->first.start_index();
+			position_type lineEnd = line->first.end_index();
 			bool placeCursorToRight = (aGlyphPosition == lineEnd);
 			if (aForCursor)
 			{
@@ -944,20 +969,20 @@ namespace neogfx
 				{
 					auto iterGlyph = iGlyphs.begin() + aGlyphPosition;
 					const auto& glyph = aGlyphPosition < lineEnd ? *iterGlyph : *(iterGlyph - 1);
-					point linePos{ glyph.x - line->lineStart.second->x, line->ypos };
+					point linePos{ glyph.x - line->first.start()->x, line_ypos(lines, line) };
 					if (placeCursorToRight)
 						linePos.x += glyph.advance().cx;
 					return position_info{ iterGlyph, column, line, iGlyphs.begin() + lineStart, iGlyphs.begin() + lineEnd, linePos };
 				}
 				else
-					return position_info{ line->lineStart.second, column, line, iGlyphs.begin() + lineStart, iGlyphs.begin() + lineEnd, point{ 0.0, line->ypos } };
+					return position_info{ line->first.start(), column, line, iGlyphs.begin() + lineStart, iGlyphs.begin() + lineEnd, point{ 0.0, line_ypos(lines, line) } };
 			}
 		}
 		point pos;
 		if (!lines.empty())
 		{
 			pos.x = 0.0;
-			pos.y = lines.back().ypos + lines.back().extents.cy;
+			pos.y = line_ypos(lines, lines.end());
 		}
 		return position_info{ iGlyphs.end(), column, lines.end(), iGlyphs.end(), iGlyphs.end(), pos };
 	}
@@ -1000,18 +1025,13 @@ namespace neogfx
 		if (adjusted.x < 0.0)
 			adjusted.x = 0.0;
 		const auto& lines = column.lines();
-		auto line = std::lower_bound(lines.begin(), lines.end(), glyph_line{ {}, {}, {}, adjusted.y, {} },
-			[](const glyph_line& left, const glyph_line& right) { return left.ypos < right.ypos; });
-		if (line == lines.end() && !lines.empty() && adjusted.y < lines.back().ypos + lines.back().extents.cy)
-			--line;
+		auto line = ypos_to_line(lines, adjusted.y);
 		if (line != lines.end())
 		{
-			if (line != lines.begin() && adjusted.y < line->ypos)
-				--line;
-			auto lineStart = (line != lines.end() ? line->lineStart.first : iGlyphs.size());
-			auto lineEnd = (line != lines.end() ? line->lineEnd.first : iGlyphs.size());
-			auto lineStartX = line->lineStart.second->x;
-			for (auto gi = line->lineStart.first; gi != lineEnd; ++gi)
+			auto lineStart = line->first.start_index();
+			auto lineEnd = line->first.end_index();
+			auto lineStartX = line->first.start()->x;
+			for (auto gi = lineStart; gi != lineEnd; ++gi)
 			{
 				auto& g = iGlyphs[gi];
 				if (adjusted.x >= g.x - lineStartX && adjusted.x < g.x - lineStartX + g.advance().cx)
@@ -1199,6 +1219,7 @@ namespace neogfx
 		{
 			iHint = aHint;
 			iHintedSize = boost::none;
+			invalidate_size_hints();
 			if (has_managing_layout())
 				managing_layout().layout_items(true);
 			update();
@@ -1213,6 +1234,13 @@ namespace neogfx
 		return iCalculatedTabStops->second;
 	}
 
+	dimension text_edit::estimated_character_width() const
+	{
+		if (iEstimatedCharacterWidth == boost::none || iEstimatedCharacterWidth->first != font())
+			iEstimatedCharacterWidth = std::make_pair(font(), graphics_context(*this).text_extent("0", font()).cx);
+		return iEstimatedCharacterWidth->second;
+	}
+
 	void text_edit::set_tab_stop_hint(const std::string& aTabStopHint)
 	{
 		if (iTabStopHint != aTabStopHint)
@@ -1315,24 +1343,68 @@ namespace neogfx
 		return std::make_pair(iText.size(), iText.size());
 	}
 
-	void text_edit::refresh_paragraph(document_text::const_iterator aWhere, ptrdiff_t aDelta)
+	void text_edit::clear_paragraph_caches()
 	{
-		/* simple (naive) implementation just to get things moving (so just refresh everything) ... */
-		(void)aWhere;
-		graphics_context gc(*this);
-		if (password())
-			gc.set_password(true, iPasswordMask.empty() ? "\xE2\x97\x8F" : iPasswordMask);
-		iGlyphs.clear();
-		iGlyphParagraphs.clear();
 		iCharacterToParagraphCache.clear();
 		iCharacterToParagraphCacheLastAccess.reset();
 		iGlyphToParagraphCache.clear();
 		iGlyphToParagraphCacheLastAccess.reset();
+	}
+
+	void text_edit::refresh_paragraph(document_text::const_iterator aWhere, ptrdiff_t aDelta)
+	{
+		clear_paragraph_caches();
+		if (aDelta == 0 || iGlyphParagraphs.empty() || iGlyphs.empty())
+		{
+			iGlyphs.clear();
+			iGlyphParagraphs.clear();
+			if (iLazyLayout)
+				defer_paragraphs(0, iText.size(), iGlyphParagraphs.end());
+			else
+				shape_paragraphs(0, iText.size(), 0, iGlyphParagraphs.end());
+			refresh_columns();
+			return;
+		}
+		// Only the paragraphs touched by the edit are reshaped; for a deletion that includes the paragraph
+		// containing the first character after the deleted text as the newline separating them may have gone.
+		const auto& paragraphs = iGlyphParagraphs;
+		position_type where = aWhere - iText.begin();
+		auto first = paragraphs.find_by_foreign_index(glyph_paragraph_index{ where, 0 }, [](const glyph_paragraph_index& aLhs, const glyph_paragraph_index& aRhs) { return aLhs.characters() < aRhs.characters(); }).first;
+		if (first == paragraphs.end())
+			--first;
+		auto last = first;
+		if (aDelta < 0)
+		{
+			last = paragraphs.find_by_foreign_index(glyph_paragraph_index{ where + static_cast<position_type>(-aDelta), 0 }, [](const glyph_paragraph_index& aLhs, const glyph_paragraph_index& aRhs) { return aLhs.characters() < aRhs.characters(); }).first;
+			if (last == paragraphs.end())
+				--last;
+		}
+		auto insertBefore = last + 1;
+		glyph_paragraphs::size_type firstIndex = first - paragraphs.begin();
+		glyph_paragraphs::size_type oldParagraphCount = insertBefore - first;
+		position_type textStart = first->first.text_start_index();
+		position_type textEnd = static_cast<position_type>(static_cast<ptrdiff_t>(last->first.text_end_index()) + aDelta);
+		document_glyphs::size_type glyphStart = first->first.start_index();
+		document_glyphs::size_type oldGlyphCount = last->first.end_index() - glyphStart;
+		iGlyphs.erase(iGlyphs.begin() + glyphStart, iGlyphs.begin() + glyphStart + oldGlyphCount);
+		iGlyphParagraphs.erase(first, insertBefore);
+		auto newParagraphs = shape_paragraphs(textStart, textEnd, glyphStart, insertBefore);
+		if (!refresh_lines(newParagraphs.first, firstIndex, oldParagraphCount, newParagraphs.second))
+			refresh_columns();
+	}
+
+	std::pair<text_edit::glyph_paragraphs::iterator, text_edit::glyph_paragraphs::size_type> text_edit::shape_paragraphs(position_type aTextStart, position_type aTextEnd, document_glyphs::size_type aGlyphPosition, glyph_paragraphs::const_iterator aInsertBefore)
+	{
+		std::pair<glyph_paragraphs::iterator, glyph_paragraphs::size_type> result{ iGlyphParagraphs.end(), 0 };
+		graphics_context gc(*this);
+		if (password())
+			gc.set_password(true, iPasswordMask.empty() ? "\xE2\x97\x8F" : iPasswordMask);
 		std::u32string paragraphBuffer;
-		auto paragraphStart = iText.begin();
+		auto paragraphStart = iText.begin() + aTextStart;
+		auto textEnd = iText.begin() + aTextEnd;
 		auto iterColumn = iGlyphColumns.begin();
 		neolib::vecarray<std::u32string::size_type, 16, -1> columnDelimiters;
-		auto fs = [this, paragraphStart, &columnDelimiters](std::u32string::size_type aSourceIndex)
+		auto fs = [this, &paragraphStart, &columnDelimiters](std::u32string::size_type aSourceIndex)
 		{
 			const auto& tagContents = iText.tag(paragraphStart + aSourceIndex).contents();
 			std::size_t indexColumn = std::lower_bound(columnDelimiters.begin(), columnDelimiters.end(), aSourceIndex) - columnDelimiters.begin();
@@ -1344,7 +1416,7 @@ namespace neogfx
 				columnStyle.font() != boost::none ? columnStyle : iDefaultStyle;
 			return style.font() != boost::none ? *style.font() : font();
 		};
-		for (auto iterChar = iText.begin(); iterChar != iText.end(); ++iterChar)
+		for (auto iterChar = paragraphStart; iterChar != textEnd; ++iterChar)
 		{
 			auto& column = *(iterColumn);
 			auto ch = *iterChar;
@@ -1355,49 +1427,80 @@ namespace neogfx
 				continue;
 			}
 			bool newLine = (ch == U'\n');
-			if (newLine || iterChar == iText.end() - 1)
+			if (newLine || iterChar == textEnd - 1)
 			{
 				paragraphBuffer.assign(paragraphStart, iterChar + 1);
 				auto gt = gc.to_glyph_text(paragraphBuffer.begin(), paragraphBuffer.end(), fs);
-				auto paragraphGlyphs = iGlyphs.insert(iGlyphs.end(), gt.cbegin(), gt.cend());
-				auto newParagraph = iGlyphParagraphs.insert(iGlyphParagraphs.end(),
+				document_glyphs::size_type paragraphGlyphCount = gt.cend() - gt.cbegin();
+				iGlyphs.insert(iGlyphs.begin() + aGlyphPosition, gt.cbegin(), gt.cend());
+				auto newParagraph = iGlyphParagraphs.insert(aInsertBefore,
 					std::make_pair(
 						glyph_paragraph{*this},
-						glyph_paragraph_index{
-							static_cast<std::size_t>((iterChar + 1) - iText.begin()) - static_cast<std::size_t>(paragraphStart - iText.begin()),
-							iGlyphs.size() - static_cast<std::size_t>(paragraphGlyphs - iGlyphs.begin())}),
+						glyph_paragraph_index{ static_cast<std::size_t>((iterChar + 1) - paragraphStart), paragraphGlyphCount }),
 					glyph_paragraphs::skip_type{glyph_paragraph_index{}, glyph_paragraph_index{}});
 				newParagraph->first.set_self(newParagraph);
+				if (result.second++ == 0)
+					result.first = newParagraph;
+				aGlyphPosition += paragraphGlyphCount;
 				paragraphStart = iterChar + 1;
+				iterColumn = iGlyphColumns.begin();
 				columnDelimiters.clear();
+				auto& paragraph = *newParagraph;
+				if (paragraph.first.start() == paragraph.first.end())
+					continue;
+				auto paragraphTextStart = paragraph.first.text_start_index();
+				coordinate x = 0.0;
+				for (auto iterGlyph = paragraph.first.start(); iterGlyph != paragraph.first.end(); ++iterGlyph)
+				{
+					if (iText[paragraphTextStart + iterGlyph->source().first] == iterColumn->delimiter() && iterColumn + 1 != iGlyphColumns.end())
+					{
+						iterGlyph->set_advance(size{});
+						++iterColumn;
+						continue;
+					}
+					else if (iterGlyph->is_whitespace() && iterGlyph->value() == U'\t')
+					{
+						auto advance = iterGlyph->advance();
+						advance.cx = tab_stops() - std::fmod(x, tab_stops());
+						iterGlyph->set_advance(advance);
+					}
+					iterGlyph->x = x;
+					x += iterGlyph->advance().cx;
+				}
 			}
 		}
-		for (auto p = iGlyphParagraphs.begin(); p != iGlyphParagraphs.end(); ++p)
+		return result;
+	}
+
+	void text_edit::defer_paragraphs(position_type aTextStart, position_type aTextEnd, glyph_paragraphs::const_iterator aInsertBefore)
+	{
+		// Lazy layout: paragraphs are only delimited here; refine_lines() shapes each one when it first wraps it.
+		auto paragraphStart = iText.begin() + aTextStart;
+		auto textEnd = iText.begin() + aTextEnd;
+		for (auto iterChar = paragraphStart; iterChar != textEnd; ++iterChar)
 		{
-			auto& paragraph = *p;
-			if (paragraph.first.start() == paragraph.first.end())
-				continue;
-			coordinate x = 0.0;
-			iterColumn = iGlyphColumns.begin();
-			for (auto iterGlyph = paragraph.first.start(); iterGlyph != paragraph.first.end(); ++iterGlyph)
+			if (*iterChar == U'\n' || iterChar == textEnd - 1)
 			{
-				if (iText[iterGlyph->source().first] == iterColumn->delimiter() && iterColumn + 1 != iGlyphColumns.end())
-				{
-					iterGlyph->set_advance(size{});
-					++iterColumn;
-					continue;
-				}
-				else if (iterGlyph->is_whitespace() && iterGlyph->value() == U'\t')
-				{
-					auto advance = iterGlyph->advance();
-					advance.cx = tab_stops() - std::fmod(x, tab_stops());
-					iterGlyph->set_advance(advance);
-				}
-				iterGlyph->x = x;
-				x += iterGlyph->advance().cx;
+				auto newParagraph = iGlyphParagraphs.insert(aInsertBefore,
+					std::make_pair(
+						glyph_paragraph{*this},
+						glyph_paragraph_index{ static_cast<std::size_t>((iterChar + 1) - paragraphStart), 0 }),
+					glyph_paragraphs::skip_type{glyph_paragraph_index{}, glyph_paragraph_index{}});
+				newParagraph->first.set_self(newParagraph);
+				paragraphStart = iterChar + 1;
 			}
 		}
-		refresh_columns();
+	}
+
+	text_edit::glyph_paragraphs::iterator text_edit::shape_deferred_paragraph(glyph_paragraphs::iterator aParagraph)
+	{
+		clear_paragraph_caches();
+		position_type textStart = aParagraph->first.text_start_index();
+		position_type textEnd = aParagraph->first.text_end_index();
+		document_glyphs::size_type glyphStart = aParagraph->first.start_index();
+		auto insertBefore = aParagraph + 1;
+		iGlyphParagraphs.erase(aParagraph, insertBefore);
+		return shape_paragraphs(textStart, textEnd, glyphStart, insertBefore).first;
 	}
 
 	void text_edit::refresh_columns()
@@ -1408,9 +1511,7 @@ namespace neogfx
 
 	void text_edit::refresh_lines()
 	{
-		/* simple (naive) implementation just to get things moving... */
-		for (auto& column : iGlyphColumns)
-			column.lines().clear();
+		clear_lines();
 		point pos{};
 		dimension availableWidth = client_rect(false).width();
 		dimension availableHeight = client_rect(false).height();
@@ -1418,115 +1519,15 @@ namespace neogfx
 		bool showHorizontalScrollbar = false;
 		iTextExtents = size{};
 		uint32_t pass = 1;
-		auto iterColumn = iGlyphColumns.begin();
+		glyph_line_list paragraphLines;
 		for (auto p = iGlyphParagraphs.begin(); p != iGlyphParagraphs.end();)
 		{
-			auto& column = *iterColumn;
-			auto& lines = column.lines();
-			auto& paragraph = *p;
-			auto paragraphStart = paragraph.first.start();
-			auto paragraphEnd = paragraph.first.end();
-			if (paragraphStart == paragraphEnd || (paragraphStart->is_whitespace() && paragraphStart->value() == U'\n'))
-			{
-				auto lineStart = paragraphStart;
-				auto lineEnd = lineStart;
-				const auto& glyph = *lineStart;
-				const auto& tagContents = iText.tag(iText.begin() + paragraph.first.text_start_index() + glyph.source().first).contents();
-				const auto& style = tagContents.is<style_list::const_iterator>() ? *static_variant_cast<style_list::const_iterator>(tagContents) : iDefaultStyle;
-				auto& glyphFont = style.font() != boost::none ? *style.font() : font();
-				lines.push_back(
-					glyph_line{
-						{ p - iGlyphParagraphs.begin(), p },
-						{ lineStart - iGlyphs.begin(), lineStart },
-						{ lineEnd - iGlyphs.begin(), lineEnd },
-						pos.y,
-						{ 0.0, glyphFont.height() } });
-				pos.y += glyphFont.height();
-			}
-			else if (iWordWrap && (paragraphEnd - 1)->x + (paragraphEnd - 1)->advance().cx > availableWidth)
-			{
-				auto insertionPoint = lines.end();
-				bool first = true;
-				auto next = paragraph.first.start();
-				auto lineStart = next;
-				auto lineEnd = paragraphEnd;
-				coordinate offset = 0.0;
-				while (next != paragraphEnd)
-				{
-					auto split = std::lower_bound(next, paragraphEnd, paragraph_positioned_glyph{ offset + availableWidth });
-					if (split != next && (split != paragraphEnd || (split - 1)->x + (split - 1)->advance().cx >= offset + availableWidth))
-						--split;
-					if (split == next)
-						++split;
-					if (split != paragraphEnd)
-					{
-						std::pair<document_glyphs::iterator, document_glyphs::iterator> wordBreak = word_break(lineStart, split, paragraphEnd);
-						lineEnd = wordBreak.first;
-						next = wordBreak.second;
-						if (wordBreak.first == wordBreak.second)
-						{
-							while (lineEnd != lineStart && (lineEnd - 1)->source() == wordBreak.first->source())
-								--lineEnd;
-							next = lineEnd;
-						}
-					}
-					else
-						next = paragraphEnd;
-					dimension x = (split != iGlyphs.end() ? split->x : (lineStart != lineEnd ? iGlyphs.back().x + iGlyphs.back().advance().cx : 0.0));
-					auto height = paragraph.first.height(lineStart, lineEnd);
-					if (lineEnd != lineStart && (lineEnd - 1)->is_whitespace() && (lineEnd - 1)->value() == U'\n')
-						--lineEnd;
-					bool rtl = false;
-					if (!first &&
-						insertionPoint->lineStart != insertionPoint->lineEnd &&
-						lineStart != lineEnd &&
-						insertionPoint->lineStart.second->direction() == text_direction::RTL &&
-						(lineEnd - 1)->direction() == text_direction::RTL)
-						rtl = true; // todo: is this sufficient for multi-line RTL text?
-					if (!rtl)
-						insertionPoint = lines.end();
-					insertionPoint = lines.insert(insertionPoint,
-						glyph_line{
-							{ p - iGlyphParagraphs.begin(), p },
-							{ lineStart - iGlyphs.begin(), lineStart },
-							{ lineEnd - iGlyphs.begin(), lineEnd },
-							pos.y,
-							{ x - offset, height } });
-					if (rtl)
-					{
-						auto ypos = (insertionPoint + 1)->ypos;
-						for (auto i = insertionPoint; i != lines.end(); ++i)
-						{
-							i->ypos = ypos;
-							ypos += i->extents.cy;
-						}
-					}
-					pos.y += height;
-					iTextExtents.cx = std::max(iTextExtents.cx, x - offset);
-					lineStart = next;
-					if (lineStart != paragraphEnd)
-						offset = lineStart->x;
-					lineEnd = paragraphEnd;
-					first = false;
-				}
-			}
+			paragraphLines.clear();
+			if (iLazyLayout)
+				estimate_paragraph(p, paragraphLines, pos, availableWidth);
 			else
-			{
-				auto lineStart = paragraphStart;
-				auto lineEnd = paragraphEnd;
-				auto height = paragraph.first.height(lineStart, lineEnd);
-				if (lineEnd != lineStart && (lineEnd - 1)->is_whitespace() && (lineEnd - 1)->value() == U'\n')
-					--lineEnd;
-				lines.push_back(
-					glyph_line{
-						{ p - iGlyphParagraphs.begin(), p },
-						{ lineStart - iGlyphs.begin(), lineStart },
-						{ lineEnd - iGlyphs.begin(), lineEnd },
-						pos.y,
-						{ (lineEnd - 1)->x + (lineEnd - 1)->advance().cx, height} });
-				pos.y += lines.back().extents.cy;
-				iTextExtents.cx = std::max(iTextExtents.cx, lines.back().extents.cx);
-			}
+				wrap_paragraph(p, paragraphLines, pos, availableWidth);
+			insert_lines(iGlyphColumns.front().lines().end(), paragraphLines);
 			switch (pass)
 			{
 			case 1:
@@ -1535,9 +1536,8 @@ namespace neogfx
 				{
 					showVerticalScrollbar = true;
 					availableWidth -= vertical_scrollbar().width(*this);
-					lines.clear();
+					clear_lines();
 					pos = point{};
-					iTextExtents = size{};
 					p = iGlyphParagraphs.begin();
 					++pass;
 				}
@@ -1549,9 +1549,8 @@ namespace neogfx
 				{
 					showHorizontalScrollbar = true;
 					availableHeight -= horizontal_scrollbar().width(*this);
-					lines.clear();
+					clear_lines();
 					pos = point{};
-					iTextExtents = size{};
 					p = iGlyphParagraphs.begin();
 					++pass;
 				}
@@ -1560,15 +1559,317 @@ namespace neogfx
 				break;
 			}
 		}
-		if (!iGlyphs.empty() && iGlyphs.back().is_whitespace() && iGlyphs.back().value() == U'\n')
+		iLineLayout = line_layout{ availableWidth, availableHeight, showVerticalScrollbar, showHorizontalScrollbar };
+		if (!iGlyphColumns.empty())
+			iNextEstimatedLine = iGlyphColumns.front().lines().begin();
+		if (!iText.empty() && iText[iText.size() - 1] == U'\n')
 			pos.y += font().height();
 		iTextExtents.cy = pos.y;
 	}
 
+	bool text_edit::refresh_lines(glyph_paragraphs::iterator aFirstParagraph, glyph_paragraphs::size_type aFirstParagraphIndex, glyph_paragraphs::size_type aOldParagraphCount, glyph_paragraphs::size_type aNewParagraphCount)
+	{
+		// Re-wraps just the reshaped paragraphs; the lines that follow them need no adjustment as their positions
+		// are held as offsets. If the change in text extents would alter scrollbar visibility (and so the available
+		// width) a full refresh is required.
+		if (iLineLayout == boost::none || iGlyphColumns.empty())
+			return false;
+		const auto& lines = iGlyphColumns.front().lines();
+		auto paragraphLess = [](const glyph_line_index& aLhs, const glyph_line_index& aRhs) { return aLhs.paragraphs() < aRhs.paragraphs(); };
+		auto firstLine = lines.find_by_foreign_index(glyph_line_index{ aFirstParagraphIndex, 0.0 }, paragraphLess).first;
+		auto lastLine = lines.find_by_foreign_index(glyph_line_index{ aFirstParagraphIndex + aOldParagraphCount, 0.0 }, paragraphLess).first;
+		glyph_line_list newLines;
+		point pos{ 0.0, line_ypos(lines, firstLine) };
+		auto p = aFirstParagraph;
+		for (glyph_paragraphs::size_type i = 0; i < aNewParagraphCount; ++i, ++p)
+			wrap_paragraph(p, newLines, pos, iLineLayout->availableWidth);
+		erase_lines(firstLine, lastLine);
+		insert_lines(lastLine, newLines);
+		coordinate bottom = line_ypos(lines, lines.end());
+		if ((bottom >= iLineLayout->availableHeight) != iLineLayout->verticalScrollbar ||
+			(iTextExtents.cx > iLineLayout->availableWidth) != iLineLayout->horizontalScrollbar)
+			return false;
+		if (!iText.empty() && iText[iText.size() - 1] == U'\n')
+			bottom += font().height();
+		iTextExtents.cy = bottom;
+		vertical_scrollbar().set_maximum(iTextExtents.cy);
+		horizontal_scrollbar().set_maximum(iTextExtents.cx <= client_rect(false).width() ? 0.0 : iTextExtents.cx);
+		update();
+		return true;
+	}
+
+	void text_edit::wrap_paragraph(glyph_paragraphs::iterator aParagraph, glyph_line_list& aLines, point& aPos, dimension aAvailableWidth)
+	{
+		auto& paragraph = *aParagraph;
+		auto paragraphStart = paragraph.first.start();
+		auto paragraphEnd = paragraph.first.end();
+		if (paragraphStart == paragraphEnd || (paragraphStart->is_whitespace() && paragraphStart->value() == U'\n'))
+		{
+			const auto& glyph = *paragraphStart;
+			const auto& tagContents = iText.tag(iText.begin() + paragraph.first.text_start_index() + glyph.source().first).contents();
+			const auto& style = tagContents.is<style_list::const_iterator>() ? *static_variant_cast<style_list::const_iterator>(tagContents) : iDefaultStyle;
+			auto& glyphFont = style.font() != boost::none ? *style.font() : font();
+			aLines.push_back(
+				glyph_line{
+					aParagraph,
+					0,
+					0,
+					{ 0.0, glyphFont.height() } });
+			aPos.y += glyphFont.height();
+		}
+		else if (iWordWrap && (paragraphEnd - 1)->x + (paragraphEnd - 1)->advance().cx > aAvailableWidth)
+		{
+			auto insertionPoint = aLines.end();
+			bool first = true;
+			auto next = paragraphStart;
+			auto lineStart = next;
+			auto lineEnd = paragraphEnd;
+			coordinate offset = 0.0;
+			while (next != paragraphEnd)
+			{
+				auto split = std::lower_bound(next, paragraphEnd, paragraph_positioned_glyph{ offset + aAvailableWidth });
+				if (split != next && (split != paragraphEnd || (split - 1)->x + (split - 1)->advance().cx >= offset + aAvailableWidth))
+					--split;
+				if (split == next)
+					++split;
+				if (split != paragraphEnd)
+				{
+					std::pair<document_glyphs::iterator, document_glyphs::iterator> wordBreak = word_break(lineStart, split, paragraphEnd);
+					lineEnd = wordBreak.first;
+					next = wordBreak.second;
+					if (wordBreak.first == wordBreak.second)
+					{
+						while (lineEnd != lineStart && (lineEnd - 1)->source() == wordBreak.first->source())
+							--lineEnd;
+						next = lineEnd;
+					}
+				}
+				else
+					next = paragraphEnd;
+				dimension x = (split != iGlyphs.end() ? split->x : (lineStart != lineEnd ? iGlyphs.back().x + iGlyphs.back().advance().cx : 0.0));
+				auto height = paragraph.first.height(lineStart, lineEnd);
+				if (lineEnd != lineStart && (lineEnd - 1)->is_whitespace() && (lineEnd - 1)->value() == U'\n')
+					--lineEnd;
+				bool rtl = false;
+				if (!first &&
+					insertionPoint->lineStart != insertionPoint->lineEnd &&
+					lineStart != lineEnd &&
+					insertionPoint->start()->direction() == text_direction::RTL &&
+					(lineEnd - 1)->direction() == text_direction::RTL)
+					rtl = true; // todo: is this sufficient for multi-line RTL text?
+				if (!rtl)
+					insertionPoint = aLines.end();
+				insertionPoint = aLines.insert(insertionPoint,
+					glyph_line{
+						aParagraph,
+						static_cast<document_glyphs::size_type>(lineStart - paragraphStart),
+						static_cast<document_glyphs::size_type>(lineEnd - paragraphStart),
+						{ x - offset, height } });
+				aPos.y += height;
+				lineStart = next;
+				if (lineStart != paragraphEnd)
+					offset = lineStart->x;
+				lineEnd = paragraphEnd;
+				first = false;
+			}
+		}
+		else
+		{
+			auto lineStart = paragraphStart;
+			auto lineEnd = paragraphEnd;
+			auto height = paragraph.first.height(lineStart, lineEnd);
+			if (lineEnd != lineStart && (lineEnd - 1)->is_whitespace() && (lineEnd - 1)->value() == U'\n')
+				--lineEnd;
+			aLines.push_back(
+				glyph_line{
+					aParagraph,
+					0,
+					static_cast<document_glyphs::size_type>(lineEnd - paragraphStart),
+					{ (lineEnd - 1)->x + (lineEnd - 1)->advance().cx, height} });
+			aPos.y += aLines.back().extents.cy;
+		}
+	}
+
+	void text_edit::estimate_paragraph(glyph_paragraphs::iterator aParagraph, glyph_line_list& aLines, point& aPos, dimension aAvailableWidth)
+	{
+		// Lazy layout: a single placeholder line per paragraph whose height is estimated from the paragraph's
+		// unwrapped width; refine_lines() later replaces placeholders with properly wrapped lines.
+		auto& paragraph = *aParagraph;
+		auto paragraphStart = paragraph.first.start();
+		auto paragraphEnd = paragraph.first.end();
+		auto lineEnd = paragraphEnd;
+		dimension width = 0.0;
+		if (paragraph.first.deferred())
+			width = paragraph.second.characters() * estimated_character_width();
+		else if (paragraphStart == paragraphEnd || (paragraphStart->is_whitespace() && paragraphStart->value() == U'\n'))
+		{
+			wrap_paragraph(aParagraph, aLines, aPos, aAvailableWidth);
+			return;
+		}
+		else
+		{
+			if ((lineEnd - 1)->is_whitespace() && (lineEnd - 1)->value() == U'\n')
+				--lineEnd;
+			width = (lineEnd - 1)->x + (lineEnd - 1)->advance().cx;
+		}
+		dimension lineCount = 1.0;
+		if (iWordWrap && width > aAvailableWidth && aAvailableWidth > 0.0)
+		{
+			lineCount = std::ceil(width / aAvailableWidth);
+			width = aAvailableWidth;
+		}
+		aLines.push_back(
+			glyph_line{
+				aParagraph,
+				0,
+				static_cast<document_glyphs::size_type>(lineEnd - paragraphStart),
+				{ width, font().height() * lineCount },
+				true });
+		aPos.y += aLines.back().extents.cy;
+	}
+
+	void text_edit::insert_lines(glyph_lines::const_iterator aPosition, const glyph_line_list& aLines)
+	{
+		auto& lines = iGlyphColumns.front().lines();
+		for (auto line = aLines.begin(); line != aLines.end(); ++line)
+		{
+			bool firstInParagraph = (line == aLines.begin() || line->paragraph != (line - 1)->paragraph);
+			lines.insert(aPosition,
+				std::make_pair(*line, glyph_line_index{ firstInParagraph ? 1u : 0u, line->extents.cy }),
+				glyph_lines::skip_type{ glyph_line_index{}, glyph_line_index{} });
+			iLineWidths.insert(line->extents.cx);
+			if (line->estimated)
+				++iEstimatedLines;
+		}
+		iTextExtents.cx = (iLineWidths.empty() ? 0.0 : *iLineWidths.rbegin());
+	}
+
+	void text_edit::erase_lines(glyph_lines::const_iterator aFirst, glyph_lines::const_iterator aLast)
+	{
+		for (auto line = aFirst; line != aLast; ++line)
+		{
+			if (line == iNextEstimatedLine)
+				iNextEstimatedLine = aLast;
+			iLineWidths.erase(iLineWidths.find(line->first.extents.cx));
+			if (line->first.estimated)
+				--iEstimatedLines;
+		}
+		iGlyphColumns.front().lines().erase(aFirst, aLast);
+		iTextExtents.cx = (iLineWidths.empty() ? 0.0 : *iLineWidths.rbegin());
+	}
+
+	void text_edit::clear_lines()
+	{
+		for (auto& column : iGlyphColumns)
+			column.lines().clear();
+		iLineWidths.clear();
+		iEstimatedLines = 0;
+		iTextExtents.cx = 0.0;
+	}
+
+	coordinate text_edit::line_ypos(const glyph_lines& aLines, glyph_lines::const_iterator aLine)
+	{
+		if (aLine != aLines.end())
+			return aLines.foreign_index(aLine).height();
+		if (aLines.empty())
+			return 0.0;
+		auto lastLine = aLines.end() - 1;
+		return aLines.foreign_index(lastLine).height() + lastLine->second.height();
+	}
+
+	text_edit::glyph_lines::const_iterator text_edit::ypos_to_line(const glyph_lines& aLines, coordinate aYpos)
+	{
+		return aLines.find_by_foreign_index(glyph_line_index{ 0, aYpos }, [](const glyph_line_index& aLhs, const glyph_line_index& aRhs) { return aLhs.height() < aRhs.height(); }).first;
+	}
+
+	void text_edit::refine_lines()
+	{
+		if (iEstimatedLines == 0 || iLineLayout == boost::none || iGlyphColumns.empty())
+			return;
+		const auto& lines = iGlyphColumns.front().lines();
+		const auto& paragraphs = iGlyphParagraphs;
+		// the cursor's paragraph is found from its text position as glyph positions are not known until it is shaped
+		auto cursorParagraph = character_to_paragraph(cursor().position());
+		if (cursorParagraph == paragraphs.end() && !paragraphs.empty())
+			--cursorParagraph;
+		if (cursorParagraph != paragraphs.end())
+		{
+			auto cursorLine = lines.find_by_foreign_index(glyph_line_index{ static_cast<glyph_paragraphs::size_type>(cursorParagraph - paragraphs.begin()), 0.0 },
+				[](const glyph_line_index& aLhs, const glyph_line_index& aRhs) { return aLhs.paragraphs() < aRhs.paragraphs(); }).first;
+			if (cursorLine != lines.end() && cursorLine->first.estimated)
+				refine_lines(cursorLine, cursorLine + 1);
+		}
+		coordinate page = client_rect(false).height();
+		auto first = ypos_to_line(lines, std::max(vertical_scrollbar().position() - page, 0.0));
+		auto last = ypos_to_line(lines, vertical_scrollbar().position() + page * 2.0);
+		if (last != lines.end())
+			++last;
+		if (std::any_of(first, last, [](const glyph_lines::value_type& aLine) { return aLine.first.estimated; }))
+			refine_lines(first, last);
+		// while shown also spend a slice of time outside the viewport so that the scrollbars converge on the true text
+		// extents; lines before iNextEstimatedLine have all been refined so it only ever moves forward
+		if (!effectively_visible())
+			return;
+		while (iNextEstimatedLine != lines.end() && !iNextEstimatedLine->first.estimated)
+			++iNextEstimatedLine;
+		if (iNextEstimatedLine != lines.end())
+			refine_lines(iNextEstimatedLine, lines.end(), std::chrono::steady_clock::now() + std::chrono::milliseconds(kLazyLayoutBudget_ms));
+	}
+
+	void text_edit::refine_lines(glyph_lines::const_iterator aFirstLine, glyph_lines::const_iterator aLastLine, const boost::optional<std::chrono::steady_clock::time_point>& aDeadline)
+	{
+		// Each placeholder is replaced in place; lines that follow move with it as their positions are held as offsets.
+		const auto& lines = iGlyphColumns.front().lines();
+		coordinate viewportTop = vertical_scrollbar().position();
+		coordinate viewportBottom = viewportTop + client_rect(false).height();
+		coordinate shiftAboveViewport = 0.0;
+		coordinate dy = 0.0;
+		glyph_lines::size_type refined = 0;
+		bool visibleLinesChanged = false;
+		glyph_line_list newLines;
+		for (auto line = aFirstLine; line != aLastLine;)
+		{
+			auto next = line + 1;
+			if (line->first.estimated)
+			{
+				if (aDeadline != boost::none && refined != 0 && std::chrono::steady_clock::now() >= *aDeadline)
+					break;
+				coordinate ypos = line_ypos(lines, line);
+				coordinate oldHeight = line->first.extents.cy;
+				auto paragraph = line->first.paragraph;
+				if (paragraph->first.deferred())
+					paragraph = shape_deferred_paragraph(paragraph);
+				newLines.clear();
+				point pos{ 0.0, ypos };
+				wrap_paragraph(paragraph, newLines, pos, iLineLayout->availableWidth);
+				erase_lines(line, next);
+				insert_lines(next, newLines);
+				++refined;
+				// lines above the viewport are compensated for by moving the scroll position and lines below it are not shown
+				if (ypos - dy + oldHeight <= viewportTop)
+					shiftAboveViewport = dy + (pos.y - ypos) - oldHeight;
+				else if (ypos - dy < viewportBottom)
+					visibleLinesChanged = true;
+				dy += (pos.y - ypos) - oldHeight;
+			}
+			line = next;
+		}
+		if (refined == 0)
+			return;
+		iTextExtents.cy += dy;
+		vertical_scrollbar().set_maximum(iTextExtents.cy);
+		horizontal_scrollbar().set_maximum(iTextExtents.cx <= client_rect(false).width() ? 0.0 : iTextExtents.cx);
+		if (shiftAboveViewport != 0.0)
+			vertical_scrollbar().set_position(viewportTop + shiftAboveViewport);
+		if (visibleLinesChanged)
+			update();
+	}
+
 	void text_edit::animate()
 	{
 		if (has_focus())
 			update_cursor();
+		refine_lines();
 	}
 
 	void text_edit::update_cursor()
@@ -1586,10 +1887,10 @@ namespace neogfx
 			const auto& style = tagContents.is<style_list::const_iterator>() ? *static_variant_cast<style_list::const_iterator>(tagContents) : iDefaultStyle;
 			auto& glyphFont = style.font() != boost::none ? *style.font() : font();
 			glyphHeight = glyphFont.height();
-			lineHeight = cursorPos.line->extents.cy;
+			lineHeight = cursorPos.line->first.extents.cy;
 		}
 		else if (cursorPos.line != cursorPos.column->lines().end())
-			glyphHeight = lineHeight = cursorPos.line->extents.cy;
+			glyphHeight = lineHeight = cursorPos.line->first.extents.cy;
 		else
 			glyphHeight = lineHeight = font().height();
 		update(rect{ point{ cursorPos.pos - point{ horizontal_scrollbar().position(), vertical_scrollbar().position() } } + client_rect(false).top_left() + point{ 0.0, lineHeight - glyphHeight }, size{cursor().width(), glyphHeight} });
@@ -1600,7 +1901,7 @@ namespace neogfx
 		scoped_units su(*this, UnitsPixels);
 		auto p = glyph_position(cursor_glyph_position(), true);
 		auto e = (p.line != p.column->lines().end() ? 
-			size{ p.glyph != p.lineEnd ? p.glyph->advance().cx : 0.0, p.line->extents.cy } : 
+			size{ p.glyph != p.lineEnd ? p.glyph->advance().cx : 0.0, p.line->first.extents.cy } : 
 			size{ 0.0, font().height() });
 		e.cy = std::min(e.cy, vertical_scrollbar().page());
 		if (p.pos.y < vertical_scrollbar().position())
@@ -1629,8 +1930,8 @@ namespace neogfx
 
 	void text_edit::draw_glyphs(const graphics_context& aGraphicsContext, const point& aPoint, const glyph_column& aColumn, glyph_lines::const_iterator aLine) const
 	{
-		auto lineStart = aLine->lineStart.second;
-		auto lineEnd = aLine->lineEnd.second;
+		auto lineStart = aLine->first.start();
+		auto lineEnd = aLine->first.end();
 		if (lineEnd != lineStart && (lineEnd - 1)->category() == text_category::Whitespace && (lineEnd - 1)->value() == U'\n')
 			--lineEnd;
 		{
@@ -1653,7 +1954,7 @@ namespace neogfx
 					{
 					case 0:
 						if (selected)
-							aGraphicsContext.fill_rect(rect{ pos, size{glyph.advance().cx, aLine->extents.cy} }, 
+							aGraphicsContext.fill_rect(rect{ pos, size{glyph.advance().cx, aLine->first.extents.cy} }, 
 								has_focus() ? 
 									app::instance().current_style().selection_colour() : 
 									app::instance().current_style().selection_colour().with_alpha(64));
@@ -1673,7 +1974,7 @@ namespace neogfx
 								point{-1.0, 0.0}, point{1.0, 0.0},
 								point{-1.0, 1.0}, point{0.0, 1.0}, point{1.0, 1.0},
 							};
-							aGraphicsContext.draw_glyph(sOutlinePositions[outlinePos] + pos + glyph.offset() + point{ 0.0, aLine->extents.cy - glyphFont.height() - 1.0 }, glyph,
+							aGraphicsContext.draw_glyph(sOutlinePositions[outlinePos] + pos + glyph.offset() + point{ 0.0, aLine->first.extents.cy - glyphFont.height() - 1.0 }, glyph,
 								glyphFont,
 								style.text_outline_colour().is<colour>() ?
 									static_variant_cast<const colour&>(style.text_outline_colour()) : style.text_outline_colour().is<gradient>() ?
@@ -1682,7 +1983,7 @@ namespace neogfx
 						}
 						break;
 					case 2:
-						aGraphicsContext.draw_glyph(pos + glyph.offset() + point{ 0.0, aLine->extents.cy - glyphFont.height() - (outlinesPresent ? 1.0 : 0.0)}, glyph,
+						aGraphicsContext.draw_glyph(pos + glyph.offset() + point{ 0.0, aLine->first.extents.cy - glyphFont.height() - (outlinesPresent ? 1.0 : 0.0)}, glyph,
 							glyphFont,
 							selected && has_focus() ? 
 								(app::instance().current_style().selection_colour().light() ? colour::Black : colour::White) :
@@ -1703,7 +2004,7 @@ namespace neogfx
 			const auto& style = glyph_style(i, aColumn);
 			const auto& glyphFont = style.font() != boost::none ? *style.font() : font();
 			if (glyph.underline())
-				aGraphicsContext.draw_glyph_underline(pos + point{ 0.0, aLine->extents.cy - glyphFont.height() }, glyph,
+				aGraphicsContext.draw_glyph_underline(pos + point{ 0.0, aLine->first.extents.cy - glyphFont.height() }, glyph,
 					glyphFont,
 					style.text_colour().is<colour>() ?
 						static_variant_cast<const colour&>(style.text_colour()) : style.text_colour().is<gradient>() ? 
@@ -1728,10 +2029,10 @@ namespace neogfx
 			glyphHeight = glyphFont.height();
 			if (!style.text_outline_colour().empty())
 				glyphHeight += 2.0;
-			lineHeight = cursorPos.line->extents.cy;
+			lineHeight = cursorPos.line->first.extents.cy;
 		}
 		else if (cursorPos.line != cursorPos.column->lines().end())
-			glyphHeight = lineHeight = cursorPos.line->extents.cy;
+			glyphHeight = lineHeight = cursorPos.line->first.extents.cy;
 		else
 			glyphHeight = lineHeight = font().height();
 		if (((app::instance().program_elapsed_ms() - iCursorAnimationStartTime) / 500) % 2 == 0)
@@ -132,8 +132,12 @@ namespace neogfx
 			iTextExtent = boost::none;
 			iGlyphTextCache = glyph_text(font());
 			text_changed.trigger();
-			if (oldSize != minimum_size() && has_managing_layout())
-				managing_layout().layout_items(true);
+			if (oldSize != minimum_size())
+			{
+				invalidate_size_hints();
+				if (has_managing_layout())
+					managing_layout().layout_items(true);
+			}
 			update();
 		}
 	}
@@ -232,6 +236,7 @@ namespace neogfx
 		{
 			iTextExtent = boost::none;
 			iGlyphTextCache = glyph_text(font());
+			invalidate_size_hints();
 			if (has_managing_layout())
 				managing_layout().layout_items(true);
 			update();
@@ -18,6 +18,7 @@
 */
 
 #include <neogfx/neogfx.hpp>
+#include <unordered_map>
 #include <neolib/raii.hpp>
 #include <neogfx/app/app.hpp>
 #include <neogfx/gui/widget/widget.hpp>
@@ -27,15 +28,190 @@
 
 namespace neogfx
 {
-	class widget::layout_timer : public pause_rendering, neolib::callback_timer
+	class widget::layout_timer : public pause_rendering, callback_timer
 	{
 	public:
 		layout_timer(i_surface& aSurface, neolib::io_task& aIoTask, std::function<void(callback_timer&)> aCallback) :
-			pause_rendering(aSurface), neolib::callback_timer(aIoTask, aCallback, 0)
+			pause_rendering(aSurface), callback_timer(aIoTask, aCallback, 0)
 		{
 		}
 	};
 
+	// Position lookup and a uniform grid over child rects (client coordinates) for widgets with many children; the
+	// grid is kept up to date as children move and resize and is rebuilt lazily if too many children have left it.
+	class widget::child_index
+	{
+	public:
+		static const std::size_t kThreshold = 32;
+	private:
+		static const std::size_t kMaxCellsPerAxis = 64;
+		struct entry
+		{
+			int32_t left;
+			int32_t top;
+			int32_t right;
+			int32_t bottom;
+			bool outlier;
+		};
+		typedef std::vector<const i_widget*> cell;
+	public:
+		child_index(const widget& aOwner) :
+			iOwner(aOwner), iIndicesDirty(true), iGridDirty(true), iColumns(0), iRows(0), iOutliers(0)
+		{
+		}
+	public:
+		widget_list::size_type find(const i_widget& aChild) const
+		{
+			if (iIndicesDirty)
+			{
+				iIndices.clear();
+				for (widget_list::size_type i = 0; i < iOwner.iChildren.size(); ++i)
+					iIndices[&*iOwner.iChildren[i]] = i;
+				iIndicesDirty = false;
+			}
+			auto existing = iIndices.find(&aChild);
+			return existing != iIndices.end() ? existing->second : iOwner.iChildren.size();
+		}
+		void added(const i_widget& aChild)
+		{
+			if (!iIndicesDirty)
+				iIndices[&aChild] = iOwner.iChildren.size() - 1;
+			if (!iGridDirty)
+				insert(aChild);
+		}
+		void removed(const i_widget& aChild, widget_list::size_type aIndex)
+		{
+			if (!iIndicesDirty)
+			{
+				iIndices.erase(&aChild);
+				if (aIndex != iOwner.iChildren.size())
+					iIndicesDirty = true;
+			}
+			if (!iGridDirty)
+				remove(aChild);
+		}
+		void geometry_changed(const i_widget& aChild)
+		{
+			if (iGridDirty || iEntries.find(&aChild) == iEntries.end())
+				return;
+			remove(aChild);
+			insert(aChild);
+			if (iOutliers * 2 > iEntries.size())
+				iGridDirty = true;
+		}
+		const i_widget* child_at(const point& aPosition) const
+		{
+			if (iGridDirty)
+				rebuild();
+			const i_widget* result = nullptr;
+			widget_list::size_type resultIndex = iOwner.iChildren.size();
+			for (auto c : iCells[cell_row(aPosition.y) * iColumns + cell_column(aPosition.x)])
+			{
+				if (!c->visible() || !iOwner.to_client_coordinates(c->window_rect()).contains(aPosition))
+					continue;
+				auto index = find(*c);
+				if (index < resultIndex)
+				{
+					result = c;
+					resultIndex = index;
+				}
+			}
+			return result;
+		}
+		void children_intersecting(const rect& aArea, std::vector<widget_list::size_type>& aResult) const
+		{
+			aResult.clear();
+			if (aArea.empty())
+				return;
+			if (iGridDirty)
+				rebuild();
+			int32_t left = cell_column(aArea.left());
+			int32_t right = cell_column(aArea.right());
+			int32_t bottom = cell_row(aArea.bottom());
+			for (int32_t row = cell_row(aArea.top()); row <= bottom; ++row)
+				for (int32_t column = left; column <= right; ++column)
+					for (auto c : iCells[row * iColumns + column])
+						if (!aArea.intersection(iOwner.to_client_coordinates(c->window_rect())).empty())
+							aResult.push_back(find(*c));
+			std::sort(aResult.begin(), aResult.end());
+			aResult.erase(std::unique(aResult.begin(), aResult.end()), aResult.end());
+		}
+	private:
+		int32_t cell_column(coordinate aX) const
+		{
+			return std::max(0, std::min(iColumns - 1, static_cast<int32_t>(std::floor((aX - iBounds.x) / iCellSize.cx))));
+		}
+		int32_t cell_row(coordinate aY) const
+		{
+			return std::max(0, std::min(iRows - 1, static_cast<int32_t>(std::floor((aY - iBounds.y) / iCellSize.cy))));
+		}
+		void insert(const i_widget& aChild) const
+		{
+			rect childRect = iOwner.to_client_coordinates(aChild.window_rect());
+			entry e{ cell_column(childRect.left()), cell_row(childRect.top()), cell_column(childRect.right()), cell_row(childRect.bottom()), !iBounds.contains(childRect) };
+			for (int32_t row = e.top; row <= e.bottom; ++row)
+				for (int32_t column = e.left; column <= e.right; ++column)
+					iCells[row * iColumns + column].push_back(&aChild);
+			if (e.outlier)
+				++iOutliers;
+			iEntries[&aChild] = e;
+		}
+		void remove(const i_widget& aChild) const
+		{
+			auto existing = iEntries.find(&aChild);
+			if (existing == iEntries.end())
+				return;
+			const entry& e = existing->second;
+			for (int32_t row = e.top; row <= e.bottom; ++row)
+				for (int32_t column = e.left; column <= e.right; ++column)
+				{
+					auto& c = iCells[row * iColumns + column];
+					c.erase(std::find(c.begin(), c.end(), &aChild));
+				}
+			if (e.outlier)
+				--iOutliers;
+			iEntries.erase(existing);
+		}
+		void rebuild() const
+		{
+			iCells.clear();
+			iEntries.clear();
+			iOutliers = 0;
+			optional_rect bounds;
+			size totalExtents;
+			for (const auto& c : iOwner.iChildren)
+			{
+				rect childRect = iOwner.to_client_coordinates(c->window_rect());
+				bounds = (bounds == boost::none ? childRect : bounds->combine(childRect));
+				totalExtents += childRect.extents();
+			}
+			iBounds = (bounds != boost::none ? *bounds : rect{});
+			// cells about the size of an average child unless that would make the grid too large
+			size averageExtents = iOwner.iChildren.empty() ? size{} : totalExtents / static_cast<coordinate>(iOwner.iChildren.size());
+			iCellSize = size{
+				std::max(std::max(averageExtents.cx, iBounds.cx / kMaxCellsPerAxis), 1.0),
+				std::max(std::max(averageExtents.cy, iBounds.cy / kMaxCellsPerAxis), 1.0) };
+			iColumns = std::max(1, std::min(static_cast<int32_t>(kMaxCellsPerAxis), static_cast<int32_t>(std::ceil(iBounds.cx / iCellSize.cx))));
+			iRows = std::max(1, std::min(static_cast<int32_t>(kMaxCellsPerAxis), static_cast<int32_t>(std::ceil(iBounds.cy / iCellSize.cy))));
+			iCells.resize(static_cast<std::size_t>(iColumns * iRows));
+			for (const auto& c : iOwner.iChildren)
+				insert(*c);
+			iGridDirty = false;
+		}
+	private:
+		const widget& iOwner;
+		mutable std::unordered_map<const i_widget*, widget_list::size_type> iIndices;
+		mutable bool iIndicesDirty;
+		mutable bool iGridDirty;
+		mutable rect iBounds;
+		mutable size iCellSize;
+		mutable int32_t iColumns;
+		mutable int32_t iRows;
+		mutable std::vector<cell> iCells;
+		mutable std::unordered_map<const i_widget*, entry> iEntries;
+		mutable std::size_t iOutliers;
+	};
+
 
 	widget::device_metrics_forwarder::device_metrics_forwarder(widget& aOwner) :
 		iOwner(aOwner)
@@ -72,6 +248,7 @@ namespace neogfx
 		iParent(nullptr),
 		iLinkBefore(nullptr),
 		iLinkAfter(nullptr),
+		iParentLayout(nullptr),
 		iDeviceMetricsForwarder(*this),
 		iUnitsContext(iDeviceMetricsForwarder),
 		iMinimumSize{},
@@ -91,6 +268,7 @@ namespace neogfx
 		iParent(nullptr),
 		iLinkBefore(nullptr),
 		iLinkAfter(nullptr),
+		iParentLayout(nullptr),
 		iDeviceMetricsForwarder(*this),
 		iUnitsContext(iDeviceMetricsForwarder),
 		iMinimumSize{},
@@ -111,6 +289,7 @@ namespace neogfx
 		iParent(nullptr),
 		iLinkBefore(nullptr),
 		iLinkAfter(nullptr),
+		iParentLayout(nullptr),
 		iDeviceMetricsForwarder(*this),
 		iUnitsContext(iDeviceMetricsForwarder),
 		iMinimumSize{},
@@ -264,7 +443,7 @@ namespace neogfx
 		i_widget* oldParent = aWidget.has_parent() ? &aWidget.parent() : nullptr;
 		aWidget.set_parent(*this);
 		if (find_child(aWidget, false) == iChildren.end())
-			iChildren.push_back(std::shared_ptr<i_widget>(std::shared_ptr<i_widget>(), &aWidget));
+			add_child(std::shared_ptr<i_widget>(std::shared_ptr<i_widget>(), &aWidget));
 		if (oldParent != nullptr)
 			oldParent->remove_widget(aWidget);
 		aWidget.set_singular(false);
@@ -279,7 +458,7 @@ namespace neogfx
 		i_widget* oldParent = aWidget->has_parent() ? &aWidget->parent() : nullptr;
 		aWidget->set_parent(*this);
 		if (find_child(*aWidget, false) == iChildren.end())
-			iChildren.push_back(aWidget);
+			add_child(aWidget);
 		if (oldParent != nullptr)
 			oldParent->remove_widget(*aWidget);
 		aWidget->set_singular(false);
@@ -295,13 +474,30 @@ namespace neogfx
 		auto keep = *existing;
 		if (aSingular)
 			keep->set_singular(true);
+		auto index = static_cast<widget_list::size_type>(existing - iChildren.begin());
 		iChildren.erase(existing);
+		if (iChildIndex != nullptr)
+		{
+			if (iChildren.size() < child_index::kThreshold / 2)
+				iChildIndex.reset();
+			else
+				iChildIndex->removed(aWidget, index);
+		}
 		if (has_layout())
 			layout().remove_item(aWidget);
 		if (has_surface())
 			surface().widget_removed(aWidget);
 	}
 
+	void widget::add_child(std::shared_ptr<i_widget> aChild)
+	{
+		iChildren.push_back(aChild);
+		if (iChildIndex != nullptr)
+			iChildIndex->added(*aChild);
+		else if (iChildren.size() >= child_index::kThreshold)
+			iChildIndex = std::make_unique<child_index>(*this);
+	}
+
 	void widget::remove_widgets()
 	{
 		while (!iChildren.empty())
@@ -346,9 +542,18 @@ namespace neogfx
 
 	widget::widget_list::const_iterator widget::find_child(const i_widget& aChild, bool aThrowIfNotFound) const
 	{
-		for (auto i = iChildren.begin(); i != iChildren.end(); ++i)
-			if (&**i == &aChild)
-				return i;
+		if (iChildIndex != nullptr)
+		{
+			auto index = iChildIndex->find(aChild);
+			if (index != iChildren.size())
+				return iChildren.begin() + index;
+		}
+		else
+		{
+			for (auto i = iChildren.begin(); i != iChildren.end(); ++i)
+				if (&**i == &aChild)
+					return i;
+		}
 		if (aThrowIfNotFound)
 			throw not_child();
 		else
@@ -357,9 +562,18 @@ namespace neogfx
 
 	widget::widget_list::iterator widget::find_child(const i_widget& aChild, bool aThrowIfNotFound)
 	{
-		for (auto i = iChildren.begin(); i != iChildren.end(); ++i)
-			if (&**i == &aChild)
-				return i;
+		if (iChildIndex != nullptr)
+		{
+			auto index = iChildIndex->find(aChild);
+			if (index != iChildren.size())
+				return iChildren.begin() + index;
+		}
+		else
+		{
+			for (auto i = iChildren.begin(); i != iChildren.end(); ++i)
+				if (&**i == &aChild)
+					return i;
+		}
 		if (aThrowIfNotFound)
 			throw not_child();
 		else
@@ -551,6 +765,8 @@ namespace neogfx
 
 	bool widget::has_parent_layout() const
 	{
+		if (iParentLayout != nullptr)
+			return true;
 		if (!has_parent())
 			return false;
 		const i_widget* w = &parent();
@@ -561,6 +777,8 @@ namespace neogfx
 	
 	const i_layout& widget::parent_layout() const
 	{
+		if (iParentLayout != nullptr)
+			return *iParentLayout;
 		if (!has_parent())
 			throw no_parent_layout();
 		const i_widget* w = &parent();
@@ -576,6 +794,11 @@ namespace neogfx
 		return const_cast<i_layout&>(const_cast<const widget*>(this)->parent_layout());
 	}
 
+	void widget::set_parent_layout(i_layout* aParentLayout)
+	{
+		iParentLayout = aParentLayout;
+	}
+
 	void widget::layout_items(bool aDefer)
 	{
 		if (layout_items_in_progress())
@@ -623,7 +846,7 @@ namespace neogfx
 		{
 			if (!iLayoutTimer)
 			{
-				iLayoutTimer = std::make_unique<layout_timer>(surface(), app::instance(), [this](neolib::callback_timer&)
+				iLayoutTimer = std::make_unique<layout_timer>(surface(), app::instance(), [this](callback_timer&)
 				{
 					auto t = std::move(iLayoutTimer);
 					if (!surface().destroyed())
@@ -654,6 +877,14 @@ namespace neogfx
 			update();
 	}
 
+	void widget::invalidate_size_hints()
+	{
+		if (has_layout())
+			layout().invalidate_size_hints();
+		else if (has_parent_layout())
+			parent_layout().invalidate_size_hints(*this);
+	}
+
 	logical_coordinate_system widget::logical_coordinate_system() const
 	{
 		return neogfx::logical_coordinate_system::AutomaticGui;
@@ -684,6 +915,8 @@ namespace neogfx
 			update();
 			iPosition = units_converter(*this).to_device_units(aPosition);
 			update();
+			if (has_parent(false))
+				parent().child_geometry_changed(*this);
 			moved();
 		}
 	}
@@ -709,6 +942,8 @@ namespace neogfx
 			update();
 			iSize = units_converter(*this).to_device_units(aSize);
 			update();
+			if (has_parent(false))
+				parent().child_geometry_changed(*this);
 			resized();
 		}
 	}
@@ -718,6 +953,12 @@ namespace neogfx
 		layout_items();
 	}
 
+	void widget::child_geometry_changed(i_widget& aChild)
+	{
+		if (iChildIndex != nullptr)
+			iChildIndex->geometry_changed(aChild);
+	}
+
 	rect widget::window_rect() const
 	{
 		return rect{origin(true), extents()};
@@ -735,6 +976,11 @@ namespace neogfx
 	{
 		if (client_rect().contains(aPosition))
 		{
+			if (iChildIndex != nullptr)
+			{
+				auto c = iChildIndex->child_at(aPosition);
+				return c != nullptr ? c->widget_at(aPosition - c->position()) : *this;
+			}
 			for (const auto& c : children())
 				if (c->visible() && to_client_coordinates(c->window_rect()).contains(aPosition))
 					return c->widget_at(aPosition - c->position());
@@ -765,6 +1011,7 @@ namespace neogfx
 		if (iSizePolicy != aSizePolicy)
 		{
 			iSizePolicy = aSizePolicy;
+			invalidate_size_hints();
 			if (aUpdateLayout && has_managing_layout())
 				managing_layout().layout_items(true);
 		}
@@ -787,6 +1034,7 @@ namespace neogfx
 		if (iWeight != aWeight)
 		{
 			iWeight = aWeight;
+			invalidate_size_hints();
 			if (aUpdateLayout && has_managing_layout())
 				managing_layout().layout_items(true);
 		}
@@ -812,6 +1060,7 @@ namespace neogfx
 		if (iMinimumSize != newMinimumSize)
 		{
 			iMinimumSize = newMinimumSize;
+			invalidate_size_hints();
 			if (aUpdateLayout && has_managing_layout())
 				managing_layout().layout_items(true);
 		}
@@ -839,6 +1088,7 @@ namespace neogfx
 		if (iMaximumSize != newMaximumSize)
 		{
 			iMaximumSize = newMaximumSize;
+			invalidate_size_hints();
 			if (aUpdateLayout && has_managing_layout())
 				managing_layout().layout_items(true);
 		}
@@ -860,6 +1110,7 @@ namespace neogfx
 		if (iMargins != newMargins)
 		{
 			iMargins = newMargins;
+			invalidate_size_hints();
 			if (aUpdateLayout && has_managing_layout())
 				managing_layout().layout_items(true);
 		}
@@ -883,11 +1134,18 @@ namespace neogfx
 
 	bool widget::requires_update() const
 	{
-		return surface().has_invalidated_area() && !surface().invalidated_area().intersection(window_rect()).empty();
+		if (!surface().has_invalidated_area() || surface().invalidated_area().intersection(window_rect()).empty())
+			return false;
+		for (const auto& invalidatedRect : surface().invalidated_rects())
+			if (!invalidatedRect.intersection(window_rect()).empty())
+				return true;
+		return false;
 	}
 
 	rect widget::update_rect() const
 	{
+		if (iUpdateRect != boost::none)
+			return *iUpdateRect;
 		if (!requires_update())
 			throw no_update_rect();
 		return to_client_coordinates(surface().invalidated_area().intersection(window_rect()));
@@ -914,40 +1172,77 @@ namespace neogfx
 			return;
 		if (!requires_update())
 			return;
-		
-		const rect updateRect = update_rect();
 
-		const rect nonClientClipRect = default_clip_rect(true).intersection(updateRect);
+		// The invalidated area is made up of disjoint rects; each one this widget intersects is painted in turn (and is
+		// what update_rect() returns meanwhile) and children are then visited once for all of them.
+		std::vector<rect> updateRects;
+		for (const auto& invalidatedRect : surface().invalidated_rects())
+		{
+			rect updateRect = invalidatedRect.intersection(window_rect());
+			if (!updateRect.empty())
+				updateRects.push_back(to_client_coordinates(updateRect));
+		}
+
+		boost::optional<rect> childArea;
+		for (const auto& updateRect : updateRects)
+		{
+			iUpdateRect = updateRect;
+
+			const rect nonClientClipRect = default_clip_rect(true).intersection(updateRect);
+
+			aGraphicsContext.set_extents(extents());
+			aGraphicsContext.set_origin(origin(true));
+			aGraphicsContext.scissor_on(nonClientClipRect);
+			paint_non_client(aGraphicsContext);
+			aGraphicsContext.scissor_off();
 
-		aGraphicsContext.set_extents(extents());
-		aGraphicsContext.set_origin(origin(true));
-		aGraphicsContext.scissor_on(nonClientClipRect);
-		paint_non_client(aGraphicsContext);
-		aGraphicsContext.scissor_off();
+			const rect clipRect = default_clip_rect().intersection(updateRect);
 
-		const rect clipRect = default_clip_rect().intersection(updateRect);
+			aGraphicsContext.set_extents(client_rect().extents());
+			aGraphicsContext.set_origin(origin());
+			aGraphicsContext.scissor_on(clipRect);
+			scoped_coordinate_system scs(aGraphicsContext, origin(), extents(), logical_coordinate_system());
+			painting.trigger(aGraphicsContext);
+			paint(aGraphicsContext);
+			aGraphicsContext.scissor_off();
+
+			if (!clipRect.empty())
+				childArea = (childArea == boost::none ? clipRect : childArea->combine(clipRect));
+		}
+		iUpdateRect = boost::none;
 
 		aGraphicsContext.set_extents(client_rect().extents());
 		aGraphicsContext.set_origin(origin());
-		aGraphicsContext.scissor_on(clipRect);
 		scoped_coordinate_system scs(aGraphicsContext, origin(), extents(), logical_coordinate_system());
-		painting.trigger(aGraphicsContext);
-		paint(aGraphicsContext);
-		aGraphicsContext.scissor_off();
 
-		for (auto i = iChildren.rbegin(); i != iChildren.rend(); ++i)
+		if (childArea != boost::none && iChildIndex != nullptr)
 		{
-			const auto& c = *i;
-			rect intersection = clipRect.intersection(to_client_coordinates(c->window_rect()));
-			if (!intersection.empty())
-				c->render(aGraphicsContext);
+			std::vector<widget_list::size_type> visibleChildren;
+			iChildIndex->children_intersecting(*childArea, visibleChildren);
+			for (auto i = visibleChildren.rbegin(); i != visibleChildren.rend(); ++i)
+				iChildren[*i]->render(aGraphicsContext);
+		}
+		else if (childArea != boost::none)
+		{
+			for (auto i = iChildren.rbegin(); i != iChildren.rend(); ++i)
+			{
+				const auto& c = *i;
+				rect intersection = childArea->intersection(to_client_coordinates(c->window_rect()));
+				if (!intersection.empty())
+					c->render(aGraphicsContext);
+			}
 		}
 
-		aGraphicsContext.set_extents(extents());
-		aGraphicsContext.set_origin(origin(true));
-		aGraphicsContext.scissor_on(nonClientClipRect);
-		paint_non_client_after(aGraphicsContext);
-		aGraphicsContext.scissor_off();
+		for (const auto& updateRect : updateRects)
+		{
+			iUpdateRect = updateRect;
+			aGraphicsContext.set_extents(extents());
+			aGraphicsContext.set_origin(origin(true));
+			aGraphicsContext.scissor_on(default_clip_rect(true).intersection(updateRect));
+			paint_non_client_after(aGraphicsContext);
+			aGraphicsContext.scissor_off();
+		}
+		iUpdateRect = boost::none;
 	}
 
 	bool widget::transparent_background() const
@@ -1034,6 +1329,7 @@ namespace neogfx
 	void widget::set_font(const optional_font& aFont)
 	{
 		iFont = aFont;
+		invalidate_size_hints();
 		if (has_managing_layout())
 			managing_layout().layout_items(true);
 		update();
@@ -1065,6 +1361,7 @@ namespace neogfx
 		{
 			iVisible = aVisible;
 			visibility_changed.trigger();
+			invalidate_size_hints();
 			if (has_parent_layout())
 				parent_layout().invalidate();
 			if (effectively_hidden())
@@ -64,7 +64,7 @@ namespace neogfx
 		app::event_processing_context epc(app::instance(), "neogfx::context_menu");
 		while (!finished)
 		{
-			app::instance().process_events(epc);
+			app::instance().process_events_or_wait(epc);
 		}
 	}
 }
\ No newline at end of file
@@ -100,9 +100,82 @@ namespace neogfx
 	void opengl_window::invalidate(const rect& aInvalidatedRect)
 	{
 		//std::cerr << "invalidate: " << aInvalidatedRect << std::endl;
-		if (aInvalidatedRect.cx != 0.0 && aInvalidatedRect.cy != 0.0 &&
-			iInvalidatedRects.find(aInvalidatedRect) == iInvalidatedRects.end())
-			iInvalidatedRects.insert(aInvalidatedRect);
+		if (aInvalidatedRect.cx == 0.0 || aInvalidatedRect.cy == 0.0)
+			return;
+		// Damage is kept as a short list of disjoint rects: overlapping rects are always merged and others only when
+		// their bounding rect is at most 25% larger than the two rects (or when the list is full).
+		rect damage = aInvalidatedRect;
+		bool merged = true;
+		while (merged)
+		{
+			merged = false;
+			for (auto i = iInvalidatedRects.begin(); i != iInvalidatedRects.end(); ++i)
+			{
+				rect combined = damage.combine(*i);
+				if (!damage.intersection(*i).empty() ||
+					combined.cx * combined.cy * 4.0 <= (damage.cx * damage.cy + i->cx * i->cy) * 5.0)
+				{
+					damage = combined;
+					iInvalidatedRects.erase(i);
+					merged = true;
+					break;
+				}
+			}
+			if (!merged && iInvalidatedRects.size() >= kMaxInvalidatedRects)
+			{
+				auto cheapest = iInvalidatedRects.begin();
+				dimension cheapestGrowth = 0.0;
+				for (auto i = iInvalidatedRects.begin(); i != iInvalidatedRects.end(); ++i)
+				{
+					rect combined = damage.combine(*i);
+					dimension growth = combined.cx * combined.cy - i->cx * i->cy;
+					if (i == iInvalidatedRects.begin() || growth < cheapestGrowth)
+					{
+						cheapest = i;
+						cheapestGrowth = growth;
+					}
+				}
+				damage = damage.combine(*cheapest);
+				iInvalidatedRects.erase(cheapest);
+				merged = true;
+			}
+		}
+		iInvalidatedRects.push_back(damage);
+	}
+
+	void opengl_window::scroll(const rect& aArea, const delta& aDelta)
+	{
+		// The still valid part of aArea is copied within the frame buffer at the next render so only the newly
+		// exposed strips have to be repainted.
+		rect area = aArea.intersection(rect{ point{}, surface_size() });
+		if (area.empty())
+			return;
+		auto integral = [](coordinate aValue) { return aValue == std::floor(aValue); };
+		rect source = area.intersection(rect{ point{ area.x - aDelta.dx, area.y - aDelta.dy }, size{ area.cx, area.cy } });
+		if (source.empty() || !integral(area.x) || !integral(area.y) || !integral(area.cx) || !integral(area.cy) || !integral(aDelta.dx) || !integral(aDelta.dy))
+		{
+			invalidate(area);
+			return;
+		}
+		iPendingScrolls.push_back(std::make_pair(source, aDelta));
+		// damage that has not been rendered yet moves with the contents
+		std::vector<rect> movedDamage;
+		for (const auto& ir : iInvalidatedRects)
+		{
+			rect moved = ir.intersection(source);
+			if (!moved.empty())
+				movedDamage.push_back(rect{ point{ moved.x + aDelta.dx, moved.y + aDelta.dy }, size{ moved.cx, moved.cy } });
+		}
+		for (const auto& md : movedDamage)
+			invalidate(md);
+		if (aDelta.dy > 0.0)
+			invalidate(rect{ area.top_left(), size{ area.cx, aDelta.dy } });
+		else if (aDelta.dy < 0.0)
+			invalidate(rect{ point{ area.x, area.bottom() + aDelta.dy }, size{ area.cx, -aDelta.dy } });
+		if (aDelta.dx > 0.0)
+			invalidate(rect{ area.top_left(), size{ aDelta.dx, area.cy } });
+		else if (aDelta.dx < 0.0)
+			invalidate(rect{ point{ area.right() + aDelta.dx, area.y }, size{ -aDelta.dx, area.cy } });
 	}
 
 	bool opengl_window::has_invalidated_area() const
@@ -117,11 +190,27 @@ namespace neogfx
 		throw no_invalidated_area();
 	}
 
+	const std::vector<rect>& opengl_window::invalidated_rects() const
+	{
+		if (has_invalidated_area())
+			return iDamagedRects;
+		throw no_invalidated_area();
+	}
+
 	bool opengl_window::can_render() const
 	{
 		return !iPaused;
 	}
 
+	boost::optional<uint64_t> opengl_window::next_frame_time() const
+	{
+		if (iRendering || !can_render() || (iInvalidatedRects.empty() && !rendering_check.has_subscribers()))
+			return boost::none;
+		if (iFrameRate == boost::none)
+			return iLastFrameTime;
+		return iLastFrameTime + static_cast<uint64_t>(std::ceil(1000 / (has_rendering_priority() ? *iFrameRate : *iFrameRate / 10.0)));
+	}
+
 	void opengl_window::render(bool aOOBRequest)
 	{
 		if (iRendering || rendering_engine().creating_window() || !can_render())
@@ -146,24 +235,21 @@ namespace neogfx
 		if (iInvalidatedRects.empty())
 			return;
 
-		iInvalidatedArea = *iInvalidatedRects.begin();
-		for (const auto& ir : iInvalidatedRects)
+		iDamagedRects.clear();
+		for (auto ir : iInvalidatedRects)
 		{
-			*iInvalidatedArea = iInvalidatedArea->combine(ir);
+			ir.cx = std::min(ir.cx, surface_size().cx - ir.x);
+			ir.cy = std::min(ir.cy, surface_size().cy - ir.y);
+			ir = ir.ceil();
+			if (ir.cx > 0.0 && ir.cy > 0.0)
+				iDamagedRects.push_back(ir);
 		}
 		iInvalidatedRects.clear();
-		iInvalidatedArea->cx = std::min(iInvalidatedArea->cx, surface_size().cx - iInvalidatedArea->x);
-		iInvalidatedArea->cy = std::min(iInvalidatedArea->cy, surface_size().cy - iInvalidatedArea->y);
 
-		iInvalidatedArea = iInvalidatedArea->ceil();
-
-		if (iInvalidatedArea->cx <= 0.0 || iInvalidatedArea->cy <= 0.0)
-		{
-			iInvalidatedArea = boost::none;
+		if (iDamagedRects.empty())
 			return;
-		}
 
-		//std::cerr << "invalidated: " << *iInvalidatedArea << std::endl;
+		//std::cerr << "invalidated: " << iDamagedRects.size() << " rect(s)" << std::endl;
 
 		++iFrameCounter;
 
@@ -183,6 +269,7 @@ namespace neogfx
 		glCheck(glEnable(GL_BLEND));
 		if (iFrameBufferSize.cx < static_cast<double>(extents().cx) || iFrameBufferSize.cy < static_cast<double>(extents().cy))
 		{
+			iPendingScrolls.clear(); // nothing to scroll in a new frame buffer
 			if (iFrameBufferSize != size{})
 			{
 				glCheck(glDeleteRenderbuffers(1, &iDepthStencilBuffer));
@@ -217,11 +304,37 @@ namespace neogfx
 		GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0 };
 		glCheck(glDrawBuffers(sizeof(drawBuffers) / sizeof(drawBuffers[0]), drawBuffers));
 
+		apply_pending_scrolls();
+
+		// install glyphs rasterized in the background since the last frame and upload them in one go
+		rendering_engine().font_manager().update_glyph_atlas();
+
+		// one pass over the widget tree: each widget paints the damaged rects it intersects, clipped to each in turn
+		iInvalidatedArea = iDamagedRects.front();
+		for (const auto& damagedRect : iDamagedRects)
+			iInvalidatedArea = iInvalidatedArea->combine(damagedRect);
 		glCheck(iWindow.native_window_render(invalidated_area()));
 
 		glCheck(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0));
 		glCheck(glBindFramebuffer(GL_READ_FRAMEBUFFER, iFrameBuffer));
-		glCheck(glBlitFramebuffer(0, 0, static_cast<GLint>(extents().cx), static_cast<GLint>(extents().cy), 0, 0, static_cast<GLint>(extents().cx), static_cast<GLint>(extents().cy), GL_COLOR_BUFFER_BIT, GL_NEAREST));
+		if (rendering_engine().double_buffering()) // back buffer contents are undefined after a swap so present everything
+		{
+			glCheck(glBlitFramebuffer(0, 0, static_cast<GLint>(extents().cx), static_cast<GLint>(extents().cy), 0, 0, static_cast<GLint>(extents().cx), static_cast<GLint>(extents().cy), GL_COLOR_BUFFER_BIT, GL_NEAREST));
+		}
+		else
+		{
+			iScrolledRects.insert(iScrolledRects.end(), iDamagedRects.begin(), iDamagedRects.end());
+			for (const auto& presentRect : iScrolledRects)
+			{
+				GLint x0 = static_cast<GLint>(presentRect.left());
+				GLint y0 = static_cast<GLint>(extents().cy - presentRect.bottom());
+				GLint x1 = static_cast<GLint>(presentRect.right());
+				GLint y1 = static_cast<GLint>(extents().cy - presentRect.top());
+				glCheck(glBlitFramebuffer(x0, y0, x1, y1, x0, y0, x1, y1, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+			}
+		}
+
+		rendering_engine().font_manager().trim_glyph_atlas();
 
 		display();
 
@@ -236,6 +349,49 @@ namespace neogfx
 			iFpsData.pop_front();		
 	}
 
+	void opengl_window::apply_pending_scrolls()
+	{
+		iScrolledRects.clear();
+		if (iPendingScrolls.empty())
+			return;
+		// Overlapping copies within one (multisample) frame buffer are undefined so contents go via a single sample buffer.
+		if (iScrollBufferSize != iFrameBufferSize)
+		{
+			if (iScrollBufferSize != size{})
+			{
+				glCheck(glDeleteTextures(1, &iScrollBufferTexture));
+				glCheck(glDeleteFramebuffers(1, &iScrollBuffer));
+			}
+			iScrollBufferSize = iFrameBufferSize;
+			glCheck(glGenFramebuffers(1, &iScrollBuffer));
+			glCheck(glBindFramebuffer(GL_FRAMEBUFFER, iScrollBuffer));
+			glCheck(glGenTextures(1, &iScrollBufferTexture));
+			glCheck(glBindTexture(GL_TEXTURE_2D, iScrollBufferTexture));
+			glCheck(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, static_cast<GLsizei>(iScrollBufferSize.cx), static_cast<GLsizei>(iScrollBufferSize.cy), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+			glCheck(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, iScrollBufferTexture, 0));
+			glCheck(glBindTexture(GL_TEXTURE_2D, 0));
+		}
+		for (const auto& scroll : iPendingScrolls)
+		{
+			const rect& source = scroll.first;
+			GLint x0 = static_cast<GLint>(source.left());
+			GLint y0 = static_cast<GLint>(extents().cy - source.bottom());
+			GLint x1 = static_cast<GLint>(source.right());
+			GLint y1 = static_cast<GLint>(extents().cy - source.top());
+			GLint dx = static_cast<GLint>(scroll.second.dx);
+			GLint dy = static_cast<GLint>(-scroll.second.dy);
+			glCheck(glBindFramebuffer(GL_READ_FRAMEBUFFER, iFrameBuffer));
+			glCheck(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, iScrollBuffer));
+			glCheck(glBlitFramebuffer(x0, y0, x1, y1, x0, y0, x1, y1, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+			glCheck(glBindFramebuffer(GL_READ_FRAMEBUFFER, iScrollBuffer));
+			glCheck(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, iFrameBuffer));
+			glCheck(glBlitFramebuffer(x0, y0, x1, y1, x0 + dx, y0 + dy, x1 + dx, y1 + dy, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+			iScrolledRects.push_back(rect{ point{ source.x + scroll.second.dx, source.y + scroll.second.dy }, size{ source.cx, source.cy } });
+		}
+		iPendingScrolls.clear();
+		glCheck(glBindFramebuffer(GL_FRAMEBUFFER, iFrameBuffer));
+	}
+
 	void opengl_window::pause()
 	{
 		++iPaused;
@@ -302,6 +458,11 @@ namespace neogfx
 			glCheck(glDeleteRenderbuffers(1, &iDepthStencilBuffer));
 			glCheck(glDeleteTextures(1, &iFrameBufferTexture));
 			glCheck(glDeleteFramebuffers(1, &iFrameBuffer));
+			if (iScrollBufferSize != size{})
+			{
+				glCheck(glDeleteTextures(1, &iScrollBufferTexture));
+				glCheck(glDeleteFramebuffers(1, &iScrollBuffer));
+			}
 		}
 	}
 
@@ -40,6 +40,8 @@ namespace neogfx
 			failed_to_create_framebuffer(GLenum aErrorCode) : 
 				std::runtime_error("neogfx::opengl_window::failed_to_create_framebuffer: Failed to create frame buffer, reason: " + glErrorString(aErrorCode)) {} };
 		struct busy_rendering : std::logic_error { busy_rendering() : std::logic_error("neogfx::opengl_window::busy_rendering") {} };
+	private:
+		static const std::size_t kMaxInvalidatedRects = 16;
 	public:
 		opengl_window(i_rendering_engine& aRenderingEngine, i_surface_manager& aSurfaceManager, i_window& aWindow);
 		~opengl_window();
@@ -54,9 +56,12 @@ namespace neogfx
 		double fps() const override;
 	public:
 		void invalidate(const rect& aInvalidatedRect) override;
+		void scroll(const rect& aArea, const delta& aDelta) override;
 		bool has_invalidated_area() const override;
 		const rect& invalidated_area() const override;
+		const std::vector<rect>& invalidated_rects() const override;
 		bool can_render() const override;
+		boost::optional<uint64_t> next_frame_time() const override;
 		void render(bool aOOBRequest = false) override;
 		void pause() override;
 		void resume() override;
@@ -74,6 +79,7 @@ namespace neogfx
 		void destroying();
 		void destroyed();
 	private:
+		void apply_pending_scrolls();
 		virtual void display() = 0;
 	private:
 		i_window& iWindow;
@@ -84,7 +90,13 @@ namespace neogfx
 		GLuint iFrameBufferTexture;
 		GLuint iDepthStencilBuffer;
 		size iFrameBufferSize;
-		std::unordered_set<rect> iInvalidatedRects;
+		std::vector<rect> iInvalidatedRects;
+		std::vector<rect> iDamagedRects;
+		std::vector<std::pair<rect, delta>> iPendingScrolls;
+		std::vector<rect> iScrolledRects;
+		GLuint iScrollBuffer;
+		GLuint iScrollBufferTexture;
+		size iScrollBufferSize;
 		boost::optional<rect> iInvalidatedArea;
 		uint64_t iFrameCounter;
 		boost::optional<uint32_t> iFrameRate;
@@ -0,0 +1,446 @@
+// software_window.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <neogfx/app/app.hpp>
+#include "../../../gfx/native/software_renderer.hpp"
+#include "../../../gfx/native/software_graphics_context.hpp"
+#include "software_window.hpp"
+
+namespace neogfx
+{
+	software_window::software_window(software_renderer& aRenderingEngine, i_surface_manager& aSurfaceManager, i_window& aWindow, const point& aPosition, const size& aDimensions, window_style aStyle) :
+		native_window(aRenderingEngine, aSurfaceManager),
+		iWindow(aWindow),
+		iLogicalCoordinateSystem(neogfx::logical_coordinate_system::AutomaticGui),
+		iPosition(aPosition),
+		iExtents(aDimensions),
+		iFrameBuffer(aDimensions),
+		iMouseButtons(mouse_button::None),
+		iFrameCounter(0),
+		iFrameRate(60),
+		iLastFrameTime(0),
+		iLastFrameDuration(0.0),
+		iRendering(false),
+		iPaused(0),
+		iVisible(false),
+		iActive(false),
+		iEnabled(true),
+		iCapturingMouse(false),
+		iDestroyed(false)
+	{
+		if ((aStyle & window_style::InitiallyHidden) != window_style::InitiallyHidden)
+			show((aStyle & window_style::NoActivate) != window_style::NoActivate);
+	}
+
+	software_window::~software_window()
+	{
+		close();
+		if (rendering_engine().active_context_surface() == this)
+			rendering_engine().deactivate_context();
+	}
+
+	const software_frame_buffer& software_window::frame_buffer() const
+	{
+		return iFrameBuffer;
+	}
+
+	void software_window::push_event(const native_event& aEvent)
+	{
+		// there is no system to query so mouse state is tracked from the (synthesized) events themselves
+		if (aEvent.is<mouse_event>())
+		{
+			const auto& mouseEvent = static_variant_cast<const mouse_event&>(aEvent);
+			switch (mouseEvent.type())
+			{
+			case mouse_event::ButtonPressed:
+			case mouse_event::ButtonDoubleClicked:
+				iMousePosition = mouseEvent.position();
+				iMouseButtons = iMouseButtons | mouseEvent.mouse_button();
+				break;
+			case mouse_event::ButtonReleased:
+				iMousePosition = mouseEvent.position();
+				iMouseButtons = iMouseButtons & ~mouseEvent.mouse_button();
+				break;
+			case mouse_event::Moved:
+				iMousePosition = mouseEvent.position();
+				break;
+			default:
+				break;
+			}
+		}
+		native_window::push_event(aEvent);
+	}
+
+	neogfx::logical_coordinate_system software_window::logical_coordinate_system() const
+	{
+		return iLogicalCoordinateSystem;
+	}
+
+	void software_window::set_logical_coordinate_system(neogfx::logical_coordinate_system aSystem)
+	{
+		iLogicalCoordinateSystem = aSystem;
+	}
+
+	const std::pair<vec2, vec2>& software_window::logical_coordinates() const
+	{
+		switch (iLogicalCoordinateSystem)
+		{
+		case neogfx::logical_coordinate_system::Specified:
+			return iLogicalCoordinates;
+		case neogfx::logical_coordinate_system::AutomaticGui:
+			return iLogicalCoordinates = std::make_pair<vec2, vec2>({ 0.0, extents().cy }, { extents().cx, 0.0 });
+		case neogfx::logical_coordinate_system::AutomaticGame:
+			return iLogicalCoordinates = std::make_pair<vec2, vec2>({ 0.0, 0.0 }, { extents().cx, extents().cy });
+		}
+		return iLogicalCoordinates;
+	}
+
+	void software_window::set_logical_coordinates(const std::pair<vec2, vec2>& aCoordinates)
+	{
+		iLogicalCoordinates = aCoordinates;
+	}
+
+	void* software_window::handle() const
+	{
+		return const_cast<software_window*>(this);
+	}
+
+	void* software_window::native_handle() const
+	{
+		return nullptr;
+	}
+
+	point software_window::surface_position() const
+	{
+		return iPosition;
+	}
+
+	void software_window::move_surface(const point& aPosition)
+	{
+		iPosition = aPosition;
+	}
+
+	size software_window::surface_size() const
+	{
+		return iExtents;
+	}
+
+	void software_window::resize_surface(const size& aSize)
+	{
+		if (iExtents != aSize)
+		{
+			iExtents = aSize;
+			push_event(window_event(window_event::SizeChanged, iExtents));
+		}
+	}
+
+	point software_window::mouse_position() const
+	{
+		return iMousePosition;
+	}
+
+	bool software_window::is_mouse_button_pressed(mouse_button aButton) const
+	{
+		return (aButton & iMouseButtons) != mouse_button::None;
+	}
+
+	void software_window::save_mouse_cursor()
+	{
+	}
+
+	void software_window::set_mouse_cursor(mouse_system_cursor)
+	{
+	}
+
+	void software_window::restore_mouse_cursor()
+	{
+	}
+
+	void software_window::update_mouse_cursor()
+	{
+	}
+
+	uint64_t software_window::frame_counter() const
+	{
+		return iFrameCounter;
+	}
+
+	void software_window::limit_frame_rate(uint32_t aFps)
+	{
+		iFrameRate = aFps;
+	}
+
+	double software_window::fps() const
+	{
+		return iLastFrameDuration != 0.0 ? 1000.0 / iLastFrameDuration : 0.0;
+	}
+
+	void software_window::invalidate(const rect& aInvalidatedRect)
+	{
+		if (aInvalidatedRect.cx == 0.0 || aInvalidatedRect.cy == 0.0)
+			return;
+		iDamage = (iDamage == boost::none ? aInvalidatedRect : iDamage->combine(aInvalidatedRect));
+	}
+
+	void software_window::scroll(const rect& aArea, const delta&)
+	{
+		// repainting the area costs about the same as moving its pixels in memory
+		invalidate(aArea);
+	}
+
+	bool software_window::has_invalidated_area() const
+	{
+		return iInvalidatedArea != boost::none;
+	}
+
+	const rect& software_window::invalidated_area() const
+	{
+		if (has_invalidated_area())
+			return *iInvalidatedArea;
+		throw no_invalidated_area();
+	}
+
+	const std::vector<rect>& software_window::invalidated_rects() const
+	{
+		if (has_invalidated_area())
+			return iInvalidatedRects;
+		throw no_invalidated_area();
+	}
+
+	bool software_window::can_render() const
+	{
+		return is_visible() && !iPaused;
+	}
+
+	boost::optional<uint64_t> software_window::next_frame_time() const
+	{
+		if (iRendering || !can_render() || (iDamage == boost::none && !rendering_check.has_subscribers()))
+			return boost::none;
+		if (iFrameRate == boost::none)
+			return iLastFrameTime;
+		return iLastFrameTime + static_cast<uint64_t>(std::ceil(1000 / (has_rendering_priority() ? *iFrameRate : *iFrameRate / 10.0)));
+	}
+
+	void software_window::render(bool aOOBRequest)
+	{
+		if (iRendering || rendering_engine().creating_window() || !can_render())
+			return;
+
+		uint64_t now = app::instance().program_elapsed_ms();
+
+		if (!aOOBRequest)
+		{
+			if (processing_event())
+				return;
+
+			if (iFrameRate != boost::none && now - iLastFrameTime < 1000 / (has_rendering_priority() ? *iFrameRate : *iFrameRate / 10.0))
+				return;
+
+			if (!iWindow.native_window_ready_to_render())
+				return;
+		}
+
+		rendering_check.trigger();
+
+		if (iFrameBuffer.extents() != surface_size().ceil())
+		{
+			iFrameBuffer.resize(surface_size());
+			invalidate(rect{ point{}, surface_size() });
+		}
+
+		if (iDamage == boost::none)
+			return;
+
+		rect damage = iDamage->intersection(rect{ point{}, surface_size() }).ceil();
+		iDamage = boost::none;
+
+		if (damage.empty())
+			return;
+
+		++iFrameCounter;
+
+		iRendering = true;
+		iLastFrameTime = now;
+
+		rendering.trigger();
+
+		rendering_engine().activate_context(*this);
+
+		rendering_engine().font_manager().update_glyph_atlas();
+
+		iInvalidatedArea = damage;
+		iInvalidatedRects.assign(1, damage);
+		iWindow.native_window_render(invalidated_area());
+		iInvalidatedArea = boost::none;
+		iInvalidatedRects.clear();
+
+		rendering_engine().font_manager().trim_glyph_atlas();
+		static_cast<software_renderer&>(rendering_engine()).glyph_cache().trim();
+
+		rendering_engine().deactivate_context();
+
+		iRendering = false;
+
+		rendering_finished.trigger();
+
+		iLastFrameDuration = static_cast<double>(app::instance().program_elapsed_ms() - now);
+	}
+
+	void software_window::pause()
+	{
+		++iPaused;
+	}
+
+	void software_window::resume()
+	{
+		--iPaused;
+	}
+
+	bool software_window::is_rendering() const
+	{
+		return iRendering;
+	}
+
+	void* software_window::rendering_target_texture_handle() const
+	{
+		return nullptr;
+	}
+
+	size software_window::rendering_target_texture_extents() const
+	{
+		return iFrameBuffer.extents();
+	}
+
+	std::unique_ptr<i_native_graphics_context> software_window::create_graphics_context() const
+	{
+		return std::unique_ptr<i_native_graphics_context>(new software_graphics_context(*this, iFrameBuffer, static_cast<software_renderer&>(rendering_engine()).glyph_cache()));
+	}
+
+	std::unique_ptr<i_native_graphics_context> software_window::create_graphics_context(const i_widget& aWidget) const
+	{
+		return std::unique_ptr<i_native_graphics_context>(new software_graphics_context(*this, iFrameBuffer, static_cast<software_renderer&>(rendering_engine()).glyph_cache(), aWidget));
+	}
+
+	bool software_window::metrics_available() const
+	{
+		return true;
+	}
+
+	size software_window::extents() const
+	{
+		return surface_size();
+	}
+
+	dimension software_window::horizontal_dpi() const
+	{
+		return rendering_engine().screen_metrics().horizontal_dpi();
+	}
+
+	dimension software_window::vertical_dpi() const
+	{
+		return rendering_engine().screen_metrics().vertical_dpi();
+	}
+
+	dimension software_window::em_size() const
+	{
+		return 0;
+	}
+
+	i_window& software_window::window() const
+	{
+		return iWindow;
+	}
+
+	void software_window::close()
+	{
+		if (!iDestroyed && window().native_window_can_close())
+		{
+			release_capture();
+			window().native_window_closing();
+			iDestroyed = true;
+			window().native_window_closed();
+		}
+	}
+
+	bool software_window::is_visible() const
+	{
+		return iVisible;
+	}
+
+	void software_window::show(bool aActivate)
+	{
+		iVisible = true;
+		if (aActivate)
+			activate();
+	}
+
+	void software_window::hide()
+	{
+		iVisible = false;
+		if (iActive)
+		{
+			iActive = false;
+			push_event(window_event(window_event::FocusLost));
+		}
+	}
+
+	bool software_window::is_active() const
+	{
+		return iActive;
+	}
+
+	void software_window::activate()
+	{
+		if (!is_enabled() || iActive)
+			return;
+		iActive = true;
+		push_event(window_event(window_event::FocusGained));
+	}
+
+	bool software_window::is_enabled() const
+	{
+		return iEnabled;
+	}
+
+	void software_window::enable(bool aEnable)
+	{
+		iEnabled = aEnable;
+	}
+
+	bool software_window::is_capturing() const
+	{
+		return iCapturingMouse;
+	}
+
+	void software_window::set_capture()
+	{
+		iCapturingMouse = true;
+	}
+
+	void software_window::release_capture()
+	{
+		iCapturingMouse = false;
+	}
+
+	bool software_window::is_destroyed() const
+	{
+		return iDestroyed;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+// software_window.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <boost/optional.hpp>
+#include <neogfx/gui/window/window.hpp>
+#include "../../../gfx/native/software_frame_buffer.hpp"
+#include "native_window.hpp"
+
+namespace neogfx
+{
+	class software_renderer;
+
+	// Offscreen window created by software_renderer; what would be presented on screen is left in frame_buffer().
+	class software_window : public native_window
+	{
+	public:
+		software_window(software_renderer& aRenderingEngine, i_surface_manager& aSurfaceManager, i_window& aWindow, const point& aPosition, const size& aDimensions, window_style aStyle = window_style::Default);
+		~software_window();
+	public:
+		const software_frame_buffer& frame_buffer() const;
+	public:
+		void push_event(const native_event& aEvent) override;
+	public:
+		neogfx::logical_coordinate_system logical_coordinate_system() const override;
+		void set_logical_coordinate_system(neogfx::logical_coordinate_system aSystem) override;
+		const std::pair<vec2, vec2>& logical_coordinates() const override;
+		void set_logical_coordinates(const std::pair<vec2, vec2>& aCoordinates) override;
+	public:
+		void* handle() const override;
+		void* native_handle() const override;
+		point surface_position() const override;
+		void move_surface(const point& aPosition) override;
+		size surface_size() const override;
+		void resize_surface(const size& aSize) override;
+		point mouse_position() const override;
+		bool is_mouse_button_pressed(mouse_button aButton) const override;
+	public:
+		void save_mouse_cursor() override;
+		void set_mouse_cursor(mouse_system_cursor aSystemCursor) override;
+		void restore_mouse_cursor() override;
+		void update_mouse_cursor() override;
+	public:
+		uint64_t frame_counter() const override;
+		void limit_frame_rate(uint32_t aFps) override;
+		double fps() const override;
+	public:
+		void invalidate(const rect& aInvalidatedRect) override;
+		void scroll(const rect& aArea, const delta& aDelta) override;
+		bool has_invalidated_area() const override;
+		const rect& invalidated_area() const override;
+		const std::vector<rect>& invalidated_rects() const override;
+		bool can_render() const override;
+		boost::optional<uint64_t> next_frame_time() const override;
+		void render(bool aOOBRequest = false) override;
+		void pause() override;
+		void resume() override;
+		bool is_rendering() const override;
+		void* rendering_target_texture_handle() const override;
+		size rendering_target_texture_extents() const override;
+		std::unique_ptr<i_native_graphics_context> create_graphics_context() const override;
+		std::unique_ptr<i_native_graphics_context> create_graphics_context(const i_widget& aWidget) const override;
+	public:
+		bool metrics_available() const override;
+		size extents() const override;
+		dimension horizontal_dpi() const override;
+		dimension vertical_dpi() const override;
+		dimension em_size() const override;
+	public:
+		i_window& window() const override;
+		void close() override;
+		bool is_visible() const override;
+		void show(bool aActivate = false) override;
+		void hide() override;
+		bool is_active() const override;
+		void activate() override;
+		bool is_enabled() const override;
+		void enable(bool aEnable) override;
+		bool is_capturing() const override;
+		void set_capture() override;
+		void release_capture() override;
+		bool is_destroyed() const override;
+	private:
+		i_window& iWindow;
+		neogfx::logical_coordinate_system iLogicalCoordinateSystem;
+		mutable std::pair<vec2, vec2> iLogicalCoordinates;
+		point iPosition;
+		size iExtents;
+		mutable software_frame_buffer iFrameBuffer;
+		boost::optional<rect> iDamage;
+		boost::optional<rect> iInvalidatedArea;
+		std::vector<rect> iInvalidatedRects;
+		point iMousePosition;
+		mouse_button iMouseButtons;
+		uint64_t iFrameCounter;
+		boost::optional<uint32_t> iFrameRate;
+		uint64_t iLastFrameTime;
+		double iLastFrameDuration;
+		bool iRendering;
+		uint32_t iPaused;
+		bool iVisible;
+		bool iActive;
+		bool iEnabled;
+		bool iCapturingMouse;
+		bool iDestroyed;
+	};
+}
\ No newline at end of file
@@ -24,6 +24,7 @@
 #include <neogfx/app/app.hpp>
 #include <neogfx/gui/window/window.hpp>
 #include <neogfx/gui/layout/i_layout.hpp>
+#include <neogfx/gui/layout/layout_item.hpp>
 #include "native/i_native_window.hpp"
 #include "../../hid/native/i_native_surface.hpp"
 
@@ -458,6 +459,7 @@ namespace neogfx
 
 	void window::layout_surface()
 	{
+		layout_item::invalidate_all_size_hints();
 		widget::layout_items();
 	}
 
@@ -468,6 +470,11 @@ namespace neogfx
 			update(aInvalidatedRect);
 	}
 
+	void window::scroll_surface(const rect& aArea, const delta& aDelta)
+	{
+		native_surface().scroll(aArea, aDelta);
+	}
+
 	bool window::has_invalidated_area() const
 	{
 		return native_surface().has_invalidated_area();
@@ -478,6 +485,11 @@ namespace neogfx
 		return native_surface().invalidated_area();
 	}
 
+	const std::vector<rect>& window::invalidated_rects() const
+	{
+		return native_surface().invalidated_rects();
+	}
+
 	bool window::has_rendering_priority() const
 	{
 		return is_active();
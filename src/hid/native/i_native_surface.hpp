@@ -69,9 +69,12 @@ namespace neogfx
 		virtual double fps() const = 0;
 	public:
 		virtual void invalidate(const rect& aInvalidatedRect) = 0;
+		virtual void scroll(const rect& aArea, const delta& aDelta) = 0;
 		virtual bool has_invalidated_area() const = 0;
 		virtual const rect& invalidated_area() const = 0;
+		virtual const std::vector<rect>& invalidated_rects() const = 0;
 		virtual bool can_render() const = 0;
+		virtual boost::optional<uint64_t> next_frame_time() const = 0;
 		virtual void render(bool aOOBRequest = false) = 0;
 		virtual void pause() = 0;
 		virtual void resume() = 0;
@@ -116,11 +116,40 @@ namespace neogfx
 		if (iRenderingSurfaces || iRenderingEngine.creating_window())
 			return;
 		iRenderingSurfaces = true;
+		if (iRenderingEngine.texture_manager().uploads_pending())
+		{
+			auto damage = iRenderingEngine.texture_manager().process_uploads();
+			for (auto& s : iSurfaces)
+			{
+				if (s->destroyed())
+					continue;
+				boost::optional<rect> surfaceDamage;
+				for (auto& d : damage)
+					if (d.first == &s->native_surface())
+						surfaceDamage = (surfaceDamage == boost::none ? d.second : surfaceDamage->combine(d.second));
+				if (surfaceDamage != boost::none)
+					s->invalidate_surface(*surfaceDamage, false);
+			}
+		}
 		for (auto& s : iSurfaces)
 			s->render_surface();
 		iRenderingSurfaces = false;
 	}
 
+	boost::optional<uint64_t> surface_manager::next_frame_time() const
+	{
+		boost::optional<uint64_t> result;
+		for (auto& s : iSurfaces)
+		{
+			if (s->destroyed())
+				continue;
+			auto surfaceFrameTime = s->native_surface().next_frame_time();
+			if (surfaceFrameTime != boost::none && (result == boost::none || *surfaceFrameTime < *result))
+				result = surfaceFrameTime;
+		}
+		return result;
+	}
+
 	void surface_manager::display_error_message(const std::string& aTitle, const std::string& aMessage) const
 	{
 		for (auto i = iSurfaces.begin(); i != iSurfaces.end(); ++i)
@@ -0,0 +1,147 @@
+// glyph_bitmap_bench.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2017 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Standalone equivalence check and benchmark for the glyph bitmap kernels in src/gfx/text/native/glyph_bitmap.cpp;
+// it is not part of the solution. Build it from the repository root against the kernels alone, e.g.
+//   g++ -std=c++14 -O2 -Iinclude -I<neolib>/include tests/glyph_bitmap_bench.cpp src/gfx/text/native/glyph_bitmap.cpp
+// adding -mavx2 (or /arch:AVX2) for the AVX2 paths. Pass --check to run the equivalence check only.
+
+#include <neogfx/neogfx.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <array>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include "../src/gfx/text/native/glyph_bitmap.hpp"
+
+namespace
+{
+	typedef std::array<uint8_t, 4> pixel;
+	typedef std::vector<pixel> pixel_buffer;
+
+	// the loops glyph_texture() used before the kernels, kept as the reference output
+	void reference_subpixel(const uint8_t* aBuffer, uint32_t aWidth, uint32_t aRows, uint32_t aPitch, pixel_buffer& aOutput, uint32_t aOutputWidth)
+	{
+		static const double coefficients[] = { 1.5 / 16.0, 3.0 / 16.0, 7.0 / 16.0, 3.0 / 16.0, 1.5 / 16.0 };
+		for (uint32_t y = 0; y < aRows; y++)
+			for (uint32_t x = 0; x < aWidth; x++)
+			{
+				uint8_t alpha = 0;
+				for (int32_t z = 0; z < 5; ++z)
+					alpha += static_cast<uint8_t>(aBuffer[std::min<int32_t>(std::max<int32_t>(0, x - z + 2), aWidth - 1) + aPitch * y] * coefficients[z]);
+				aOutput[(x / 3 + 1) + (y + 1) * static_cast<std::size_t>(aOutputWidth)][x % 3] = alpha;
+			}
+	}
+
+	void reference_greyscale(const uint8_t* aBuffer, uint32_t aWidth, uint32_t aRows, uint32_t aPitch, pixel_buffer& aOutput, uint32_t aOutputWidth)
+	{
+		for (uint32_t y = 0; y < aRows; y++)
+			for (uint32_t x = 0; x < aWidth; x++)
+				aOutput[(x + 1) + (y + 1) * static_cast<std::size_t>(aOutputWidth)][3] = aBuffer[x + aPitch * y];
+	}
+
+	void kernel_subpixel(const uint8_t* aBuffer, uint32_t aWidth, uint32_t aRows, uint32_t aPitch, pixel_buffer& aOutput, uint32_t aOutputWidth)
+	{
+		std::vector<uint8_t> filtered(aWidth);
+		for (uint32_t y = 0; y < aRows; y++)
+		{
+			neogfx::lcd_filter_row(aBuffer + static_cast<std::size_t>(aPitch) * y, aWidth, &filtered[0]);
+			neogfx::subpixels_to_rgba(&filtered[0], aWidth, &aOutput[1 + (y + 1) * static_cast<std::size_t>(aOutputWidth)][0]);
+		}
+	}
+
+	void kernel_greyscale(const uint8_t* aBuffer, uint32_t aWidth, uint32_t aRows, uint32_t aPitch, pixel_buffer& aOutput, uint32_t aOutputWidth)
+	{
+		for (uint32_t y = 0; y < aRows; y++)
+			neogfx::coverage_to_rgba(aBuffer + static_cast<std::size_t>(aPitch) * y, aWidth, &aOutput[1 + (y + 1) * static_cast<std::size_t>(aOutputWidth)][0]);
+	}
+
+	typedef void (*conversion)(const uint8_t*, uint32_t, uint32_t, uint32_t, pixel_buffer&, uint32_t);
+
+	// every row width from 1 to 199 in both modes, with padded pitches and saturated coverage mixed in
+	bool check(std::mt19937& aRandom)
+	{
+		for (uint32_t width = 1; width < 200; ++width)
+			for (int subpixel = 0; subpixel < 2; ++subpixel)
+			{
+				const uint32_t rows = 3;
+				const uint32_t pitch = width + aRandom() % 5;
+				std::vector<uint8_t> buffer(static_cast<std::size_t>(pitch) * rows);
+				for (auto& b : buffer)
+					b = static_cast<uint8_t>(aRandom() % 4 == 0 ? 255 : aRandom());
+				const uint32_t outputWidth = (subpixel ? (width + 2) / 3 : width) + 2;
+				pixel_buffer expected(static_cast<std::size_t>(outputWidth) * (rows + 2), pixel{});
+				pixel_buffer actual(expected);
+				(subpixel ? reference_subpixel : reference_greyscale)(&buffer[0], width, rows, pitch, expected, outputWidth);
+				(subpixel ? kernel_subpixel : kernel_greyscale)(&buffer[0], width, rows, pitch, actual, outputWidth);
+				if (actual != expected)
+				{
+					std::printf("mismatch: width %u, %s\n", width, subpixel ? "subpixel" : "greyscale");
+					return false;
+				}
+			}
+		return true;
+	}
+
+	double time_per_glyph(conversion aConversion, const std::vector<uint8_t>& aBuffer, uint32_t aWidth, uint32_t aRows, uint32_t aPitch, pixel_buffer& aOutput, uint32_t aOutputWidth)
+	{
+		const int iterations = std::max(1, 20000000 / static_cast<int>(aWidth * aRows));
+		volatile uint32_t sink = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; ++i)
+		{
+			aConversion(&aBuffer[0], aWidth, aRows, aPitch, aOutput, aOutputWidth);
+			sink = sink + aOutput[aOutput.size() / 2][i % 4];
+		}
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::mt19937 random(42);
+	if (!check(random))
+		return EXIT_FAILURE;
+	std::printf("kernels match the reference loops\n");
+	if (argc > 1 && std::strcmp(argv[1], "--check") == 0)
+		return EXIT_SUCCESS;
+	struct glyph_size { const char* name; uint32_t cx; uint32_t cy; };
+	const glyph_size sizes[] = { { "12pt", 10, 14 }, { "36pt", 30, 40 }, { "144pt", 120, 160 } };
+	for (auto const& s : sizes)
+		for (int subpixel = 0; subpixel < 2; ++subpixel)
+		{
+			const uint32_t width = subpixel ? s.cx * 3 : s.cx;
+			const uint32_t rows = s.cy;
+			const uint32_t pitch = (width + 3) & ~3u;
+			std::vector<uint8_t> buffer(static_cast<std::size_t>(pitch) * rows);
+			for (auto& b : buffer)
+				b = static_cast<uint8_t>(random());
+			const uint32_t outputWidth = s.cx + 2;
+			pixel_buffer output(static_cast<std::size_t>(outputWidth) * (rows + 2), pixel{});
+			double reference = time_per_glyph(subpixel ? reference_subpixel : reference_greyscale, buffer, width, rows, pitch, output, outputWidth);
+			double kernel = time_per_glyph(subpixel ? kernel_subpixel : kernel_greyscale, buffer, width, rows, pitch, output, outputWidth);
+			std::printf("%-6s %-10s reference %9.0f ns  kernels %9.0f ns  x%.1f\n", s.name, subpixel ? "subpixel" : "greyscale", reference, kernel, reference / kernel);
+		}
+	return EXIT_SUCCESS;
+}
\ No newline at end of file